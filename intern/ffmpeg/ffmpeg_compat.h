@@ -775,4 +775,23 @@ int avpicture_deinterlace(
 
 #endif
 
+/* The seek index of a stream is only accessible through functions since FFmpeg 4.4, the
+ * #AVStream fields were made private in FFmpeg 5. */
+#if LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(58, 78, 100)
+FFMPEG_INLINE
+int avformat_index_get_entries_count(const AVStream *st)
+{
+  return st->nb_index_entries;
+}
+
+FFMPEG_INLINE
+const AVIndexEntry *avformat_index_get_entry(AVStream *st, int idx)
+{
+  if (idx < 0 || idx >= st->nb_index_entries) {
+    return NULL;
+  }
+  return &st->index_entries[idx];
+}
+#endif
+
 #endif
@@ -193,6 +193,8 @@ class SEQUENCER_MT_view_cache(Menu):
         col.prop(ed, "show_cache_raw")
         col.prop(ed, "show_cache_preprocessed")
         col.prop(ed, "show_cache_composite")
+        col.separator()
+        col.prop(ed, "show_cache_render_time")
 
 
 class SEQUENCER_MT_range(Menu):
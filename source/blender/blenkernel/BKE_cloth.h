@@ -29,6 +29,7 @@
 extern "C" {
 #endif
 
+struct BVHTreeOverlap;
 struct ClothModifierData;
 struct CollisionModifierData;
 struct Depsgraph;
@@ -86,8 +87,7 @@ typedef struct Cloth {
   unsigned char old_solver_type; /* unused, only 1 solver here */
   unsigned char pad2;
   short pad3;
-  struct BVHTree *bvhtree;     /* collision tree for this cloth object */
-  struct BVHTree *bvhselftree; /* collision tree for this cloth object */
+  struct BVHTree *bvhtree; /* collision tree for this cloth object */
   struct MVertTri *tri;
   struct Implicit_Data *implicit; /* our implicit solver connects to this pointer */
   struct EdgeSet *edgeset;        /* used for selfcollisions */
@@ -96,6 +96,7 @@ typedef struct Cloth {
   float average_acceleration[3];  /* Moving average of overall acceleration. */
   struct MEdge *edges;            /* Used for hair collisions. */
   struct EdgeSet *sew_edge_graph; /* Sewing edges represented using a GHash */
+  struct ClothSelfCollisionCache *selfcoll_cache; /* Self collision candidates, see collision.c */
 } Cloth;
 
 /**
@@ -231,6 +232,12 @@ int cloth_bvh_collision(struct Depsgraph *depsgraph,
                         float step,
                         float dt);
 
+void cloth_selfcollision_cache_free(struct Cloth *cloth);
+struct BVHTreeOverlap *cloth_selfcollision_candidates_find(const struct Cloth *cloth,
+                                                           float bounds_pad,
+                                                           bool sewing_active,
+                                                           unsigned int *r_overlap_num);
+
 ////////////////////////////////////////////////
 
 /////////////////////////////////////////////////
@@ -250,7 +257,7 @@ void clothModifier_do(struct ClothModifierData *clmd,
 int cloth_uses_vgroup(struct ClothModifierData *clmd);
 
 // needed for collision.c
-void bvhtree_update_from_cloth(struct ClothModifierData *clmd, bool moving, bool self);
+void bvhtree_update_from_cloth(struct ClothModifierData *clmd, bool moving);
 
 // needed for button_object.c
 void cloth_clear_cache(struct Object *ob, struct ClothModifierData *clmd, float framenr);
@@ -470,6 +470,16 @@ void psys_apply_hair_lattice(struct Depsgraph *depsgraph,
 struct ParticleSystem *psys_get_target_system(struct Object *ob, struct ParticleTarget *pt);
 void psys_count_keyed_targets(struct ParticleSimulationData *sim);
 void psys_update_particle_tree(struct ParticleSystem *psys, float cfra);
+void psys_update_particle_neighbor_grid(struct ParticleSystem *psys, float cfra, float cell_size);
+void psys_neighbor_grid_range_query(const struct ParticleSystem *psys,
+                                    const float co[3],
+                                    float radius,
+                                    void (*callback)(void *userdata,
+                                                     int index,
+                                                     const float co[3],
+                                                     float dist_sq),
+                                    void *userdata);
+void psys_free_neighbor_grid(struct ParticleSystem *psys);
 void psys_changed_type(struct Object *ob, struct ParticleSystem *psys);
 
 void psys_make_temp_pointcache(struct Object *ob, struct ParticleSystem *psys);
@@ -537,6 +547,9 @@ void psys_mat_hair_to_orco(struct Object *ob,
 float psys_get_dietime_from_cache(struct PointCache *cache, int index);
 
 void psys_free_pdd(struct ParticleSystem *psys);
+void psys_free_child_path_cache(struct ParticleSystem *psys);
+bool psys_child_path_settings_equal(const struct ParticleSettings *part_a,
+                                    const struct ParticleSettings *part_b);
 
 float *psys_cache_vgroup(struct Mesh *mesh, struct ParticleSystem *psys, int vgroup);
 void psys_get_texture(struct ParticleSimulationData *sim,
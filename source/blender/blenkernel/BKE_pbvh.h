@@ -128,6 +128,18 @@ void BKE_pbvh_build_bmesh(PBVH *pbvh,
                           const int cd_face_node_offset);
 void BKE_pbvh_free(PBVH *pbvh);
 
+/* Statistics of the last build, also logged with `--log "bke.pbvh"`. */
+typedef struct PBVHBuildStats {
+  double build_time;
+  int totnode, totleaf, max_depth;
+  int leaf_prims_min, leaf_prims_max;
+  float leaf_prims_avg;
+  /** Surface area heuristic cost, relative to the bounds of the root node. */
+  float sah_cost;
+} PBVHBuildStats;
+
+void BKE_pbvh_build_stats_get(const PBVH *pbvh, PBVHBuildStats *r_stats);
+
 /* Hierarchical Search in the BVH, two methods:
  * - for each hit calling a callback
  * - gather nodes in an array (easy to multithread) */
@@ -318,6 +330,7 @@ void BKE_pbvh_face_sets_set(PBVH *pbvh, int *face_sets);
 void BKE_pbvh_face_sets_color_set(PBVH *pbvh, int seed, int color_default);
 
 void BKE_pbvh_respect_hide_set(PBVH *pbvh, bool respect_hide);
+void BKE_pbvh_use_sah_split_set(PBVH *pbvh, bool use_sah_split);
 
 /* vertex deformer */
 float (*BKE_pbvh_vert_coords_alloc(struct PBVH *pbvh))[3];
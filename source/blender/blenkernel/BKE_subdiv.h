@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include "BLI_bitmap.h"
 #include "BLI_compiler_compat.h"
 #include "BLI_sys_types.h"
 
@@ -190,6 +191,15 @@ typedef struct Subdiv {
     /* Indexed by base face index, element indicates total number of ptex
      * faces created for preceding base faces. */
     int *face_ptex_offset;
+    /* Hash of the mesh topology the topology refiner was created or last verified for, see
+     * BKE_subdiv_converter_topology_hash_for_mesh(). Zero when unknown. */
+    uint64_t topology_hash;
+    /* Indexed by coarse mesh vertex index, set for vertices which are used by faces (so are known
+     * to OpenSubdiv). Calculated on the first refinement from mesh. */
+    BLI_bitmap *coarse_vertex_used_map;
+    int coarse_vertex_used_map_len;
+    /* All coarse vertices are used by faces, so their coordinates can be passed as-is. */
+    bool coarse_vertex_all_used;
   } cache_;
 } Subdiv;
 
@@ -1758,6 +1758,85 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+static bool mesh_eval_customdata_equal(const CustomData *cd_a,
+                                       const CustomData *cd_b,
+                                       const int totelem,
+                                       const CustomDataMask ignore_mask)
+{
+  if (cd_a->totlayer != cd_b->totlayer) {
+    return false;
+  }
+  for (int i = 0; i < cd_a->totlayer; i++) {
+    const CustomDataLayer *layer_a = &cd_a->layers[i];
+    const CustomDataLayer *layer_b = &cd_b->layers[i];
+    if (layer_a->type != layer_b->type) {
+      return false;
+    }
+    if (CD_TYPE_AS_MASK(layer_a->type) & ignore_mask) {
+      continue;
+    }
+    if (layer_a->flag != layer_b->flag || layer_a->active != layer_b->active ||
+        layer_a->active_rnd != layer_b->active_rnd || !STREQ(layer_a->name, layer_b->name)) {
+      return false;
+    }
+    /* Layers passed through a deform-only modifier stack are shared with its input,
+     * only compare the contents when the modifiers made a copy. */
+    if (layer_a->data != layer_b->data) {
+      if (layer_a->data == NULL || layer_b->data == NULL) {
+        return false;
+      }
+      if (memcmp(layer_a->data, layer_b->data, CustomData_sizeof(layer_a->type) * totelem) !=
+          0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Check whether \a me_new only differs from the previous evaluated mesh \a me_prev in vertex
+ * positions and the data derived from them (normals, generated coordinates).
+ * In that case the draw cache of \a me_prev can be reused, only discarding the position
+ * dependent buffers, which avoids rebuilding the index buffers of deforming meshes every frame.
+ */
+static bool mesh_eval_is_deformed_copy(const Mesh *me_prev, const Mesh *me_new)
+{
+  if (me_prev->totvert != me_new->totvert || me_prev->totedge != me_new->totedge ||
+      me_prev->totloop != me_new->totloop || me_prev->totpoly != me_new->totpoly ||
+      me_prev->totcol != me_new->totcol) {
+    return false;
+  }
+  if (me_prev->edit_mesh != NULL || me_new->edit_mesh != NULL) {
+    return false;
+  }
+  if (me_prev->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA ||
+      me_new->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return false;
+  }
+
+  /* Vertex positions are expected to change, hidden and selected state are drawn. */
+  if (me_prev->mvert != me_new->mvert) {
+    for (int i = 0; i < me_new->totvert; i++) {
+      if (me_prev->mvert[i].flag != me_new->mvert[i].flag ||
+          me_prev->mvert[i].bweight != me_new->mvert[i].bweight) {
+        return false;
+      }
+    }
+  }
+
+  const CustomDataMask vmask_deform = CD_MASK_MVERT | CD_MASK_ORCO | CD_MASK_NORMAL;
+  const CustomDataMask lmask_deform = CD_MASK_NORMAL | CD_MASK_TANGENT;
+  const CustomDataMask pmask_deform = CD_MASK_NORMAL;
+  return mesh_eval_customdata_equal(
+             &me_prev->vdata, &me_new->vdata, me_new->totvert, vmask_deform) &&
+         mesh_eval_customdata_equal(&me_prev->edata, &me_new->edata, me_new->totedge, 0) &&
+         mesh_eval_customdata_equal(
+             &me_prev->ldata, &me_new->ldata, me_new->totloop, lmask_deform) &&
+         mesh_eval_customdata_equal(
+             &me_prev->pdata, &me_new->pdata, me_new->totpoly, pmask_deform);
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1770,6 +1849,19 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  /* Keep the previous result around until the new one is computed, so its draw cache can be
+   * taken over when the modifier stack only moved vertices (e.g. armature deformation). */
+  Mesh *mesh_eval_prev = NULL;
+  if (ob->runtime.is_data_eval_owned && ob->runtime.data_eval != NULL &&
+      GS(ob->runtime.data_eval->name) == ID_ME) {
+    Mesh *mesh_eval_owned = (Mesh *)ob->runtime.data_eval;
+    if (mesh_eval_owned->runtime.batch_cache != NULL &&
+        mesh_eval_owned->runtime.subdiv_ccg == NULL) {
+      mesh_eval_prev = mesh_eval_owned;
+      ob->runtime.data_eval = NULL;
+    }
+  }
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1807,6 +1899,16 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (mesh_eval_prev != NULL) {
+    if (is_mesh_eval_owned && mesh_eval->runtime.batch_cache == NULL &&
+        mesh_eval_is_deformed_copy(mesh_eval_prev, mesh_eval)) {
+      mesh_eval->runtime.batch_cache = mesh_eval_prev->runtime.batch_cache;
+      mesh_eval->runtime.batch_cache_deform_only = true;
+      mesh_eval_prev->runtime.batch_cache = NULL;
+    }
+    BKE_mesh_eval_delete(mesh_eval_prev);
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
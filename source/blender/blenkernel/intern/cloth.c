@@ -130,23 +130,14 @@ static BVHTree *bvhtree_build_from_cloth(ClothModifierData *clmd, float epsilon)
   return bvhtree;
 }
 
-void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
+void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving)
 {
   unsigned int i = 0;
   Cloth *cloth = clmd->clothObject;
-  BVHTree *bvhtree;
+  BVHTree *bvhtree = cloth->bvhtree;
   ClothVertex *verts = cloth->verts;
   const MVertTri *vt;
 
-  BLI_assert(!(clmd->hairdata != NULL && self));
-
-  if (self) {
-    bvhtree = cloth->bvhselftree;
-  }
-  else {
-    bvhtree = cloth->bvhtree;
-  }
-
   if (!bvhtree) {
     return;
   }
@@ -472,9 +463,7 @@ void cloth_free_modifier(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhtree);
     }
 
-    if (cloth->bvhselftree) {
-      BLI_bvhtree_free(cloth->bvhselftree);
-    }
+    cloth_selfcollision_cache_free(cloth);
 
     /* we save our faces for collision objects */
     if (cloth->tri) {
@@ -554,9 +543,7 @@ void cloth_free_modifier_extern(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhtree);
     }
 
-    if (cloth->bvhselftree) {
-      BLI_bvhtree_free(cloth->bvhselftree);
-    }
+    cloth_selfcollision_cache_free(cloth);
 
     /* we save our faces for collision objects */
     if (cloth->tri) {
@@ -826,7 +813,6 @@ static bool cloth_from_object(
   }
 
   clmd->clothObject->bvhtree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->epsilon);
-  clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->selfepsilon);
 
   return true;
 }
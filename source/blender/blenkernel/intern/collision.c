@@ -35,6 +35,7 @@
 #include "BLI_edgehash.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -837,107 +838,119 @@ static int cloth_collision_response_static(ClothModifierData *clmd,
   return result;
 }
 
-static int cloth_selfcollision_response_static(ClothModifierData *clmd,
-                                               CollPair *collpair,
-                                               uint collision_count,
-                                               const float dt)
+/* Compute the impulses of a single self collision, only modifying its six vertices. */
+static bool cloth_selfcollision_response_pair(ClothModifierData *clmd,
+                                              CollPair *collpair,
+                                              const float dt)
 {
-  int result = 0;
+  bool result = false;
   Cloth *cloth = clmd->clothObject;
   const float clamp_sq = square_f(clmd->coll_parms->self_clamp * dt);
   const float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
   const float min_distance = (2.0f * clmd->coll_parms->selfepsilon) * (8.0f / 9.0f);
 
-  for (int i = 0; i < collision_count; i++, collpair++) {
-    float ia[3][3] = {{0.0f}};
-    float ib[3][3] = {{0.0f}};
-    float w1, w2, w3, u1, u2, u3;
-    float v1[3], v2[3], relativeVelocity[3];
+  float ia[3][3] = {{0.0f}};
+  float ib[3][3] = {{0.0f}};
+  float w1, w2, w3, u1, u2, u3;
+  float v1[3], v2[3], relativeVelocity[3];
 
-    /* Only handle static collisions here. */
-    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
-      continue;
-    }
+  /* Compute barycentric coordinates for both collision points. */
+  collision_compute_barycentric(collpair->pa,
+                                cloth->verts[collpair->ap1].tx,
+                                cloth->verts[collpair->ap2].tx,
+                                cloth->verts[collpair->ap3].tx,
+                                &w1,
+                                &w2,
+                                &w3);
 
-    /* Compute barycentric coordinates for both collision points. */
-    collision_compute_barycentric(collpair->pa,
-                                  cloth->verts[collpair->ap1].tx,
-                                  cloth->verts[collpair->ap2].tx,
-                                  cloth->verts[collpair->ap3].tx,
-                                  &w1,
-                                  &w2,
-                                  &w3);
+  collision_compute_barycentric(collpair->pb,
+                                cloth->verts[collpair->bp1].tx,
+                                cloth->verts[collpair->bp2].tx,
+                                cloth->verts[collpair->bp3].tx,
+                                &u1,
+                                &u2,
+                                &u3);
 
-    collision_compute_barycentric(collpair->pb,
-                                  cloth->verts[collpair->bp1].tx,
-                                  cloth->verts[collpair->bp2].tx,
-                                  cloth->verts[collpair->bp3].tx,
-                                  &u1,
-                                  &u2,
-                                  &u3);
+  /* Calculate relative "velocity". */
+  collision_interpolateOnTriangle(v1,
+                                  cloth->verts[collpair->ap1].tv,
+                                  cloth->verts[collpair->ap2].tv,
+                                  cloth->verts[collpair->ap3].tv,
+                                  w1,
+                                  w2,
+                                  w3);
+
+  collision_interpolateOnTriangle(v2,
+                                  cloth->verts[collpair->bp1].tv,
+                                  cloth->verts[collpair->bp2].tv,
+                                  cloth->verts[collpair->bp3].tv,
+                                  u1,
+                                  u2,
+                                  u3);
 
-    /* Calculate relative "velocity". */
-    collision_interpolateOnTriangle(v1,
-                                    cloth->verts[collpair->ap1].tv,
-                                    cloth->verts[collpair->ap2].tv,
-                                    cloth->verts[collpair->ap3].tv,
-                                    w1,
-                                    w2,
-                                    w3);
+  sub_v3_v3v3(relativeVelocity, v2, v1);
 
-    collision_interpolateOnTriangle(v2,
-                                    cloth->verts[collpair->bp1].tv,
-                                    cloth->verts[collpair->bp2].tv,
-                                    cloth->verts[collpair->bp3].tv,
-                                    u1,
-                                    u2,
-                                    u3);
+  /* Calculate the normal component of the relative velocity
+   * (actually only the magnitude - the direction is stored in 'normal'). */
+  const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+  const float d = min_distance - collpair->distance;
 
-    sub_v3_v3v3(relativeVelocity, v2, v1);
+  /* TODO: Impulses should be weighed by mass as this is self col,
+   * this has to be done after mass distribution is implemented. */
 
-    /* Calculate the normal component of the relative velocity
-     * (actually only the magnitude - the direction is stored in 'normal'). */
-    const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
-    const float d = min_distance - collpair->distance;
+  /* If magrelVel < 0 the edges are approaching each other. */
+  if (magrelVel > 0.0f) {
+    /* Calculate Impulse magnitude to stop all motion in normal direction. */
+    float magtangent = 0, repulse = 0;
+    double impulse = 0.0;
+    float vrel_t_pre[3];
+    float temp[3];
 
-    /* TODO: Impulses should be weighed by mass as this is self col,
-     * this has to be done after mass distribution is implemented. */
+    /* Calculate tangential velocity. */
+    copy_v3_v3(temp, collpair->normal);
+    mul_v3_fl(temp, magrelVel);
+    sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
 
-    /* If magrelVel < 0 the edges are approaching each other. */
-    if (magrelVel > 0.0f) {
-      /* Calculate Impulse magnitude to stop all motion in normal direction. */
-      float magtangent = 0, repulse = 0;
-      double impulse = 0.0;
-      float vrel_t_pre[3];
-      float temp[3];
+    /* Decrease in magnitude of relative tangential velocity due to coulomb friction
+     * in original formula "magrelVel" should be the
+     * "change of relative velocity in normal direction". */
+    magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
 
-      /* Calculate tangential velocity. */
-      copy_v3_v3(temp, collpair->normal);
-      mul_v3_fl(temp, magrelVel);
-      sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
+    /* Apply friction impulse. */
+    if (magtangent > ALMOST_ZERO) {
+      normalize_v3(vrel_t_pre);
 
-      /* Decrease in magnitude of relative tangential velocity due to coulomb friction
-       * in original formula "magrelVel" should be the
-       * "change of relative velocity in normal direction". */
-      magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
+      impulse = magtangent / 1.5;
 
-      /* Apply friction impulse. */
-      if (magtangent > ALMOST_ZERO) {
-        normalize_v3(vrel_t_pre);
+      VECADDMUL(ia[0], vrel_t_pre, (double)w1 * impulse);
+      VECADDMUL(ia[1], vrel_t_pre, (double)w2 * impulse);
+      VECADDMUL(ia[2], vrel_t_pre, (double)w3 * impulse);
 
-        impulse = magtangent / 1.5;
+      VECADDMUL(ib[0], vrel_t_pre, (double)u1 * -impulse);
+      VECADDMUL(ib[1], vrel_t_pre, (double)u2 * -impulse);
+      VECADDMUL(ib[2], vrel_t_pre, (double)u3 * -impulse);
+    }
+
+    /* Apply velocity stopping impulse. */
+    impulse = magrelVel / 3.0f;
 
-        VECADDMUL(ia[0], vrel_t_pre, (double)w1 * impulse);
-        VECADDMUL(ia[1], vrel_t_pre, (double)w2 * impulse);
-        VECADDMUL(ia[2], vrel_t_pre, (double)w3 * impulse);
+    VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, (double)w3 * impulse);
 
-        VECADDMUL(ib[0], vrel_t_pre, (double)u1 * -impulse);
-        VECADDMUL(ib[1], vrel_t_pre, (double)u2 * -impulse);
-        VECADDMUL(ib[2], vrel_t_pre, (double)u3 * -impulse);
+    VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
+    VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
+    VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
+
+    if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
+      repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+
+      if (impulse > ALMOST_ZERO) {
+        repulse = min_ff(repulse, 5.0 * impulse);
       }
 
-      /* Apply velocity stopping impulse. */
-      impulse = magrelVel / 3.0f;
+      repulse = max_ff(impulse, repulse);
+      impulse = repulse / 1.5f;
 
       VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
       VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
@@ -946,61 +959,164 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd,
       VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
       VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
       VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
+    }
 
-      if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
-        repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+    result = true;
+  }
+  else if (d > ALMOST_ZERO) {
+    /* Stay on the safe side and clamp repulse. */
+    float repulse = d * 1.0f / time_multiplier;
+    float impulse = repulse / 9.0f;
 
-        if (impulse > ALMOST_ZERO) {
-          repulse = min_ff(repulse, 5.0 * impulse);
-        }
+    VECADDMUL(ia[0], collpair->normal, w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, w3 * impulse);
 
-        repulse = max_ff(impulse, repulse);
-        impulse = repulse / 1.5f;
+    VECADDMUL(ib[0], collpair->normal, u1 * -impulse);
+    VECADDMUL(ib[1], collpair->normal, u2 * -impulse);
+    VECADDMUL(ib[2], collpair->normal, u3 * -impulse);
 
-        VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
-        VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
-        VECADDMUL(ia[2], collpair->normal, (double)w3 * impulse);
+    result = true;
+  }
 
-        VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
-        VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
-        VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
-      }
+  if (result) {
+    cloth_collision_impulse_vert(clamp_sq, ia[0], &cloth->verts[collpair->ap1]);
+    cloth_collision_impulse_vert(clamp_sq, ia[1], &cloth->verts[collpair->ap2]);
+    cloth_collision_impulse_vert(clamp_sq, ia[2], &cloth->verts[collpair->ap3]);
 
-      result = 1;
-    }
-    else if (d > ALMOST_ZERO) {
-      /* Stay on the safe side and clamp repulse. */
-      float repulse = d * 1.0f / time_multiplier;
-      float impulse = repulse / 9.0f;
+    cloth_collision_impulse_vert(clamp_sq, ib[0], &cloth->verts[collpair->bp1]);
+    cloth_collision_impulse_vert(clamp_sq, ib[1], &cloth->verts[collpair->bp2]);
+    cloth_collision_impulse_vert(clamp_sq, ib[2], &cloth->verts[collpair->bp3]);
+  }
 
-      VECADDMUL(ia[0], collpair->normal, w1 * impulse);
-      VECADDMUL(ia[1], collpair->normal, w2 * impulse);
-      VECADDMUL(ia[2], collpair->normal, w3 * impulse);
+  return result;
+}
 
-      VECADDMUL(ib[0], collpair->normal, u1 * -impulse);
-      VECADDMUL(ib[1], collpair->normal, u2 * -impulse);
-      VECADDMUL(ib[2], collpair->normal, u3 * -impulse);
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif
 
-      result = 1;
-    }
+/* Self collisions are resolved in groups of collisions that don't share any vertex, the last group
+ * holds the collisions that didn't fit in any other and is resolved serially. */
+#define SELFCOLL_COLORS_NUM 64
 
-    if (result) {
-      cloth_collision_impulse_vert(clamp_sq, ia[0], &cloth->verts[collpair->ap1]);
-      cloth_collision_impulse_vert(clamp_sq, ia[1], &cloth->verts[collpair->ap2]);
-      cloth_collision_impulse_vert(clamp_sq, ia[2], &cloth->verts[collpair->ap3]);
+typedef struct SelfColResponseData {
+  ClothModifierData *clmd;
+  CollPair *collisions;
+  const uint *order;
+  float dt;
+} SelfColResponseData;
 
-      cloth_collision_impulse_vert(clamp_sq, ib[0], &cloth->verts[collpair->bp1]);
-      cloth_collision_impulse_vert(clamp_sq, ib[1], &cloth->verts[collpair->bp2]);
-      cloth_collision_impulse_vert(clamp_sq, ib[2], &cloth->verts[collpair->bp3]);
-    }
+static void cloth_selfcollision_response_task(void *__restrict userdata,
+                                              const int index,
+                                              const TaskParallelTLS *__restrict tls)
+{
+  SelfColResponseData *data = (SelfColResponseData *)userdata;
+  bool *result = (bool *)tls->userdata_chunk;
+
+  if (cloth_selfcollision_response_pair(
+          data->clmd, &data->collisions[data->order[index]], data->dt)) {
+    *result = true;
+  }
+}
+
+static void cloth_selfcollision_response_reduce(const void *__restrict UNUSED(userdata),
+                                                void *__restrict chunk_join,
+                                                void *__restrict chunk)
+{
+  bool *join = (bool *)chunk_join;
+  *join = *join || *(const bool *)chunk;
+}
+
+static int cloth_selfcollision_response_static(ClothModifierData *clmd,
+                                               CollPair *collpair,
+                                               const uint *order,
+                                               const uint *color_offsets,
+                                               const float dt)
+{
+  SelfColResponseData data = {
+      .clmd = clmd,
+      .collisions = collpair,
+      .order = order,
+      .dt = dt,
+  };
+  bool result = false;
+
+  for (int color = 0; color <= SELFCOLL_COLORS_NUM; color++) {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (color < SELFCOLL_COLORS_NUM);
+    settings.min_iter_per_thread = 64;
+    settings.userdata_chunk = &result;
+    settings.userdata_chunk_size = sizeof(result);
+    settings.func_reduce = cloth_selfcollision_response_reduce;
+    BLI_task_parallel_range(color_offsets[color],
+                            color_offsets[color + 1],
+                            &data,
+                            cloth_selfcollision_response_task,
+                            &settings);
   }
 
   return result;
 }
 
-#ifdef __GNUC__
-#  pragma GCC diagnostic pop
-#endif
+/* Greedy coloring of the active self collisions, so that no two collisions of a color share a
+ * vertex. Fills r_order with the collision indices sorted by color, the collisions of a color
+ * ranging from r_color_offsets[color] to r_color_offsets[color + 1]. */
+static void cloth_selfcollision_colors_build(const Cloth *cloth,
+                                             const CollPair *collpair,
+                                             const uint collision_count,
+                                             uint *r_order,
+                                             uint r_color_offsets[SELFCOLL_COLORS_NUM + 2])
+{
+  uint64_t *vert_colors = MEM_calloc_arrayN(cloth->mvert_num, sizeof(*vert_colors), __func__);
+  uchar *colors = MEM_malloc_arrayN(collision_count, sizeof(*colors), __func__);
+
+  memset(r_color_offsets, 0, sizeof(*r_color_offsets) * (SELFCOLL_COLORS_NUM + 2));
+
+  for (uint i = 0; i < collision_count; i++) {
+    const CollPair *pair = &collpair[i];
+    if (pair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
+      colors[i] = UCHAR_MAX;
+      continue;
+    }
+
+    const int verts[6] = {pair->ap1, pair->ap2, pair->ap3, pair->bp1, pair->bp2, pair->bp3};
+    uint64_t used = 0;
+    for (int v = 0; v < 6; v++) {
+      used |= vert_colors[verts[v]];
+    }
+
+    uint color = SELFCOLL_COLORS_NUM;
+    if (used != UINT64_MAX) {
+      color = bitscan_forward_uint64(~used);
+      for (int v = 0; v < 6; v++) {
+        vert_colors[verts[v]] |= (uint64_t)1 << color;
+      }
+    }
+
+    colors[i] = (uchar)color;
+    r_color_offsets[color + 1]++;
+  }
+
+  for (int color = 0; color <= SELFCOLL_COLORS_NUM; color++) {
+    r_color_offsets[color + 1] += r_color_offsets[color];
+  }
+
+  /* Use the offsets as cursors, then shift them back. */
+  for (uint i = 0; i < collision_count; i++) {
+    if (colors[i] != UCHAR_MAX) {
+      r_order[r_color_offsets[colors[i]]++] = i;
+    }
+  }
+  for (int color = SELFCOLL_COLORS_NUM + 1; color > 0; color--) {
+    r_color_offsets[color] = r_color_offsets[color - 1];
+  }
+  r_color_offsets[0] = 0;
+
+  MEM_freeN(colors);
+  MEM_freeN(vert_colors);
+}
 
 static void cloth_collision(void *__restrict userdata,
                             const int index,
@@ -1111,6 +1227,21 @@ static void cloth_selfcollision(void *__restrict userdata,
   BLI_assert(cloth_bvh_selfcollision_is_active(clmd->clothObject, tri_a, tri_b, sewing_active));
 #endif
 
+  /* Candidates are found with enlarged bounds, skip the ones too far apart with a cheap test. */
+  float min_a[3], max_a[3], min_b[3], max_b[3];
+  INIT_MINMAX(min_a, max_a);
+  INIT_MINMAX(min_b, max_b);
+  for (int i = 0; i < 3; i++) {
+    minmax_v3v3_v3(min_a, max_a, verts1[tri_a->tri[i]].tx);
+    minmax_v3v3_v3(min_b, max_b, verts1[tri_b->tri[i]].tx);
+  }
+  add_v3_fl(max_a, epsilon * 2.0f + ALMOST_ZERO);
+  add_v3_fl(min_a, -(epsilon * 2.0f + ALMOST_ZERO));
+  if (!isect_aabb_aabb_v3(min_a, max_a, min_b, max_b)) {
+    collpair[index].flag = COLLISION_INACTIVE;
+    return;
+  }
+
   /* Compute distance and normal. */
   distance = compute_collision_point_tri_tri(verts1[tri_a->tri[0]].tx,
                                              verts1[tri_a->tri[1]].tx,
@@ -1481,10 +1612,14 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
   mvert_num = clmd->clothObject->mvert_num;
   verts = cloth->verts;
 
+  uint *order = MEM_malloc_arrayN(collision_count, sizeof(*order), __func__);
+  uint color_offsets[SELFCOLL_COLORS_NUM + 2];
+  cloth_selfcollision_colors_build(cloth, collisions, collision_count, order, color_offsets);
+
   for (j = 0; j < 2; j++) {
     result = 0;
 
-    result += cloth_selfcollision_response_static(clmd, collisions, collision_count, dt);
+    result += cloth_selfcollision_response_static(clmd, collisions, order, color_offsets, dt);
 
     /* Apply impulses in parallel. */
     if (result) {
@@ -1505,26 +1640,500 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
       break;
     }
   }
+
+  MEM_freeN(order);
+
   return ret;
 }
 
-static bool cloth_bvh_self_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
+/***********************************
+ * Self collision broad phase
+ ***********************************/
+
+BLI_INLINE void max_v3_v3v3(float r[3], const float a[3], const float b[3])
+{
+  r[0] = max_ff(a[0], b[0]);
+  r[1] = max_ff(a[1], b[1]);
+  r[2] = max_ff(a[2], b[2]);
+}
+
+/* Candidate triangle pairs for self collisions, found with a spatial hash of the triangle bounds
+ * enlarged by a margin. The candidates are reused by the following sub-steps of the same frame,
+ * as long as no vertex moved more than half the margin since they were found. */
+typedef struct ClothSelfCollisionCache {
+  BVHTreeOverlap *overlap;
+  uint overlap_num;
+
+  /* Vertex positions and settings the candidates were found with. */
+  float (*co)[3];
+  uint mvert_num;
+  uint tri_num;
+  int frame;
+  float epsilon;
+  bool sewing_active;
+} ClothSelfCollisionCache;
+
+/* Fraction of the collision distance added to the triangle bounds, a larger margin finds more
+ * candidates but lets them be reused for larger motions. */
+#define SELFCOLL_MARGIN_FAC 1.0f
+
+/* Triangles overlapping more cells than this are not hashed, they are tested against all the
+ * other triangles instead, which bounds the size of the hash when the simulation explodes. */
+#define SELFCOLL_TRI_CELLS_MAX 64
+/* Cell coordinates are clamped to this range, so that far away vertices can't overflow them. */
+#define SELFCOLL_CELL_COORD_MAX (1 << 16)
+
+typedef enum eSelfColTriType {
+  SELFCOL_TRI_HASHED = 0,
+  /* Overlaps too many cells, tested against all the other triangles. */
+  SELFCOL_TRI_LARGE,
+  /* Has non-finite vertex positions, never a candidate. */
+  SELFCOL_TRI_INVALID,
+} eSelfColTriType;
+
+typedef struct SelfColHashEntry {
+  int cell[3];
+  uint tri;
+} SelfColHashEntry;
+
+typedef struct SelfColHashData {
+  const Cloth *cloth;
+  bool sewing_active;
+  float bounds_pad;
+
+  /* Enlarged triangle bounds. */
+  float (*bounds_min)[3];
+  float (*bounds_max)[3];
+  float cell_size_inv;
+
+  /* #eSelfColTriType of each triangle, and the large triangles in increasing order. */
+  uchar *tri_types;
+  uint *large_tris;
+  uint large_tris_num;
+
+  /* Cells overlapped by each triangle, from entries_offsets[tri] to entries_offsets[tri + 1]. */
+  uint *entries_offsets;
+  SelfColHashEntry *entries;
+
+  /* Indices of the entries in each bucket of the hash table. */
+  uint *bucket_offsets;
+  uint *bucket_entries;
+  uint bucket_mask;
+
+  /* Candidates of each triangle, counted in a first pass then written in a second one. */
+  uint *pairs_offsets;
+  BVHTreeOverlap *pairs;
+} SelfColHashData;
+
+BLI_INLINE uint selfcol_hash_cell(const int cell[3])
+{
+  return ((uint)cell[0] * 73856093u) ^ ((uint)cell[1] * 19349663u) ^ ((uint)cell[2] * 83492791u);
+}
+
+BLI_INLINE void selfcol_hash_cell_from_co(const SelfColHashData *data,
+                                          const float co[3],
+                                          int r_cell[3])
+{
+  for (int k = 0; k < 3; k++) {
+    const float cell = clamp_f(
+        co[k] * data->cell_size_inv, -SELFCOLL_CELL_COORD_MAX, SELFCOLL_CELL_COORD_MAX);
+    r_cell[k] = (int)floorf(cell);
+  }
+}
+
+static void selfcol_hash_bounds_task(void *__restrict userdata,
+                                     const int tri,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SelfColHashData *data = (SelfColHashData *)userdata;
+  const ClothVertex *verts = data->cloth->verts;
+  const MVertTri *vt = &data->cloth->tri[tri];
+
+  INIT_MINMAX(data->bounds_min[tri], data->bounds_max[tri]);
+  data->tri_types[tri] = SELFCOL_TRI_HASHED;
+  for (int i = 0; i < 3; i++) {
+    const float *co = verts[vt->tri[i]].tx;
+    if (!is_finite_v3(co)) {
+      data->tri_types[tri] = SELFCOL_TRI_INVALID;
+    }
+    minmax_v3v3_v3(data->bounds_min[tri], data->bounds_max[tri], co);
+  }
+  add_v3_fl(data->bounds_min[tri], -data->bounds_pad);
+  add_v3_fl(data->bounds_max[tri], data->bounds_pad);
+}
+
+static void selfcol_hash_count_task(void *__restrict userdata,
+                                    const int tri,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SelfColHashData *data = (SelfColHashData *)userdata;
+  data->entries_offsets[tri + 1] = 0;
+
+  if (data->tri_types[tri] == SELFCOL_TRI_INVALID) {
+    return;
+  }
+
+  int cell_min[3], cell_max[3];
+  selfcol_hash_cell_from_co(data, data->bounds_min[tri], cell_min);
+  selfcol_hash_cell_from_co(data, data->bounds_max[tri], cell_max);
+
+  /* Can't overflow since the cell coordinates are clamped. */
+  const int64_t cells_num = (int64_t)(cell_max[0] - cell_min[0] + 1) *
+                            (int64_t)(cell_max[1] - cell_min[1] + 1) *
+                            (int64_t)(cell_max[2] - cell_min[2] + 1);
+  if (cells_num > SELFCOLL_TRI_CELLS_MAX) {
+    data->tri_types[tri] = SELFCOL_TRI_LARGE;
+    return;
+  }
+  data->entries_offsets[tri + 1] = (uint)cells_num;
+}
+
+static void selfcol_hash_fill_task(void *__restrict userdata,
+                                   const int tri,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SelfColHashData *data = (SelfColHashData *)userdata;
+  if (data->tri_types[tri] != SELFCOL_TRI_HASHED) {
+    return;
+  }
+
+  SelfColHashEntry *entry = &data->entries[data->entries_offsets[tri]];
+  int cell_min[3], cell_max[3], cell[3];
+  selfcol_hash_cell_from_co(data, data->bounds_min[tri], cell_min);
+  selfcol_hash_cell_from_co(data, data->bounds_max[tri], cell_max);
+
+  for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+    for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+      for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++, entry++) {
+        copy_v3_v3_int(entry->cell, cell);
+        entry->tri = (uint)tri;
+      }
+    }
+  }
+}
+
+/* Test a pair of triangles which are not both hashed. */
+BLI_INLINE void selfcol_hash_tri_pair_test(const SelfColHashData *data,
+                                           const uint tri_a,
+                                           const uint tri_b,
+                                           BVHTreeOverlap *r_pairs,
+                                           uint *r_pairs_num)
 {
-  /* No need for equal combinations (eg. (0,1) & (1,0)). */
-  if (index_a < index_b) {
-    ClothModifierData *clmd = (ClothModifierData *)userdata;
-    struct Cloth *clothObject = clmd->clothObject;
-    const MVertTri *tri_a, *tri_b;
-    tri_a = &clothObject->tri[index_a];
-    tri_b = &clothObject->tri[index_b];
-
-    bool sewing_active = (clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_SEW);
-
-    if (cloth_bvh_selfcollision_is_active(clothObject, tri_a, tri_b, sewing_active)) {
-      return true;
+  if (data->tri_types[tri_b] == SELFCOL_TRI_INVALID ||
+      !isect_aabb_aabb_v3(data->bounds_min[tri_a],
+                          data->bounds_max[tri_a],
+                          data->bounds_min[tri_b],
+                          data->bounds_max[tri_b]) ||
+      !cloth_bvh_selfcollision_is_active(data->cloth,
+                                         &data->cloth->tri[tri_a],
+                                         &data->cloth->tri[tri_b],
+                                         data->sewing_active)) {
+    return;
+  }
+  if (r_pairs) {
+    r_pairs[*r_pairs_num].indexA = (int)tri_a;
+    r_pairs[*r_pairs_num].indexB = (int)tri_b;
+  }
+  (*r_pairs_num)++;
+}
+
+/* Find the candidates of a triangle with the triangles of higher index, returns their number and
+ * writes them to r_pairs when given. */
+static uint selfcol_hash_tri_pairs(const SelfColHashData *data,
+                                   const uint tri_a,
+                                   BVHTreeOverlap *r_pairs)
+{
+  uint pairs_num = 0;
+
+  switch ((eSelfColTriType)data->tri_types[tri_a]) {
+    case SELFCOL_TRI_INVALID:
+      return 0;
+    case SELFCOL_TRI_LARGE:
+      for (uint tri_b = tri_a + 1; tri_b < data->cloth->primitive_num; tri_b++) {
+        selfcol_hash_tri_pair_test(data, tri_a, tri_b, r_pairs, &pairs_num);
+      }
+      return pairs_num;
+    case SELFCOL_TRI_HASHED:
+      break;
+  }
+
+  const float *min_a = data->bounds_min[tri_a];
+  const float *max_a = data->bounds_max[tri_a];
+
+  for (uint e = data->entries_offsets[tri_a]; e < data->entries_offsets[tri_a + 1]; e++) {
+    const SelfColHashEntry *entry_a = &data->entries[e];
+    const uint bucket = selfcol_hash_cell(entry_a->cell) & data->bucket_mask;
+
+    for (uint k = data->bucket_offsets[bucket]; k < data->bucket_offsets[bucket + 1]; k++) {
+      const SelfColHashEntry *entry_b = &data->entries[data->bucket_entries[k]];
+      const uint tri_b = entry_b->tri;
+      if (tri_b <= tri_a || !equals_v3v3_int(entry_a->cell, entry_b->cell)) {
+        continue;
+      }
+
+      const float *min_b = data->bounds_min[tri_b];
+      const float *max_b = data->bounds_max[tri_b];
+      if (!isect_aabb_aabb_v3(min_a, max_a, min_b, max_b)) {
+        continue;
+      }
+
+      /* Both triangles share all the cells overlapping the intersection of their bounds, only
+       * report the pair from the cell holding the lowest corner of that intersection. */
+      float isect_min[3];
+      int isect_cell[3];
+      max_v3_v3v3(isect_min, min_a, min_b);
+      selfcol_hash_cell_from_co(data, isect_min, isect_cell);
+      if (!equals_v3v3_int(isect_cell, entry_a->cell)) {
+        continue;
+      }
+
+      if (!cloth_bvh_selfcollision_is_active(data->cloth,
+                                             &data->cloth->tri[tri_a],
+                                             &data->cloth->tri[tri_b],
+                                             data->sewing_active)) {
+        continue;
+      }
+
+      if (r_pairs) {
+        r_pairs[pairs_num].indexA = (int)tri_a;
+        r_pairs[pairs_num].indexB = (int)tri_b;
+      }
+      pairs_num++;
+    }
+  }
+
+  /* Pairs with a large triangle of lower index are found from that triangle. */
+  for (uint i = 0; i < data->large_tris_num; i++) {
+    if (data->large_tris[i] > tri_a) {
+      selfcol_hash_tri_pair_test(data, tri_a, data->large_tris[i], r_pairs, &pairs_num);
     }
   }
-  return false;
+
+  return pairs_num;
+}
+
+static void selfcol_hash_pairs_count_task(void *__restrict userdata,
+                                          const int tri,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SelfColHashData *data = (SelfColHashData *)userdata;
+  data->pairs_offsets[tri + 1] = selfcol_hash_tri_pairs(data, (uint)tri, NULL);
+}
+
+static void selfcol_hash_pairs_fill_task(void *__restrict userdata,
+                                         const int tri,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SelfColHashData *data = (SelfColHashData *)userdata;
+  selfcol_hash_tri_pairs(data, (uint)tri, &data->pairs[data->pairs_offsets[tri]]);
+}
+
+static void selfcol_hash_parallel_range(SelfColHashData *data, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, (int)data->cloth->primitive_num, data, func, &settings);
+}
+
+static void selfcol_prefix_sum(uint *offsets, const uint len)
+{
+  offsets[0] = 0;
+  for (uint i = 0; i < len; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+}
+
+/**
+ * Find all the candidate pairs of triangles for self collisions: the triangles which bounds
+ * enlarged by \a bounds_pad overlap, and which may collide. Pairs are ordered by triangle so the
+ * result does not depend on the threads scheduling, the returned array is freed by the caller.
+ */
+BVHTreeOverlap *cloth_selfcollision_candidates_find(const Cloth *cloth,
+                                                    const float bounds_pad,
+                                                    const bool sewing_active,
+                                                    uint *r_overlap_num)
+{
+  const uint tri_num = cloth->primitive_num;
+
+  SelfColHashData data = {
+      .cloth = cloth,
+      .sewing_active = sewing_active,
+      .bounds_pad = bounds_pad,
+  };
+
+  data.bounds_min = MEM_malloc_arrayN(tri_num, sizeof(*data.bounds_min), __func__);
+  data.bounds_max = MEM_malloc_arrayN(tri_num, sizeof(*data.bounds_max), __func__);
+  data.tri_types = MEM_malloc_arrayN(tri_num, sizeof(*data.tri_types), __func__);
+  selfcol_hash_parallel_range(&data, selfcol_hash_bounds_task);
+
+  /* Cells as large as the average triangle bounds, so most triangles overlap a few cells. */
+  double size_sum = 0.0;
+  uint size_num = 0;
+  for (uint tri = 0; tri < tri_num; tri++) {
+    if (data.tri_types[tri] == SELFCOL_TRI_INVALID) {
+      continue;
+    }
+    float size[3];
+    sub_v3_v3v3(size, data.bounds_max[tri], data.bounds_min[tri]);
+    size_sum += (double)max_fff(size[0], size[1], size[2]);
+    size_num++;
+  }
+  const float cell_size = (size_num > 0) ? (float)(size_sum / size_num) : 0.0f;
+  data.cell_size_inv = 1.0f / clamp_f(cell_size, FLT_EPSILON, FLT_MAX);
+
+  data.entries_offsets = MEM_malloc_arrayN(tri_num + 1, sizeof(*data.entries_offsets), __func__);
+  selfcol_hash_parallel_range(&data, selfcol_hash_count_task);
+  selfcol_prefix_sum(data.entries_offsets, tri_num);
+
+  data.large_tris = MEM_malloc_arrayN(tri_num, sizeof(*data.large_tris), __func__);
+  for (uint tri = 0; tri < tri_num; tri++) {
+    if (data.tri_types[tri] == SELFCOL_TRI_LARGE) {
+      data.large_tris[data.large_tris_num++] = tri;
+    }
+  }
+
+  const uint entries_num = data.entries_offsets[tri_num];
+  data.entries = MEM_malloc_arrayN(MAX2(entries_num, 1), sizeof(*data.entries), __func__);
+  selfcol_hash_parallel_range(&data, selfcol_hash_fill_task);
+
+  /* Sort the entries into buckets, keeping them ordered by triangle in each bucket. */
+  const uint buckets_num = power_of_2_max_u(MAX2(entries_num, 1));
+  data.bucket_mask = buckets_num - 1;
+  data.bucket_offsets = MEM_calloc_arrayN(buckets_num + 1, sizeof(*data.bucket_offsets), __func__);
+  data.bucket_entries = MEM_malloc_arrayN(
+      MAX2(entries_num, 1), sizeof(*data.bucket_entries), __func__);
+  for (uint e = 0; e < entries_num; e++) {
+    data.bucket_offsets[(selfcol_hash_cell(data.entries[e].cell) & data.bucket_mask) + 1]++;
+  }
+  selfcol_prefix_sum(data.bucket_offsets, buckets_num);
+  for (uint e = 0; e < entries_num; e++) {
+    const uint bucket = selfcol_hash_cell(data.entries[e].cell) & data.bucket_mask;
+    data.bucket_entries[data.bucket_offsets[bucket]++] = e;
+  }
+  for (uint bucket = buckets_num; bucket > 0; bucket--) {
+    data.bucket_offsets[bucket] = data.bucket_offsets[bucket - 1];
+  }
+  data.bucket_offsets[0] = 0;
+
+  data.pairs_offsets = MEM_malloc_arrayN(tri_num + 1, sizeof(*data.pairs_offsets), __func__);
+  selfcol_hash_parallel_range(&data, selfcol_hash_pairs_count_task);
+  selfcol_prefix_sum(data.pairs_offsets, tri_num);
+
+  *r_overlap_num = data.pairs_offsets[tri_num];
+  data.pairs = MEM_malloc_arrayN(MAX2(*r_overlap_num, 1), sizeof(*data.pairs), __func__);
+  selfcol_hash_parallel_range(&data, selfcol_hash_pairs_fill_task);
+
+  MEM_freeN(data.bounds_min);
+  MEM_freeN(data.bounds_max);
+  MEM_freeN(data.tri_types);
+  MEM_freeN(data.large_tris);
+  MEM_freeN(data.entries_offsets);
+  MEM_freeN(data.entries);
+  MEM_freeN(data.bucket_offsets);
+  MEM_freeN(data.bucket_entries);
+  MEM_freeN(data.pairs_offsets);
+
+  return data.pairs;
+}
+
+typedef struct SelfColMotionData {
+  const ClothVertex *verts;
+  const float (*co)[3];
+} SelfColMotionData;
+
+static void selfcol_motion_task(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict tls)
+{
+  const SelfColMotionData *data = (const SelfColMotionData *)userdata;
+  float *max_dist_sq = (float *)tls->userdata_chunk;
+  *max_dist_sq = max_ff(*max_dist_sq, len_squared_v3v3(data->verts[i].tx, data->co[i]));
+}
+
+static void selfcol_motion_reduce(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_join,
+                                  void *__restrict chunk)
+{
+  float *join = (float *)chunk_join;
+  *join = max_ff(*join, *(const float *)chunk);
+}
+
+/* Largest squared distance a vertex moved since the candidates were found. */
+static float cloth_selfcollision_max_motion_sq(const Cloth *cloth,
+                                               const ClothSelfCollisionCache *cache)
+{
+  SelfColMotionData data = {
+      .verts = cloth->verts,
+      .co = (const float(*)[3])cache->co,
+  };
+  float max_dist_sq = 0.0f;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = &max_dist_sq;
+  settings.userdata_chunk_size = sizeof(max_dist_sq);
+  settings.func_reduce = selfcol_motion_reduce;
+  BLI_task_parallel_range(0, (int)cloth->mvert_num, &data, selfcol_motion_task, &settings);
+
+  return max_dist_sq;
+}
+
+/* Find the candidate pairs for self collisions, or reuse the ones of the previous sub-step. */
+static ClothSelfCollisionCache *cloth_selfcollision_candidates_update(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+  const float epsilon = clmd->coll_parms->selfepsilon;
+  const float margin = 2.0f * epsilon * SELFCOLL_MARGIN_FAC;
+  const bool sewing_active = (clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_SEW);
+
+  if (cloth->selfcoll_cache == NULL) {
+    cloth->selfcoll_cache = MEM_callocN(sizeof(ClothSelfCollisionCache), __func__);
+  }
+  ClothSelfCollisionCache *cache = cloth->selfcoll_cache;
+
+  if (cache->overlap && cache->mvert_num == cloth->mvert_num &&
+      cache->tri_num == cloth->primitive_num && cache->frame == cloth->last_frame &&
+      cache->epsilon == epsilon && cache->sewing_active == sewing_active &&
+      cloth_selfcollision_max_motion_sq(cloth, cache) <= square_f(margin * 0.5f)) {
+    return cache;
+  }
+
+  MEM_SAFE_FREE(cache->overlap);
+  if (cache->mvert_num != cloth->mvert_num) {
+    MEM_SAFE_FREE(cache->co);
+    cache->co = MEM_malloc_arrayN(cloth->mvert_num, sizeof(*cache->co), __func__);
+  }
+
+  /* Bounds are enlarged by half the collision distance, plus half the margin as each triangle
+   * may move by that much towards the other. */
+  cache->overlap = cloth_selfcollision_candidates_find(
+      cloth, epsilon + margin * 0.5f, sewing_active, &cache->overlap_num);
+
+  for (uint i = 0; i < cloth->mvert_num; i++) {
+    copy_v3_v3(cache->co[i], cloth->verts[i].tx);
+  }
+  cache->mvert_num = cloth->mvert_num;
+  cache->tri_num = cloth->primitive_num;
+  cache->frame = cloth->last_frame;
+  cache->epsilon = epsilon;
+  cache->sewing_active = sewing_active;
+
+  return cache;
+}
+
+void cloth_selfcollision_cache_free(Cloth *cloth)
+{
+  ClothSelfCollisionCache *cache = cloth->selfcoll_cache;
+  if (cache == NULL) {
+    return;
+  }
+
+  MEM_SAFE_FREE(cache->overlap);
+  MEM_SAFE_FREE(cache->co);
+  MEM_freeN(cache);
+  cloth->selfcoll_cache = NULL;
 }
 
 int cloth_bvh_collision(
@@ -1551,7 +2160,7 @@ int cloth_bvh_collision(
   mvert_num = cloth->mvert_num;
 
   if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) {
-    bvhtree_update_from_cloth(clmd, false, false);
+    bvhtree_update_from_cloth(clmd, false);
 
     /* Enable self collision if this is a hair sim */
     const bool is_hair = (clmd->hairdata != NULL);
@@ -1584,11 +2193,13 @@ int cloth_bvh_collision(
     }
   }
 
-  if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) {
-    bvhtree_update_from_cloth(clmd, false, true);
-
-    overlap_self = BLI_bvhtree_overlap(
-        cloth->bvhselftree, cloth->bvhselftree, &coll_count_self, cloth_bvh_self_overlap_cb, clmd);
+  /* Self collisions are found between triangles, hair has none. */
+  const bool use_selfcollision = (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) &&
+                                 clmd->hairdata == NULL && cloth->primitive_num > 0;
+  if (use_selfcollision) {
+    ClothSelfCollisionCache *selfcoll_cache = cloth_selfcollision_candidates_update(clmd);
+    overlap_self = selfcoll_cache->overlap;
+    coll_count_self = selfcoll_cache->overlap_num;
   }
 
   do {
@@ -1643,16 +2254,13 @@ int cloth_bvh_collision(
       verts = cloth->verts;
       mvert_num = cloth->mvert_num;
 
-      if (cloth->bvhselftree) {
-        if (coll_count_self && overlap_self) {
-          collisions = (CollPair *)MEM_mallocN(sizeof(CollPair) * coll_count_self,
-                                               "collision array");
+      if (use_selfcollision && coll_count_self && overlap_self) {
+        collisions = (CollPair *)MEM_mallocN(sizeof(CollPair) * coll_count_self,
+                                             "collision array");
 
-          if (cloth_bvh_selfcollisions_nearcheck(
-                  clmd, collisions, coll_count_self, overlap_self)) {
-            ret += cloth_bvh_selfcollisions_resolve(clmd, collisions, coll_count_self, dt);
-            ret2 += ret;
-          }
+        if (cloth_bvh_selfcollisions_nearcheck(clmd, collisions, coll_count_self, overlap_self)) {
+          ret += cloth_bvh_selfcollisions_resolve(clmd, collisions, coll_count_self, dt);
+          ret2 += ret;
         }
       }
 
@@ -1685,20 +2293,11 @@ int cloth_bvh_collision(
 
   MEM_SAFE_FREE(coll_counts_obj);
 
-  MEM_SAFE_FREE(overlap_self);
-
   BKE_collision_objects_free(collobjs);
 
   return MIN2(ret, 1);
 }
 
-BLI_INLINE void max_v3_v3v3(float r[3], const float a[3], const float b[3])
-{
-  r[0] = max_ff(a[0], b[0]);
-  r[1] = max_ff(a[1], b[1]);
-  r[2] = max_ff(a[2], b[2]);
-}
-
 void collision_get_collider_velocity(float vel_old[3],
                                      float vel_new[3],
                                      CollisionModifierData *collmd,
@@ -0,0 +1,171 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BKE_cloth.h"
+
+namespace blender::bke::tests {
+
+using TriPair = std::pair<int, int>;
+
+/* Two grids of `size` by `size` quads on top of each other, closer than the collision distance,
+ * so every triangle has candidates in the other grid. */
+class ClothSelfCollisionTest : public testing::Test {
+ protected:
+  static constexpr int size = 24;
+  static constexpr float pad = 0.02f;
+
+  Cloth cloth = {};
+
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_threadapi_exit();
+  }
+
+  void SetUp() override
+  {
+    const int verts_size = size + 1;
+    const int grid_verts_num = verts_size * verts_size;
+    cloth.mvert_num = grid_verts_num * 2;
+    cloth.primitive_num = size * size * 4;
+    cloth.verts = static_cast<ClothVertex *>(
+        MEM_calloc_arrayN(cloth.mvert_num, sizeof(ClothVertex), __func__));
+    cloth.tri = static_cast<MVertTri *>(
+        MEM_calloc_arrayN(cloth.primitive_num, sizeof(MVertTri), __func__));
+
+    MVertTri *vt = cloth.tri;
+    for (int grid = 0; grid < 2; grid++) {
+      const int v_start = grid * grid_verts_num;
+      for (int y = 0; y < verts_size; y++) {
+        for (int x = 0; x < verts_size; x++) {
+          float *co = cloth.verts[v_start + y * verts_size + x].tx;
+          co[0] = x * 0.1f;
+          co[1] = y * 0.1f;
+          co[2] = grid * 0.01f;
+        }
+      }
+      for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+          const uint v = v_start + y * verts_size + x;
+          *vt++ = {{v, v + 1, v + verts_size + 1}};
+          *vt++ = {{v, v + verts_size + 1, v + verts_size}};
+        }
+      }
+    }
+  }
+
+  void TearDown() override
+  {
+    MEM_freeN(cloth.verts);
+    MEM_freeN(cloth.tri);
+  }
+
+  bool tri_bounds(const int tri, float r_min[3], float r_max[3]) const
+  {
+    INIT_MINMAX(r_min, r_max);
+    for (int i = 0; i < 3; i++) {
+      const float *co = cloth.verts[cloth.tri[tri].tri[i]].tx;
+      if (!is_finite_v3(co)) {
+        return false;
+      }
+      minmax_v3v3_v3(r_min, r_max, co);
+    }
+    add_v3_fl(r_min, -pad);
+    add_v3_fl(r_max, pad);
+    return true;
+  }
+
+  /* Test all the pairs of triangles not sharing a vertex. */
+  std::vector<TriPair> candidates_brute_force() const
+  {
+    std::vector<TriPair> pairs;
+    for (int a = 0; a < (int)cloth.primitive_num; a++) {
+      float min_a[3], max_a[3];
+      if (!tri_bounds(a, min_a, max_a)) {
+        continue;
+      }
+      for (int b = a + 1; b < (int)cloth.primitive_num; b++) {
+        float min_b[3], max_b[3];
+        if (!tri_bounds(b, min_b, max_b) || !isect_aabb_aabb_v3(min_a, max_a, min_b, max_b)) {
+          continue;
+        }
+        bool shares_vert = false;
+        for (int i = 0; i < 3; i++) {
+          for (int j = 0; j < 3; j++) {
+            shares_vert |= cloth.tri[a].tri[i] == cloth.tri[b].tri[j];
+          }
+        }
+        if (!shares_vert) {
+          pairs.emplace_back(a, b);
+        }
+      }
+    }
+    return pairs;
+  }
+
+  std::vector<TriPair> candidates_find() const
+  {
+    uint overlap_num;
+    BVHTreeOverlap *overlap = cloth_selfcollision_candidates_find(
+        &cloth, pad, false, &overlap_num);
+    std::vector<TriPair> pairs;
+    for (uint i = 0; i < overlap_num; i++) {
+      EXPECT_LT(overlap[i].indexA, overlap[i].indexB);
+      pairs.emplace_back(overlap[i].indexA, overlap[i].indexB);
+    }
+    MEM_freeN(overlap);
+
+    /* Each pair is found once. */
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(std::adjacent_find(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+  }
+};
+
+TEST_F(ClothSelfCollisionTest, candidates)
+{
+  const std::vector<TriPair> pairs = candidates_find();
+  EXPECT_FALSE(pairs.empty());
+  EXPECT_EQ(pairs, candidates_brute_force());
+}
+
+/* A vertex far away makes its triangles overlap too many cells to be hashed, they are tested
+ * against all the others instead. */
+TEST_F(ClothSelfCollisionTest, candidates_large_triangles)
+{
+  copy_v3_fl(cloth.verts[size / 2].tx, 1e30f);
+  copy_v3_fl(cloth.verts[cloth.mvert_num - size / 2].tx, -1e30f);
+  EXPECT_EQ(candidates_find(), candidates_brute_force());
+}
+
+/* Triangles with non-finite positions are never candidates. */
+TEST_F(ClothSelfCollisionTest, candidates_non_finite)
+{
+  cloth.verts[size / 2].tx[0] = std::numeric_limits<float>::quiet_NaN();
+  cloth.verts[size * 3].tx[1] = std::numeric_limits<float>::infinity();
+  const std::vector<TriPair> pairs = candidates_find();
+  EXPECT_FALSE(pairs.empty());
+  EXPECT_EQ(pairs, candidates_brute_force());
+}
+
+}  // namespace blender::bke::tests
@@ -970,6 +970,12 @@ ChannelDriver *fcurve_copy_driver(const ChannelDriver *driver)
 /** \name Driver Expression Evaluation
  * \{ */
 
+/* Number of driver expressions compiled for the simple expression evaluator and the ones
+ * falling back to Python, which are evaluated serialized by #python_driver_lock.
+ * Counted when compiling to keep atomics out of the evaluation. */
+static uint64_t driver_expression_simple_num = 0;
+static uint64_t driver_expression_python_num = 0;
+
 /* Index constants for the expression parameter array. */
 enum {
   /* Index of the 'frame' variable. */
@@ -1064,6 +1070,13 @@ static bool driver_compile_simple_expr(ChannelDriver *driver)
   if (atomic_cas_ptr((void **)&driver->expr_simple, NULL, expr) != NULL) {
     BLI_expr_pylike_free(expr);
   }
+  else if (BLI_expr_pylike_is_valid(expr)) {
+    atomic_add_and_fetch_uint64(&driver_expression_simple_num, 1);
+  }
+  else {
+    atomic_add_and_fetch_uint64(&driver_expression_python_num, 1);
+    CLOG_INFO(&LOG, 1, "driver expression evaluated with Python: '%s'", driver->expression);
+  }
 
   return true;
 }
@@ -1088,6 +1101,16 @@ bool BKE_driver_has_simple_expression(ChannelDriver *driver)
   return driver_compile_simple_expr(driver) && BLI_expr_pylike_is_valid(driver->expr_simple);
 }
 
+/**
+ * Get the number of driver expressions compiled since startup, for the simple expression
+ * evaluator and falling back to Python. Expressions are compiled again when they change.
+ */
+void BKE_driver_expression_stats_get(uint64_t *r_simple_num, uint64_t *r_python_num)
+{
+  *r_simple_num = driver_expression_simple_num;
+  *r_python_num = driver_expression_python_num;
+}
+
 /* TODO(sergey): This is somewhat weak, but we don't want neither false-positive
  * time dependencies nor special exceptions in the depsgraph evaluation. */
 static bool python_driver_exression_depends_on_time(const char *expression)
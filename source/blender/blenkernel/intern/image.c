@@ -4418,7 +4418,14 @@ static ImBuf *load_image_single(Image *ima,
     BKE_image_user_file_path(&iuser_t, ima, filepath);
 
     /* read ibuf */
-    ibuf = IMB_loadiffname(filepath, flag, ima->colorspace_settings.name);
+    if (ima->source == IMA_SRC_FILE && image_num_files(ima) == 1) {
+      /* Of multilayer files only the layers and passes are read here, pixels of passes are
+       * read once they are used, see #image_get_ibuf_multilayer. */
+      ibuf = IMB_loadiffname_passes(filepath, flag, ima->colorspace_settings.name, NULL, NULL);
+    }
+    else {
+      ibuf = IMB_loadiffname(filepath, flag, ima->colorspace_settings.name);
+    }
   }
 
   if (ibuf) {
@@ -4532,6 +4539,71 @@ static ImBuf *image_load_image_file(Image *ima, ImageUser *iuser, int cfra)
   return ibuf;
 }
 
+#ifdef WITH_OPENEXR
+/* Read the pixels of a pass of a multilayer image which was loaded without them. */
+static void image_multilayer_pass_load(Image *ima, RenderLayer *rl, RenderPass *rpass)
+{
+  ImageUser iuser = {NULL};
+  char filepath[FILE_MAX];
+
+  iuser.framenr = ima->lastframe;
+  BKE_image_user_file_path(&iuser, ima, filepath);
+
+  const bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+  RenderResult *rr = RE_MultilayerReadPartial(
+      filepath, rl->name, rpass->name, NULL, ima->colorspace_settings.name, predivide);
+  if (rr == NULL) {
+    return;
+  }
+
+  RenderLayer *rl_read = BLI_findstring(&rr->layers, rl->name, offsetof(RenderLayer, name));
+  RenderPass *rpass_read = rl_read ? RE_pass_find_by_name(rl_read, rpass->name, rpass->view) :
+                                     NULL;
+
+  /* The file could have changed on disk since it was loaded. */
+  if (rpass_read && rpass_read->rect && rpass_read->channels == rpass->channels &&
+      rpass_read->rectx == rpass->rectx && rpass_read->recty == rpass->recty) {
+    rpass->rect = rpass_read->rect;
+    rpass_read->rect = NULL;
+  }
+
+  RE_FreeRenderResult(rr);
+}
+
+static void image_multilayer_pass_ensure(Image *ima, RenderPass *rpass)
+{
+  LISTBASE_FOREACH (RenderLayer *, rl, &ima->rr->layers) {
+    if (BLI_findindex(&rl->passes, rpass) != -1) {
+      image_multilayer_pass_load(ima, rl, rpass);
+      break;
+    }
+  }
+}
+#endif /* WITH_OPENEXR */
+
+/**
+ * Multilayer images are loaded without the pixels of their passes, read all of them for code
+ * which uses the whole render result, like saving.
+ */
+void BKE_image_multilayer_passes_ensure(Image *ima)
+{
+#ifdef WITH_OPENEXR
+  BLI_mutex_lock(image_mutex);
+  if (ima->type == IMA_TYPE_MULTILAYER && ima->rr) {
+    LISTBASE_FOREACH (RenderLayer *, rl, &ima->rr->layers) {
+      LISTBASE_FOREACH (RenderPass *, rpass, &rl->passes) {
+        if (rpass->rect == NULL) {
+          image_multilayer_pass_load(ima, rl, rpass);
+        }
+      }
+    }
+  }
+  BLI_mutex_unlock(image_mutex);
+#else
+  UNUSED_VARS(ima);
+#endif
+}
+
 static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
 {
   ImBuf *ibuf = NULL;
@@ -4546,7 +4618,13 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+#ifdef WITH_OPENEXR
+    if (rpass && rpass->rect == NULL) {
+      image_multilayer_pass_ensure(ima, rpass);
+    }
+#endif
+
+    if (rpass && rpass->rect) {
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
       image_init_after_load(ima, iuser, ibuf);
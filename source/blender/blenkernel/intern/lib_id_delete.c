@@ -141,6 +141,7 @@ void BKE_id_free_ex(Main *bmain, void *idv, int flag, const bool use_flag_from_i
 #  ifdef WITH_PYTHON_SAFETY
   BPY_id_release(id);
 #  endif
+  BPY_id_release_buffers(id);
   if (id->py_instance) {
     BPY_DECREF_RNA_INVALIDATE(id->py_instance);
   }
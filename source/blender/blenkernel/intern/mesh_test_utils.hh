@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_mesh.h"
+
+namespace blender::bke::tests {
+
+/**
+ * Grid of `size` by `size` quads in the unit square, followed by `loose_verts_len` loose
+ * vertices at the origin. Edges along X come first, then edges along Y, without any flags.
+ */
+static inline Mesh *mesh_grid_create(const int size, const int loose_verts_len = 0)
+{
+  const int verts_size = size + 1;
+  const int edges_x_len = size * verts_size;
+  Mesh *me = BKE_mesh_new_nomain(verts_size * verts_size + loose_verts_len,
+                                 edges_x_len * 2,
+                                 0,
+                                 size * size * 4,
+                                 size * size);
+
+  for (int y = 0; y < verts_size; y++) {
+    for (int x = 0; x < verts_size; x++) {
+      MVert *mv = &me->mvert[y * verts_size + x];
+      mv->co[0] = (float)x / size;
+      mv->co[1] = (float)y / size;
+      mv->co[2] = 0.0f;
+    }
+  }
+
+  MEdge *med = me->medge;
+  for (int y = 0; y < verts_size; y++) {
+    for (int x = 0; x < size; x++, med++) {
+      med->v1 = y * verts_size + x;
+      med->v2 = y * verts_size + x + 1;
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < verts_size; x++, med++) {
+      med->v1 = y * verts_size + x;
+      med->v2 = (y + 1) * verts_size + x;
+    }
+  }
+
+  MLoop *ml = me->mloop;
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int p_index = y * size + x;
+      const int v_index = y * verts_size + x;
+      MPoly *mp = &me->mpoly[p_index];
+      mp->loopstart = p_index * 4;
+      mp->totloop = 4;
+
+      ml->v = v_index;
+      ml->e = y * size + x;
+      ml++;
+      ml->v = v_index + 1;
+      ml->e = edges_x_len + y * verts_size + x + 1;
+      ml++;
+      ml->v = v_index + verts_size + 1;
+      ml->e = (y + 1) * size + x;
+      ml++;
+      ml->v = v_index + verts_size;
+      ml->e = edges_x_len + y * verts_size + x;
+      ml++;
+    }
+  }
+
+  return me;
+}
+
+}  // namespace blender::bke::tests
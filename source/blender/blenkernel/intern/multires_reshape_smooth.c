@@ -52,20 +52,14 @@
 /** \name Local Structs
  * \{ */
 
-/* Surface refers to a simplified and lower-memory footprint representation of the limit surface.
- *
- * Used to store pre-calculated information which is expensive or impossible to evaluate when
- * traversing the final limit surface.  */
+/* Surface refers to a simplified representation of the limit surface: position and tangent space
+ * at a point. */
 
 typedef struct SurfacePoint {
   float P[3];
   float tangent_matrix[3][3];
 } SurfacePoint;
 
-typedef struct SurfaceGrid {
-  SurfacePoint *points;
-} SurfaceGrid;
-
 /* Geometry elements which are used to simplify creation of topology refiner at the sculpt level.
  * Contains a limited subset of information needed to construct topology refiner. */
 
@@ -95,30 +89,12 @@ typedef struct Edge {
   float sharpness;
 } Edge;
 
-/* Storage of data which is linearly interpolated from the reshape level to the top level. */
+/* Data which is linearly interpolated from the reshape level to the top level. */
 
 typedef struct LinearGridElement {
   float mask;
 } LinearGridElement;
 
-typedef struct LinearGrid {
-  LinearGridElement *elements;
-} LinearGrid;
-
-typedef struct LinearGrids {
-  int num_grids;
-  int level;
-
-  /* Cached size for the grid, for faster lookup. */
-  int grid_size;
-
-  /* Indexed by grid index. */
-  LinearGrid *grids;
-
-  /* Elements for all grids are allocated in a single array, for the allocation performance. */
-  LinearGridElement *elements_storage;
-} LinearGrids;
-
 /* Context which holds all information eeded during propagation and smoothing. */
 
 typedef struct MultiresReshapeSmoothContext {
@@ -146,25 +122,24 @@ typedef struct MultiresReshapeSmoothContext {
     Face *faces;
   } geometry;
 
-  /* Grids of data which is linearly interpolated between grid elements at the reshape level.
-   * The data is actually stored as a delta, which is then to be added to the higher levels. */
-  LinearGrids linear_delta_grids;
-
   /* Index i of this map indicates that base edge i is adjacent to at least one face. */
   BLI_bitmap *non_loose_base_edge_map;
 
   /* Subdivision surface created for geometry at a reshape level. */
   Subdiv *reshape_subdiv;
 
-  /* Limit surface of the base mesh with original sculpt level details on it, subdivided up to the
-   * top level.
+  /* Limit surface of the base mesh with original sculpt level details on it: subdivision surface
+   * of the same topology as reshape_subdiv, refined with the original coordinates.
    * Is used as a base point to calculate how much displacement has been made in the sculpt mode.
    *
+   * It is evaluated on demand while the top level grids are written, so that no data of the size
+   * of the top level is stored next to the destination grids.
+   *
    * NOTE: Referring to sculpt as it is the main user of this functionality and it is clear to
    * understand what it actually means in a concrete example. This is a generic code which is also
    * used by Subdivide operation, but the idea is exactly the same as propagation in the sculpt
    * mode. */
-  SurfaceGrid *base_surface_grids;
+  Subdiv *base_surface_subdiv;
 
   /* Defines how displacement is interpolated on the higher levels (for example, whether
    * displacement is smoothed in Catmull-Clark mode or interpolated linearly preserving sharp edges
@@ -178,60 +153,9 @@ typedef struct MultiresReshapeSmoothContext {
 /** \} */
 
 /* -------------------------------------------------------------------- */
-/** \name Linear grids manipulation
+/** \name Linear grid elements manipulation
  * \{ */
 
-static void linear_grids_init(LinearGrids *linear_grids)
-{
-  linear_grids->num_grids = 0;
-  linear_grids->level = 0;
-
-  linear_grids->grids = NULL;
-  linear_grids->elements_storage = NULL;
-}
-
-static void linear_grids_allocate(LinearGrids *linear_grids, int num_grids, int level)
-{
-  const size_t grid_size = BKE_subdiv_grid_size_from_level(level);
-  const size_t grid_area = grid_size * grid_size;
-  const size_t num_grid_elements = num_grids * grid_area;
-
-  linear_grids->num_grids = num_grids;
-  linear_grids->level = level;
-  linear_grids->grid_size = grid_size;
-
-  linear_grids->grids = MEM_malloc_arrayN(num_grids, sizeof(LinearGrid), "linear grids");
-  linear_grids->elements_storage = MEM_calloc_arrayN(
-      num_grid_elements, sizeof(LinearGridElement), "linear elements storage");
-
-  for (int i = 0; i < num_grids; ++i) {
-    const size_t element_offset = grid_area * i;
-    linear_grids->grids[i].elements = &linear_grids->elements_storage[element_offset];
-  }
-}
-
-static LinearGridElement *linear_grid_element_get(const LinearGrids *linear_grids,
-                                                  const GridCoord *grid_coord)
-{
-  BLI_assert(grid_coord->grid_index >= 0);
-  BLI_assert(grid_coord->grid_index < linear_grids->num_grids);
-
-  const int grid_size = linear_grids->grid_size;
-
-  const int grid_x = lround(grid_coord->u * (grid_size - 1));
-  const int grid_y = lround(grid_coord->v * (grid_size - 1));
-  const int grid_element_index = grid_y * grid_size + grid_x;
-
-  LinearGrid *grid = &linear_grids->grids[grid_coord->grid_index];
-  return &grid->elements[grid_element_index];
-}
-
-static void linear_grids_free(LinearGrids *linear_grids)
-{
-  MEM_SAFE_FREE(linear_grids->grids);
-  MEM_SAFE_FREE(linear_grids->elements_storage);
-}
-
 static void linear_grid_element_init(LinearGridElement *linear_grid_element)
 {
   linear_grid_element->mask = 0.0f;
@@ -255,70 +179,6 @@ static void linear_grid_element_interpolate(LinearGridElement *result,
 
 /** \} */
 
-/* -------------------------------------------------------------------- */
-/** \name Surface
- * \{ */
-
-static void base_surface_grids_allocate(MultiresReshapeSmoothContext *reshape_smooth_context)
-{
-  const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
-
-  const int num_grids = reshape_context->num_grids;
-  const int grid_size = reshape_context->top.grid_size;
-  const int grid_area = grid_size * grid_size;
-
-  SurfaceGrid *surface_grid = MEM_malloc_arrayN(num_grids, sizeof(SurfaceGrid), "delta grids");
-
-  for (int grid_index = 0; grid_index < num_grids; ++grid_index) {
-    surface_grid[grid_index].points = MEM_calloc_arrayN(
-        sizeof(SurfacePoint), grid_area, "delta grid displacement");
-  }
-
-  reshape_smooth_context->base_surface_grids = surface_grid;
-}
-
-static void base_surface_grids_free(MultiresReshapeSmoothContext *reshape_smooth_context)
-{
-  if (reshape_smooth_context->base_surface_grids == NULL) {
-    return;
-  }
-
-  const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
-
-  const int num_grids = reshape_context->num_grids;
-  for (int grid_index = 0; grid_index < num_grids; ++grid_index) {
-    MEM_freeN(reshape_smooth_context->base_surface_grids[grid_index].points);
-  }
-  MEM_freeN(reshape_smooth_context->base_surface_grids);
-}
-
-static SurfacePoint *base_surface_grids_read(
-    const MultiresReshapeSmoothContext *reshape_smooth_context, const GridCoord *grid_coord)
-{
-  const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
-
-  const int grid_index = grid_coord->grid_index;
-  const int grid_size = reshape_context->top.grid_size;
-  const int grid_x = lround(grid_coord->u * (grid_size - 1));
-  const int grid_y = lround(grid_coord->v * (grid_size - 1));
-  const int grid_element_index = grid_y * grid_size + grid_x;
-
-  SurfaceGrid *surface_grid = &reshape_smooth_context->base_surface_grids[grid_index];
-  return &surface_grid->points[grid_element_index];
-}
-
-static void base_surface_grids_write(const MultiresReshapeSmoothContext *reshape_smooth_context,
-                                     const GridCoord *grid_coord,
-                                     float P[3],
-                                     float tangent_matrix[3][3])
-{
-  SurfacePoint *point = base_surface_grids_read(reshape_smooth_context, grid_coord);
-  copy_v3_v3(point->P, P);
-  copy_m3_m3(point->tangent_matrix, tangent_matrix);
-}
-
-/** \} */
-
 /* -------------------------------------------------------------------- */
 /** \name Evaluation of subdivision surface at a reshape level
  * \{ */
@@ -521,11 +381,9 @@ static void context_init(MultiresReshapeSmoothContext *reshape_smooth_context,
   reshape_smooth_context->geometry.num_faces = 0;
   reshape_smooth_context->geometry.faces = NULL;
 
-  linear_grids_init(&reshape_smooth_context->linear_delta_grids);
-
   reshape_smooth_context->non_loose_base_edge_map = NULL;
   reshape_smooth_context->reshape_subdiv = NULL;
-  reshape_smooth_context->base_surface_grids = NULL;
+  reshape_smooth_context->base_surface_subdiv = NULL;
 
   reshape_smooth_context->smoothing_type = mode;
 }
@@ -541,16 +399,16 @@ static void context_free_geometry(MultiresReshapeSmoothContext *reshape_smooth_c
   MEM_SAFE_FREE(reshape_smooth_context->geometry.corners);
   MEM_SAFE_FREE(reshape_smooth_context->geometry.faces);
   MEM_SAFE_FREE(reshape_smooth_context->geometry.edges);
-
-  linear_grids_free(&reshape_smooth_context->linear_delta_grids);
 }
 
 static void context_free_subdiv(MultiresReshapeSmoothContext *reshape_smooth_context)
 {
-  if (reshape_smooth_context->reshape_subdiv == NULL) {
-    return;
+  if (reshape_smooth_context->reshape_subdiv != NULL) {
+    BKE_subdiv_free(reshape_smooth_context->reshape_subdiv);
+  }
+  if (reshape_smooth_context->base_surface_subdiv != NULL) {
+    BKE_subdiv_free(reshape_smooth_context->base_surface_subdiv);
   }
-  BKE_subdiv_free(reshape_smooth_context->reshape_subdiv);
 }
 
 static void context_free(MultiresReshapeSmoothContext *reshape_smooth_context)
@@ -559,7 +417,6 @@ static void context_free(MultiresReshapeSmoothContext *reshape_smooth_context)
 
   context_free_geometry(reshape_smooth_context);
   context_free_subdiv(reshape_smooth_context);
-  base_surface_grids_free(reshape_smooth_context);
 }
 
 static bool foreach_topology_info(const SubdivForeachContext *foreach_context,
@@ -1027,8 +884,9 @@ static void converter_init(const MultiresReshapeSmoothContext *reshape_smooth_co
   converter->user_data = (void *)reshape_smooth_context;
 }
 
-/* Create subdiv descriptor created for topology at a reshape level,  */
-static void reshape_subdiv_create(MultiresReshapeSmoothContext *reshape_smooth_context)
+/* Create subdivision surface for the geometry at a reshape level, ready for evaluation once the
+ * coarse positions are refined. */
+static Subdiv *reshape_subdiv_new(const MultiresReshapeSmoothContext *reshape_smooth_context)
 {
   const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
   const SubdivSettings *settings = &reshape_context->subdiv->settings;
@@ -1039,9 +897,19 @@ static void reshape_subdiv_create(MultiresReshapeSmoothContext *reshape_smooth_c
   Subdiv *reshape_subdiv = BKE_subdiv_new_from_converter(settings, &converter);
   BKE_subdiv_eval_begin(reshape_subdiv);
 
-  reshape_smooth_context->reshape_subdiv = reshape_subdiv;
-
   BKE_subdiv_converter_free(&converter);
+
+  return reshape_subdiv;
+}
+
+static void reshape_subdiv_create(MultiresReshapeSmoothContext *reshape_smooth_context)
+{
+  reshape_smooth_context->reshape_subdiv = reshape_subdiv_new(reshape_smooth_context);
+}
+
+static void base_surface_subdiv_create(MultiresReshapeSmoothContext *reshape_smooth_context)
+{
+  reshape_smooth_context->base_surface_subdiv = reshape_subdiv_new(reshape_smooth_context);
 }
 
 /* Callback to provide coarse position for subdivision surface topology at a reshape level. */
@@ -1050,22 +918,49 @@ typedef void(ReshapeSubdivCoarsePositionCb)(
     const Vertex *vertex,
     float r_P[3]);
 
-/* Refine subdivision surface topology at a reshape level for new coarse vertices positions.  */
+typedef struct ReshapeSubdivRefineTaskData {
+  const MultiresReshapeSmoothContext *reshape_smooth_context;
+  ReshapeSubdivCoarsePositionCb *coarse_position_cb;
+  float (*coarse_positions)[3];
+} ReshapeSubdivRefineTaskData;
+
+static void reshape_subdiv_refine_task(void *__restrict userdata_v,
+                                       const int vertex_index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReshapeSubdivRefineTaskData *data = userdata_v;
+  const MultiresReshapeSmoothContext *reshape_smooth_context = data->reshape_smooth_context;
+  const Vertex *vertex = &reshape_smooth_context->geometry.vertices[vertex_index];
+  data->coarse_position_cb(reshape_smooth_context, vertex, data->coarse_positions[vertex_index]);
+}
+
+/* Refine subdivision surface topology at a reshape level for new coarse vertices positions.
+ *
+ * The coarse positions are calculated in parallel, and are passed to the evaluator at once. */
 static void reshape_subdiv_refine(const MultiresReshapeSmoothContext *reshape_smooth_context,
+                                  Subdiv *reshape_subdiv,
                                   ReshapeSubdivCoarsePositionCb coarse_position_cb)
 {
-  Subdiv *reshape_subdiv = reshape_smooth_context->reshape_subdiv;
+  const int num_vertices = reshape_smooth_context->geometry.num_vertices;
 
-  /* TODO(sergey): For non-trivial coarse_position_cb we should multi-thread this loop. */
+  ReshapeSubdivRefineTaskData data;
+  data.reshape_smooth_context = reshape_smooth_context;
+  data.coarse_position_cb = coarse_position_cb;
+  data.coarse_positions = MEM_malloc_arrayN(
+      num_vertices, sizeof(float[3]), "reshape coarse positions");
 
-  const int num_vertices = reshape_smooth_context->geometry.num_vertices;
-  for (int i = 0; i < num_vertices; ++i) {
-    const Vertex *vertex = &reshape_smooth_context->geometry.vertices[i];
-    float P[3];
-    coarse_position_cb(reshape_smooth_context, vertex, P);
-    reshape_subdiv->evaluator->setCoarsePositions(reshape_subdiv->evaluator, P, i, 1);
-  }
+  TaskParallelSettings parallel_range_settings;
+  BLI_parallel_range_settings_defaults(&parallel_range_settings);
+  parallel_range_settings.min_iter_per_thread = 1024;
+
+  BLI_task_parallel_range(
+      0, num_vertices, &data, reshape_subdiv_refine_task, &parallel_range_settings);
+
+  reshape_subdiv->evaluator->setCoarsePositions(
+      reshape_subdiv->evaluator, &data.coarse_positions[0][0], 0, num_vertices);
   reshape_subdiv->evaluator->refine(reshape_subdiv->evaluator);
+
+  MEM_freeN(data.coarse_positions);
 }
 
 BLI_INLINE const GridCoord *reshape_subdiv_refine_vertex_grid_coord(const Vertex *vertex)
@@ -1106,9 +1001,10 @@ static void reshape_subdiv_refine_orig_P(
 
   add_v3_v3v3(r_P, limit_P, D);
 }
-static void reshape_subdiv_refine_orig(const MultiresReshapeSmoothContext *reshape_smooth_context)
+static void reshape_subdiv_refine_orig(const MultiresReshapeSmoothContext *reshape_smooth_context,
+                                       Subdiv *reshape_subdiv)
 {
-  reshape_subdiv_refine(reshape_smooth_context, reshape_subdiv_refine_orig_P);
+  reshape_subdiv_refine(reshape_smooth_context, reshape_subdiv, reshape_subdiv_refine_orig_P);
 }
 
 /* Version of reshape_subdiv_refine() which uses coarse position from final grids. */
@@ -1131,13 +1027,15 @@ static void reshape_subdiv_refine_final_P(
    * vertices coordinates. */
   copy_v3_v3(r_P, grid_element.displacement);
 }
-static void reshape_subdiv_refine_final(const MultiresReshapeSmoothContext *reshape_smooth_context)
+static void reshape_subdiv_refine_final(const MultiresReshapeSmoothContext *reshape_smooth_context,
+                                        Subdiv *reshape_subdiv)
 {
-  reshape_subdiv_refine(reshape_smooth_context, reshape_subdiv_refine_final_P);
+  reshape_subdiv_refine(reshape_smooth_context, reshape_subdiv, reshape_subdiv_refine_final_P);
 }
 
 static void reshape_subdiv_evaluate_limit_at_grid(
     const MultiresReshapeSmoothContext *reshape_smooth_context,
+    Subdiv *reshape_subdiv,
     const PTexCoord *ptex_coord,
     const GridCoord *grid_coord,
     float limit_P[3],
@@ -1146,7 +1044,7 @@ static void reshape_subdiv_evaluate_limit_at_grid(
   const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
 
   float dPdu[3], dPdv[3];
-  BKE_subdiv_eval_limit_point_and_derivatives(reshape_smooth_context->reshape_subdiv,
+  BKE_subdiv_eval_limit_point_and_derivatives(reshape_subdiv,
                                               ptex_coord->ptex_face_index,
                                               ptex_coord->u,
                                               ptex_coord->v,
@@ -1247,45 +1145,47 @@ static void linear_grid_element_delta_interpolate(
   linear_grid_element_interpolate(result, corner_elements, weights);
 }
 
-static void evaluate_linear_delta_grids_callback(
-    const MultiresReshapeSmoothContext *reshape_smooth_context,
-    const PTexCoord *UNUSED(ptex_coord),
-    const GridCoord *grid_coord,
-    void *UNUSED(userdata_v))
-{
-  LinearGridElement *linear_delta_element = linear_grid_element_get(
-      &reshape_smooth_context->linear_delta_grids, grid_coord);
-
-  linear_grid_element_delta_interpolate(reshape_smooth_context, grid_coord, linear_delta_element);
-}
-
-static void evaluate_linear_delta_grids(MultiresReshapeSmoothContext *reshape_smooth_context)
+/* Whether the grid coordinate at the top level matches a grid element at the reshape level. */
+static bool is_reshape_level_grid_coord(const MultiresReshapeContext *reshape_context,
+                                        const GridCoord *grid_coord)
 {
-  const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
-  const int num_grids = reshape_context->num_grids;
-  const int top_level = reshape_context->top.level;
+  const int level_difference = (reshape_context->top.level - reshape_context->reshape.level);
+  const int step = 1 << level_difference;
 
-  linear_grids_allocate(&reshape_smooth_context->linear_delta_grids, num_grids, top_level);
+  const int grid_size = reshape_context->top.grid_size;
+  const int grid_x = lround(grid_coord->u * (grid_size - 1));
+  const int grid_y = lround(grid_coord->v * (grid_size - 1));
 
-  foreach_toplevel_grid_coord(reshape_smooth_context, evaluate_linear_delta_grids_callback, NULL);
+  return (grid_x % step) == 0 && (grid_y % step) == 0;
 }
 
+/* Propagate linear data to the given top level element.
+ *
+ * The delta is interpolated from the reshape level elements of the same grid on demand, so no
+ * top level storage is needed for it. The reshape level elements themselves are not written:
+ * they already hold the final value, and are read concurrently by the tasks of the neighbor
+ * faces. */
 static void propagate_linear_data_delta(const MultiresReshapeSmoothContext *reshape_smooth_context,
                                         ReshapeGridElement *final_grid_element,
                                         const GridCoord *grid_coord)
 {
   const MultiresReshapeContext *reshape_context = reshape_smooth_context->reshape_context;
 
-  LinearGridElement *linear_delta_element = linear_grid_element_get(
-      &reshape_smooth_context->linear_delta_grids, grid_coord);
+  if (final_grid_element->mask == NULL) {
+    return;
+  }
+  if (is_reshape_level_grid_coord(reshape_context, grid_coord)) {
+    return;
+  }
+
+  LinearGridElement linear_delta_element;
+  linear_grid_element_delta_interpolate(reshape_smooth_context, grid_coord, &linear_delta_element);
 
   const ReshapeConstGridElement orig_grid_element =
       multires_reshape_orig_grid_element_for_grid_coord(reshape_context, grid_coord);
 
-  if (final_grid_element->mask != NULL) {
-    *final_grid_element->mask = clamp_f(
-        orig_grid_element.mask + linear_delta_element->mask, 0.0f, 1.0f);
-  }
+  *final_grid_element->mask = clamp_f(
+      orig_grid_element.mask + linear_delta_element.mask, 0.0f, 1.0f);
 }
 
 /** \} */
@@ -1294,23 +1194,18 @@ static void propagate_linear_data_delta(const MultiresReshapeSmoothContext *resh
 /** \name Evaluation of base surface
  * \{ */
 
-static void evaluate_base_surface_grids_callback(
-    const MultiresReshapeSmoothContext *reshape_smooth_context,
-    const PTexCoord *ptex_coord,
-    const GridCoord *grid_coord,
-    void *UNUSED(userdata_v))
-{
-  float limit_P[3];
-  float tangent_matrix[3][3];
-  reshape_subdiv_evaluate_limit_at_grid(
-      reshape_smooth_context, ptex_coord, grid_coord, limit_P, tangent_matrix);
-
-  base_surface_grids_write(reshape_smooth_context, grid_coord, limit_P, tangent_matrix);
-}
-
-static void evaluate_base_surface_grids(const MultiresReshapeSmoothContext *reshape_smooth_context)
+/* Original surface point on sculpt level (sculpt level before edits in sculpt mode). */
+static void evaluate_base_surface_point(const MultiresReshapeSmoothContext *reshape_smooth_context,
+                                        const PTexCoord *ptex_coord,
+                                        const GridCoord *grid_coord,
+                                        SurfacePoint *r_point)
 {
-  foreach_toplevel_grid_coord(reshape_smooth_context, evaluate_base_surface_grids_callback, NULL);
+  reshape_subdiv_evaluate_limit_at_grid(reshape_smooth_context,
+                                        reshape_smooth_context->base_surface_subdiv,
+                                        ptex_coord,
+                                        grid_coord,
+                                        r_point->P,
+                                        r_point->tangent_matrix);
 }
 
 /** \} */
@@ -1359,26 +1254,30 @@ static void evaluate_higher_grid_positions_with_details_callback(
   evaluate_final_original_point(reshape_smooth_context, grid_coord, orig_final_P);
 
   /* Original surface point on sculpt level (sculpt level before edits in sculpt mode). */
-  const SurfacePoint *orig_sculpt_point = base_surface_grids_read(reshape_smooth_context,
-                                                                  grid_coord);
+  SurfacePoint orig_sculpt_point;
+  evaluate_base_surface_point(reshape_smooth_context, ptex_coord, grid_coord, &orig_sculpt_point);
 
   /* Difference between original top level and original sculpt level in object space. */
   float original_detail_delta[3];
-  sub_v3_v3v3(original_detail_delta, orig_final_P, orig_sculpt_point->P);
+  sub_v3_v3v3(original_detail_delta, orig_final_P, orig_sculpt_point.P);
 
   /* Difference between original top level and original sculpt level in tangent space of original
    * sculpt level. */
   float original_detail_delta_tangent[3];
   float original_sculpt_tangent_matrix_inv[3][3];
-  invert_m3_m3(original_sculpt_tangent_matrix_inv, orig_sculpt_point->tangent_matrix);
+  invert_m3_m3(original_sculpt_tangent_matrix_inv, orig_sculpt_point.tangent_matrix);
   mul_v3_m3v3(
       original_detail_delta_tangent, original_sculpt_tangent_matrix_inv, original_detail_delta);
 
   /* Limit surface of smoothed (subdivided) edited sculpt level. */
   float smooth_limit_P[3];
   float smooth_tangent_matrix[3][3];
-  reshape_subdiv_evaluate_limit_at_grid(
-      reshape_smooth_context, ptex_coord, grid_coord, smooth_limit_P, smooth_tangent_matrix);
+  reshape_subdiv_evaluate_limit_at_grid(reshape_smooth_context,
+                                        reshape_smooth_context->reshape_subdiv,
+                                        ptex_coord,
+                                        grid_coord,
+                                        smooth_limit_P,
+                                        smooth_tangent_matrix);
 
   /* Add original detail to the smoothed surface. */
   float smooth_delta[3];
@@ -1457,15 +1356,15 @@ void multires_reshape_smooth_object_grids_with_details(
   }
 
   geometry_create(&reshape_smooth_context);
-  evaluate_linear_delta_grids(&reshape_smooth_context);
 
-  reshape_subdiv_create(&reshape_smooth_context);
+  /* Both the original and the edited surfaces at the reshape level are kept for evaluation, so
+   * that every top level element is calculated and written in a single pass over the faces. */
+  base_surface_subdiv_create(&reshape_smooth_context);
+  reshape_subdiv_refine_orig(&reshape_smooth_context, reshape_smooth_context.base_surface_subdiv);
 
-  base_surface_grids_allocate(&reshape_smooth_context);
-  reshape_subdiv_refine_orig(&reshape_smooth_context);
-  evaluate_base_surface_grids(&reshape_smooth_context);
+  reshape_subdiv_create(&reshape_smooth_context);
+  reshape_subdiv_refine_final(&reshape_smooth_context, reshape_smooth_context.reshape_subdiv);
 
-  reshape_subdiv_refine_final(&reshape_smooth_context);
   evaluate_higher_grid_positions_with_details(&reshape_smooth_context);
 
   context_free(&reshape_smooth_context);
@@ -1484,11 +1383,9 @@ void multires_reshape_smooth_object_grids(const MultiresReshapeContext *reshape_
   context_init(&reshape_smooth_context, reshape_context, mode);
 
   geometry_create(&reshape_smooth_context);
-  evaluate_linear_delta_grids(&reshape_smooth_context);
 
   reshape_subdiv_create(&reshape_smooth_context);
-
-  reshape_subdiv_refine_final(&reshape_smooth_context);
+  reshape_subdiv_refine_final(&reshape_smooth_context, reshape_smooth_context.reshape_subdiv);
   evaluate_higher_grid_positions(&reshape_smooth_context);
 
   context_free(&reshape_smooth_context);
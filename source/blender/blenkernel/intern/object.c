@@ -2197,11 +2197,12 @@ ParticleSystem *BKE_object_copy_particlesystem(ParticleSystem *psys, const int f
 
   psysn->pathcache = NULL;
   psysn->childcache = NULL;
+  psysn->childcache_keys = NULL;
   psysn->edit = NULL;
   psysn->pdd = NULL;
   psysn->effectors = NULL;
   psysn->tree = NULL;
-  psysn->bvhtree = NULL;
+  psysn->neighbor_grid = NULL;
   psysn->batch_cache = NULL;
 
   BLI_listbase_clear(&psysn->pathcachebufs);
@@ -45,7 +45,6 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_blenlib.h"
-#include "BLI_kdopbvh.h"
 #include "BLI_kdtree.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
@@ -972,11 +971,94 @@ void free_keyed_keys(ParticleSystem *psys)
     }
   }
 }
-static void free_child_path_cache(ParticleSystem *psys)
+/* Settings read by the child paths. */
+typedef struct ParticleChildPathSettings {
+  /* Plain values, compared as a whole. */
+  struct {
+    int flag, child_flag, kink_extra_steps;
+    short type, from, childtype, draw_col, kink, kink_axis;
+    float lifetime, randlife;
+    float parents, childsize, childrandsize, childrad, childflat;
+    float clumpfac, clumppow, clump_noise_size;
+    float kink_amp, kink_freq, kink_shape, kink_flat, kink_amp_clump;
+    float kink_axis_random, kink_amp_random;
+    float rough1, rough1_size, rough2, rough2_size, rough2_thres, rough_end, rough_end_shape;
+    float clength, clength_thres;
+    float parting_fac, parting_min, parting_max;
+    float twist;
+  } values;
+
+  /* Copies of the curves in use. */
+  CurveMapping *clumpcurve, *roughcurve, *twistcurve;
+} ParticleChildPathSettings;
+
+/* Data of a parent read by the child paths, besides its path. */
+typedef struct ParticleChildCacheParent {
+  int flag, num, num_dmcache;
+  float fuv[4], foffset;
+} ParticleChildCacheParent;
+
+/* Copies of the inputs the child paths were computed from, so that the next update only
+ * recomputes the children whose parents or distribution changed. */
+typedef struct ParticleChildCacheKeys {
+  ParticleChildPathSettings settings;
+  int seed, child_seed, totpart;
+  int between, segments, extra_segments, totchild, totparent;
+  float cfra;
+  float obmat[4][4];
+
+  /* Emitter surface the children are distributed on, and its vertex groups. */
+  float (*vert_co)[3];
+  int totvert;
+  MFace *mface;
+  int totface;
+  float *vgroups[8];
+
+  /* Paths of the parents, only the keys read by the children. */
+  ParticleCacheKey *parent_paths;
+  ParticleChildCacheParent *parents;
+  int parents_num;
+
+  /* Distribution of every child. */
+  ChildParticle *children;
+} ParticleChildCacheKeys;
+
+static void child_path_settings_free(ParticleChildPathSettings *settings)
+{
+  CurveMapping **curves[] = {
+      &settings->clumpcurve, &settings->roughcurve, &settings->twistcurve};
+  for (int i = 0; i < ARRAY_SIZE(curves); i++) {
+    if (*curves[i]) {
+      BKE_curvemapping_free(*curves[i]);
+      *curves[i] = NULL;
+    }
+  }
+}
+
+static void child_cache_keys_free(ParticleChildCacheKeys *keys)
+{
+  child_path_settings_free(&keys->settings);
+  MEM_SAFE_FREE(keys->vert_co);
+  MEM_SAFE_FREE(keys->mface);
+  for (int i = 0; i < ARRAY_SIZE(keys->vgroups); i++) {
+    MEM_SAFE_FREE(keys->vgroups[i]);
+  }
+  MEM_SAFE_FREE(keys->parent_paths);
+  MEM_SAFE_FREE(keys->parents);
+  MEM_SAFE_FREE(keys->children);
+  MEM_freeN(keys);
+}
+
+void psys_free_child_path_cache(ParticleSystem *psys)
 {
   psys_free_path_cache_buffers(psys->childcache, &psys->childcachebufs);
   psys->childcache = NULL;
   psys->totchildcache = 0;
+
+  if (psys->childcache_keys) {
+    child_cache_keys_free(psys->childcache_keys);
+    psys->childcache_keys = NULL;
+  }
 }
 void psys_free_path_cache(ParticleSystem *psys, PTCacheEdit *edit)
 {
@@ -990,7 +1072,7 @@ void psys_free_path_cache(ParticleSystem *psys, PTCacheEdit *edit)
     psys->pathcache = NULL;
     psys->totcached = 0;
 
-    free_child_path_cache(psys);
+    psys_free_child_path_cache(psys);
   }
 }
 void psys_free_children(ParticleSystem *psys)
@@ -1001,7 +1083,7 @@ void psys_free_children(ParticleSystem *psys)
     psys->totchild = 0;
   }
 
-  free_child_path_cache(psys);
+  psys_free_child_path_cache(psys);
 }
 void psys_free_particles(ParticleSystem *psys)
 {
@@ -1121,7 +1203,7 @@ void psys_free(Object *ob, ParticleSystem *psys)
 
     BLI_freelistN(&psys->targets);
 
-    BLI_bvhtree_free(psys->bvhtree);
+    psys_free_neighbor_grid(psys);
     BLI_kdtree_3d_free(psys->tree);
 
     if (psys->fluid_springs) {
@@ -2794,21 +2876,12 @@ static bool psys_thread_context_init_path(ParticleThreadContext *ctx,
   return true;
 }
 
-static void psys_task_init_path(ParticleTask *task, ParticleSimulationData *sim)
-{
-  /* init random number generator */
-  int seed = 31415926 + sim->psys->seed;
-
-  task->rng_path = BLI_rng_new(seed);
-}
-
 /* note: this function must be thread safe, except for branching! */
-static void psys_thread_create_path(ParticleTask *task,
+static void psys_thread_create_path(ParticleThreadContext *ctx,
                                     struct ChildParticle *cpa,
                                     ParticleCacheKey *child_keys,
                                     int i)
 {
-  ParticleThreadContext *ctx = task->ctx;
   Object *ob = ctx->sim.ob;
   ParticleSystem *psys = ctx->sim.psys;
   ParticleSettings *part = psys->part;
@@ -3135,20 +3208,366 @@ static void psys_thread_create_path(ParticleTask *task,
   }
 }
 
-static void exec_child_path_cache(TaskPool *__restrict UNUSED(pool), void *taskdata)
+static ParticleCacheKey **psys_child_parent_path_cache(ParticleThreadContext *ctx,
+                                                       int *r_parents_num)
 {
-  ParticleTask *task = taskdata;
-  ParticleThreadContext *ctx = task->ctx;
   ParticleSystem *psys = ctx->sim.psys;
-  ParticleCacheKey **cache = psys->childcache;
-  ChildParticle *cpa;
-  int i;
+  PTCacheEdit *edit = psys_orig_edit_get(psys);
+
+  if (psys_in_edit_mode(ctx->sim.depsgraph, psys) && edit) {
+    *r_parents_num = edit->totcached;
+    return edit->pathcache;
+  }
+  *r_parents_num = psys->totcached;
+  return psys->pathcache;
+}
+
+/* Effectors, lattices and textures depend on data that is not part of the keys. */
+static bool child_cache_supports_incremental(const ParticleThreadContext *ctx)
+{
+  const ParticleSystem *psys = ctx->sim.psys;
+  const ParticleSettings *part = psys->part;
+
+  if ((part->flag & PART_CHILD_EFFECT) || psys->lattice_deform_data) {
+    return false;
+  }
+  for (int m = 0; m < MAX_MTEX; m++) {
+    const MTex *mtex = part->mtex[m];
+    if (mtex && mtex->tex && (mtex->mapto & PAMAP_CHILD)) {
+      return false;
+    }
+  }
+  /* Settings changes are tagged, but their data (curves...) is not all part of the keys. */
+  return (psys->recalc & ID_RECALC_PSYS_ALL) == 0;
+}
+
+static CurveMapping *child_path_curve_copy(const CurveMapping *curve, const bool use_curve)
+{
+  return (use_curve && curve) ? BKE_curvemapping_copy(curve) : NULL;
+}
+
+static void child_path_settings_get(const ParticleSettings *part,
+                                    ParticleChildPathSettings *r_settings)
+{
+  /* Zeroed first, so that the padding of the values compares equal. */
+  memset(r_settings, 0, sizeof(*r_settings));
+
+  r_settings->values.flag = part->flag;
+  r_settings->values.child_flag = part->child_flag;
+  r_settings->values.kink_extra_steps = part->kink_extra_steps;
+  r_settings->values.type = part->type;
+  r_settings->values.from = part->from;
+  r_settings->values.childtype = part->childtype;
+  r_settings->values.draw_col = part->draw_col;
+  r_settings->values.kink = part->kink;
+  r_settings->values.kink_axis = part->kink_axis;
+  r_settings->values.lifetime = part->lifetime;
+  r_settings->values.randlife = part->randlife;
+  r_settings->values.parents = part->parents;
+  r_settings->values.childsize = part->childsize;
+  r_settings->values.childrandsize = part->childrandsize;
+  r_settings->values.childrad = part->childrad;
+  r_settings->values.childflat = part->childflat;
+  r_settings->values.clumpfac = part->clumpfac;
+  r_settings->values.clumppow = part->clumppow;
+  r_settings->values.clump_noise_size = part->clump_noise_size;
+  r_settings->values.kink_amp = part->kink_amp;
+  r_settings->values.kink_freq = part->kink_freq;
+  r_settings->values.kink_shape = part->kink_shape;
+  r_settings->values.kink_flat = part->kink_flat;
+  r_settings->values.kink_amp_clump = part->kink_amp_clump;
+  r_settings->values.kink_axis_random = part->kink_axis_random;
+  r_settings->values.kink_amp_random = part->kink_amp_random;
+  r_settings->values.rough1 = part->rough1;
+  r_settings->values.rough1_size = part->rough1_size;
+  r_settings->values.rough2 = part->rough2;
+  r_settings->values.rough2_size = part->rough2_size;
+  r_settings->values.rough2_thres = part->rough2_thres;
+  r_settings->values.rough_end = part->rough_end;
+  r_settings->values.rough_end_shape = part->rough_end_shape;
+  r_settings->values.clength = part->clength;
+  r_settings->values.clength_thres = part->clength_thres;
+  r_settings->values.parting_fac = part->parting_fac;
+  r_settings->values.parting_min = part->parting_min;
+  r_settings->values.parting_max = part->parting_max;
+  r_settings->values.twist = part->twist;
+
+  r_settings->clumpcurve = child_path_curve_copy(
+      part->clumpcurve, part->child_flag & PART_CHILD_USE_CLUMP_CURVE);
+  r_settings->roughcurve = child_path_curve_copy(
+      part->roughcurve, part->child_flag & PART_CHILD_USE_ROUGH_CURVE);
+  r_settings->twistcurve = child_path_curve_copy(
+      part->twistcurve, part->child_flag & PART_CHILD_USE_TWIST_CURVE);
+}
+
+/* Compare what the curve evaluates to, not the evaluation tables or the UI state. */
+static bool child_path_curve_equal(const CurveMapping *curve_a, const CurveMapping *curve_b)
+{
+  if (curve_a == NULL || curve_b == NULL) {
+    return curve_a == curve_b;
+  }
+  if (curve_a->flag != curve_b->flag ||
+      !BLI_rctf_compare(&curve_a->clipr, &curve_b->clipr, 0.0f)) {
+    return false;
+  }
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma_a = &curve_a->cm[i];
+    const CurveMap *cuma_b = &curve_b->cm[i];
+    if (cuma_a->totpoint != cuma_b->totpoint || cuma_a->flag != cuma_b->flag) {
+      return false;
+    }
+    for (int a = 0; a < cuma_a->totpoint; a++) {
+      const CurveMapPoint *point_a = &cuma_a->curve[a];
+      const CurveMapPoint *point_b = &cuma_b->curve[a];
+      if (point_a->x != point_b->x || point_a->y != point_b->y ||
+          point_a->flag != point_b->flag) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool child_path_settings_equal(const ParticleChildPathSettings *settings_a,
+                                      const ParticleChildPathSettings *settings_b)
+{
+  return (memcmp(&settings_a->values, &settings_b->values, sizeof(settings_a->values)) == 0 &&
+          child_path_curve_equal(settings_a->clumpcurve, settings_b->clumpcurve) &&
+          child_path_curve_equal(settings_a->roughcurve, settings_b->roughcurve) &&
+          child_path_curve_equal(settings_a->twistcurve, settings_b->twistcurve));
+}
+
+/* Whether changing from one settings to the other changes the child paths. */
+bool psys_child_path_settings_equal(const ParticleSettings *part_a, const ParticleSettings *part_b)
+{
+  ParticleChildPathSettings settings_a, settings_b;
+  child_path_settings_get(part_a, &settings_a);
+  child_path_settings_get(part_b, &settings_b);
+
+  const bool equal = child_path_settings_equal(&settings_a, &settings_b);
+
+  child_path_settings_free(&settings_a);
+  child_path_settings_free(&settings_b);
+  return equal;
+}
+
+static void child_cache_vgroups_get(const ParticleThreadContext *ctx, const float *r_vgroups[8])
+{
+  r_vgroups[0] = ctx->vg_length;
+  r_vgroups[1] = ctx->vg_clump;
+  r_vgroups[2] = ctx->vg_kink;
+  r_vgroups[3] = ctx->vg_rough1;
+  r_vgroups[4] = ctx->vg_rough2;
+  r_vgroups[5] = ctx->vg_roughe;
+  r_vgroups[6] = ctx->vg_effector;
+  r_vgroups[7] = ctx->vg_twist;
+}
+
+typedef struct ChildPathCacheData {
+  ParticleThreadContext *ctx;
+  ParticleCacheKey **cache;
+
+  /* Parent paths children are interpolated from. */
+  ParticleCacheKey **pcache;
+  int parents_num;
+
+  /* Copies of the inputs, for the next update. */
+  ParticleChildCacheKeys *keys;
+
+  /* Incremental update from the previous inputs, NULL when all paths are computed. */
+  const ParticleChildCacheKeys *keys_prev;
+  bool *parents_changed;
+  /* Virtual parents recomputed in the parent pass. */
+  bool *virtual_parents_changed;
+} ChildPathCacheData;
 
-  cpa = psys->child + task->begin;
-  for (i = task->begin; i < task->end; i++, cpa++) {
-    BLI_assert(i < psys->totchildcache);
-    psys_thread_create_path(task, cpa, cache[i], i);
+static void child_cache_parent_store_task(void *__restrict userdata,
+                                          const int p,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ChildPathCacheData *data = userdata;
+  const ParticleSystem *psys = data->ctx->sim.psys;
+  /* Only the keys read by the children, edit mode paths may have more segments. */
+  const int keys_num = data->ctx->segments + 1;
+  ParticleCacheKey *path = &data->keys->parent_paths[p * keys_num];
+  ParticleChildCacheParent *parent = &data->keys->parents[p];
+
+  memcpy(path, data->pcache[p], sizeof(*path) * keys_num);
+  if (p < psys->totpart) {
+    const ParticleData *pa = &psys->particles[p];
+    parent->flag = pa->flag;
+    parent->num = pa->num;
+    parent->num_dmcache = pa->num_dmcache;
+    copy_v4_v4(parent->fuv, pa->fuv);
+    parent->foffset = pa->foffset;
+  }
+}
+
+static void child_cache_parent_compare_task(void *__restrict userdata,
+                                            const int p,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ChildPathCacheData *data = userdata;
+  const int keys_num = data->ctx->segments + 1;
+
+  const ParticleCacheKey *path = &data->keys->parent_paths[p * keys_num];
+  const ParticleCacheKey *path_prev = &data->keys_prev->parent_paths[p * keys_num];
+  const ParticleChildCacheParent *parent = &data->keys->parents[p];
+  const ParticleChildCacheParent *parent_prev = &data->keys_prev->parents[p];
+
+  data->parents_changed[p] = (memcmp(path, path_prev, sizeof(*path) * keys_num) != 0 ||
+                              memcmp(parent, parent_prev, sizeof(*parent)) != 0);
+}
+
+static ParticleChildCacheKeys *child_cache_keys_create(ChildPathCacheData *data)
+{
+  const ParticleThreadContext *ctx = data->ctx;
+  const ParticleSystem *psys = ctx->sim.psys;
+  const Mesh *mesh = ctx->mesh;
+  const float *vgroups[8];
+  ParticleChildCacheKeys *keys = MEM_callocN(sizeof(*keys), __func__);
+
+  child_path_settings_get(psys->part, &keys->settings);
+  keys->seed = psys->seed;
+  keys->child_seed = psys->child_seed;
+  keys->totpart = psys->totpart;
+  keys->between = ctx->between;
+  keys->segments = ctx->segments;
+  keys->extra_segments = ctx->extra_segments;
+  keys->totchild = ctx->totchild;
+  keys->totparent = ctx->totparent;
+  keys->cfra = ctx->cfra;
+  copy_m4_m4(keys->obmat, ctx->sim.ob->obmat);
+
+  keys->totvert = mesh->totvert;
+  keys->vert_co = MEM_malloc_arrayN(MAX2(mesh->totvert, 1), sizeof(*keys->vert_co), __func__);
+  for (int v = 0; v < mesh->totvert; v++) {
+    copy_v3_v3(keys->vert_co[v], mesh->mvert[v].co);
+  }
+  keys->totface = mesh->totface;
+  keys->mface = MEM_malloc_arrayN(MAX2(mesh->totface, 1), sizeof(*keys->mface), __func__);
+  if (mesh->totface) {
+    memcpy(keys->mface, mesh->mface, sizeof(*keys->mface) * mesh->totface);
+  }
+  child_cache_vgroups_get(ctx, vgroups);
+  for (int i = 0; i < ARRAY_SIZE(vgroups); i++) {
+    if (vgroups[i]) {
+      keys->vgroups[i] = MEM_malloc_arrayN(mesh->totvert, sizeof(float), __func__);
+      memcpy(keys->vgroups[i], vgroups[i], sizeof(float) * mesh->totvert);
+    }
+  }
+
+  keys->parents_num = data->parents_num;
+  keys->parent_paths = MEM_malloc_arrayN(MAX2(data->parents_num, 1) * (ctx->segments + 1),
+                                         sizeof(*keys->parent_paths),
+                                         __func__);
+  keys->parents = MEM_calloc_arrayN(
+      MAX2(data->parents_num, 1), sizeof(*keys->parents), __func__);
+  data->keys = keys;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, data->parents_num, data, child_cache_parent_store_task, &settings);
+
+  keys->children = MEM_dupallocN(psys->child);
+
+  return keys;
+}
+
+/* Whether the children can be computed from the same inputs as the previous update, besides
+ * their parents and distribution which are compared per child. */
+static bool child_cache_keys_context_equal(const ParticleChildCacheKeys *keys_a,
+                                           const ParticleChildCacheKeys *keys_b)
+{
+  if (!child_path_settings_equal(&keys_a->settings, &keys_b->settings) ||
+      keys_a->seed != keys_b->seed || keys_a->child_seed != keys_b->child_seed ||
+      keys_a->totpart != keys_b->totpart || keys_a->between != keys_b->between ||
+      keys_a->segments != keys_b->segments || keys_a->extra_segments != keys_b->extra_segments ||
+      keys_a->totchild != keys_b->totchild || keys_a->totparent != keys_b->totparent ||
+      keys_a->cfra != keys_b->cfra || !equals_m4m4(keys_a->obmat, keys_b->obmat) ||
+      keys_a->parents_num != keys_b->parents_num) {
+    return false;
+  }
+
+  if (keys_a->totvert != keys_b->totvert || keys_a->totface != keys_b->totface ||
+      memcmp(keys_a->vert_co, keys_b->vert_co, sizeof(*keys_a->vert_co) * keys_a->totvert) ||
+      memcmp(keys_a->mface, keys_b->mface, sizeof(*keys_a->mface) * keys_a->totface)) {
+    return false;
+  }
+  for (int i = 0; i < ARRAY_SIZE(keys_a->vgroups); i++) {
+    if ((keys_a->vgroups[i] == NULL) != (keys_b->vgroups[i] == NULL) ||
+        (keys_a->vgroups[i] &&
+         memcmp(keys_a->vgroups[i], keys_b->vgroups[i], sizeof(float) * keys_a->totvert))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+BLI_INLINE bool child_cache_parent_changed(const ChildPathCacheData *data, const int p)
+{
+  return (p >= 0 && p < data->parents_num && data->parents_changed[p]);
+}
+
+/* Whether any of the parent paths read by #psys_thread_create_path changed. */
+static bool child_cache_child_parents_changed(const ChildPathCacheData *data,
+                                              const ChildParticle *cpa,
+                                              const int i)
+{
+  const ParticleThreadContext *ctx = data->ctx;
+
+  if (child_cache_parent_changed(data, cpa->parent)) {
+    return true;
+  }
+  for (int w = 0; w < 4; w++) {
+    /* Interpolated children read the first parent in place of missing ones. */
+    const int p = (cpa->pa[w] >= 0) ? cpa->pa[w] : (ctx->between ? 0 : -1);
+    if (child_cache_parent_changed(data, p)) {
+      return true;
+    }
+  }
+  if (ctx->totparent && i >= ctx->totparent) {
+    if (cpa->parent < 0 || cpa->parent >= ctx->totparent ||
+        data->virtual_parents_changed[cpa->parent]) {
+      return true;
+    }
   }
+  return false;
+}
+
+static void child_path_cache_task(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ChildPathCacheData *data = userdata;
+  ParticleThreadContext *ctx = data->ctx;
+  ChildParticle *cpa = &ctx->sim.psys->child[i];
+  ParticleCacheKey *child_keys = data->cache[i];
+
+  BLI_assert(i < ctx->sim.psys->totchildcache);
+
+  if (data->keys_prev) {
+    if (memcmp(cpa, &data->keys_prev->children[i], sizeof(*cpa)) == 0 &&
+        !child_cache_child_parents_changed(data, cpa, i)) {
+      return;
+    }
+
+    memset(child_keys, 0, sizeof(*child_keys) * (ctx->segments + ctx->extra_segments + 1));
+    if (i < ctx->totparent) {
+      data->virtual_parents_changed[i] = true;
+    }
+  }
+
+  psys_thread_create_path(ctx, cpa, child_keys, i);
+}
+
+static void child_path_cache_parallel_range(ChildPathCacheData *data, int start, int stop)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(start, stop, data, child_path_cache_task, &settings);
 }
 
 void psys_cache_child_paths(ParticleSimulationData *sim,
@@ -3156,63 +3575,85 @@ void psys_cache_child_paths(ParticleSimulationData *sim,
                             const bool editupdate,
                             const bool use_render_params)
 {
-  TaskPool *task_pool;
+  ParticleSystem *psys = sim->psys;
   ParticleThreadContext ctx;
-  ParticleTask *tasks_parent, *tasks_child;
-  int numtasks_parent, numtasks_child;
-  int i, totchild, totparent;
+  int totchild, totparent;
 
-  if (sim->psys->flag & PSYS_GLOBAL_HAIR) {
+  if (psys->flag & PSYS_GLOBAL_HAIR) {
+    if (!editupdate) {
+      psys_free_child_path_cache(psys);
+    }
     return;
   }
 
-  /* create a task pool for child path tasks */
   if (!psys_thread_context_init_path(&ctx, sim, sim->scene, cfra, editupdate, use_render_params)) {
+    if (!editupdate) {
+      psys_free_child_path_cache(psys);
+    }
     return;
   }
 
-  task_pool = BLI_task_pool_create(&ctx, TASK_PRIORITY_LOW);
   totchild = ctx.totchild;
   totparent = ctx.totparent;
 
-  if (editupdate && sim->psys->childcache && totchild == sim->psys->totchildcache) {
+  ChildPathCacheData data = {.ctx = &ctx};
+  ParticleChildCacheKeys *keys = NULL;
+  ParticleChildCacheKeys *keys_prev = psys->childcache_keys;
+  psys->childcache_keys = NULL;
+
+  data.pcache = psys_child_parent_path_cache(&ctx, &data.parents_num);
+
+  if (!editupdate && data.pcache) {
+    /* Keep the inputs of the children, to skip the unchanged ones on the next update. */
+    keys = child_cache_keys_create(&data);
+
+    if (keys_prev && psys->childcache && psys->totchildcache == totchild &&
+        child_cache_keys_context_equal(keys_prev, keys) &&
+        child_cache_supports_incremental(&ctx)) {
+      data.keys_prev = keys_prev;
+      data.parents_changed = MEM_malloc_arrayN(
+          MAX2(data.parents_num, 1), sizeof(*data.parents_changed), __func__);
+      data.virtual_parents_changed = MEM_calloc_arrayN(
+          MAX2(totparent, 1), sizeof(*data.virtual_parents_changed), __func__);
+
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 64;
+      BLI_task_parallel_range(
+          0, data.parents_num, &data, child_cache_parent_compare_task, &settings);
+    }
+  }
+
+  if (data.keys_prev ||
+      (editupdate && psys->childcache && totchild == psys->totchildcache)) {
     /* just overwrite the existing cache */
   }
   else {
     /* clear out old and create new empty path cache */
-    free_child_path_cache(sim->psys);
+    psys_free_child_path_cache(psys);
 
-    sim->psys->childcache = psys_alloc_path_cache_buffers(
-        &sim->psys->childcachebufs, totchild, ctx.segments + ctx.extra_segments + 1);
-    sim->psys->totchildcache = totchild;
+    psys->childcache = psys_alloc_path_cache_buffers(
+        &psys->childcachebufs, totchild, ctx.segments + ctx.extra_segments + 1);
+    psys->totchildcache = totchild;
   }
 
+  data.cache = psys->childcache;
+
   /* cache parent paths */
   ctx.parent_pass = 1;
-  psys_tasks_create(&ctx, 0, totparent, &tasks_parent, &numtasks_parent);
-  for (i = 0; i < numtasks_parent; i++) {
-    ParticleTask *task = &tasks_parent[i];
-
-    psys_task_init_path(task, sim);
-    BLI_task_pool_push(task_pool, exec_child_path_cache, task, false, NULL);
-  }
-  BLI_task_pool_work_and_wait(task_pool);
+  child_path_cache_parallel_range(&data, 0, totparent);
 
   /* cache child paths */
   ctx.parent_pass = 0;
-  psys_tasks_create(&ctx, totparent, totchild, &tasks_child, &numtasks_child);
-  for (i = 0; i < numtasks_child; i++) {
-    ParticleTask *task = &tasks_child[i];
+  child_path_cache_parallel_range(&data, totparent, totchild);
 
-    psys_task_init_path(task, sim);
-    BLI_task_pool_push(task_pool, exec_child_path_cache, task, false, NULL);
+  /* The previous keys are either replaced, or out of date after an edit mode update. */
+  psys->childcache_keys = keys;
+  if (keys_prev) {
+    child_cache_keys_free(keys_prev);
   }
-  BLI_task_pool_work_and_wait(task_pool);
-
-  BLI_task_pool_free(task_pool);
-
-  psys_tasks_free(tasks_parent, numtasks_parent);
-  psys_tasks_free(tasks_child, numtasks_child);
+  MEM_SAFE_FREE(data.parents_changed);
+  MEM_SAFE_FREE(data.virtual_parents_changed);
 
   psys_thread_context_free(&ctx);
 }
@@ -3311,8 +3752,12 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
   keyed = psys->flag & PSYS_KEYED;
   baked = psys->pointcache->mem_cache.first && psys->part->type != PART_HAIR;
 
-  /* clear out old and create new empty path cache */
-  psys_free_path_cache(psys, psys->edit);
+  /* Clear out old and create new empty path cache. Child paths are kept, so that
+   * #psys_cache_child_paths can only update the ones whose parents changed. */
+  psys_free_path_cache(NULL, psys->edit);
+  psys_free_path_cache_buffers(psys->pathcache, &psys->pathcachebufs);
+  psys->pathcache = NULL;
+  psys->totcached = 0;
   cache = psys->pathcache = psys_alloc_path_cache_buffers(
       &psys->pathcachebufs, totpart, segments + 1);
 
@@ -5337,6 +5782,7 @@ void BKE_particle_system_blend_read_data(BlendDataReader *reader, ListBase *part
     psys->free_edit = NULL;
     psys->pathcache = NULL;
     psys->childcache = NULL;
+    psys->childcache_keys = NULL;
     BLI_listbase_clear(&psys->pathcachebufs);
     BLI_listbase_clear(&psys->childcachebufs);
     psys->pdd = NULL;
@@ -5366,7 +5812,7 @@ void BKE_particle_system_blend_read_data(BlendDataReader *reader, ListBase *part
     }
 
     psys->tree = NULL;
-    psys->bvhtree = NULL;
+    psys->neighbor_grid = NULL;
 
     psys->orig_psys = NULL;
     psys->batch_cache = NULL;
@@ -876,6 +876,37 @@ static void distribute_invalid(ParticleSimulationData *sim, int from)
   }
 }
 
+typedef struct DistributeFaceAreaData {
+  const Mesh *mesh;
+  const float (*orcodata)[3];
+  /* Texture space of the original mesh, for the orcos. */
+  float orco_loc[3], orco_size[3];
+  float *r_area;
+} DistributeFaceAreaData;
+
+static void distribute_face_area_task(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DistributeFaceAreaData *data = userdata;
+  const MFace *mf = &data->mesh->mface[i];
+  const uint verts[4] = {mf->v1, mf->v2, mf->v3, mf->v4};
+  const int verts_num = mf->v4 ? 4 : 3;
+  float co[4][3];
+
+  for (int j = 0; j < verts_num; j++) {
+    if (data->orcodata) {
+      madd_v3_v3v3v3(co[j], data->orco_loc, data->orcodata[verts[j]], data->orco_size);
+    }
+    else {
+      copy_v3_v3(co[j], data->mesh->mvert[verts[j]].co);
+    }
+  }
+
+  data->r_area[i] = mf->v4 ? area_quad_v3(co[0], co[1], co[2], co[3]) :
+                             area_tri_v3(co[0], co[1], co[2]);
+}
+
 /* Creates a distribution of coordinates on a Mesh */
 static int psys_thread_context_init_distribute(ParticleThreadContext *ctx,
                                                ParticleSimulationData *sim,
@@ -1051,48 +1082,32 @@ static int psys_thread_context_init_distribute(ParticleThreadContext *ctx,
 
   /* Calculate weights from face areas */
   if ((part->flag & PART_EDISTR || children) && from != PART_FROM_VERT) {
-    MVert *v1, *v2, *v3, *v4;
-    float totarea = 0.0f, co1[3], co2[3], co3[3], co4[3];
-    float(*orcodata)[3];
+    float totarea = 0.0f;
+
+    DistributeFaceAreaData data = {
+        .mesh = mesh,
+        .orcodata = CustomData_get_layer(&mesh->vdata, CD_ORCO),
+        .r_area = element_weight,
+    };
+    if (data.orcodata) {
+      /* Transform orcos from normalized 0..1 to object space, the texture space is computed
+       * here so that the tasks only read it. */
+      Mesh *me_orig = ob->data;
+      BKE_mesh_texspace_get(
+          me_orig->texcomesh ? me_orig->texcomesh : me_orig, data.orco_loc, data.orco_size);
+    }
 
-    orcodata = CustomData_get_layer(&mesh->vdata, CD_ORCO);
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, totelem, &data, distribute_face_area_task, &settings);
 
+    /* Summed in order, the distribution doesn't depend on the threads scheduling. */
     for (i = 0; i < totelem; i++) {
-      MFace *mf = &mesh->mface[i];
-
-      if (orcodata) {
-        /* Transform orcos from normalized 0..1 to object space. */
-        copy_v3_v3(co1, orcodata[mf->v1]);
-        copy_v3_v3(co2, orcodata[mf->v2]);
-        copy_v3_v3(co3, orcodata[mf->v3]);
-        BKE_mesh_orco_verts_transform(ob->data, &co1, 1, 1);
-        BKE_mesh_orco_verts_transform(ob->data, &co2, 1, 1);
-        BKE_mesh_orco_verts_transform(ob->data, &co3, 1, 1);
-        if (mf->v4) {
-          copy_v3_v3(co4, orcodata[mf->v4]);
-          BKE_mesh_orco_verts_transform(ob->data, &co4, 1, 1);
-        }
-      }
-      else {
-        v1 = &mesh->mvert[mf->v1];
-        v2 = &mesh->mvert[mf->v2];
-        v3 = &mesh->mvert[mf->v3];
-        copy_v3_v3(co1, v1->co);
-        copy_v3_v3(co2, v2->co);
-        copy_v3_v3(co3, v3->co);
-        if (mf->v4) {
-          v4 = &mesh->mvert[mf->v4];
-          copy_v3_v3(co4, v4->co);
-        }
-      }
-
-      cur = mf->v4 ? area_quad_v3(co1, co2, co3, co4) : area_tri_v3(co1, co2, co3);
-
+      cur = element_weight[i];
       if (cur > maxweight) {
         maxweight = cur;
       }
-
-      element_weight[i] = cur;
       totarea += cur;
     }
 
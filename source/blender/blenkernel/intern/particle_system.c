@@ -91,7 +91,7 @@
 #  include "manta_fluid_API.h"
 #endif  // WITH_FLUID
 
-static ThreadRWMutex psys_bvhtree_rwlock = BLI_RWLOCK_INITIALIZER;
+static ThreadRWMutex psys_neighbor_grid_rwlock = BLI_RWLOCK_INITIALIZER;
 
 /************************************************/
 /*          Reacting to system events           */
@@ -1316,49 +1316,258 @@ void psys_get_pointcache_start_end(Scene *scene, ParticleSystem *psys, int *sfra
 }
 
 /************************************************/
-/*          Effectors                           */
+/*          Neighbor Grid                       */
 /************************************************/
-static void psys_update_particle_bvhtree(ParticleSystem *psys, float cfra)
+
+/* Uniform grid of the alive particles, used for the neighbor searches of fluid particles. The
+ * cells are stored sparsely in a hash table and the particles are sorted by bucket, so the
+ * particles of a cell are contiguous in memory and ordered by index. */
+typedef struct ParticleNeighborGrid {
+  float cell_size_inv;
+  uint bucket_mask;
+
+  /* Particles of each bucket, from bucket_offsets[bucket] to bucket_offsets[bucket + 1]. */
+  uint *bucket_offsets;
+  int *index;
+  float (*co)[3];
+  uint points_num;
+} ParticleNeighborGrid;
+
+/* Keep cell coordinates far from the integer limits, for particles that went very far away. */
+#define NEIGHBOR_GRID_CELL_LIMIT (1 << 30)
+
+BLI_INLINE void neighbor_grid_cell_from_co(const ParticleNeighborGrid *grid,
+                                           const float co[3],
+                                           int r_cell[3])
 {
-  if (psys) {
-    PARTICLE_P;
-    int totpart = 0;
-    bool need_rebuild;
+  for (int k = 0; k < 3; k++) {
+    const float f = floorf(co[k] * grid->cell_size_inv);
+    /* Written so that NaN ends up in the lowest cell. */
+    r_cell[k] = (f > -NEIGHBOR_GRID_CELL_LIMIT) ?
+                    ((f < NEIGHBOR_GRID_CELL_LIMIT) ? (int)f : NEIGHBOR_GRID_CELL_LIMIT) :
+                    -NEIGHBOR_GRID_CELL_LIMIT;
+  }
+}
 
-    BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
-    need_rebuild = !psys->bvhtree || psys->bvhtree_frame != cfra;
-    BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
+BLI_INLINE uint neighbor_grid_bucket(const ParticleNeighborGrid *grid, const int cell[3])
+{
+  return (((uint)cell[0] * 73856093u) ^ ((uint)cell[1] * 19349663u) ^
+          ((uint)cell[2] * 83492791u)) &
+         grid->bucket_mask;
+}
 
-    if (need_rebuild) {
-      LOOP_SHOWN_PARTICLES
-      {
-        totpart++;
-      }
+typedef struct NeighborGridBuildData {
+  const ParticleNeighborGrid *grid;
+  const float (*co)[3];
+  uint *bucket;
+} NeighborGridBuildData;
+
+static void neighbor_grid_bucket_task(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  NeighborGridBuildData *data = userdata;
+  int cell[3];
+  neighbor_grid_cell_from_co(data->grid, data->co[i], cell);
+  data->bucket[i] = neighbor_grid_bucket(data->grid, cell);
+}
+
+static ParticleNeighborGrid *neighbor_grid_build(ParticleSystem *psys,
+                                                 float cfra,
+                                                 float cell_size)
+{
+  PARTICLE_P;
+  uint points_num = 0;
+
+  LOOP_SHOWN_PARTICLES
+  {
+    if (pa->alive == PARS_ALIVE) {
+      points_num++;
+    }
+  }
 
-      BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_WRITE);
+  ParticleNeighborGrid *grid = MEM_callocN(sizeof(*grid), __func__);
+  grid->cell_size_inv = 1.0f / max_ff(cell_size, FLT_EPSILON);
+  grid->points_num = points_num;
 
-      BLI_bvhtree_free(psys->bvhtree);
-      psys->bvhtree = BLI_bvhtree_new(totpart, 0.0, 4, 6);
+  const uint buckets_num = power_of_2_max_u(MAX2(points_num, 1));
+  grid->bucket_mask = buckets_num - 1;
+  grid->bucket_offsets = MEM_calloc_arrayN(
+      buckets_num + 1, sizeof(*grid->bucket_offsets), __func__);
+  grid->index = MEM_malloc_arrayN(MAX2(points_num, 1), sizeof(*grid->index), __func__);
+  grid->co = MEM_malloc_arrayN(MAX2(points_num, 1), sizeof(*grid->co), __func__);
 
-      LOOP_SHOWN_PARTICLES
-      {
-        if (pa->alive == PARS_ALIVE) {
-          if (pa->state.time == cfra) {
-            BLI_bvhtree_insert(psys->bvhtree, p, pa->prev_state.co, 1);
+  if (points_num == 0) {
+    return grid;
+  }
+
+  /* Gather the points in particle order, the buckets are computed in parallel. */
+  int *index = MEM_malloc_arrayN(points_num, sizeof(*index), __func__);
+  float(*co)[3] = MEM_malloc_arrayN(points_num, sizeof(*co), __func__);
+  uint *bucket = MEM_malloc_arrayN(points_num, sizeof(*bucket), __func__);
+  uint i = 0;
+
+  LOOP_SHOWN_PARTICLES
+  {
+    if (pa->alive == PARS_ALIVE) {
+      index[i] = p;
+      copy_v3_v3(co[i], (pa->state.time == cfra) ? pa->prev_state.co : pa->state.co);
+      i++;
+    }
+  }
+
+  NeighborGridBuildData data = {
+      .grid = grid,
+      .co = (const float(*)[3])co,
+      .bucket = bucket,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, (int)points_num, &data, neighbor_grid_bucket_task, &settings);
+
+  /* Counting sort of the points by bucket, keeping them ordered by index in each bucket. */
+  for (i = 0; i < points_num; i++) {
+    grid->bucket_offsets[bucket[i] + 1]++;
+  }
+  for (uint b = 0; b < buckets_num; b++) {
+    grid->bucket_offsets[b + 1] += grid->bucket_offsets[b];
+  }
+  for (i = 0; i < points_num; i++) {
+    const uint dst = grid->bucket_offsets[bucket[i]]++;
+    grid->index[dst] = index[i];
+    copy_v3_v3(grid->co[dst], co[i]);
+  }
+  for (uint b = buckets_num; b > 0; b--) {
+    grid->bucket_offsets[b] = grid->bucket_offsets[b - 1];
+  }
+  grid->bucket_offsets[0] = 0;
+
+  MEM_freeN(index);
+  MEM_freeN(co);
+  MEM_freeN(bucket);
+
+  return grid;
+}
+
+static void neighbor_grid_free(ParticleNeighborGrid *grid)
+{
+  MEM_freeN(grid->bucket_offsets);
+  MEM_freeN(grid->index);
+  MEM_freeN(grid->co);
+  MEM_freeN(grid);
+}
+
+/* Call the callback for every point closer than the radius, same as #BLI_bvhtree_range_query.
+ * Points are visited cell by cell, and by index inside a cell. */
+static void neighbor_grid_range_query(const ParticleNeighborGrid *grid,
+                                      const float co[3],
+                                      float radius,
+                                      BVHTree_RangeQuery callback,
+                                      void *userdata)
+{
+  const float radius_sq = radius * radius;
+  float co_min[3], co_max[3];
+  int cell_min[3], cell_max[3], cell[3];
+
+  copy_v3_v3(co_min, co);
+  copy_v3_v3(co_max, co);
+  add_v3_fl(co_min, -radius);
+  add_v3_fl(co_max, radius);
+  neighbor_grid_cell_from_co(grid, co_min, cell_min);
+  neighbor_grid_cell_from_co(grid, co_max, cell_max);
+
+  /* The cell spans of far away queries don't fit an int, and their product doesn't fit 64 bits,
+   * stop multiplying once it's known to be too large. */
+  const uint64_t buckets_num = (uint64_t)grid->bucket_mask + 1;
+  uint64_t cells_num = 1;
+  for (int k = 0; k < 3 && cells_num <= buckets_num; k++) {
+    cells_num *= (uint64_t)((int64_t)cell_max[k] - (int64_t)cell_min[k] + 1);
+  }
+
+  if (cells_num > buckets_num) {
+    /* The radius spans more cells than there are buckets, test all points instead. */
+    for (uint i = 0; i < grid->points_num; i++) {
+      const float dist_sq = len_squared_v3v3(co, grid->co[i]);
+      if (dist_sq < radius_sq) {
+        callback(userdata, grid->index[i], grid->co[i], dist_sq);
+      }
+    }
+    return;
+  }
+
+  for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+    for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+      for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+        const uint bucket = neighbor_grid_bucket(grid, cell);
+        for (uint i = grid->bucket_offsets[bucket]; i < grid->bucket_offsets[bucket + 1]; i++) {
+          const float dist_sq = len_squared_v3v3(co, grid->co[i]);
+          if (dist_sq >= radius_sq) {
+            continue;
           }
-          else {
-            BLI_bvhtree_insert(psys->bvhtree, p, pa->state.co, 1);
+          /* Other cells of the query may share the bucket, only report the point once. */
+          int point_cell[3];
+          neighbor_grid_cell_from_co(grid, grid->co[i], point_cell);
+          if (!equals_v3v3_int(point_cell, cell)) {
+            continue;
           }
+          callback(userdata, grid->index[i], grid->co[i], dist_sq);
         }
       }
-      BLI_bvhtree_balance(psys->bvhtree);
+    }
+  }
+}
 
-      psys->bvhtree_frame = cfra;
+/* Rebuild the neighbor grid of fluid particles once per frame. The cell size is only a
+ * performance setting, queries with any radius are supported. */
+void psys_update_particle_neighbor_grid(ParticleSystem *psys, float cfra, float cell_size)
+{
+  if (psys) {
+    bool need_rebuild;
 
-      BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
+    BLI_rw_mutex_lock(&psys_neighbor_grid_rwlock, THREAD_LOCK_READ);
+    need_rebuild = !psys->neighbor_grid || psys->neighbor_grid_frame != cfra;
+    BLI_rw_mutex_unlock(&psys_neighbor_grid_rwlock);
+
+    if (need_rebuild) {
+      BLI_rw_mutex_lock(&psys_neighbor_grid_rwlock, THREAD_LOCK_WRITE);
+
+      if (psys->neighbor_grid) {
+        neighbor_grid_free(psys->neighbor_grid);
+      }
+      psys->neighbor_grid = neighbor_grid_build(psys, cfra, cell_size);
+      psys->neighbor_grid_frame = cfra;
+
+      BLI_rw_mutex_unlock(&psys_neighbor_grid_rwlock);
     }
   }
 }
+
+/* Call the callback for every alive particle closer than the radius, in the grid built by
+ * #psys_update_particle_neighbor_grid. The grid must not be rebuilt meanwhile. */
+void psys_neighbor_grid_range_query(const ParticleSystem *psys,
+                                    const float co[3],
+                                    float radius,
+                                    BVHTree_RangeQuery callback,
+                                    void *userdata)
+{
+  if (psys->neighbor_grid) {
+    neighbor_grid_range_query(psys->neighbor_grid, co, radius, callback, userdata);
+  }
+}
+
+void psys_free_neighbor_grid(ParticleSystem *psys)
+{
+  if (psys->neighbor_grid) {
+    neighbor_grid_free(psys->neighbor_grid);
+    psys->neighbor_grid = NULL;
+  }
+}
+
+/************************************************/
+/*          Effectors                           */
+/************************************************/
 void psys_update_particle_tree(ParticleSystem *psys, float cfra)
 {
   if (psys) {
@@ -1708,11 +1917,11 @@ static void sph_evaluate_func(BVHTree *tree,
       break;
     }
 
-    BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
+    BLI_rw_mutex_lock(&psys_neighbor_grid_rwlock, THREAD_LOCK_READ);
 
-    BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
+    psys_neighbor_grid_range_query(psys[i], co, interaction_radius, callback, pfr);
 
-    BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
+    BLI_rw_mutex_unlock(&psys_neighbor_grid_rwlock);
   }
 }
 static void sph_density_accum_cb(void *userdata, int index, const float co[3], float squared_dist)
@@ -3256,6 +3465,13 @@ static void psys_update_path_cache(ParticleSimulationData *sim,
         psys_cache_child_paths(sim, cfra, 0, use_render_params);
       }
     }
+    else {
+      skip = 1;
+    }
+
+    if (skip) {
+      psys_free_child_path_cache(psys);
+    }
   }
   else if (psys->pathcache) {
     psys_free_path_cache(psys, NULL);
@@ -3880,12 +4096,17 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
     }
     case PART_PHYS_FLUID: {
       ParticleTarget *pt = psys->targets.first;
-      psys_update_particle_bvhtree(psys, cfra);
+      SPHFluidSettings *fluid = part->fluid;
+      /* Same as the interaction radius of the fluid solvers, for the largest particles. */
+      const float cell_size = fluid->radius *
+                              (fluid->flag & SPH_FAC_RADIUS ? 4.0f * part->size : 1.0f);
+      psys_update_particle_neighbor_grid(psys, cfra, cell_size);
 
       for (; pt;
-           pt = pt->next) { /* Updating others systems particle tree for fluid-fluid interaction */
+           pt = pt->next) { /* Updating others systems particle grid for fluid-fluid interaction */
         if (pt->ob) {
-          psys_update_particle_bvhtree(BLI_findlink(&pt->ob->particlesystem, pt->psys - 1), cfra);
+          psys_update_particle_neighbor_grid(
+              BLI_findlink(&pt->ob->particlesystem, pt->psys - 1), cfra, cell_size);
         }
       }
       break;
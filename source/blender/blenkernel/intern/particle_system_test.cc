@@ -0,0 +1,165 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "DNA_particle_types.h"
+
+#include "BKE_particle.h"
+
+namespace blender::bke::tests {
+
+using Neighbor = std::pair<int, float>;
+
+/* Alive particles at random positions in the unit cube, as seen by the fluid solver at the
+ * start of a frame. */
+class ParticleNeighborGridTest : public testing::Test {
+ protected:
+  static constexpr int particles_num = 2000;
+  static constexpr float cfra = 1.0f;
+  static constexpr float cell_size = 0.05f;
+
+  ParticleSystem psys = {};
+
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_threadapi_exit();
+  }
+
+  void SetUp() override
+  {
+    psys.totpart = particles_num;
+    psys.particles = static_cast<ParticleData *>(
+        MEM_calloc_arrayN(particles_num, sizeof(ParticleData), __func__));
+
+    RNG *rng = BLI_rng_new(0);
+    for (int p = 0; p < particles_num; p++) {
+      ParticleData *pa = &psys.particles[p];
+      pa->alive = PARS_ALIVE;
+      BLI_rng_get_float_unit_v3(rng, pa->state.co);
+      mul_v3_fl(pa->state.co, BLI_rng_get_float(rng));
+    }
+    BLI_rng_free(rng);
+
+    /* Dead and hidden particles are not in the grid. */
+    psys.particles[1].alive = PARS_DEAD;
+    psys.particles[2].flag |= PARS_NO_DISP;
+  }
+
+  void TearDown() override
+  {
+    psys_free_neighbor_grid(&psys);
+    MEM_freeN(psys.particles);
+  }
+
+  static void neighbor_add_cb(void *userdata, int index, const float UNUSED(co[3]), float dist_sq)
+  {
+    static_cast<std::vector<Neighbor> *>(userdata)->emplace_back(index, dist_sq);
+  }
+
+  std::vector<Neighbor> neighbors_find(const float co[3], const float radius) const
+  {
+    std::vector<Neighbor> neighbors;
+    psys_neighbor_grid_range_query(&psys, co, radius, neighbor_add_cb, &neighbors);
+
+    /* Each particle is found once. */
+    std::sort(neighbors.begin(), neighbors.end());
+    EXPECT_EQ(std::adjacent_find(neighbors.begin(),
+                                 neighbors.end(),
+                                 [](const Neighbor &a, const Neighbor &b) {
+                                   return a.first == b.first;
+                                 }),
+              neighbors.end());
+    return neighbors;
+  }
+
+  std::vector<Neighbor> neighbors_brute_force(const float co[3], const float radius) const
+  {
+    std::vector<Neighbor> neighbors;
+    for (int p = 0; p < particles_num; p++) {
+      const ParticleData *pa = &psys.particles[p];
+      if (pa->alive != PARS_ALIVE || (pa->flag & (PARS_UNEXIST | PARS_NO_DISP))) {
+        continue;
+      }
+      const float dist_sq = len_squared_v3v3(co, pa->state.co);
+      if (dist_sq < radius * radius) {
+        neighbors.emplace_back(p, dist_sq);
+      }
+    }
+    return neighbors;
+  }
+
+  void expect_neighbors_match(const float co[3], const float radius) const
+  {
+    EXPECT_EQ(neighbors_find(co, radius), neighbors_brute_force(co, radius));
+  }
+};
+
+TEST_F(ParticleNeighborGridTest, range_query)
+{
+  psys_update_particle_neighbor_grid(&psys, cfra, cell_size);
+
+  /* Radii smaller and larger than a cell, and one spanning more cells than there are buckets. */
+  for (const float radius : {0.01f, 0.05f, 0.2f, 10.0f}) {
+    for (int p = 0; p < particles_num; p += 97) {
+      expect_neighbors_match(psys.particles[p].state.co, radius);
+    }
+  }
+  const float center[3] = {0.0f, 0.0f, 0.0f};
+  EXPECT_EQ(neighbors_find(center, 10.0f).size(), size_t(particles_num - 2));
+}
+
+/* Particles updated in the current frame are looked up at their previous position. */
+TEST_F(ParticleNeighborGridTest, range_query_previous_state)
+{
+  for (int p = 0; p < particles_num; p++) {
+    ParticleData *pa = &psys.particles[p];
+    pa->state.time = cfra;
+    copy_v3_v3(pa->prev_state.co, pa->state.co);
+    add_v3_fl(pa->state.co, 100.0f);
+  }
+  psys_update_particle_neighbor_grid(&psys, cfra, cell_size);
+
+  for (int p = 0; p < particles_num; p += 97) {
+    std::vector<Neighbor> neighbors;
+    psys_neighbor_grid_range_query(
+        &psys, psys.particles[p].prev_state.co, 0.1f, neighbor_add_cb, &neighbors);
+    EXPECT_FALSE(neighbors.empty());
+  }
+}
+
+/* Particles far away or with non-finite positions end up in the cells at the limits, queries
+ * spanning all of them must not overflow. */
+TEST_F(ParticleNeighborGridTest, range_query_far_away)
+{
+  copy_v3_fl(psys.particles[10].state.co, 1e20f);
+  copy_v3_fl(psys.particles[11].state.co, -1e20f);
+  psys.particles[12].state.co[0] = std::numeric_limits<float>::quiet_NaN();
+  psys.particles[13].state.co[1] = std::numeric_limits<float>::infinity();
+  psys_update_particle_neighbor_grid(&psys, cfra, cell_size);
+
+  for (const float radius : {0.05f, 1e10f, 1e21f}) {
+    for (int p = 0; p < particles_num; p += 97) {
+      expect_neighbors_match(psys.particles[p].state.co, radius);
+    }
+    expect_neighbors_match(psys.particles[10].state.co, radius);
+    expect_neighbors_match(psys.particles[11].state.co, radius);
+  }
+}
+
+}  // namespace blender::bke::tests
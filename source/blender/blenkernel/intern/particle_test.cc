@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_string.h"
+
+#include "DNA_color_types.h"
+#include "DNA_particle_types.h"
+
+#include "BKE_colortools.h"
+#include "BKE_particle.h"
+
+namespace blender::bke::tests {
+
+static ParticleSettings child_path_settings_create()
+{
+  ParticleSettings part = {};
+  part.type = PART_HAIR;
+  part.childtype = PART_CHILD_FACES;
+  part.parents = 0.5f;
+  part.childrad = 0.2f;
+  part.clumpfac = 0.5f;
+  part.kink = PART_KINK_CURL;
+  part.kink_amp = 0.1f;
+  return part;
+}
+
+TEST(particle, child_path_settings_equal)
+{
+  const ParticleSettings part_a = child_path_settings_create();
+  ParticleSettings part_b = part_a;
+  EXPECT_TRUE(psys_child_path_settings_equal(&part_a, &part_b));
+
+  /* Settings the child paths don't read. */
+  BLI_strncpy(part_b.id.name, "PAOther", sizeof(part_b.id.name));
+  part_b.id.recalc = ID_RECALC_PSYS_REDO;
+  part_b.draw_size = 2.0f;
+  part_b.totpart = 100;
+  EXPECT_TRUE(psys_child_path_settings_equal(&part_a, &part_b));
+
+  part_b.kink_amp = 0.2f;
+  EXPECT_FALSE(psys_child_path_settings_equal(&part_a, &part_b));
+  part_b.kink_amp = part_a.kink_amp;
+
+  part_b.child_flag |= PART_CHILD_USE_TWIST_CURVE;
+  EXPECT_FALSE(psys_child_path_settings_equal(&part_a, &part_b));
+}
+
+TEST(particle, child_path_settings_equal_curves)
+{
+  ParticleSettings part_a = child_path_settings_create();
+  ParticleSettings part_b = part_a;
+  part_a.clumpcurve = BKE_curvemapping_add(1, 0.0f, 0.0f, 1.0f, 1.0f);
+  part_b.clumpcurve = BKE_curvemapping_copy(part_a.clumpcurve);
+  CurveMapPoint *point_b = &part_b.clumpcurve->cm[0].curve[1];
+
+  /* Curves are only compared when in use. */
+  point_b->y = 0.5f;
+  EXPECT_TRUE(psys_child_path_settings_equal(&part_a, &part_b));
+
+  part_a.child_flag |= PART_CHILD_USE_CLUMP_CURVE;
+  part_b.child_flag |= PART_CHILD_USE_CLUMP_CURVE;
+  EXPECT_FALSE(psys_child_path_settings_equal(&part_a, &part_b));
+
+  /* Evaluation tables are not compared. */
+  point_b->y = part_a.clumpcurve->cm[0].curve[1].y;
+  BKE_curvemapping_init(part_b.clumpcurve);
+  EXPECT_TRUE(psys_child_path_settings_equal(&part_a, &part_b));
+
+  BKE_curvemapping_free(part_a.clumpcurve);
+  BKE_curvemapping_free(part_b.clumpcurve);
+}
+
+}  // namespace blender::bke::tests
@@ -45,12 +45,16 @@
 
 #include "atomic_ops.h"
 
+#include "CLG_log.h"
+
 #include "pbvh_intern.h"
 
 #include <limits.h>
 
 #define LEAF_LIMIT 10000
 
+static CLG_LogRef LOG = {"bke.pbvh"};
+
 //#define PERFCNTRS
 
 #define STACK_FIXED_DEPTH 100
@@ -250,18 +254,35 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
   pbvh->totnode = totnode;
 }
 
+/* Claim a vertex for the leaf node, the leaf with the lowest index using a vertex owns it.
+ * Leaves are built in parallel, this keeps the result independent of the order they run in. */
+static void vert_owner_claim(int *vert_owner, int vertex, int node_index)
+{
+  int owner = vert_owner[vertex];
+  while (node_index < owner) {
+    const int owner_prev = atomic_cas_int32(&vert_owner[vertex], owner, node_index);
+    if (owner_prev == owner) {
+      break;
+    }
+    owner = owner_prev;
+  }
+}
+
 /* Add a vertex to the map, with a positive value for unique vertices and
  * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+static int map_insert_vert(PBVH *pbvh,
+                           GHash *map,
+                           unsigned int *face_verts,
+                           unsigned int *uniq_verts,
+                           int vertex,
+                           int node_index)
 {
   void *key, **value_p;
 
   key = POINTER_FROM_INT(vertex);
   if (!BLI_ghash_ensure_p(map, key, &value_p)) {
     int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
+    if (pbvh->vert_owner[vertex] == node_index) {
       value_i = *uniq_verts;
       (*uniq_verts)++;
     }
@@ -277,7 +298,7 @@ static int map_insert_vert(
 }
 
 /* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, int node_index)
 {
   bool has_visible = false;
 
@@ -298,8 +319,12 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      face_vert_indices[i][j] = map_insert_vert(pbvh,
+                                                map,
+                                                &node->face_verts,
+                                                &node->uniq_verts,
+                                                pbvh->mloop[lt->tri[j]].v,
+                                                node_index);
     }
 
     if (has_visible == false) {
@@ -343,15 +368,6 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   BLI_ghash_free(map, NULL, NULL);
 }
 
-static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
-{
-  BB_reset(&node->vb);
-  for (int i = offset + count - 1; i >= offset; i--) {
-    BB_expand_with_bb(&node->vb, (BB *)(&prim_bbc[pbvh->prim_indices[i]]));
-  }
-  node->orig_vb = node->vb;
-}
-
 /* Returns the number of visible quads in the nodes' grids. */
 int BKE_pbvh_count_grid_quads(BLI_bitmap **grid_hidden,
                               const int *grid_indices,
@@ -413,24 +429,6 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
-{
-  pbvh->nodes[node_index].flag |= PBVH_Leaf;
-
-  pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
-  pbvh->nodes[node_index].totprim = count;
-
-  /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
-  if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-  else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-}
-
 /* Return zero if all primitives in the node can be drawn with the
  * same material (including flat/smooth shading), non-zero otherwise */
 static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
@@ -465,79 +463,398 @@ static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
   return false;
 }
 
-/* Recursively build a node in the tree
- *
- * vb is the voxel box around all of the primitives contained in
- * this node.
+/* -------------------------------------------------------------------- */
+/** \name Tree Construction
  *
- * cb is the bounding box around all the centroids of the primitives
- * contained in this node
+ * Subtrees with enough primitives are split in separate tasks, each building its nodes in a
+ * local array. The arrays are merged depth first once all tasks are done, so the node layout
+ * only depends on the split decisions and not on the order the tasks ran in.
+ * Leaf nodes and node bounds are computed afterwards, in parallel over the final nodes.
+ * \{ */
+
+/* Subtrees with fewer primitives than this factor times the leaf limit are built by the task
+ * which split their parent. */
+#define BUILD_TASK_LEAF_FACTOR 8
+
+/* Number of buckets used to evaluate split candidates with the surface area heuristic. */
+#define BUILD_SAH_BINS 16
+
+/* Value of #PBVHBuildNode.children_offset for leaf nodes. */
+#define BUILD_NODE_LEAF -1
+
+typedef struct PBVHBuildNode {
+  int prim_offset, prim_count;
+  /* Index of the first child in the subtree's node array, or #BUILD_NODE_LEAF. */
+  int children_offset;
+  /* Set when the node is the root of a subtree built by another task. */
+  struct PBVHBuildSubtree *subtree;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildSubtree {
+  /* The subtree root is the first node. */
+  PBVHBuildNode *nodes;
+  int totnode, node_mem_count;
+} PBVHBuildSubtree;
+
+typedef struct PBVHBuildContext {
+  PBVH *pbvh;
+  const BBC *prim_bbc;
+  TaskPool *task_pool;
+  bool use_sah;
+} PBVHBuildContext;
+
+static float BB_surface_area(const BB *bb)
+{
+  float dim[3];
+  sub_v3_v3v3(dim, bb->bmax, bb->bmin);
+  return 2.0f * (dim[0] * dim[1] + dim[1] * dim[2] + dim[2] * dim[0]);
+}
+
+static int build_subtree_node_add(PBVHBuildSubtree *subtree, int prim_offset, int prim_count)
+{
+  if (subtree->totnode == subtree->node_mem_count) {
+    subtree->node_mem_count = max_ii(subtree->node_mem_count * 2, 64);
+    subtree->nodes = MEM_reallocN(subtree->nodes,
+                                  sizeof(*subtree->nodes) * subtree->node_mem_count);
+  }
+  PBVHBuildNode *node = &subtree->nodes[subtree->totnode];
+  node->prim_offset = prim_offset;
+  node->prim_count = prim_count;
+  node->children_offset = BUILD_NODE_LEAF;
+  node->subtree = NULL;
+  return subtree->totnode++;
+}
+
+/**
+ * Find the split plane with the lowest surface area heuristic cost, binning the primitives by
+ * their centroids along each axis.
  *
- * offset and start indicate a range in the array of primitive indices
+ * \return false when the centroids are all at the same location.
  */
+static bool build_sah_split_find(const PBVHBuildContext *ctx,
+                                 const BB *cb,
+                                 int offset,
+                                 int count,
+                                 int *r_axis,
+                                 float *r_mid)
+{
+  const int *prim_indices = ctx->pbvh->prim_indices;
+  float cost_best = FLT_MAX;
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = cb->bmax[axis] - cb->bmin[axis];
+    if (!(extent > 0.0f)) {
+      continue;
+    }
+    const float scale = BUILD_SAH_BINS / extent;
+
+    BB bins_bb[BUILD_SAH_BINS];
+    int bins_count[BUILD_SAH_BINS] = {0};
+    for (int b = 0; b < BUILD_SAH_BINS; b++) {
+      BB_reset(&bins_bb[b]);
+    }
+    for (int i = offset; i < offset + count; i++) {
+      const BBC *bbc = &ctx->prim_bbc[prim_indices[i]];
+      const int b = min_ii((int)((bbc->bcentroid[axis] - cb->bmin[axis]) * scale),
+                           BUILD_SAH_BINS - 1);
+      bins_count[b]++;
+      BB_expand_with_bb(&bins_bb[b], (BB *)bbc);
+    }
+
+    /* Area and primitive count on the right side of the split after each bin. */
+    float right_area[BUILD_SAH_BINS - 1];
+    int right_count[BUILD_SAH_BINS - 1];
+    BB right_bb;
+    BB_reset(&right_bb);
+    int right_total = 0;
+    for (int b = BUILD_SAH_BINS - 1; b > 0; b--) {
+      BB_expand_with_bb(&right_bb, &bins_bb[b]);
+      right_total += bins_count[b];
+      right_area[b - 1] = right_total ? BB_surface_area(&right_bb) : 0.0f;
+      right_count[b - 1] = right_total;
+    }
+
+    BB left_bb;
+    BB_reset(&left_bb);
+    int left_total = 0;
+    for (int b = 0; b < BUILD_SAH_BINS - 1; b++) {
+      BB_expand_with_bb(&left_bb, &bins_bb[b]);
+      left_total += bins_count[b];
+      if (left_total == 0 || right_count[b] == 0) {
+        continue;
+      }
+      const float cost = BB_surface_area(&left_bb) * left_total + right_area[b] * right_count[b];
+      if (cost < cost_best) {
+        cost_best = cost;
+        *r_axis = axis;
+        *r_mid = cb->bmin[axis] + (b + 1) / scale;
+      }
+    }
+  }
+
+  return cost_best != FLT_MAX;
+}
 
-static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int offset, int count)
+/* Split the primitives of a node in two, returns the index of the first primitive on the right. */
+static int build_split(const PBVHBuildContext *ctx, const BB *cb, int offset, int count)
 {
-  int end;
+  PBVH *pbvh = ctx->pbvh;
+
+  /* Find axis with widest range of primitive centroids */
   BB cb_backing;
+  if (!cb) {
+    cb = &cb_backing;
+    BB_reset(&cb_backing);
+    for (int i = offset + count - 1; i >= offset; i--) {
+      BB_expand(&cb_backing, ctx->prim_bbc[pbvh->prim_indices[i]].bcentroid);
+    }
+  }
+
+  int axis;
+  float mid;
+  if (ctx->use_sah && build_sah_split_find(ctx, cb, offset, count, &axis, &mid)) {
+    const int end = partition_indices(
+        pbvh->prim_indices, offset, offset + count - 1, axis, mid, (BBC *)ctx->prim_bbc);
+    if (end > offset && end < offset + count) {
+      return end;
+    }
+  }
+
+  /* Partition primitives along the middle of the widest axis. */
+  axis = BB_widest_axis(cb);
+  mid = (cb->bmax[axis] + cb->bmin[axis]) * 0.5f;
+  return partition_indices(
+      pbvh->prim_indices, offset, offset + count - 1, axis, mid, (BBC *)ctx->prim_bbc);
+}
+
+static void build_subtree_task(TaskPool *__restrict pool, void *taskdata);
+
+static void build_sub(PBVHBuildContext *ctx,
+                      PBVHBuildSubtree *subtree,
+                      int node_index,
+                      const BB *cb);
+
+static void build_child(PBVHBuildContext *ctx,
+                        PBVHBuildSubtree *subtree,
+                        int node_index,
+                        int offset,
+                        int count)
+{
+  if (count > ctx->pbvh->leaf_limit * BUILD_TASK_LEAF_FACTOR) {
+    PBVHBuildSubtree *child = MEM_callocN(sizeof(*child), __func__);
+    build_subtree_node_add(child, offset, count);
+    subtree->nodes[node_index].subtree = child;
+    BLI_task_pool_push(ctx->task_pool, build_subtree_task, child, false, NULL);
+  }
+  else {
+    build_sub(ctx, subtree, node_index, NULL);
+  }
+}
+
+/* Recursively build a node in the tree
+ *
+ * cb is the bounding box around all the centroids of the primitives
+ * contained in this node, computed when NULL.
+ *
+ * The primitives of the node are given by its offset and count in the array of primitive
+ * indices, which are reordered so each child gets a contiguous range.
+ */
+static void build_sub(PBVHBuildContext *ctx,
+                      PBVHBuildSubtree *subtree,
+                      int node_index,
+                      const BB *cb)
+{
+  PBVH *pbvh = ctx->pbvh;
+  const int offset = subtree->nodes[node_index].prim_offset;
+  const int count = subtree->nodes[node_index].prim_count;
+  int end;
 
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = count <= pbvh->leaf_limit;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(pbvh, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
       return;
     }
+    /* Partition primitives by material */
+    end = partition_indices_material(pbvh, offset, offset + count - 1);
+  }
+  else {
+    end = build_split(ctx, cb, offset, count);
+  }
+
+  /* Add two child nodes, this may reallocate the node array. */
+  const int children_offset = build_subtree_node_add(subtree, offset, end - offset);
+  build_subtree_node_add(subtree, end, offset + count - end);
+  subtree->nodes[node_index].children_offset = children_offset;
+
+  /* Build children */
+  build_child(ctx, subtree, children_offset, offset, end - offset);
+  build_child(ctx, subtree, children_offset + 1, end, offset + count - end);
+}
+
+static void build_subtree_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PBVHBuildContext *ctx = BLI_task_pool_user_data(pool);
+  build_sub(ctx, (PBVHBuildSubtree *)taskdata, 0, NULL);
+}
+
+/* Number of nodes in a subtree, including the ones built by other tasks. */
+static int build_subtree_totnode(const PBVHBuildSubtree *subtree)
+{
+  int totnode = subtree->totnode;
+  for (int i = 0; i < subtree->totnode; i++) {
+    if (subtree->nodes[i].subtree) {
+      /* The root of the child subtree replaces the node it was split from. */
+      totnode += build_subtree_totnode(subtree->nodes[i].subtree) - 1;
+    }
   }
+  return totnode;
+}
 
-  /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+/* Copy the nodes of a subtree into the PBVH, its root going to the node at \a root_index and the
+ * other nodes being appended. Children always end up after their parent. */
+static void build_subtree_merge(PBVH *pbvh, PBVHBuildSubtree *subtree, int root_index)
+{
+  const int base = pbvh->totnode - 1;
+  pbvh->totnode += subtree->totnode - 1;
 
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
+  for (int i = 0; i < subtree->totnode; i++) {
+    const PBVHBuildNode *build_node = &subtree->nodes[i];
+    if (build_node->subtree) {
+      continue;
+    }
+    PBVHNode *node = &pbvh->nodes[(i == 0) ? root_index : base + i];
+    if (build_node->children_offset == BUILD_NODE_LEAF) {
+      node->flag |= PBVH_Leaf;
+      node->prim_indices = pbvh->prim_indices + build_node->prim_offset;
+      node->totprim = build_node->prim_count;
+    }
+    else {
+      node->children_offset = base + build_node->children_offset;
+    }
+  }
 
-  if (!below_leaf_limit) {
-    /* Find axis with widest range of primitive centroids */
-    if (!cb) {
-      cb = &cb_backing;
-      BB_reset(cb);
-      for (int i = offset + count - 1; i >= offset; i--) {
-        BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
+  for (int i = 0; i < subtree->totnode; i++) {
+    PBVHBuildSubtree *child = subtree->nodes[i].subtree;
+    if (child) {
+      build_subtree_merge(pbvh, child, base + i);
+    }
+  }
+
+  MEM_freeN(subtree->nodes);
+  MEM_freeN(subtree);
+}
+
+typedef struct PBVHBuildLeafData {
+  PBVH *pbvh;
+  const BBC *prim_bbc;
+} PBVHBuildLeafData;
+
+static void build_leaf_claim_verts_task_cb(void *__restrict userdata,
+                                           const int n,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeafData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = &pbvh->nodes[n];
+
+  if (node->flag & PBVH_Leaf) {
+    for (int i = 0; i < node->totprim; i++) {
+      const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+      for (int j = 0; j < 3; j++) {
+        vert_owner_claim(pbvh->vert_owner, pbvh->mloop[lt->tri[j]].v, n);
       }
     }
-    const int axis = BB_widest_axis(cb);
+  }
+}
+
+static void build_leaf_task_cb(void *__restrict userdata,
+                               const int n,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeafData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = &pbvh->nodes[n];
+
+  if (!(node->flag & PBVH_Leaf)) {
+    return;
+  }
 
-    /* Partition primitives along that axis */
-    end = partition_indices(pbvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+  /* Still need vb for searches */
+  BB_reset(&node->vb);
+  for (int i = 0; i < node->totprim; i++) {
+    BB_expand_with_bb(&node->vb, (BB *)&data->prim_bbc[node->prim_indices[i]]);
+  }
+  node->orig_vb = node->vb;
+
+  if (pbvh->looptri) {
+    build_mesh_leaf_node(pbvh, node, n);
   }
   else {
-    /* Partition primitives by material */
-    end = partition_indices_material(pbvh, offset, offset + count - 1);
+    build_grid_leaf_node(pbvh, node);
   }
+}
 
-  /* Build children */
-  build_sub(pbvh, pbvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(pbvh,
-            pbvh->nodes[node_index].children_offset + 1,
-            NULL,
-            prim_bbc,
-            end,
-            offset + count - end);
+static void pbvh_build_stats_calc(PBVH *pbvh)
+{
+  PBVHBuildStats *stats = &pbvh->build_stats;
+  int *depth = MEM_mallocN(sizeof(*depth) * pbvh->totnode, __func__);
+  const float root_area = BB_surface_area(&pbvh->nodes[0].vb);
+
+  stats->totnode = pbvh->totnode;
+  stats->totleaf = 0;
+  stats->max_depth = 0;
+  stats->leaf_prims_min = INT_MAX;
+  stats->leaf_prims_max = 0;
+  stats->sah_cost = 0.0f;
+
+  depth[0] = 0;
+  for (int i = 0; i < pbvh->totnode; i++) {
+    const PBVHNode *node = &pbvh->nodes[i];
+    const float area = (root_area > 0.0f) ? BB_surface_area(&node->vb) / root_area : 1.0f;
+    stats->max_depth = max_ii(stats->max_depth, depth[i]);
+
+    if (node->flag & PBVH_Leaf) {
+      stats->totleaf++;
+      stats->leaf_prims_min = min_ii(stats->leaf_prims_min, node->totprim);
+      stats->leaf_prims_max = max_ii(stats->leaf_prims_max, node->totprim);
+      stats->sah_cost += area * node->totprim;
+    }
+    else {
+      depth[node->children_offset] = depth[node->children_offset + 1] = depth[i] + 1;
+      stats->sah_cost += area;
+    }
+  }
+  stats->leaf_prims_avg = (float)pbvh->totprim / stats->totleaf;
+
+  MEM_freeN(depth);
+}
+
+static void pbvh_build_stats_report(PBVH *pbvh, const double build_time)
+{
+  PBVHBuildStats *stats = &pbvh->build_stats;
+  stats->build_time = build_time;
+
+  CLOG_INFO(&LOG,
+            1,
+            "%s split, %d primitives in %.4fs: %d nodes, %d leaves, depth %d, "
+            "leaf primitives %d/%.1f/%d (min/avg/max), SAH cost %.1f",
+            pbvh->use_sah_split ? "SAH" : "median",
+            pbvh->totprim,
+            stats->build_time,
+            stats->totnode,
+            stats->totleaf,
+            stats->max_depth,
+            stats->leaf_prims_min,
+            stats->leaf_prims_avg,
+            stats->leaf_prims_max,
+            stats->sah_cost);
 }
 
 static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
 {
   if (totprim != pbvh->totprim) {
     pbvh->totprim = totprim;
-    if (pbvh->nodes) {
-      MEM_freeN(pbvh->nodes);
-    }
     if (pbvh->prim_indices) {
       MEM_freeN(pbvh->prim_indices);
     }
@@ -545,17 +862,135 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     for (int i = 0; i < totprim; i++) {
       pbvh->prim_indices[i] = i;
     }
-    pbvh->totnode = 0;
-    if (pbvh->node_mem_count < 100) {
-      pbvh->node_mem_count = 100;
-      pbvh->nodes = MEM_callocN(sizeof(PBVHNode) * pbvh->node_mem_count, "bvh initial nodes");
-    }
   }
+  PBVHBuildContext ctx = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+      .use_sah = pbvh->use_sah_split,
+  };
+
+  /* Split the primitives into a tree of subtrees. */
+  PBVHBuildSubtree *root = MEM_callocN(sizeof(*root), __func__);
+  build_subtree_node_add(root, 0, totprim);
+  ctx.task_pool = BLI_task_pool_create(&ctx, TASK_PRIORITY_HIGH);
+  build_sub(&ctx, root, 0, cb);
+  BLI_task_pool_work_and_wait(ctx.task_pool);
+  BLI_task_pool_free(ctx.task_pool);
 
+  if (pbvh->nodes) {
+    MEM_freeN(pbvh->nodes);
+  }
+  pbvh->node_mem_count = build_subtree_totnode(root);
+  pbvh->nodes = MEM_callocN(sizeof(PBVHNode) * pbvh->node_mem_count, "bvh nodes");
   pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_subtree_merge(pbvh, root, 0);
+  BLI_assert(pbvh->totnode == pbvh->node_mem_count);
+
+  /* Build the leaves, mesh vertices shared between leaves are owned by the first one. */
+  PBVHBuildLeafData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, pbvh->totnode);
+  if (pbvh->looptri) {
+    pbvh->vert_owner = MEM_malloc_arrayN(pbvh->totvert, sizeof(int), __func__);
+    copy_vn_i(pbvh->vert_owner, pbvh->totvert, INT_MAX);
+    BLI_task_parallel_range(0, pbvh->totnode, &data, build_leaf_claim_verts_task_cb, &settings);
+  }
+  BLI_task_parallel_range(0, pbvh->totnode, &data, build_leaf_task_cb, &settings);
+  MEM_SAFE_FREE(pbvh->vert_owner);
+
+  /* Bounds of the inner nodes, children are always stored after their parent. */
+  for (int i = pbvh->totnode - 1; i >= 0; i--) {
+    PBVHNode *node = &pbvh->nodes[i];
+    if (!(node->flag & PBVH_Leaf)) {
+      node->vb = pbvh->nodes[node->children_offset].vb;
+      BB_expand_with_bb(&node->vb, &pbvh->nodes[node->children_offset + 1].vb);
+      node->orig_vb = node->vb;
+    }
+  }
+
+  pbvh_build_stats_calc(pbvh);
 }
 
+typedef struct PBVHBuildPrimData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildPrimData;
+
+static void build_prim_bbc_reduce(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_join,
+                                  void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+static void build_prim_bbc_looptri_task_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildPrimData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const MLoopTri *lt = &pbvh->looptri[i];
+  BBC *bbc = &data->prim_bbc[i];
+
+  BB_reset((BB *)bbc);
+  for (int j = 0; j < 3; j++) {
+    BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+  }
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void build_prim_bbc_grid_task_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildPrimData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const CCGKey *key = &pbvh->gridkey;
+  CCGElem *grid = pbvh->grids[i];
+  BBC *bbc = &data->prim_bbc[i];
+
+  BB_reset((BB *)bbc);
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+/* For each primitive, store the AABB and the AABB centroid,
+ * the bounds of all centroids are returned in \a r_cb. */
+static BBC *build_prim_bbc_calc(PBVH *pbvh, int totprim, BB *r_cb)
+{
+  PBVHBuildPrimData data = {
+      .pbvh = pbvh,
+      .prim_bbc = MEM_mallocN(sizeof(BBC) * totprim, "prim_bbc"),
+  };
+
+  BB_reset(r_cb);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = r_cb;
+  settings.userdata_chunk_size = sizeof(*r_cb);
+  settings.func_reduce = build_prim_bbc_reduce;
+  BLI_task_parallel_range(0,
+                          totprim,
+                          &data,
+                          pbvh->looptri ? build_prim_bbc_looptri_task_cb :
+                                          build_prim_bbc_grid_task_cb,
+                          &settings);
+
+  return data.prim_bbc;
+}
+
+/** \} */
+
 /**
  * Do a full rebuild with on Mesh data structure.
  *
@@ -574,8 +1009,7 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          const MLoopTri *looptri,
                          int looptri_num)
 {
-  BBC *prim_bbc = NULL;
-  BB cb;
+  const double time_start = PIL_check_seconds_timer();
 
   pbvh->mesh = mesh;
   pbvh->type = PBVH_FACES;
@@ -583,7 +1017,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->mloop = mloop;
   pbvh->looptri = looptri;
   pbvh->verts = verts;
-  pbvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
   pbvh->totvert = totvert;
   pbvh->leaf_limit = LEAF_LIMIT;
   pbvh->vdata = vdata;
@@ -593,33 +1026,16 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
-
   /* For each face, store the AABB and the AABB centroid */
-  prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
-
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  BB cb;
+  BBC *prim_bbc = build_prim_bbc_calc(pbvh, looptri_num, &cb);
 
   if (looptri_num) {
     pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
+    pbvh_build_stats_report(pbvh, PIL_check_seconds_timer() - time_start);
   }
 
   MEM_freeN(prim_bbc);
-  MEM_freeN(pbvh->vert_bitmap);
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -631,6 +1047,7 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
                           DMFlagMat *flagmats,
                           BLI_bitmap **grid_hidden)
 {
+  const double time_start = PIL_check_seconds_timer();
   const int gridsize = key->grid_size;
 
   pbvh->type = PBVH_GRIDS;
@@ -642,29 +1059,13 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   pbvh->grid_hidden = grid_hidden;
   pbvh->leaf_limit = max_ii(LEAF_LIMIT / (gridsize * gridsize), 1);
 
-  BB cb;
-  BB_reset(&cb);
-
   /* For each grid, store the AABB and the AABB centroid */
-  BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
-
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  BB cb;
+  BBC *prim_bbc = build_prim_bbc_calc(pbvh, totgrid, &cb);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
+    pbvh_build_stats_report(pbvh, PIL_check_seconds_timer() - time_start);
   }
 
   MEM_freeN(prim_bbc);
@@ -3073,3 +3474,13 @@ void BKE_pbvh_respect_hide_set(PBVH *pbvh, bool respect_hide)
 {
   pbvh->respect_hide = respect_hide;
 }
+
+void BKE_pbvh_use_sah_split_set(PBVH *pbvh, bool use_sah_split)
+{
+  pbvh->use_sah_split = use_sah_split;
+}
+
+void BKE_pbvh_build_stats_get(const PBVH *pbvh, PBVHBuildStats *r_stats)
+{
+  *r_stats = pbvh->build_stats;
+}
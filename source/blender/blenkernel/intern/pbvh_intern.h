@@ -152,7 +152,7 @@ struct PBVH {
 
   /* Only used during BVH build and update,
    * don't need to remain valid after */
-  BLI_bitmap *vert_bitmap;
+  int *vert_owner;
 
 #ifdef PERFCNTRS
   int perf_modified;
@@ -163,6 +163,10 @@ struct PBVH {
   bool show_mask;
   bool show_face_sets;
   bool respect_hide;
+  /* Split nodes using the surface area heuristic instead of the middle of the widest axis. */
+  bool use_sah_split;
+
+  PBVHBuildStats build_stats;
 
   /* Dynamic topology */
   BMesh *bm;
@@ -0,0 +1,162 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_geom.h"
+#include "BLI_threads.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+#include "mesh_test_utils.hh"
+#include "pbvh_intern.h"
+
+namespace blender::bke::tests {
+
+class PBVHBuildTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BLI_threadapi_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_threadapi_exit();
+  }
+
+  /* Grid denser towards one corner and with waves along Z, so the split strategies give
+   * different trees. */
+  static Mesh *mesh_grid_warped_create(const int size)
+  {
+    Mesh *me = mesh_grid_create(size);
+    for (int i = 0; i < me->totvert; i++) {
+      float *co = me->mvert[i].co;
+      const float u = co[0], v = co[1];
+      co[0] = u * u;
+      co[1] = v * v;
+      co[2] = 0.05f * sinf(u * 40.0f) * cosf(v * 25.0f);
+    }
+    return me;
+  }
+
+  static PBVH *pbvh_build(Mesh *me, const bool use_sah_split)
+  {
+    const int looptri_num = poly_to_tri_count(me->totpoly, me->totloop);
+    MLoopTri *looptri = static_cast<MLoopTri *>(
+        MEM_malloc_arrayN(looptri_num, sizeof(*looptri), __func__));
+    BKE_mesh_recalc_looptri(me->mloop, me->mpoly, me->mvert, me->totloop, me->totpoly, looptri);
+
+    PBVH *pbvh = BKE_pbvh_new();
+    BKE_pbvh_use_sah_split_set(pbvh, use_sah_split);
+    BKE_pbvh_build_mesh(pbvh,
+                        me,
+                        me->mpoly,
+                        me->mloop,
+                        me->mvert,
+                        me->totvert,
+                        &me->vdata,
+                        &me->ldata,
+                        &me->pdata,
+                        looptri,
+                        looptri_num);
+    return pbvh;
+  }
+
+  /* Every vertex must be unique in exactly one leaf, and inside the bounds of the leaves
+   * using it. */
+  static void pbvh_verify(PBVH *pbvh, const Mesh *me)
+  {
+    PBVHNode **nodes;
+    int totnode;
+    BKE_pbvh_search_gather(pbvh, nullptr, nullptr, &nodes, &totnode);
+
+    int *vert_uniq_count = static_cast<int *>(
+        MEM_calloc_arrayN(me->totvert, sizeof(int), __func__));
+
+    for (int n = 0; n < totnode; n++) {
+      int uniq_verts, totvert;
+      const int *vert_indices;
+      MVert *mvert;
+      float bb_min[3], bb_max[3];
+      BKE_pbvh_node_num_verts(pbvh, nodes[n], &uniq_verts, &totvert);
+      BKE_pbvh_node_get_verts(pbvh, nodes[n], &vert_indices, &mvert);
+      BKE_pbvh_node_get_BB(nodes[n], bb_min, bb_max);
+
+      for (int i = 0; i < totvert; i++) {
+        const float *co = mvert[vert_indices[i]].co;
+        EXPECT_TRUE(co[0] >= bb_min[0] && co[1] >= bb_min[1] && co[2] >= bb_min[2]);
+        EXPECT_TRUE(co[0] <= bb_max[0] && co[1] <= bb_max[1] && co[2] <= bb_max[2]);
+        if (i < uniq_verts) {
+          vert_uniq_count[vert_indices[i]]++;
+        }
+      }
+    }
+
+    for (int i = 0; i < me->totvert; i++) {
+      EXPECT_EQ(vert_uniq_count[i], 1);
+    }
+
+    MEM_freeN(vert_uniq_count);
+    MEM_SAFE_FREE(nodes);
+  }
+
+  /* Both trees have the same nodes, with the same bounds and primitives. */
+  static void pbvh_expect_eq(const PBVH *a, const PBVH *b)
+  {
+    ASSERT_EQ(a->totnode, b->totnode);
+    ASSERT_EQ(a->totprim, b->totprim);
+
+    for (int n = 0; n < a->totnode; n++) {
+      const PBVHNode *node_a = &a->nodes[n];
+      const PBVHNode *node_b = &b->nodes[n];
+      EXPECT_EQ(node_a->flag & PBVH_Leaf, node_b->flag & PBVH_Leaf);
+      EXPECT_EQ(node_a->children_offset, node_b->children_offset);
+      EXPECT_EQ(memcmp(&node_a->vb, &node_b->vb, sizeof(node_a->vb)), 0);
+      ASSERT_EQ(node_a->totprim, node_b->totprim);
+      EXPECT_EQ(node_a->prim_indices - a->prim_indices, node_b->prim_indices - b->prim_indices);
+    }
+
+    EXPECT_EQ(memcmp(a->prim_indices, b->prim_indices, sizeof(int) * size_t(a->totprim)), 0);
+  }
+};
+
+TEST_F(PBVHBuildTest, build_mesh)
+{
+  Mesh *me = mesh_grid_warped_create(512);
+  const int looptri_num = poly_to_tri_count(me->totpoly, me->totloop);
+
+  for (const bool use_sah_split : {false, true}) {
+    PBVH *pbvh = pbvh_build(me, use_sah_split);
+
+    PBVHBuildStats stats;
+    BKE_pbvh_build_stats_get(pbvh, &stats);
+    EXPECT_EQ(stats.totnode, stats.totleaf * 2 - 1);
+    EXPECT_LE(stats.leaf_prims_max, 10000);
+    EXPECT_NEAR(stats.leaf_prims_avg * stats.totleaf, looptri_num, 1.0f);
+    pbvh_verify(pbvh, me);
+
+    /* The tree does not depend on the order the build tasks ran in. */
+    PBVH *pbvh_other = pbvh_build(me, use_sah_split);
+    PBVHBuildStats stats_other;
+    BKE_pbvh_build_stats_get(pbvh_other, &stats_other);
+    EXPECT_EQ(stats.sah_cost, stats_other.sah_cost);
+    pbvh_expect_eq(pbvh, pbvh_other);
+
+    BKE_pbvh_free(pbvh_other);
+    BKE_pbvh_free(pbvh);
+  }
+
+  BKE_id_free(nullptr, me);
+}
+
+}  // namespace blender::bke::tests
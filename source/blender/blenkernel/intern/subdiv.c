@@ -177,10 +177,24 @@ Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const Mesh *mesh)
 {
+  /* Fast path for deform-only changes: matching hash means the topology refiner and evaluator can
+   * be kept without creating a converter and doing a full topology comparison. */
+  const uint64_t topology_hash = BKE_subdiv_converter_topology_hash_for_mesh(settings, mesh);
+  if (subdiv != NULL && subdiv->topology_refiner != NULL && topology_hash != 0 &&
+      subdiv->cache_.topology_hash == topology_hash &&
+      BKE_subdiv_settings_equal(&subdiv->settings, settings)) {
+    return subdiv;
+  }
   OpenSubdiv_Converter converter;
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   subdiv = BKE_subdiv_update_from_converter(subdiv, settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  if (subdiv != NULL && subdiv->cache_.topology_hash != topology_hash) {
+    /* Same OpenSubdiv topology can still come from a different mesh layout (for example, loose
+     * vertices at other indices), so the mapping of coarse vertices is to be re-calculated. */
+    MEM_SAFE_FREE(subdiv->cache_.coarse_vertex_used_map);
+    subdiv->cache_.topology_hash = topology_hash;
+  }
   return subdiv;
 }
 
@@ -198,6 +212,7 @@ void BKE_subdiv_free(Subdiv *subdiv)
   if (subdiv->cache_.face_ptex_offset != NULL) {
     MEM_freeN(subdiv->cache_.face_ptex_offset);
   }
+  MEM_SAFE_FREE(subdiv->cache_.coarse_vertex_used_map);
   MEM_freeN(subdiv);
 }
 
@@ -37,6 +37,11 @@ void BKE_subdiv_converter_init_for_mesh(struct OpenSubdiv_Converter *converter,
                                         const struct SubdivSettings *settings,
                                         const struct Mesh *mesh);
 
+/* Hash of all the mesh data which the converter passes to OpenSubdiv, except of the settings.
+ * Equal hashes mean the topology refiner created for one mesh can be used for the other. */
+uint64_t BKE_subdiv_converter_topology_hash_for_mesh(const struct SubdivSettings *settings,
+                                                     const struct Mesh *mesh);
+
 /* NOTE: Frees converter data, but not converter itself. This means, that if
  * converter was allocated on heap, it is up to the user to free that memory. */
 void BKE_subdiv_converter_free(struct OpenSubdiv_Converter *converter);
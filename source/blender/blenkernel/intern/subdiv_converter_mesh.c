@@ -29,6 +29,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_bitmap.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
@@ -405,3 +406,89 @@ void BKE_subdiv_converter_init_for_mesh(struct OpenSubdiv_Converter *converter,
   init_functions(converter);
   init_user_data(converter, settings, mesh);
 }
+
+/* ============================= TOPOLOGY HASH ============================== */
+
+/* Values are gathered into a buffer and hashed in chunks, so that hashing is bound by memory
+ * bandwidth rather than by per-element calls. Two hash streams with different seeds are used to
+ * make collisions practically impossible, since a collision means re-using wrong topology. */
+
+#define TOPOLOGY_HASH_BUFFER_SIZE 1024
+
+typedef struct TopologyHash {
+  BLI_HashMurmur2A mm2[2];
+  uint buffer[TOPOLOGY_HASH_BUFFER_SIZE];
+  int buffer_len;
+} TopologyHash;
+
+static void topology_hash_add_data(TopologyHash *hash, const uchar *data, const size_t len)
+{
+  BLI_hash_mm2a_add(&hash->mm2[0], data, len);
+  BLI_hash_mm2a_add(&hash->mm2[1], data, len);
+}
+
+static void topology_hash_flush(TopologyHash *hash)
+{
+  topology_hash_add_data(hash, (const uchar *)hash->buffer, sizeof(uint) * hash->buffer_len);
+  hash->buffer_len = 0;
+}
+
+BLI_INLINE void topology_hash_add_uint(TopologyHash *hash, const uint value)
+{
+  hash->buffer[hash->buffer_len++] = value;
+  if (hash->buffer_len == TOPOLOGY_HASH_BUFFER_SIZE) {
+    topology_hash_flush(hash);
+  }
+}
+
+uint64_t BKE_subdiv_converter_topology_hash_for_mesh(const SubdivSettings *settings,
+                                                     const Mesh *mesh)
+{
+  TopologyHash hash;
+  BLI_hash_mm2a_init(&hash.mm2[0], 0);
+  BLI_hash_mm2a_init(&hash.mm2[1], 0x9e3779b9);
+  hash.buffer_len = 0;
+
+  topology_hash_add_uint(&hash, (uint)mesh->totvert);
+  topology_hash_add_uint(&hash, (uint)mesh->totedge);
+  topology_hash_add_uint(&hash, (uint)mesh->totpoly);
+  topology_hash_add_uint(&hash, (uint)mesh->totloop);
+
+  /* Faces. */
+  const MPoly *mpoly = mesh->mpoly;
+  for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
+    topology_hash_add_uint(&hash, (uint)mpoly[poly_index].loopstart);
+    topology_hash_add_uint(&hash, (uint)mpoly[poly_index].totloop);
+  }
+  /* Loops only store vertex and edge indices, so they are hashed as-is. */
+  topology_hash_flush(&hash);
+  topology_hash_add_data(&hash, (const uchar *)mesh->mloop, sizeof(MLoop) * mesh->totloop);
+
+  /* Edges, including the loose ones: their vertices are infinitely sharp. */
+  const MEdge *medge = mesh->medge;
+  for (int edge_index = 0; edge_index < mesh->totedge; edge_index++) {
+    topology_hash_add_uint(&hash, medge[edge_index].v1);
+    topology_hash_add_uint(&hash, medge[edge_index].v2);
+    if (settings->use_creases) {
+      topology_hash_add_uint(&hash, (uint)medge[edge_index].crease);
+    }
+  }
+
+  /* UV maps: face-varying topology depends on which UV coordinates are separate. */
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  topology_hash_add_uint(&hash, (uint)num_uv_layers);
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      uint uv_bits[2];
+      memcpy(uv_bits, mloopuv[loop_index].uv, sizeof(uv_bits));
+      topology_hash_add_uint(&hash, uv_bits[0]);
+      topology_hash_add_uint(&hash, uv_bits[1]);
+    }
+  }
+
+  topology_hash_flush(&hash);
+  const uint64_t hash_a = BLI_hash_mm2a_end(&hash.mm2[0]);
+  const uint64_t hash_b = BLI_hash_mm2a_end(&hash.mm2[1]);
+  return (hash_a << 32) | hash_b;
+}
@@ -0,0 +1,62 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+
+#include "mesh_test_utils.hh"
+#include "subdiv_converter.h"
+
+namespace blender::bke::tests {
+
+class SubdivTopologyHashTest : public testing::Test {
+ protected:
+  SubdivSettings settings = {};
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(SubdivTopologyHashTest, deform_and_topology_changes)
+{
+  settings.use_creases = true;
+  Mesh *me = mesh_grid_create(32, 1);
+  const uint64_t hash = BKE_subdiv_converter_topology_hash_for_mesh(&settings, me);
+  EXPECT_NE(hash, 0u);
+
+  /* Deformation and element flags do not change the topology. */
+  for (int i = 0; i < me->totvert; i++) {
+    me->mvert[i].co[2] += 1.0f;
+  }
+  me->medge[0].flag |= ME_EDGEDRAW;
+  me->mpoly[0].flag |= ME_FACE_SEL;
+  EXPECT_EQ(BKE_subdiv_converter_topology_hash_for_mesh(&settings, me), hash);
+
+  /* Creases only matter when they are used. */
+  me->medge[0].crease = 255;
+  EXPECT_NE(BKE_subdiv_converter_topology_hash_for_mesh(&settings, me), hash);
+  settings.use_creases = false;
+  const uint64_t hash_no_creases = BKE_subdiv_converter_topology_hash_for_mesh(&settings, me);
+  me->medge[0].crease = 0;
+  EXPECT_EQ(BKE_subdiv_converter_topology_hash_for_mesh(&settings, me), hash_no_creases);
+
+  /* Using the loose vertex in a face instead of another one changes the topology. */
+  const uint loose_vertex = me->totvert - 1;
+  const uint vertex = me->mloop[0].v;
+  me->mloop[0].v = loose_vertex;
+  EXPECT_NE(BKE_subdiv_converter_topology_hash_for_mesh(&settings, me), hash_no_creases);
+  me->mloop[0].v = vertex;
+  EXPECT_EQ(BKE_subdiv_converter_topology_hash_for_mesh(&settings, me), hash_no_creases);
+
+  BKE_id_free(nullptr, me);
+}
+
+}  // namespace blender::bke::tests
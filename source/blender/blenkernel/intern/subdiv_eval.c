@@ -61,42 +61,84 @@ bool BKE_subdiv_eval_begin(Subdiv *subdiv)
   return true;
 }
 
-static void set_coarse_positions(Subdiv *subdiv,
-                                 const Mesh *mesh,
-                                 const float (*coarse_vertex_cos)[3])
+/* Mark vertices which are used by faces, only those are known to OpenSubdiv.
+ * The mapping only depends on topology, so it is kept for the lifetime of the subdiv. */
+static void coarse_vertex_used_map_ensure(Subdiv *subdiv, const Mesh *mesh)
 {
-  const MVert *mvert = mesh->mvert;
+  if (subdiv->cache_.coarse_vertex_used_map != NULL &&
+      subdiv->cache_.coarse_vertex_used_map_len == mesh->totvert) {
+    return;
+  }
+  MEM_SAFE_FREE(subdiv->cache_.coarse_vertex_used_map);
   const MLoop *mloop = mesh->mloop;
-  const MPoly *mpoly = mesh->mpoly;
-  /* Mark vertices which needs new coordinates. */
-  /* TODO(sergey): This is annoying to calculate this on every update,
-   * maybe it's better to cache this mapping. Or make it possible to have
-   * OpenSubdiv's vertices match mesh ones? */
   BLI_bitmap *vertex_used_map = BLI_BITMAP_NEW(mesh->totvert, "vert used map");
-  for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
-    const MPoly *poly = &mpoly[poly_index];
-    for (int corner = 0; corner < poly->totloop; corner++) {
-      const MLoop *loop = &mloop[poly->loopstart + corner];
-      BLI_BITMAP_ENABLE(vertex_used_map, loop->v);
+  for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+    BLI_BITMAP_ENABLE(vertex_used_map, mloop[loop_index].v);
+  }
+  int num_used_vertices = 0;
+  for (int vertex_index = 0; vertex_index < mesh->totvert; vertex_index++) {
+    if (BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      num_used_vertices++;
     }
   }
-  for (int vertex_index = 0, manifold_vertex_index = 0; vertex_index < mesh->totvert;
-       vertex_index++) {
+  subdiv->cache_.coarse_vertex_used_map = vertex_used_map;
+  subdiv->cache_.coarse_vertex_used_map_len = mesh->totvert;
+  subdiv->cache_.coarse_vertex_all_used = (num_used_vertices == mesh->totvert);
+}
+
+/* Pass coordinates of the given range of coarse vertices, which are all used by faces. */
+static void set_coarse_positions_range(Subdiv *subdiv,
+                                       const Mesh *mesh,
+                                       const float (*coarse_vertex_cos)[3],
+                                       const int vertex_index,
+                                       const int manifold_vertex_index,
+                                       const int num_vertices)
+{
+  OpenSubdiv_Evaluator *evaluator = subdiv->evaluator;
+  if (coarse_vertex_cos != NULL) {
+    evaluator->setCoarsePositions(
+        evaluator, coarse_vertex_cos[vertex_index], manifold_vertex_index, num_vertices);
+  }
+  else {
+    evaluator->setCoarsePositionsFromBuffer(evaluator,
+                                            &mesh->mvert[vertex_index],
+                                            offsetof(MVert, co),
+                                            sizeof(MVert),
+                                            manifold_vertex_index,
+                                            num_vertices);
+  }
+}
+
+static void set_coarse_positions(Subdiv *subdiv,
+                                 const Mesh *mesh,
+                                 const float (*coarse_vertex_cos)[3])
+{
+  coarse_vertex_used_map_ensure(subdiv, mesh);
+  if (subdiv->cache_.coarse_vertex_all_used) {
+    /* Common case: no loose vertices, so indices of OpenSubdiv vertices match the mesh ones. */
+    set_coarse_positions_range(subdiv, mesh, coarse_vertex_cos, 0, 0, mesh->totvert);
+    return;
+  }
+  /* Pass runs of vertices used by faces at once, skipping loose ones. */
+  const BLI_bitmap *vertex_used_map = subdiv->cache_.coarse_vertex_used_map;
+  int manifold_vertex_index = 0;
+  int vertex_index = 0;
+  while (vertex_index < mesh->totvert) {
     if (!BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      vertex_index++;
       continue;
     }
-    const float *vertex_co;
-    if (coarse_vertex_cos != NULL) {
-      vertex_co = coarse_vertex_cos[vertex_index];
-    }
-    else {
-      const MVert *vertex = &mvert[vertex_index];
-      vertex_co = vertex->co;
+    int vertex_index_end = vertex_index + 1;
+    while (vertex_index_end < mesh->totvert &&
+           BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index_end)) {
+      vertex_index_end++;
     }
-    subdiv->evaluator->setCoarsePositions(subdiv->evaluator, vertex_co, manifold_vertex_index, 1);
-    manifold_vertex_index++;
+    const int num_vertices = vertex_index_end - vertex_index;
+    set_coarse_positions_range(
+        subdiv, mesh, coarse_vertex_cos, vertex_index, manifold_vertex_index, num_vertices);
+    manifold_vertex_index += num_vertices;
+    vertex_index = vertex_index_end;
   }
-  MEM_freeN(vertex_used_map);
 }
 
 static void set_face_varying_data_from_uv(Subdiv *subdiv,
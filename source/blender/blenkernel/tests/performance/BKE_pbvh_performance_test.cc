@@ -0,0 +1,81 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_geom.h"
+#include "BLI_threads.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+static void pbvh_build_performance(Mesh *me, const bool use_sah_split)
+{
+  const int looptri_num = poly_to_tri_count(me->totpoly, me->totloop);
+  MLoopTri *looptri = static_cast<MLoopTri *>(
+      MEM_malloc_arrayN(looptri_num, sizeof(*looptri), __func__));
+  BKE_mesh_recalc_looptri(me->mloop, me->mpoly, me->mvert, me->totloop, me->totpoly, looptri);
+
+  PBVH *pbvh = BKE_pbvh_new();
+  BKE_pbvh_use_sah_split_set(pbvh, use_sah_split);
+  BKE_pbvh_build_mesh(pbvh,
+                      me,
+                      me->mpoly,
+                      me->mloop,
+                      me->mvert,
+                      me->totvert,
+                      &me->vdata,
+                      &me->ldata,
+                      &me->pdata,
+                      looptri,
+                      looptri_num);
+
+  PBVHBuildStats stats;
+  BKE_pbvh_build_stats_get(pbvh, &stats);
+  printf("%s split: %d triangles in %.4fs, %d nodes, %d leaves, depth %d, SAH cost %.1f\n",
+         use_sah_split ? "SAH" : "median",
+         looptri_num,
+         stats.build_time,
+         stats.totnode,
+         stats.totleaf,
+         stats.max_depth,
+         stats.sah_cost);
+
+  BKE_pbvh_free(pbvh);
+}
+
+TEST(pbvh, build_mesh)
+{
+  BKE_idtype_init();
+  BLI_threadapi_init();
+
+  /* Grid denser towards one corner and with waves along Z, so the split strategies give
+   * different trees. */
+  Mesh *me = mesh_grid_create(1024);
+  for (int i = 0; i < me->totvert; i++) {
+    float *co = me->mvert[i].co;
+    const float u = co[0], v = co[1];
+    co[0] = u * u;
+    co[1] = v * v;
+    co[2] = 0.05f * sinf(u * 40.0f) * cosf(v * 25.0f);
+  }
+
+  pbvh_build_performance(me, false);
+  pbvh_build_performance(me, true);
+
+  BKE_id_free(nullptr, me);
+  BLI_threadapi_exit();
+}
+
+}  // namespace blender::bke::tests
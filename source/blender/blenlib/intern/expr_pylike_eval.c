@@ -29,14 +29,17 @@
  *  - Literals:
  *      floating point and decimal integer.
  *  - Constants:
- *      pi, True, False
+ *      pi, e, tau, inf, True, False
  *  - Operators:
- *      +, -, *, /, ==, !=, <, <=, >, >=, and, or, not, ternary if
+ *      +, -, *, /, //, %, **, ==, !=, <, <=, >, >=, and, or, not, ternary if
  *  - Functions:
  *      min, max, radians, degrees,
- *      abs, fabs, floor, ceil, trunc, int,
+ *      abs, fabs, floor, ceil, trunc, int, float,
  *      sin, cos, tan, asin, acos, atan, atan2,
- *      exp, log, sqrt, pow, fmod
+ *      sinh, cosh, tanh, asinh, acosh, atanh,
+ *      exp, log, log2, log10, sqrt, pow, fmod, hypot, copysign,
+ *      clamp, lerp, smoothstep
+ *  - Functions and constants of the math module may be prefixed with "math.".
  *
  * The implementation has no global state and can be used multi-threaded.
  */
@@ -325,6 +328,52 @@ static double op_sub(double a, double b)
   return a - b;
 }
 
+/* Python raises ZeroDivisionError for any zero divisor of the integer division operators. */
+static double op_zero_division(void)
+{
+  feraiseexcept(FE_DIVBYZERO);
+  return 0.0;
+}
+
+/* Python floor division, computed from the modulo like `float_floor_div` in CPython so that
+ * `a // b` is exact where `floor(a / b)` is off by one after rounding, e.g. `1 // 0.1`. */
+static double op_floordiv(double a, double b)
+{
+  if (b == 0.0) {
+    return op_zero_division();
+  }
+
+  const double mod = fmod(a, b);
+  double div = (a - mod) / b;
+  if (mod != 0.0 && (mod < 0.0) != (b < 0.0)) {
+    div -= 1.0;
+  }
+  if (div == 0.0) {
+    return copysign(0.0, a / b);
+  }
+
+  /* Snap to the nearest integer, the quotient above may be off by the rounding error. */
+  double floordiv = floor(div);
+  if (div - floordiv > 0.5) {
+    floordiv += 1.0;
+  }
+  return floordiv;
+}
+
+/* Python modulo, the result has the sign of the divisor. */
+static double op_mod(double a, double b)
+{
+  if (b == 0.0) {
+    return op_zero_division();
+  }
+
+  double result = fmod(a, b);
+  if (result != 0.0 && (result < 0.0) != (b < 0.0)) {
+    result += b;
+  }
+  return result;
+}
+
 static double op_radians(double arg)
 {
   return arg * M_PI / 180.0;
@@ -402,15 +451,26 @@ static double op_ge(double a, double b)
 typedef struct BuiltinConstDef {
   const char *name;
   double value;
+  /* Also accessible with a "math." prefix. */
+  bool is_math;
 } BuiltinConstDef;
 
 static BuiltinConstDef builtin_consts[] = {
-    {"pi", M_PI}, {"True", 1.0}, {"False", 0.0}, {NULL, 0.0}};
+    {"pi", M_PI, true},
+    {"e", M_E, true},
+    {"tau", 2.0 * M_PI, true},
+    {"inf", INFINITY, true},
+    {"True", 1.0, false},
+    {"False", 0.0, false},
+    {NULL, 0.0, false},
+};
 
 typedef struct BuiltinOpDef {
   const char *name;
   eOpCode op;
   void *funcptr;
+  /* Also accessible with a "math." prefix. */
+  bool is_math;
 } BuiltinOpDef;
 
 #ifdef _MSC_VER
@@ -421,33 +481,43 @@ typedef struct BuiltinOpDef {
 #endif
 
 static BuiltinOpDef builtin_ops[] = {
-    {"radians", OPCODE_FUNC1, op_radians},
-    {"degrees", OPCODE_FUNC1, op_degrees},
-    {"abs", OPCODE_FUNC1, fabs},
-    {"fabs", OPCODE_FUNC1, fabs},
-    {"floor", OPCODE_FUNC1, floor},
-    {"ceil", OPCODE_FUNC1, ceil},
-    {"trunc", OPCODE_FUNC1, trunc},
-    {"round", OPCODE_FUNC1, round},
-    {"int", OPCODE_FUNC1, trunc},
-    {"sin", OPCODE_FUNC1, sin},
-    {"cos", OPCODE_FUNC1, cos},
-    {"tan", OPCODE_FUNC1, tan},
-    {"asin", OPCODE_FUNC1, asin},
-    {"acos", OPCODE_FUNC1, acos},
-    {"atan", OPCODE_FUNC1, atan},
-    {"atan2", OPCODE_FUNC2, atan2},
-    {"exp", OPCODE_FUNC1, exp},
-    {"log", OPCODE_FUNC1, log},
-    {"log", OPCODE_FUNC2, op_log2},
-    {"sqrt", OPCODE_FUNC1, sqrt},
-    {"pow", OPCODE_FUNC2, pow},
-    {"fmod", OPCODE_FUNC2, fmod},
-    {"lerp", OPCODE_FUNC3, op_lerp},
-    {"clamp", OPCODE_FUNC1, op_clamp},
-    {"clamp", OPCODE_FUNC3, op_clamp3},
-    {"smoothstep", OPCODE_FUNC3, op_smoothstep},
-    {NULL, OPCODE_CONST, NULL},
+    {"radians", OPCODE_FUNC1, op_radians, true},
+    {"degrees", OPCODE_FUNC1, op_degrees, true},
+    {"abs", OPCODE_FUNC1, fabs, false},
+    {"fabs", OPCODE_FUNC1, fabs, true},
+    {"floor", OPCODE_FUNC1, floor, true},
+    {"ceil", OPCODE_FUNC1, ceil, true},
+    {"trunc", OPCODE_FUNC1, trunc, true},
+    {"round", OPCODE_FUNC1, round, false},
+    {"int", OPCODE_FUNC1, trunc, false},
+    {"sin", OPCODE_FUNC1, sin, true},
+    {"cos", OPCODE_FUNC1, cos, true},
+    {"tan", OPCODE_FUNC1, tan, true},
+    {"asin", OPCODE_FUNC1, asin, true},
+    {"acos", OPCODE_FUNC1, acos, true},
+    {"atan", OPCODE_FUNC1, atan, true},
+    {"atan2", OPCODE_FUNC2, atan2, true},
+    {"sinh", OPCODE_FUNC1, sinh, true},
+    {"cosh", OPCODE_FUNC1, cosh, true},
+    {"tanh", OPCODE_FUNC1, tanh, true},
+    {"asinh", OPCODE_FUNC1, asinh, true},
+    {"acosh", OPCODE_FUNC1, acosh, true},
+    {"atanh", OPCODE_FUNC1, atanh, true},
+    {"exp", OPCODE_FUNC1, exp, true},
+    {"log", OPCODE_FUNC1, log, true},
+    {"log", OPCODE_FUNC2, op_log2, true},
+    {"log2", OPCODE_FUNC1, log2, true},
+    {"log10", OPCODE_FUNC1, log10, true},
+    {"sqrt", OPCODE_FUNC1, sqrt, true},
+    {"pow", OPCODE_FUNC2, pow, true},
+    {"fmod", OPCODE_FUNC2, fmod, true},
+    {"hypot", OPCODE_FUNC2, hypot, true},
+    {"copysign", OPCODE_FUNC2, copysign, true},
+    {"lerp", OPCODE_FUNC3, op_lerp, false},
+    {"clamp", OPCODE_FUNC1, op_clamp, false},
+    {"clamp", OPCODE_FUNC3, op_clamp3, false},
+    {"smoothstep", OPCODE_FUNC3, op_smoothstep, false},
+    {NULL, OPCODE_CONST, NULL, false},
 };
 
 /** \} */
@@ -477,6 +547,8 @@ static BuiltinOpDef builtin_ops[] = {
 #define TOKEN_NOT MAKE_CHAR2('N', 'O')
 #define TOKEN_IF MAKE_CHAR2('I', 'F')
 #define TOKEN_ELSE MAKE_CHAR2('E', 'L')
+#define TOKEN_POW MAKE_CHAR2('*', '*')
+#define TOKEN_FLOORDIV MAKE_CHAR2('/', '/')
 
 static const char *token_eq_characters = "!=><";
 static const char *token_characters = "~`!@#$%^&*+-=/\\?:;<>(){}[]|.,\"'";
@@ -713,6 +785,13 @@ static bool parse_next_token(ExprParseState *state)
     return (end == out);
   }
 
+  /* ** and // tokens */
+  if (ELEM(state->cur[0], '*', '/') && state->cur[1] == state->cur[0]) {
+    state->token = MAKE_CHAR2(state->cur[0], state->cur[1]);
+    state->cur += 2;
+    return true;
+  }
+
   /* ?= tokens */
   if (state->cur[1] == '=' && strchr(token_eq_characters, state->cur[0])) {
     state->token = MAKE_CHAR2(state->cur[0], state->cur[1]);
@@ -792,19 +871,12 @@ static int parse_function_args(ExprParseState *state)
   }
 }
 
-static bool parse_unary(ExprParseState *state)
+static bool parse_primary(ExprParseState *state)
 {
   int i;
+  bool is_math_attr = false;
 
   switch (state->token) {
-    case '+':
-      return parse_next_token(state) && parse_unary(state);
-
-    case '-':
-      CHECK_ERROR(parse_next_token(state) && parse_unary(state));
-      parse_add_func(state, OPCODE_FUNC1, 1, op_negate);
-      return true;
-
     case '(':
       return parse_next_token(state) && parse_expr(state) && state->token == ')' &&
              parse_next_token(state);
@@ -823,8 +895,18 @@ static bool parse_unary(ExprParseState *state)
         }
       }
 
+      /* The math module, its contents are also available without a prefix. */
+      if (STREQ(state->tokenbuf, "math")) {
+        CHECK_ERROR(parse_next_token(state) && state->token == '.');
+        CHECK_ERROR(parse_next_token(state) && state->token == TOKEN_ID);
+        is_math_attr = true;
+      }
+
       /* Ordinary builtin constants. */
       for (i = 0; builtin_consts[i].name; i++) {
+        if (is_math_attr && !builtin_consts[i].is_math) {
+          continue;
+        }
         if (STREQ(state->tokenbuf, builtin_consts[i].name)) {
           parse_add_op(state, OPCODE_CONST, 1)->arg.dval = builtin_consts[i].value;
           return parse_next_token(state);
@@ -833,6 +915,9 @@ static bool parse_unary(ExprParseState *state)
 
       /* Ordinary builtin functions. */
       for (i = 0; builtin_ops[i].name; i++) {
+        if (is_math_attr && !builtin_ops[i].is_math) {
+          continue;
+        }
         if (STREQ(state->tokenbuf, builtin_ops[i].name)) {
           int args = parse_function_args(state);
 
@@ -851,6 +936,10 @@ static bool parse_unary(ExprParseState *state)
         }
       }
 
+      if (is_math_attr) {
+        return false;
+      }
+
       /* Specially supported functions. */
       if (STREQ(state->tokenbuf, "min")) {
         int cnt = parse_function_args(state);
@@ -868,6 +957,11 @@ static bool parse_unary(ExprParseState *state)
         return true;
       }
 
+      /* All values are already floating point. */
+      if (STREQ(state->tokenbuf, "float")) {
+        return parse_function_args(state) == 1;
+      }
+
       return false;
 
     default:
@@ -875,6 +969,37 @@ static bool parse_unary(ExprParseState *state)
   }
 }
 
+static bool parse_unary(ExprParseState *state);
+
+static bool parse_power(ExprParseState *state)
+{
+  CHECK_ERROR(parse_primary(state));
+
+  /* Right associative, and binds less tightly than a unary operator on its right. */
+  if (state->token == TOKEN_POW) {
+    CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+    parse_add_func(state, OPCODE_FUNC2, 2, pow);
+  }
+
+  return true;
+}
+
+static bool parse_unary(ExprParseState *state)
+{
+  switch (state->token) {
+    case '+':
+      return parse_next_token(state) && parse_unary(state);
+
+    case '-':
+      CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+      parse_add_func(state, OPCODE_FUNC1, 1, op_negate);
+      return true;
+
+    default:
+      return parse_power(state);
+  }
+}
+
 static bool parse_mul(ExprParseState *state)
 {
   CHECK_ERROR(parse_unary(state));
@@ -891,6 +1016,16 @@ static bool parse_mul(ExprParseState *state)
         parse_add_func(state, OPCODE_FUNC2, 2, op_div);
         break;
 
+      case TOKEN_FLOORDIV:
+        CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+        parse_add_func(state, OPCODE_FUNC2, 2, op_floordiv);
+        break;
+
+      case '%':
+        CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+        parse_add_func(state, OPCODE_FUNC2, 2, op_mod);
+        break;
+
       default:
         return true;
     }
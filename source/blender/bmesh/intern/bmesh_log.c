@@ -27,6 +27,12 @@
  * - Moving vertices
  * - Setting vertex paint-mask values
  * - Setting vertex hflags
+ *
+ * The records of an entry are stored in append-only chunks, each holding its values as
+ * separate arrays. Chunks are never reallocated, so vertices and faces can be logged as modified
+ * from multiple threads, while other threads read the original values of vertices which are
+ * already logged. Adding and removing elements changes the topology of the BMesh, this must not
+ * happen in parallel with anything else.
  */
 
 #include "MEM_guardedalloc.h"
@@ -34,38 +40,76 @@
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
-#include "BLI_mempool.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
 
+#include "atomic_ops.h"
+
 #include "bmesh.h"
 #include "bmesh_log.h"
 #include "range_tree.h"
 
 #include "BLI_strict_flags.h"
 
-struct BMLogEntry {
-  struct BMLogEntry *next, *prev;
+/* Number of records in a chunk. */
+#define BM_LOG_CHUNK_SIZE 512
 
-  /* The following GHashes map from an element ID to one of the log
-   * types above */
+/* ID of records which have been removed from their entry again. */
+#define BM_LOG_ID_NONE ((uint)-1)
 
-  /* Elements that were in the previous entry, but have been
-   * deleted */
-  GHash *deleted_verts;
-  GHash *deleted_faces;
+/* Stamp bit set while a thread writes the record an ID refers to. */
+#define BM_LOG_STAMP_PENDING (1u << 31)
+
+/* Types of records in a log entry. */
+enum {
   /* Elements that were not in the previous entry, but are in the
    * result of this entry */
-  GHash *added_verts;
-  GHash *added_faces;
+  BM_LOG_ADDED = 0,
+  /* Elements that were in the previous entry, but have been
+   * deleted */
+  BM_LOG_DELETED = 1,
+  /* Vertices whose coordinates, mask value, or hflag have changed,
+   * faces whose hflag has changed */
+  BM_LOG_MODIFIED = 2,
+};
+#define BM_LOG_RECORD_TYPES 3
+
+/* Chunk of records, the values of the records follow in #BMLogVertChunk or #BMLogFaceChunk */
+typedef struct BMLogChunk {
+  /* The chunk that was filled before this one */
+  struct BMLogChunk *next;
+  /* Number of reserved records, exceeds #BM_LOG_CHUNK_SIZE once the chunk is full */
+  uint len;
+  /* Element ID of each record, #BM_LOG_ID_NONE for removed records */
+  uint id[BM_LOG_CHUNK_SIZE];
+} BMLogChunk;
+
+typedef struct BMLogVertChunk {
+  BMLogChunk head;
+  float co[BM_LOG_CHUNK_SIZE][3];
+  short no[BM_LOG_CHUNK_SIZE][3];
+  float mask[BM_LOG_CHUNK_SIZE];
+  char hflag[BM_LOG_CHUNK_SIZE];
+} BMLogVertChunk;
+
+typedef struct BMLogFaceChunk {
+  BMLogChunk head;
+  uint v_ids[BM_LOG_CHUNK_SIZE][3];
+  char hflag[BM_LOG_CHUNK_SIZE];
+} BMLogFaceChunk;
 
-  /* Vertices whose coordinates, mask value, or hflag have changed */
-  GHash *modified_verts;
-  GHash *modified_faces;
+struct BMLogEntry {
+  struct BMLogEntry *next, *prev;
+
+  /* Records of vertices and faces for each of the record types
+   * above, every type is a list of chunks, most recent first */
+  BMLogChunk *verts[BM_LOG_RECORD_TYPES];
+  BMLogChunk *faces[BM_LOG_RECORD_TYPES];
 
-  BLI_mempool *pool_verts;
-  BLI_mempool *pool_faces;
+  /* Identifies references to the records of this entry in
+   * BMLog.id_records, changed whenever those get invalid */
+  uint stamp;
 
   /* This is only needed for dropping BMLogEntries while still in
    * dynamic-topology mode, as that should release vert/face IDs
@@ -77,6 +121,16 @@ struct BMLogEntry {
   BMLog *log;
 };
 
+/* Location of the record of an element in the current log entry */
+typedef struct BMLogRecordRef {
+  /* Stamp of the entry the record is in, the reference is only
+   * valid when it matches the current entry */
+  uint stamp;
+  ushort index;
+  uchar type;
+  BMLogChunk *chunk;
+} BMLogRecordRef;
+
 struct BMLog {
   /* Tree of free IDs */
   struct RangeTreeUInt *unused_ids;
@@ -93,6 +147,15 @@ struct BMLog {
   GHash *id_to_elem;
   GHash *elem_to_id;
 
+  /* Record of each ID in the current entry, indexed by ID
+   *
+   * Only written when the ID gets its first record in the entry,
+   * this is what allows logging modifications from multiple
+   * threads without any lock.
+   */
+  BMLogRecordRef *id_records;
+  uint id_records_len;
+
   /* All BMLogEntrys, ordered from earliest to most recent */
   ListBase entries;
 
@@ -107,24 +170,23 @@ struct BMLog {
   BMLogEntry *current_entry;
 };
 
-typedef struct {
-  float co[3];
-  short no[3];
-  char hflag;
-  float mask;
-} BMLogVert;
-
-typedef struct {
-  uint v_ids[3];
-  char hflag;
-} BMLogFace;
-
 /************************* Get/set element IDs ************************/
 
 /* bypass actual hashing, the keys don't overlap */
 #define logkey_hash BLI_ghashutil_inthash_p_simple
 #define logkey_cmp BLI_ghashutil_intcmp
 
+/* Make sure the log can reference a record of the ID */
+static void bm_log_id_records_ensure(BMLog *log, uint id)
+{
+  if (id < log->id_records_len) {
+    return;
+  }
+  const uint len_new = MAX2(log->id_records_len * 2, id + 1);
+  log->id_records = MEM_recallocN(log->id_records, sizeof(*log->id_records) * len_new);
+  log->id_records_len = len_new;
+}
+
 /* Get the vertex's unique ID from the log */
 static uint bm_log_vert_id_get(BMLog *log, BMVert *v)
 {
@@ -139,6 +201,7 @@ static void bm_log_vert_id_set(BMLog *log, BMVert *v, uint id)
 
   BLI_ghash_reinsert(log->id_to_elem, vid, v, NULL, NULL);
   BLI_ghash_reinsert(log->elem_to_id, v, vid, NULL, NULL);
+  bm_log_id_records_ensure(log, id);
 }
 
 /* Get a vertex from its unique ID */
@@ -163,6 +226,7 @@ static void bm_log_face_id_set(BMLog *log, BMFace *f, uint id)
 
   BLI_ghash_reinsert(log->id_to_elem, fid, f, NULL, NULL);
   BLI_ghash_reinsert(log->elem_to_id, f, fid, NULL, NULL);
+  bm_log_id_records_ensure(log, id);
 }
 
 /* Get a face from its unique ID */
@@ -173,7 +237,177 @@ static BMFace *bm_log_face_from_id(BMLog *log, uint id)
   return BLI_ghash_lookup(log->id_to_elem, key);
 }
 
-/************************ BMLogVert / BMLogFace ***********************/
+/*************************** Record chunks ****************************/
+
+/* Get a stamp not used by any other log entry */
+static uint bm_log_stamp_next(void)
+{
+  static uint stamp_counter = 0;
+  uint stamp;
+  do {
+    stamp = atomic_add_and_fetch_uint32(&stamp_counter, 1) & ~BM_LOG_STAMP_PENDING;
+  } while (stamp == 0);
+  return stamp;
+}
+
+/* Number of records in a chunk, including removed ones */
+static uint bm_log_chunk_len(const BMLogChunk *chunk)
+{
+  return MIN2(chunk->len, (uint)BM_LOG_CHUNK_SIZE);
+}
+
+/* Reserve a record in a list of chunks, adding a chunk when the
+ * most recent one is full
+ *
+ * Safe to call from multiple threads for the same list */
+static BMLogChunk *bm_log_chunk_reserve(BMLogChunk **chunks_p,
+                                        const size_t chunk_size,
+                                        uint *r_index)
+{
+  while (true) {
+    BMLogChunk *chunk = *chunks_p;
+    if (chunk != NULL) {
+      const uint index = atomic_fetch_and_add_uint32(&chunk->len, 1);
+      if (index < BM_LOG_CHUNK_SIZE) {
+        *r_index = index;
+        return chunk;
+      }
+    }
+
+    BMLogChunk *chunk_new = MEM_mallocN(chunk_size, "BMLogChunk");
+    chunk_new->next = chunk;
+    chunk_new->len = 1;
+    if (atomic_cas_ptr((void **)chunks_p, chunk, chunk_new) == chunk) {
+      *r_index = 0;
+      return chunk_new;
+    }
+
+    /* Another thread added a chunk first */
+    MEM_freeN(chunk_new);
+  }
+}
+
+static void bm_log_chunks_free(BMLogChunk *chunk)
+{
+  while (chunk) {
+    BMLogChunk *chunk_next = chunk->next;
+    MEM_freeN(chunk);
+    chunk = chunk_next;
+  }
+}
+
+/* Iterate over the records in a list of chunks, skipping removed records */
+#define BM_LOG_CHUNKS_ITER_BEGIN(chunk, index, chunks) \
+  for (BMLogChunk *chunk = (chunks); chunk; chunk = chunk->next) { \
+    const uint chunk##_len = bm_log_chunk_len(chunk); \
+    for (uint index = 0; index < chunk##_len; index++) { \
+      if (chunk->id[index] == BM_LOG_ID_NONE) { \
+        continue; \
+      }
+
+#define BM_LOG_CHUNKS_ITER_END \
+  } \
+  } \
+  ((void)0)
+
+/* Get the reference to the record of an ID in the current entry
+ *
+ * Returns NULL if the ID has no record in the entry */
+static BMLogRecordRef *bm_log_record_get(BMLog *log, const BMLogEntry *entry, uint id)
+{
+  if (id >= log->id_records_len) {
+    return NULL;
+  }
+  BMLogRecordRef *ref = &log->id_records[id];
+  return (ref->stamp == entry->stamp) ? ref : NULL;
+}
+
+/* Reference the record of an ID in the current entry
+ *
+ * Only for operations that can't run in parallel */
+static void bm_log_record_set(
+    BMLog *log, const BMLogEntry *entry, uint id, int type, BMLogChunk *chunk, uint index)
+{
+  bm_log_id_records_ensure(log, id);
+
+  BMLogRecordRef *ref = &log->id_records[id];
+  ref->stamp = entry->stamp;
+  ref->index = (ushort)index;
+  ref->type = (uchar)type;
+  ref->chunk = chunk;
+}
+
+/* Claim the record of an ID in the current entry for the calling
+ * thread, which must then write and publish the record
+ *
+ * Returns false if the ID already has a record, by the time this
+ * returns it has been published */
+static bool bm_log_record_claim(BMLog *log, const BMLogEntry *entry, uint id)
+{
+  BLI_assert(id < log->id_records_len);
+
+  BMLogRecordRef *ref = &log->id_records[id];
+  const uint stamp_pending = entry->stamp | BM_LOG_STAMP_PENDING;
+
+  while (true) {
+    const uint stamp = atomic_fetch_and_add_uint32(&ref->stamp, 0);
+    if (stamp == entry->stamp) {
+      return false;
+    }
+    if (stamp == stamp_pending) {
+      /* Another thread is writing the record */
+      continue;
+    }
+    if (atomic_cas_uint32(&ref->stamp, stamp, stamp_pending) == stamp) {
+      return true;
+    }
+  }
+}
+
+/* Reference a record claimed by #bm_log_record_claim */
+static void bm_log_record_publish(
+    BMLog *log, const BMLogEntry *entry, uint id, int type, BMLogChunk *chunk, uint index)
+{
+  BMLogRecordRef *ref = &log->id_records[id];
+  ref->index = (ushort)index;
+  ref->type = (uchar)type;
+  ref->chunk = chunk;
+
+  /* The atomic operation makes the fields above visible to other
+   * threads before the stamp */
+  atomic_cas_uint32(&ref->stamp, entry->stamp | BM_LOG_STAMP_PENDING, entry->stamp);
+}
+
+/* Remove the record an ID refers to from the current entry */
+static void bm_log_record_remove(BMLogRecordRef *ref)
+{
+  ref->chunk->id[ref->index] = BM_LOG_ID_NONE;
+  ref->stamp = 0;
+}
+
+/* Reference all records of an entry that has become current
+ *
+ * Previous references to its records are invalidated */
+static void bm_log_entry_records_register(BMLog *log, BMLogEntry *entry)
+{
+  entry->stamp = bm_log_stamp_next();
+
+  for (int type = 0; type < BM_LOG_RECORD_TYPES; type++) {
+    BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, entry->verts[type])
+    {
+      bm_log_record_set(log, entry, chunk->id[i], type, chunk, i);
+    }
+    BM_LOG_CHUNKS_ITER_END;
+
+    BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, entry->faces[type])
+    {
+      bm_log_record_set(log, entry, chunk->id[i], type, chunk, i);
+    }
+    BM_LOG_CHUNKS_ITER_END;
+  }
+}
+
+/************************ Vert and face records ************************/
 
 /* Get a vertex's paint-mask value
  *
@@ -196,31 +430,39 @@ static void vert_mask_set(BMVert *v, const float new_mask, const int cd_vert_mas
   }
 }
 
-/* Update a BMLogVert with data from a BMVert */
-static void bm_log_vert_bmvert_copy(BMLogVert *lv, BMVert *v, const int cd_vert_mask_offset)
+/* Update a vertex record with data from a BMVert */
+static void bm_log_vert_bmvert_copy(BMLogVertChunk *chunk,
+                                    const uint index,
+                                    BMVert *v,
+                                    const int cd_vert_mask_offset)
 {
-  copy_v3_v3(lv->co, v->co);
-  normal_float_to_short_v3(lv->no, v->no);
-  lv->mask = vert_mask_get(v, cd_vert_mask_offset);
-  lv->hflag = v->head.hflag;
+  copy_v3_v3(chunk->co[index], v->co);
+  normal_float_to_short_v3(chunk->no[index], v->no);
+  chunk->mask[index] = vert_mask_get(v, cd_vert_mask_offset);
+  chunk->hflag[index] = v->head.hflag;
 }
 
-/* Allocate and initialize a BMLogVert */
-static BMLogVert *bm_log_vert_alloc(BMLog *log, BMVert *v, const int cd_vert_mask_offset)
+/* Add a record of a vertex to the current entry */
+static BMLogVertChunk *bm_log_vert_record_add(BMLog *log,
+                                              BMVert *v,
+                                              const uint v_id,
+                                              const int type,
+                                              const int cd_vert_mask_offset,
+                                              uint *r_index)
 {
   BMLogEntry *entry = log->current_entry;
-  BMLogVert *lv = BLI_mempool_alloc(entry->pool_verts);
+  BMLogVertChunk *chunk = (BMLogVertChunk *)bm_log_chunk_reserve(
+      &entry->verts[type], sizeof(BMLogVertChunk), r_index);
 
-  bm_log_vert_bmvert_copy(lv, v, cd_vert_mask_offset);
+  chunk->head.id[*r_index] = v_id;
+  bm_log_vert_bmvert_copy(chunk, *r_index, v, cd_vert_mask_offset);
 
-  return lv;
+  return chunk;
 }
 
-/* Allocate and initialize a BMLogFace */
-static BMLogFace *bm_log_face_alloc(BMLog *log, BMFace *f)
+/* Update a face record with data from a BMFace */
+static void bm_log_face_bmface_copy(BMLog *log, BMLogFaceChunk *chunk, const uint index, BMFace *f)
 {
-  BMLogEntry *entry = log->current_entry;
-  BMLogFace *lf = BLI_mempool_alloc(entry->pool_faces);
   BMVert *v[3];
 
   BLI_assert(f->len == 3);
@@ -228,131 +470,139 @@ static BMLogFace *bm_log_face_alloc(BMLog *log, BMFace *f)
   // BM_iter_as_array(NULL, BM_VERTS_OF_FACE, f, (void **)v, 3);
   BM_face_as_array_vert_tri(f, v);
 
-  lf->v_ids[0] = bm_log_vert_id_get(log, v[0]);
-  lf->v_ids[1] = bm_log_vert_id_get(log, v[1]);
-  lf->v_ids[2] = bm_log_vert_id_get(log, v[2]);
+  chunk->v_ids[index][0] = bm_log_vert_id_get(log, v[0]);
+  chunk->v_ids[index][1] = bm_log_vert_id_get(log, v[1]);
+  chunk->v_ids[index][2] = bm_log_vert_id_get(log, v[2]);
 
-  lf->hflag = f->head.hflag;
-  return lf;
+  chunk->hflag[index] = f->head.hflag;
+}
+
+/* Add a record of a face to the current entry */
+static BMLogFaceChunk *bm_log_face_record_add(
+    BMLog *log, BMFace *f, const uint f_id, const int type, uint *r_index)
+{
+  BMLogEntry *entry = log->current_entry;
+  BMLogFaceChunk *chunk = (BMLogFaceChunk *)bm_log_chunk_reserve(
+      &entry->faces[type], sizeof(BMLogFaceChunk), r_index);
+
+  chunk->head.id[*r_index] = f_id;
+  bm_log_face_bmface_copy(log, chunk, *r_index, f);
+
+  return chunk;
 }
 
 /************************ Helpers for undo/redo ***********************/
 
-static void bm_log_verts_unmake(BMesh *bm, BMLog *log, GHash *verts)
+static void bm_log_verts_unmake(BMesh *bm, BMLog *log, BMLogChunk *verts)
 {
   const int cd_vert_mask_offset = CustomData_get_offset(&bm->vdata, CD_PAINT_MASK);
 
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, verts) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    BMLogVert *lv = BLI_ghashIterator_getValue(&gh_iter);
-    uint id = POINTER_AS_UINT(key);
-    BMVert *v = bm_log_vert_from_id(log, id);
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, verts)
+  {
+    BMVert *v = bm_log_vert_from_id(log, chunk->id[i]);
 
     /* Ensure the log has the final values of the vertex before
      * deleting it */
-    bm_log_vert_bmvert_copy(lv, v, cd_vert_mask_offset);
+    bm_log_vert_bmvert_copy((BMLogVertChunk *)chunk, i, v, cd_vert_mask_offset);
 
     BM_vert_kill(bm, v);
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
-static void bm_log_faces_unmake(BMesh *bm, BMLog *log, GHash *faces)
+static void bm_log_faces_unmake(BMesh *bm, BMLog *log, BMLogChunk *faces)
 {
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, faces) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    uint id = POINTER_AS_UINT(key);
-    BMFace *f = bm_log_face_from_id(log, id);
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, faces)
+  {
+    BMFace *f = bm_log_face_from_id(log, chunk->id[i]);
     BMEdge *e_tri[3];
     BMLoop *l_iter;
-    int i;
+    int j;
 
     l_iter = BM_FACE_FIRST_LOOP(f);
-    for (i = 0; i < 3; i++, l_iter = l_iter->next) {
-      e_tri[i] = l_iter->e;
+    for (j = 0; j < 3; j++, l_iter = l_iter->next) {
+      e_tri[j] = l_iter->e;
     }
 
     /* Remove any unused edges */
     BM_face_kill(bm, f);
-    for (i = 0; i < 3; i++) {
-      if (BM_edge_is_wire(e_tri[i])) {
-        BM_edge_kill(bm, e_tri[i]);
+    for (j = 0; j < 3; j++) {
+      if (BM_edge_is_wire(e_tri[j])) {
+        BM_edge_kill(bm, e_tri[j]);
       }
     }
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
-static void bm_log_verts_restore(BMesh *bm, BMLog *log, GHash *verts)
+static void bm_log_verts_restore(BMesh *bm, BMLog *log, BMLogChunk *verts)
 {
   const int cd_vert_mask_offset = CustomData_get_offset(&bm->vdata, CD_PAINT_MASK);
 
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, verts) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    BMLogVert *lv = BLI_ghashIterator_getValue(&gh_iter);
-    BMVert *v = BM_vert_create(bm, lv->co, NULL, BM_CREATE_NOP);
-    vert_mask_set(v, lv->mask, cd_vert_mask_offset);
-    v->head.hflag = lv->hflag;
-    normal_short_to_float_v3(v->no, lv->no);
-    bm_log_vert_id_set(log, v, POINTER_AS_UINT(key));
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, verts)
+  {
+    BMLogVertChunk *vchunk = (BMLogVertChunk *)chunk;
+    BMVert *v = BM_vert_create(bm, vchunk->co[i], NULL, BM_CREATE_NOP);
+    vert_mask_set(v, vchunk->mask[i], cd_vert_mask_offset);
+    v->head.hflag = vchunk->hflag[i];
+    normal_short_to_float_v3(v->no, vchunk->no[i]);
+    bm_log_vert_id_set(log, v, chunk->id[i]);
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
-static void bm_log_faces_restore(BMesh *bm, BMLog *log, GHash *faces)
+static void bm_log_faces_restore(BMesh *bm, BMLog *log, BMLogChunk *faces)
 {
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, faces) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    BMLogFace *lf = BLI_ghashIterator_getValue(&gh_iter);
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, faces)
+  {
+    BMLogFaceChunk *fchunk = (BMLogFaceChunk *)chunk;
     BMVert *v[3] = {
-        bm_log_vert_from_id(log, lf->v_ids[0]),
-        bm_log_vert_from_id(log, lf->v_ids[1]),
-        bm_log_vert_from_id(log, lf->v_ids[2]),
+        bm_log_vert_from_id(log, fchunk->v_ids[i][0]),
+        bm_log_vert_from_id(log, fchunk->v_ids[i][1]),
+        bm_log_vert_from_id(log, fchunk->v_ids[i][2]),
     };
     BMFace *f;
 
     f = BM_face_create_verts(bm, v, 3, NULL, BM_CREATE_NOP, true);
-    f->head.hflag = lf->hflag;
-    bm_log_face_id_set(log, f, POINTER_AS_UINT(key));
+    f->head.hflag = fchunk->hflag[i];
+    bm_log_face_id_set(log, f, chunk->id[i]);
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
-static void bm_log_vert_values_swap(BMesh *bm, BMLog *log, GHash *verts)
+static void bm_log_vert_values_swap(BMesh *bm, BMLog *log, BMLogChunk *verts)
 {
   const int cd_vert_mask_offset = CustomData_get_offset(&bm->vdata, CD_PAINT_MASK);
 
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, verts) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    BMLogVert *lv = BLI_ghashIterator_getValue(&gh_iter);
-    uint id = POINTER_AS_UINT(key);
-    BMVert *v = bm_log_vert_from_id(log, id);
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, verts)
+  {
+    BMLogVertChunk *vchunk = (BMLogVertChunk *)chunk;
+    BMVert *v = bm_log_vert_from_id(log, chunk->id[i]);
     float mask;
     short normal[3];
 
-    swap_v3_v3(v->co, lv->co);
-    copy_v3_v3_short(normal, lv->no);
-    normal_float_to_short_v3(lv->no, v->no);
+    swap_v3_v3(v->co, vchunk->co[i]);
+    copy_v3_v3_short(normal, vchunk->no[i]);
+    normal_float_to_short_v3(vchunk->no[i], v->no);
     normal_short_to_float_v3(v->no, normal);
-    SWAP(char, v->head.hflag, lv->hflag);
-    mask = lv->mask;
-    lv->mask = vert_mask_get(v, cd_vert_mask_offset);
+    SWAP(char, v->head.hflag, vchunk->hflag[i]);
+    mask = vchunk->mask[i];
+    vchunk->mask[i] = vert_mask_get(v, cd_vert_mask_offset);
     vert_mask_set(v, mask, cd_vert_mask_offset);
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
-static void bm_log_face_values_swap(BMLog *log, GHash *faces)
+static void bm_log_face_values_swap(BMLog *log, BMLogChunk *faces)
 {
-  GHashIterator gh_iter;
-  GHASH_ITER (gh_iter, faces) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    BMLogFace *lf = BLI_ghashIterator_getValue(&gh_iter);
-    uint id = POINTER_AS_UINT(key);
-    BMFace *f = bm_log_face_from_id(log, id);
-
-    SWAP(char, f->head.hflag, lf->hflag);
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, faces)
+  {
+    BMLogFaceChunk *fchunk = (BMLogFaceChunk *)chunk;
+    BMFace *f = bm_log_face_from_id(log, chunk->id[i]);
+
+    SWAP(char, f->head.hflag, fchunk->hflag[i]);
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
 /**********************************************************************/
@@ -382,44 +632,48 @@ static BMLogEntry *bm_log_entry_create(void)
 {
   BMLogEntry *entry = MEM_callocN(sizeof(BMLogEntry), __func__);
 
-  entry->deleted_verts = BLI_ghash_new(logkey_hash, logkey_cmp, __func__);
-  entry->deleted_faces = BLI_ghash_new(logkey_hash, logkey_cmp, __func__);
-  entry->added_verts = BLI_ghash_new(logkey_hash, logkey_cmp, __func__);
-  entry->added_faces = BLI_ghash_new(logkey_hash, logkey_cmp, __func__);
-  entry->modified_verts = BLI_ghash_new(logkey_hash, logkey_cmp, __func__);
-  entry->modified_faces = BLI_ghash_new(logkey_hash, logkey_cmp, __func__);
-
-  entry->pool_verts = BLI_mempool_create(sizeof(BMLogVert), 0, 64, BLI_MEMPOOL_NOP);
-  entry->pool_faces = BLI_mempool_create(sizeof(BMLogFace), 0, 64, BLI_MEMPOOL_NOP);
+  entry->stamp = bm_log_stamp_next();
 
   return entry;
 }
 
+/* Free all records of a log entry */
+static void bm_log_entry_records_clear(BMLogEntry *entry)
+{
+  for (int type = 0; type < BM_LOG_RECORD_TYPES; type++) {
+    bm_log_chunks_free(entry->verts[type]);
+    bm_log_chunks_free(entry->faces[type]);
+    entry->verts[type] = NULL;
+    entry->faces[type] = NULL;
+  }
+
+  /* Invalidate references to the records */
+  entry->stamp = bm_log_stamp_next();
+}
+
 /* Free the data in a log entry
  *
  * Note: does not free the log entry itself */
 static void bm_log_entry_free(BMLogEntry *entry)
 {
-  BLI_ghash_free(entry->deleted_verts, NULL, NULL);
-  BLI_ghash_free(entry->deleted_faces, NULL, NULL);
-  BLI_ghash_free(entry->added_verts, NULL, NULL);
-  BLI_ghash_free(entry->added_faces, NULL, NULL);
-  BLI_ghash_free(entry->modified_verts, NULL, NULL);
-  BLI_ghash_free(entry->modified_faces, NULL, NULL);
-
-  BLI_mempool_destroy(entry->pool_verts);
-  BLI_mempool_destroy(entry->pool_faces);
+  bm_log_entry_records_clear(entry);
 }
 
-static void bm_log_id_ghash_retake(RangeTreeUInt *unused_ids, GHash *id_ghash)
+/* Take the IDs of all records in an entry */
+static void bm_log_entry_ids_retake(RangeTreeUInt *unused_ids, BMLogEntry *entry)
 {
-  GHashIterator gh_iter;
-
-  GHASH_ITER (gh_iter, id_ghash) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    uint id = POINTER_AS_UINT(key);
+  for (int type = 0; type < BM_LOG_RECORD_TYPES; type++) {
+    BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, entry->verts[type])
+    {
+      range_tree_uint_retake(unused_ids, chunk->id[i]);
+    }
+    BM_LOG_CHUNKS_ITER_END;
 
-    range_tree_uint_retake(unused_ids, id);
+    BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, entry->faces[type])
+    {
+      range_tree_uint_retake(unused_ids, chunk->id[i]);
+    }
+    BM_LOG_CHUNKS_ITER_END;
   }
 }
 
@@ -454,16 +708,14 @@ static GHash *bm_log_compress_ids_to_indices(uint *ids, uint totid)
   return map;
 }
 
-/* Release all ID keys in id_ghash */
-static void bm_log_id_ghash_release(BMLog *log, GHash *id_ghash)
+/* Release the IDs of all records in a list of chunks */
+static void bm_log_chunks_ids_release(BMLog *log, BMLogChunk *chunks)
 {
-  GHashIterator gh_iter;
-
-  GHASH_ITER (gh_iter, id_ghash) {
-    void *key = BLI_ghashIterator_getKey(&gh_iter);
-    uint id = POINTER_AS_UINT(key);
-    range_tree_uint_release(log->unused_ids, id);
+  BM_LOG_CHUNKS_ITER_BEGIN(chunk, i, chunks)
+  {
+    range_tree_uint_release(log->unused_ids, chunk->id[i]);
   }
+  BM_LOG_CHUNKS_ITER_END;
 }
 
 /***************************** Public API *****************************/
@@ -474,9 +726,10 @@ BMLog *BM_log_create(BMesh *bm)
   BMLog *log = MEM_callocN(sizeof(*log), __func__);
   const uint reserve_num = (uint)(bm->totvert + bm->totface);
 
-  log->unused_ids = range_tree_uint_alloc(0, (uint)-1);
+  log->unused_ids = range_tree_uint_alloc(0, BM_LOG_ID_NONE - 1);
   log->id_to_elem = BLI_ghash_new_ex(logkey_hash, logkey_cmp, __func__, reserve_num);
   log->elem_to_id = BLI_ghash_ptr_new_ex(__func__, reserve_num);
+  bm_log_id_records_ensure(log, reserve_num);
 
   /* Assign IDs to all existing vertices and faces */
   bm_log_assign_ids(bm, log);
@@ -490,19 +743,10 @@ void BM_log_cleanup_entry(BMLogEntry *entry)
 
   if (log) {
     /* Take all used IDs */
-    bm_log_id_ghash_retake(log->unused_ids, entry->deleted_verts);
-    bm_log_id_ghash_retake(log->unused_ids, entry->deleted_faces);
-    bm_log_id_ghash_retake(log->unused_ids, entry->added_verts);
-    bm_log_id_ghash_retake(log->unused_ids, entry->added_faces);
-    bm_log_id_ghash_retake(log->unused_ids, entry->modified_verts);
-    bm_log_id_ghash_retake(log->unused_ids, entry->modified_faces);
+    bm_log_entry_ids_retake(log->unused_ids, entry);
 
     /* delete entries to avoid releasing ids in node cleanup */
-    BLI_ghash_clear(entry->deleted_verts, NULL, NULL);
-    BLI_ghash_clear(entry->deleted_faces, NULL, NULL);
-    BLI_ghash_clear(entry->added_verts, NULL, NULL);
-    BLI_ghash_clear(entry->added_faces, NULL, NULL);
-    BLI_ghash_clear(entry->modified_verts, NULL, NULL);
+    bm_log_entry_records_clear(entry);
   }
 }
 
@@ -511,8 +755,8 @@ void BM_log_cleanup_entry(BMLogEntry *entry)
  * The 'entry' should be the last entry in the BMLog. Its prev pointer
  * will be followed back to find the first entry.
  *
- * The unused IDs field of the log will be initialized by taking all
- * keys from all GHashes in the log entry.
+ * The unused IDs field of the log will be initialized by taking the
+ * IDs of all records in the log entries.
  */
 BMLog *BM_log_from_existing_entries_create(BMesh *bm, BMLogEntry *entry)
 {
@@ -544,12 +788,11 @@ BMLog *BM_log_from_existing_entries_create(BMesh *bm, BMLogEntry *entry)
     entry->log = log;
 
     /* Take all used IDs */
-    bm_log_id_ghash_retake(log->unused_ids, entry->deleted_verts);
-    bm_log_id_ghash_retake(log->unused_ids, entry->deleted_faces);
-    bm_log_id_ghash_retake(log->unused_ids, entry->added_verts);
-    bm_log_id_ghash_retake(log->unused_ids, entry->added_faces);
-    bm_log_id_ghash_retake(log->unused_ids, entry->modified_verts);
-    bm_log_id_ghash_retake(log->unused_ids, entry->modified_faces);
+    bm_log_entry_ids_retake(log->unused_ids, entry);
+  }
+
+  if (log->current_entry) {
+    bm_log_entry_records_register(log, log->current_entry);
   }
 
   return log;
@@ -572,6 +815,8 @@ void BM_log_free(BMLog *log)
     BLI_ghash_free(log->elem_to_id, NULL, NULL);
   }
 
+  MEM_SAFE_FREE(log->id_records);
+
   /* Clear the BMLog references within each entry, but do not free
    * the entries themselves */
   for (entry = log->entries.first; entry; entry = entry->next) {
@@ -728,16 +973,16 @@ void BM_log_entry_drop(BMLogEntry *entry)
      * Also, design wise, a first entry should not have any deleted vertices since it
      * should not have anything to delete them -from-
      */
-    // bm_log_id_ghash_release(log, entry->deleted_faces);
-    // bm_log_id_ghash_release(log, entry->deleted_verts);
+    // bm_log_chunks_ids_release(log, entry->faces[BM_LOG_DELETED]);
+    // bm_log_chunks_ids_release(log, entry->verts[BM_LOG_DELETED]);
   }
   else if (!entry->next) {
     /* Release IDs of elements that are added by this entry. Since
      * the entry is at the end of the undo stack, and it's being
      * deleted, those elements can never be restored. Their IDs
      * can go back into the pool. */
-    bm_log_id_ghash_release(log, entry->added_faces);
-    bm_log_id_ghash_release(log, entry->added_verts);
+    bm_log_chunks_ids_release(log, entry->faces[BM_LOG_ADDED]);
+    bm_log_chunks_ids_release(log, entry->verts[BM_LOG_ADDED]);
   }
   else {
     BLI_assert(!"Cannot drop BMLogEntry from middle");
@@ -745,6 +990,9 @@ void BM_log_entry_drop(BMLogEntry *entry)
 
   if (log->current_entry == entry) {
     log->current_entry = entry->prev;
+    if (log->current_entry) {
+      bm_log_entry_records_register(log, log->current_entry);
+    }
   }
 
   bm_log_entry_free(entry);
@@ -762,16 +1010,20 @@ void BM_log_undo(BMesh *bm, BMLog *log)
     log->current_entry = entry->prev;
 
     /* Delete added faces and verts */
-    bm_log_faces_unmake(bm, log, entry->added_faces);
-    bm_log_verts_unmake(bm, log, entry->added_verts);
+    bm_log_faces_unmake(bm, log, entry->faces[BM_LOG_ADDED]);
+    bm_log_verts_unmake(bm, log, entry->verts[BM_LOG_ADDED]);
 
     /* Restore deleted verts and faces */
-    bm_log_verts_restore(bm, log, entry->deleted_verts);
-    bm_log_faces_restore(bm, log, entry->deleted_faces);
+    bm_log_verts_restore(bm, log, entry->verts[BM_LOG_DELETED]);
+    bm_log_faces_restore(bm, log, entry->faces[BM_LOG_DELETED]);
 
     /* Restore vertex coordinates, mask, and hflag */
-    bm_log_vert_values_swap(bm, log, entry->modified_verts);
-    bm_log_face_values_swap(log, entry->modified_faces);
+    bm_log_vert_values_swap(bm, log, entry->verts[BM_LOG_MODIFIED]);
+    bm_log_face_values_swap(log, entry->faces[BM_LOG_MODIFIED]);
+
+    if (log->current_entry) {
+      bm_log_entry_records_register(log, log->current_entry);
+    }
   }
 }
 
@@ -799,16 +1051,18 @@ void BM_log_redo(BMesh *bm, BMLog *log)
 
   if (entry) {
     /* Re-delete previously deleted faces and verts */
-    bm_log_faces_unmake(bm, log, entry->deleted_faces);
-    bm_log_verts_unmake(bm, log, entry->deleted_verts);
+    bm_log_faces_unmake(bm, log, entry->faces[BM_LOG_DELETED]);
+    bm_log_verts_unmake(bm, log, entry->verts[BM_LOG_DELETED]);
 
     /* Restore previously added verts and faces */
-    bm_log_verts_restore(bm, log, entry->added_verts);
-    bm_log_faces_restore(bm, log, entry->added_faces);
+    bm_log_verts_restore(bm, log, entry->verts[BM_LOG_ADDED]);
+    bm_log_faces_restore(bm, log, entry->faces[BM_LOG_ADDED]);
 
     /* Restore vertex coordinates, mask, and hflag */
-    bm_log_vert_values_swap(bm, log, entry->modified_verts);
-    bm_log_face_values_swap(log, entry->modified_faces);
+    bm_log_vert_values_swap(bm, log, entry->verts[BM_LOG_MODIFIED]);
+    bm_log_face_values_swap(log, entry->faces[BM_LOG_MODIFIED]);
+
+    bm_log_entry_records_register(log, entry);
   }
 }
 
@@ -823,86 +1077,92 @@ void BM_log_redo(BMesh *bm, BMLog *log)
  * Handles two separate cases:
  *
  * If the vertex was added in the current log entry, update the
- * vertex in the map of added vertices.
+ * vertex in the records of added vertices.
  *
  * If the vertex already existed prior to the current log entry, a
- * separate key/value map of modified vertices is used (using the
- * vertex's ID as the key). The values stored in that case are
- * the vertex's original state so that an undo can restore the
+ * separate record of the modified vertex is added, storing the
+ * vertex's original state so that an undo can restore the
  * previous state.
  *
  * On undo, the current vertex state will be swapped with the stored
  * state so that a subsequent redo operation will restore the newer
  * vertex state.
+ *
+ * Can be called from multiple threads, also for the same vertex.
  */
 void BM_log_vert_before_modified(BMLog *log, BMVert *v, const int cd_vert_mask_offset)
 {
   BMLogEntry *entry = log->current_entry;
-  BMLogVert *lv;
   uint v_id = bm_log_vert_id_get(log, v);
-  void *key = POINTER_FROM_UINT(v_id);
-  void **val_p;
 
-  /* Find or create the BMLogVert entry */
-  if ((lv = BLI_ghash_lookup(entry->added_verts, key))) {
-    bm_log_vert_bmvert_copy(lv, v, cd_vert_mask_offset);
+  if (bm_log_record_claim(log, entry, v_id)) {
+    uint index;
+    BMLogVertChunk *chunk = bm_log_vert_record_add(
+        log, v, v_id, BM_LOG_MODIFIED, cd_vert_mask_offset, &index);
+    bm_log_record_publish(log, entry, v_id, BM_LOG_MODIFIED, &chunk->head, index);
   }
-  else if (!BLI_ghash_ensure_p(entry->modified_verts, key, &val_p)) {
-    lv = bm_log_vert_alloc(log, v, cd_vert_mask_offset);
-    *val_p = lv;
+  else {
+    const BMLogRecordRef *ref = &log->id_records[v_id];
+    if (ref->type == BM_LOG_ADDED) {
+      bm_log_vert_bmvert_copy((BMLogVertChunk *)ref->chunk, ref->index, v, cd_vert_mask_offset);
+    }
   }
 }
 
 /* Log a new vertex as added to the BMesh
  *
- * The new vertex gets a unique ID assigned. It is then added to a map
- * of added vertices, with the key being its ID and the value
- * containing everything needed to reconstruct that vertex.
+ * The new vertex gets a unique ID assigned. It is then added to the
+ * records of added vertices, containing everything needed to
+ * reconstruct that vertex.
  */
 void BM_log_vert_added(BMLog *log, BMVert *v, const int cd_vert_mask_offset)
 {
-  BMLogVert *lv;
   uint v_id = range_tree_uint_take_any(log->unused_ids);
-  void *key = POINTER_FROM_UINT(v_id);
+  uint index;
 
   bm_log_vert_id_set(log, v, v_id);
-  lv = bm_log_vert_alloc(log, v, cd_vert_mask_offset);
-  BLI_ghash_insert(log->current_entry->added_verts, key, lv);
+  BMLogVertChunk *chunk = bm_log_vert_record_add(
+      log, v, v_id, BM_LOG_ADDED, cd_vert_mask_offset, &index);
+  bm_log_record_set(log, log->current_entry, v_id, BM_LOG_ADDED, &chunk->head, index);
 }
 
 /* Log a face before it is modified
  *
  * This is intended to handle only header flags and we always
  * assume face has been added before
+ *
+ * Can be called from multiple threads, faces that already have a
+ * record in the current entry are skipped.
  */
 void BM_log_face_modified(BMLog *log, BMFace *f)
 {
-  BMLogFace *lf;
+  BMLogEntry *entry = log->current_entry;
   uint f_id = bm_log_face_id_get(log, f);
-  void *key = POINTER_FROM_UINT(f_id);
 
-  lf = bm_log_face_alloc(log, f);
-  BLI_ghash_insert(log->current_entry->modified_faces, key, lf);
+  if (bm_log_record_claim(log, entry, f_id)) {
+    uint index;
+    BMLogFaceChunk *chunk = bm_log_face_record_add(log, f, f_id, BM_LOG_MODIFIED, &index);
+    bm_log_record_publish(log, entry, f_id, BM_LOG_MODIFIED, &chunk->head, index);
+  }
 }
 
 /* Log a new face as added to the BMesh
  *
- * The new face gets a unique ID assigned. It is then added to a map
- * of added faces, with the key being its ID and the value containing
- * everything needed to reconstruct that face.
+ * The new face gets a unique ID assigned. It is then added to the
+ * records of added faces, containing everything needed to
+ * reconstruct that face.
  */
 void BM_log_face_added(BMLog *log, BMFace *f)
 {
-  BMLogFace *lf;
   uint f_id = range_tree_uint_take_any(log->unused_ids);
-  void *key = POINTER_FROM_UINT(f_id);
+  uint index;
 
   /* Only triangles are supported for now */
   BLI_assert(f->len == 3);
 
   bm_log_face_id_set(log, f, f_id);
-  lf = bm_log_face_alloc(log, f);
-  BLI_ghash_insert(log->current_entry->added_faces, key, lf);
+  BMLogFaceChunk *chunk = bm_log_face_record_add(log, f, f_id, BM_LOG_ADDED, &index);
+  bm_log_record_set(log, log->current_entry, f_id, BM_LOG_ADDED, &chunk->head, index);
 }
 
 /* Log a vertex as removed from the BMesh
@@ -914,9 +1174,8 @@ void BM_log_face_added(BMLog *log, BMFace *f)
  * the unused pool.
  *
  * If the vertex was already part of the BMesh before the current log
- * entry, it is added to a map of deleted vertices, with the key being
- * its ID and the value containing everything needed to reconstruct
- * that vertex.
+ * entry, it is added to the records of deleted vertices, containing
+ * everything needed to reconstruct that vertex.
  *
  * If there's a move record for the vertex, that's used as the
  * vertices original location, then the move record is deleted.
@@ -925,27 +1184,29 @@ void BM_log_vert_removed(BMLog *log, BMVert *v, const int cd_vert_mask_offset)
 {
   BMLogEntry *entry = log->current_entry;
   uint v_id = bm_log_vert_id_get(log, v);
-  void *key = POINTER_FROM_UINT(v_id);
-
-  /* if it has a key, it shouldn't be NULL */
-  BLI_assert(!!BLI_ghash_lookup(entry->added_verts, key) ==
-             !!BLI_ghash_haskey(entry->added_verts, key));
+  BMLogRecordRef *ref = bm_log_record_get(log, entry, v_id);
 
-  if (BLI_ghash_remove(entry->added_verts, key, NULL, NULL)) {
+  if (ref && ref->type == BM_LOG_ADDED) {
+    bm_log_record_remove(ref);
     range_tree_uint_release(log->unused_ids, v_id);
   }
   else {
-    BMLogVert *lv, *lv_mod;
-
-    lv = bm_log_vert_alloc(log, v, cd_vert_mask_offset);
-    BLI_ghash_insert(entry->deleted_verts, key, lv);
+    uint index;
+    BMLogVertChunk *chunk = bm_log_vert_record_add(
+        log, v, v_id, BM_LOG_DELETED, cd_vert_mask_offset, &index);
 
     /* If the vertex was modified before deletion, ensure that the
      * original vertex values are stored */
-    if ((lv_mod = BLI_ghash_lookup(entry->modified_verts, key))) {
-      (*lv) = (*lv_mod);
-      BLI_ghash_remove(entry->modified_verts, key, NULL, NULL);
+    if (ref && ref->type == BM_LOG_MODIFIED) {
+      const BMLogVertChunk *chunk_mod = (const BMLogVertChunk *)ref->chunk;
+      copy_v3_v3(chunk->co[index], chunk_mod->co[ref->index]);
+      copy_v3_v3_short(chunk->no[index], chunk_mod->no[ref->index]);
+      chunk->mask[index] = chunk_mod->mask[ref->index];
+      chunk->hflag[index] = chunk_mod->hflag[ref->index];
+      bm_log_record_remove(ref);
     }
+
+    bm_log_record_set(log, entry, v_id, BM_LOG_DELETED, &chunk->head, index);
   }
 }
 
@@ -958,28 +1219,33 @@ void BM_log_vert_removed(BMLog *log, BMVert *v, const int cd_vert_mask_offset)
  * the unused pool.
  *
  * If the face was already part of the BMesh before the current log
- * entry, it is added to a map of deleted faces, with the key being
- * its ID and the value containing everything needed to reconstruct
- * that face.
+ * entry, it is added to the records of deleted faces, containing
+ * everything needed to reconstruct that face.
+ *
+ * If the face was modified before, its original hflag is used and the
+ * modified record is deleted.
  */
 void BM_log_face_removed(BMLog *log, BMFace *f)
 {
   BMLogEntry *entry = log->current_entry;
   uint f_id = bm_log_face_id_get(log, f);
-  void *key = POINTER_FROM_UINT(f_id);
-
-  /* if it has a key, it shouldn't be NULL */
-  BLI_assert(!!BLI_ghash_lookup(entry->added_faces, key) ==
-             !!BLI_ghash_haskey(entry->added_faces, key));
+  BMLogRecordRef *ref = bm_log_record_get(log, entry, f_id);
 
-  if (BLI_ghash_remove(entry->added_faces, key, NULL, NULL)) {
+  if (ref && ref->type == BM_LOG_ADDED) {
+    bm_log_record_remove(ref);
     range_tree_uint_release(log->unused_ids, f_id);
   }
   else {
-    BMLogFace *lf;
+    uint index;
+    BMLogFaceChunk *chunk = bm_log_face_record_add(log, f, f_id, BM_LOG_DELETED, &index);
 
-    lf = bm_log_face_alloc(log, f);
-    BLI_ghash_insert(entry->deleted_faces, key, lf);
+    if (ref && ref->type == BM_LOG_MODIFIED) {
+      const BMLogFaceChunk *chunk_mod = (const BMLogFaceChunk *)ref->chunk;
+      chunk->hflag[index] = chunk_mod->hflag[ref->index];
+      bm_log_record_remove(ref);
+    }
+
+    bm_log_record_set(log, entry, f_id, BM_LOG_DELETED, &chunk->head, index);
   }
 }
 
@@ -991,15 +1257,6 @@ void BM_log_all_added(BMesh *bm, BMLog *log)
   BMVert *v;
   BMFace *f;
 
-  /* avoid unnecessary resizing on initialization */
-  if (BLI_ghash_len(log->current_entry->added_verts) == 0) {
-    BLI_ghash_reserve(log->current_entry->added_verts, (uint)bm->totvert);
-  }
-
-  if (BLI_ghash_len(log->current_entry->added_faces) == 0) {
-    BLI_ghash_reserve(log->current_entry->added_faces, (uint)bm->totface);
-  }
-
   /* Log all vertices as newly created */
   BM_ITER_MESH (v, &bm_iter, bm, BM_VERTS_OF_MESH) {
     BM_log_vert_added(log, v, cd_vert_mask_offset);
@@ -1030,22 +1287,30 @@ void BM_log_before_all_removed(BMesh *bm, BMLog *log)
   }
 }
 
-/* Get the logged coordinates of a vertex
- *
- * Does not modify the log or the vertex */
-const float *BM_log_original_vert_co(BMLog *log, BMVert *v)
+/* Get the record holding the logged values of a vertex */
+static const BMLogVertChunk *bm_log_original_vert_record(BMLog *log, BMVert *v, uint *r_index)
 {
   BMLogEntry *entry = log->current_entry;
-  const BMLogVert *lv;
   uint v_id = bm_log_vert_id_get(log, v);
-  void *key = POINTER_FROM_UINT(v_id);
 
   BLI_assert(entry);
 
-  BLI_assert(BLI_ghash_haskey(entry->modified_verts, key));
+  const BMLogRecordRef *ref = bm_log_record_get(log, entry, v_id);
+
+  BLI_assert(ref && ref->type != BM_LOG_DELETED);
 
-  lv = BLI_ghash_lookup(entry->modified_verts, key);
-  return lv->co;
+  *r_index = ref->index;
+  return (const BMLogVertChunk *)ref->chunk;
+}
+
+/* Get the logged coordinates of a vertex
+ *
+ * Does not modify the log or the vertex */
+const float *BM_log_original_vert_co(BMLog *log, BMVert *v)
+{
+  uint index;
+  const BMLogVertChunk *chunk = bm_log_original_vert_record(log, v, &index);
+  return chunk->co[index];
 }
 
 /* Get the logged normal of a vertex
@@ -1053,17 +1318,9 @@ const float *BM_log_original_vert_co(BMLog *log, BMVert *v)
  * Does not modify the log or the vertex */
 const short *BM_log_original_vert_no(BMLog *log, BMVert *v)
 {
-  BMLogEntry *entry = log->current_entry;
-  const BMLogVert *lv;
-  uint v_id = bm_log_vert_id_get(log, v);
-  void *key = POINTER_FROM_UINT(v_id);
-
-  BLI_assert(entry);
-
-  BLI_assert(BLI_ghash_haskey(entry->modified_verts, key));
-
-  lv = BLI_ghash_lookup(entry->modified_verts, key);
-  return lv->no;
+  uint index;
+  const BMLogVertChunk *chunk = bm_log_original_vert_record(log, v, &index);
+  return chunk->no[index];
 }
 
 /* Get the logged mask of a vertex
@@ -1071,33 +1328,17 @@ const short *BM_log_original_vert_no(BMLog *log, BMVert *v)
  * Does not modify the log or the vertex */
 float BM_log_original_mask(BMLog *log, BMVert *v)
 {
-  BMLogEntry *entry = log->current_entry;
-  const BMLogVert *lv;
-  uint v_id = bm_log_vert_id_get(log, v);
-  void *key = POINTER_FROM_UINT(v_id);
-
-  BLI_assert(entry);
-
-  BLI_assert(BLI_ghash_haskey(entry->modified_verts, key));
-
-  lv = BLI_ghash_lookup(entry->modified_verts, key);
-  return lv->mask;
+  uint index;
+  const BMLogVertChunk *chunk = bm_log_original_vert_record(log, v, &index);
+  return chunk->mask[index];
 }
 
 void BM_log_original_vert_data(BMLog *log, BMVert *v, const float **r_co, const short **r_no)
 {
-  BMLogEntry *entry = log->current_entry;
-  const BMLogVert *lv;
-  uint v_id = bm_log_vert_id_get(log, v);
-  void *key = POINTER_FROM_UINT(v_id);
-
-  BLI_assert(entry);
-
-  BLI_assert(BLI_ghash_haskey(entry->modified_verts, key));
-
-  lv = BLI_ghash_lookup(entry->modified_verts, key);
-  *r_co = lv->co;
-  *r_no = lv->no;
+  uint index;
+  const BMLogVertChunk *chunk = bm_log_original_vert_record(log, v, &index);
+  *r_co = chunk->co[index];
+  *r_no = chunk->no[index];
 }
 
 /************************ Debugging and Testing ***********************/
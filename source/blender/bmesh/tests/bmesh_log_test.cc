@@ -0,0 +1,124 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "bmesh.h"
+#include "intern/bmesh_log.h"
+
+class BMLogTest : public testing::Test {
+ protected:
+  BMesh *bm;
+  BMLog *log;
+
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_threadapi_exit();
+  }
+
+  /* Triangulated grid of `size` by `size` quads. */
+  void SetUp() override
+  {
+    const int size = 64;
+    const int verts_size = size + 1;
+    BMeshCreateParams bm_params = {0};
+    bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+    BMVert **verts = (BMVert **)MEM_mallocN(sizeof(BMVert *) * verts_size * verts_size, __func__);
+    for (int y = 0; y < verts_size; y++) {
+      for (int x = 0; x < verts_size; x++) {
+        const float co[3] = {(float)x, (float)y, 0.0f};
+        verts[y * verts_size + x] = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+      }
+    }
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        BMVert **v = &verts[y * verts_size + x];
+        BMVert *tri_a[3] = {v[0], v[1], v[verts_size + 1]};
+        BMVert *tri_b[3] = {v[0], v[verts_size + 1], v[verts_size]};
+        BM_face_create_verts(bm, tri_a, 3, nullptr, BM_CREATE_NOP, true);
+        BM_face_create_verts(bm, tri_b, 3, nullptr, BM_CREATE_NOP, true);
+      }
+    }
+    MEM_freeN(verts);
+
+    BM_mesh_elem_table_ensure(bm, BM_VERT | BM_FACE);
+    log = BM_log_create(bm);
+  }
+
+  void TearDown() override
+  {
+    BM_log_free(log);
+    BM_mesh_free(bm);
+  }
+
+  /* Log every vertex as modified in parallel, each vertex from several tasks, then move it. */
+  static void log_and_move_task(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict /*tls*/)
+  {
+    BMLogTest *test = (BMLogTest *)userdata;
+    BMesh *bm = test->bm;
+    for (int j = -1; j <= 1; j++) {
+      BMVert *v = bm->vtable[(i + j + bm->totvert) % bm->totvert];
+      BM_log_vert_before_modified(test->log, v, -1);
+    }
+    BMVert *v = bm->vtable[i];
+    const float *co_orig = BM_log_original_vert_co(test->log, v);
+    v->co[2] = co_orig[2] + 1.0f;
+  }
+};
+
+TEST_F(BMLogTest, parallel_modify_undo_redo)
+{
+  BMLogEntry *entry = BM_log_entry_add(log);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  BLI_task_parallel_range(0, bm->totvert, this, log_and_move_task, &settings);
+
+  BM_log_undo(bm, log);
+  for (int i = 0; i < bm->totvert; i++) {
+    EXPECT_EQ(bm->vtable[i]->co[2], 0.0f);
+  }
+
+  BM_log_redo(bm, log);
+  for (int i = 0; i < bm->totvert; i++) {
+    EXPECT_EQ(bm->vtable[i]->co[2], 1.0f);
+  }
+
+  BM_log_entry_drop(entry);
+}
+
+TEST_F(BMLogTest, remove_undo_redo)
+{
+  const int totvert = bm->totvert;
+  const int totface = bm->totface;
+
+  BMLogEntry *entry = BM_log_entry_add(log);
+  BM_log_before_all_removed(bm, log);
+  BM_mesh_clear(bm);
+  EXPECT_EQ(bm->totvert, 0);
+
+  BM_log_undo(bm, log);
+  EXPECT_EQ(bm->totvert, totvert);
+  EXPECT_EQ(bm->totface, totface);
+
+  BM_log_redo(bm, log);
+  EXPECT_EQ(bm->totvert, 0);
+  EXPECT_EQ(bm->totface, 0);
+
+  BM_log_entry_drop(entry);
+}
@@ -24,6 +24,10 @@
 
 struct TaskGraph;
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* Vertex Group Selection and display options */
 typedef struct DRW_MeshWeightState {
   int defgroup_active;
@@ -275,3 +279,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                         const Scene *scene,
                                         const ToolSettings *ts,
                                         const bool use_hide);
+
+#ifdef __cplusplus
+}
+#endif
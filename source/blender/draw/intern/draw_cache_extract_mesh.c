@@ -34,6 +34,7 @@
 #include "BLI_math_vector.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
@@ -71,6 +72,7 @@
 #include "draw_cache_inline.h"
 
 #include "draw_cache_extract.h"
+#include "draw_manager_testing.h"
 
 // #define DEBUG_TIME
 
@@ -763,10 +765,18 @@ typedef void(ExtractFinishFn)(const MeshRenderData *mr,
                               struct MeshBatchCache *cache,
                               void *buffer,
                               void *data);
+typedef void *(ExtractTaskInitFn)(void *data);
+typedef void(ExtractTaskFinishFn)(void *data, void *task_data);
 
 typedef struct MeshExtract {
   /** Executed on main thread and return user data for iteration functions. */
   ExtractInitFn *init;
+  /**
+   * Optional, executed on the worker thread of each task before iterating its range of
+   * elements. Returns the user data passed to the iteration functions of that task instead of
+   * the shared one, e.g. an index buffer sub-builder.
+   */
+  ExtractTaskInitFn *task_init;
   /** Executed on one (or more if use_threading) worker thread(s). */
   ExtractTriBMeshFn *iter_looptri_bm;
   ExtractTriMeshFn *iter_looptri_mesh;
@@ -776,6 +786,11 @@ typedef struct MeshExtract {
   ExtractLEdgeMeshFn *iter_ledge_mesh;
   ExtractLVertBMeshFn *iter_lvert_bm;
   ExtractLVertMeshFn *iter_lvert_mesh;
+  /**
+   * Merges and frees the user data returned by #task_init once its range has been iterated.
+   * Calls are serialized, but may happen on any worker thread.
+   */
+  ExtractTaskFinishFn *task_finish;
   /** Executed on one worker thread after all elements iterations. */
   ExtractFinishFn *finish;
   /** Used to request common data. */
@@ -796,6 +811,29 @@ BLI_INLINE eMRIterType mesh_extract_iter_type(const MeshExtract *ext)
 
 /** \} */
 
+/* ---------------------------------------------------------------------- */
+/** \name Index Buffer Sub-Builders
+ *
+ * Used as #MeshExtract.task_init and #MeshExtract.task_finish by index buffer extractors whose
+ * user data is a #GPUIndexBufBuilder, so that each task fills the buffer through its own
+ * sub-builder.
+ * \{ */
+
+static void *extract_elb_task_init(void *elb)
+{
+  GPUIndexBufBuilder *sub_elb = MEM_mallocN(sizeof(*sub_elb), __func__);
+  GPU_indexbuf_subbuilder_init(elb, sub_elb);
+  return sub_elb;
+}
+
+static void extract_elb_task_finish(void *elb, void *sub_elb)
+{
+  GPU_indexbuf_subbuilder_join(elb, sub_elb);
+  MEM_freeN(sub_elb);
+}
+
+/** \} */
+
 /* ---------------------------------------------------------------------- */
 /** \name Extract Triangles Indices
  * \{ */
@@ -804,6 +842,11 @@ typedef struct MeshExtract_Tri_Data {
   GPUIndexBufBuilder elb;
   int *tri_mat_start;
   int *tri_mat_end;
+  /**
+   * Index of the first triangle of each visible polygon in the index buffer. Triangles are
+   * written at fixed positions so that ranges of loop triangles can be extracted in parallel.
+   */
+  int *poly_tri_first;
 } MeshExtract_Tri_Data;
 
 static void *extract_tris_init(const MeshRenderData *mr,
@@ -815,6 +858,7 @@ static void *extract_tris_init(const MeshRenderData *mr,
   size_t mat_tri_idx_size = sizeof(int) * mr->mat_len;
   data->tri_mat_start = MEM_callocN(mat_tri_idx_size, __func__);
   data->tri_mat_end = MEM_callocN(mat_tri_idx_size, __func__);
+  data->poly_tri_first = MEM_mallocN(sizeof(int) * mr->poly_len, __func__);
 
   int *mat_tri_len = data->tri_mat_start;
   /* Count how many triangle for each material. */
@@ -848,25 +892,70 @@ static void *extract_tris_init(const MeshRenderData *mr,
 
   memcpy(data->tri_mat_end, mat_tri_len, mat_tri_idx_size);
 
+  /* Assign the triangles of each polygon, in order, after the previous ones of its material.
+   * This gives the same layout as a serial extraction, and leaves `tri_mat_end` at the end of
+   * each material range. */
+  int *mat_tri_ofs = data->tri_mat_end;
+  if (mr->extract_type == MR_EXTRACT_BMESH) {
+    BMIter iter;
+    BMFace *efa;
+    int f_index;
+    BM_ITER_MESH_INDEX (efa, &iter, mr->bm, BM_FACES_OF_MESH, f_index) {
+      if (!BM_elem_flag_test(efa, BM_ELEM_HIDDEN)) {
+        int mat = min_ii(efa->mat_nr, mr->mat_len - 1);
+        data->poly_tri_first[f_index] = mat_tri_ofs[mat];
+        mat_tri_ofs[mat] += efa->len - 2;
+      }
+    }
+  }
+  else {
+    const MPoly *mp = mr->mpoly;
+    for (int mp_index = 0; mp_index < mr->poly_len; mp_index++, mp++) {
+      if (!(mr->use_hide && (mp->flag & ME_HIDE))) {
+        int mat = min_ii(mp->mat_nr, mr->mat_len - 1);
+        data->poly_tri_first[mp_index] = mat_tri_ofs[mat];
+        mat_tri_ofs[mat] += mp->totloop - 2;
+      }
+    }
+  }
+
   int visible_tri_tot = ofs;
   GPU_indexbuf_init(&data->elb, GPU_PRIM_TRIS, visible_tri_tot, mr->loop_len);
 
   return data;
 }
 
-static void extract_tris_iter_looptri_bm(const MeshRenderData *mr,
+static void *extract_tris_task_init(void *_data)
+{
+  MeshExtract_Tri_Data *data = _data;
+  MeshExtract_Tri_Data *task_data = MEM_mallocN(sizeof(*task_data), __func__);
+  *task_data = *data;
+  GPU_indexbuf_subbuilder_init(&data->elb, &task_data->elb);
+  return task_data;
+}
+
+static void extract_tris_task_finish(void *_data, void *_task_data)
+{
+  MeshExtract_Tri_Data *data = _data;
+  MeshExtract_Tri_Data *task_data = _task_data;
+  GPU_indexbuf_subbuilder_join(&data->elb, &task_data->elb);
+  MEM_freeN(task_data);
+}
+
+static void extract_tris_iter_looptri_bm(const MeshRenderData *UNUSED(mr),
                                          const struct ExtractTriBMesh_Params *params,
                                          void *_data)
 {
   MeshExtract_Tri_Data *data = _data;
-  const int mat_last = mr->mat_len - 1;
-  EXTRACT_TRIS_LOOPTRI_FOREACH_BM_BEGIN(elt, _elt_index, params)
+  EXTRACT_TRIS_LOOPTRI_FOREACH_BM_BEGIN(elt, elt_index, params)
   {
-    if (!BM_elem_flag_test(elt[0]->f, BM_ELEM_HIDDEN)) {
-      int *mat_tri_ofs = data->tri_mat_end;
-      const int mat = min_ii(elt[0]->f->mat_nr, mat_last);
+    BMFace *f = elt[0]->f;
+    if (!BM_elem_flag_test(f, BM_ELEM_HIDDEN)) {
+      /* Loop triangles of a face start at the index of its first loop minus two per face. */
+      const int f_index = BM_elem_index_get(f);
+      const int f_looptri_first = BM_elem_index_get(BM_FACE_FIRST_LOOP(f)) - (f_index * 2);
       GPU_indexbuf_set_tri_verts(&data->elb,
-                                 mat_tri_ofs[mat]++,
+                                 data->poly_tri_first[f_index] + (elt_index - f_looptri_first),
                                  BM_elem_index_get(elt[0]),
                                  BM_elem_index_get(elt[1]),
                                  BM_elem_index_get(elt[2]));
@@ -880,15 +969,16 @@ static void extract_tris_iter_looptri_mesh(const MeshRenderData *mr,
                                            void *_data)
 {
   MeshExtract_Tri_Data *data = _data;
-  const int mat_last = mr->mat_len - 1;
-  EXTRACT_TRIS_LOOPTRI_FOREACH_MESH_BEGIN(mlt, _mlt_index, params)
+  EXTRACT_TRIS_LOOPTRI_FOREACH_MESH_BEGIN(mlt, mlt_index, params)
   {
     const MPoly *mp = &mr->mpoly[mlt->poly];
     if (!(mr->use_hide && (mp->flag & ME_HIDE))) {
-      int *mat_tri_ofs = data->tri_mat_end;
-      const int mat = min_ii(mp->mat_nr, mat_last);
-      GPU_indexbuf_set_tri_verts(
-          &data->elb, mat_tri_ofs[mat]++, mlt->tri[0], mlt->tri[1], mlt->tri[2]);
+      const int mp_looptri_first = poly_to_tri_count(mlt->poly, mp->loopstart);
+      GPU_indexbuf_set_tri_verts(&data->elb,
+                                 data->poly_tri_first[mlt->poly] + (mlt_index - mp_looptri_first),
+                                 mlt->tri[0],
+                                 mlt->tri[1],
+                                 mlt->tri[2]);
     }
   }
   EXTRACT_TRIS_LOOPTRI_FOREACH_MESH_END;
@@ -922,16 +1012,19 @@ static void extract_tris_finish(const MeshRenderData *mr,
   }
   MEM_freeN(data->tri_mat_start);
   MEM_freeN(data->tri_mat_end);
+  MEM_freeN(data->poly_tri_first);
   MEM_freeN(data);
 }
 
 static const MeshExtract extract_tris = {
     .init = extract_tris_init,
+    .task_init = extract_tris_task_init,
     .iter_looptri_bm = extract_tris_iter_looptri_bm,
     .iter_looptri_mesh = extract_tris_iter_looptri_mesh,
+    .task_finish = extract_tris_task_finish,
     .finish = extract_tris_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -962,6 +1055,11 @@ static void extract_lines_iter_poly_bm(const MeshRenderData *mr,
     /* Use #BMLoop.prev to match mesh order (to avoid minor differences in data extraction). */
     l_iter = l_first = BM_FACE_FIRST_LOOP(f)->prev;
     do {
+      /* Edges are only written by the loop they reference, so that threads extracting different
+       * faces don't write the same edge. */
+      if (l_iter->e->l != l_iter) {
+        continue;
+      }
       if (!BM_elem_flag_test(l_iter->e, BM_ELEM_HIDDEN)) {
         GPU_indexbuf_set_line_verts(elb,
                                     BM_elem_index_get(l_iter->e),
@@ -1071,10 +1169,23 @@ static void extract_lines_finish(const MeshRenderData *UNUSED(mr),
 
 static const MeshExtract extract_lines = {
     .init = extract_lines_init,
+    .task_init = extract_elb_task_init,
     .iter_poly_bm = extract_lines_iter_poly_bm,
     .iter_poly_mesh = extract_lines_iter_poly_mesh,
     .iter_ledge_bm = extract_lines_iter_ledge_bm,
     .iter_ledge_mesh = extract_lines_iter_ledge_mesh,
+    .task_finish = extract_elb_task_finish,
+    .finish = extract_lines_finish,
+    .data_flag = 0,
+    .use_threading = true,
+};
+
+/* Every loop of an edge writes it in object mode, so the result depends on the order polygons
+ * are extracted in. Edit-mode uses a single loop per edge and can be threaded. */
+static const MeshExtract extract_lines_mesh = {
+    .init = extract_lines_init,
+    .iter_poly_mesh = extract_lines_iter_poly_mesh,
+    .iter_ledge_mesh = extract_lines_iter_ledge_mesh,
     .finish = extract_lines_finish,
     .data_flag = 0,
     .use_threading = false,
@@ -1099,19 +1210,29 @@ static void extract_lines_loose_subbuffer(const MeshRenderData *mr, struct MeshB
 static void extract_lines_with_lines_loose_finish(const MeshRenderData *mr,
                                                   struct MeshBatchCache *cache,
                                                   void *ibo,
-                                                  void *elb)
+                                                  void *data)
 {
-  GPU_indexbuf_build_in_place(elb, ibo);
+  extract_lines_finish(mr, cache, ibo, data);
   extract_lines_loose_subbuffer(mr, cache);
-  MEM_freeN(elb);
 }
 
 static const MeshExtract extract_lines_with_lines_loose = {
     .init = extract_lines_init,
+    .task_init = extract_elb_task_init,
     .iter_poly_bm = extract_lines_iter_poly_bm,
     .iter_poly_mesh = extract_lines_iter_poly_mesh,
     .iter_ledge_bm = extract_lines_iter_ledge_bm,
     .iter_ledge_mesh = extract_lines_iter_ledge_mesh,
+    .task_finish = extract_elb_task_finish,
+    .finish = extract_lines_with_lines_loose_finish,
+    .data_flag = 0,
+    .use_threading = true,
+};
+
+static const MeshExtract extract_lines_with_lines_loose_mesh = {
+    .init = extract_lines_init,
+    .iter_poly_mesh = extract_lines_iter_poly_mesh,
+    .iter_ledge_mesh = extract_lines_iter_ledge_mesh,
     .finish = extract_lines_with_lines_loose_finish,
     .data_flag = 0,
     .use_threading = false,
@@ -1238,6 +1359,7 @@ static void extract_points_finish(const MeshRenderData *UNUSED(mr),
   MEM_freeN(elb);
 }
 
+/* Every loop of a vertex writes it, the last one in extraction order is kept. */
 static const MeshExtract extract_points = {
     .init = extract_points_init,
     .iter_poly_bm = extract_points_iter_poly_bm,
@@ -1325,11 +1447,13 @@ static void extract_fdots_finish(const MeshRenderData *UNUSED(mr),
 
 static const MeshExtract extract_fdots = {
     .init = extract_fdots_init,
+    .task_init = extract_elb_task_init,
     .iter_poly_bm = extract_fdots_iter_poly_bm,
     .iter_poly_mesh = extract_fdots_iter_poly_mesh,
+    .task_finish = extract_elb_task_finish,
     .finish = extract_fdots_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -3864,6 +3988,18 @@ static void *extract_stretch_angle_init(const MeshRenderData *mr,
   return data;
 }
 
+/* The edge vectors are scratch data carried from one loop of a face to the next, give each task
+ * its own copy so that ranges of faces can be extracted in parallel. */
+static void *extract_stretch_angle_task_init(void *data)
+{
+  return MEM_dupallocN(data);
+}
+
+static void extract_stretch_angle_task_finish(void *UNUSED(data), void *task_data)
+{
+  MEM_freeN(task_data);
+}
+
 static void extract_stretch_angle_iter_poly_bm(const MeshRenderData *mr,
                                                const ExtractPolyBMesh_Params *params,
                                                void *_data)
@@ -3965,11 +4101,13 @@ static void extract_stretch_angle_finish(const MeshRenderData *UNUSED(mr),
 
 static const MeshExtract extract_stretch_angle = {
     .init = extract_stretch_angle_init,
+    .task_init = extract_stretch_angle_task_init,
     .iter_poly_bm = extract_stretch_angle_iter_poly_bm,
     .iter_poly_mesh = extract_stretch_angle_iter_poly_mesh,
+    .task_finish = extract_stretch_angle_task_finish,
     .finish = extract_stretch_angle_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -5235,6 +5373,8 @@ static const MeshExtract extract_fdot_idx = {
  * \{ */
 typedef struct ExtractUserData {
   void *user_data;
+  /** Serializes #MeshExtract.task_finish calls of the tasks sharing this user data. */
+  SpinLock task_finish_lock;
 } ExtractUserData;
 
 typedef enum ExtractTaskDataType {
@@ -5278,6 +5418,7 @@ static ExtractTaskData *extract_task_data_create_mesh_extract(const MeshRenderDa
    * This structure makes sure that when extract_init is called, that the user data of all
    * iterations are updated. */
   taskdata->user_data = MEM_callocN(sizeof(ExtractUserData), __func__);
+  BLI_spin_init(&taskdata->user_data->task_finish_lock);
   taskdata->iter_type = mesh_extract_iter_type(extract);
   taskdata->task_counter = task_counter;
   taskdata->start = 0;
@@ -5298,7 +5439,10 @@ static ExtractTaskData *extract_task_data_create_lines_loose(const MeshRenderDat
 static void extract_task_data_free(void *data)
 {
   ExtractTaskData *task_data = data;
-  MEM_SAFE_FREE(task_data->user_data);
+  if (task_data->user_data) {
+    BLI_spin_end(&task_data->user_data->task_finish_lock);
+    MEM_freeN(task_data->user_data);
+  }
   MEM_freeN(task_data);
 }
 
@@ -5391,12 +5535,18 @@ static void extract_run(void *__restrict taskdata)
 {
   ExtractTaskData *data = (ExtractTaskData *)taskdata;
   if (data->tasktype == EXTRACT_MESH_EXTRACT) {
-    mesh_extract_iter(data->mr,
-                      data->iter_type,
-                      data->start,
-                      data->end,
-                      data->extract,
-                      data->user_data->user_data);
+    const MeshExtract *extract = data->extract;
+    void *user_data = data->user_data->user_data;
+    void *task_user_data = extract->task_init ? extract->task_init(user_data) : user_data;
+
+    mesh_extract_iter(
+        data->mr, data->iter_type, data->start, data->end, extract, task_user_data);
+
+    if (extract->task_finish) {
+      BLI_spin_lock(&data->user_data->task_finish_lock);
+      extract->task_finish(user_data, task_user_data);
+      BLI_spin_unlock(&data->user_data->task_finish_lock);
+    }
 
     /* If this is the last task, we do the finish function. */
     int remainin_tasks = atomic_sub_and_fetch_int32(data->task_counter, 1);
@@ -5565,6 +5715,16 @@ static void extract_range_task_create(struct TaskGraph *task_graph,
   BLI_task_graph_edge_create(task_node_user_data_init, task_node);
 }
 
+#ifdef WITH_OPENGL_DRAW_TESTS
+/* Tests compare the threaded extraction against the extraction done on a single thread. */
+static bool extract_use_threading_gtests = true;
+
+void DRW_mesh_extract_use_threading_set_gtests(bool use_threading)
+{
+  extract_use_threading_gtests = use_threading;
+}
+#endif
+
 static void extract_task_create(struct TaskGraph *task_graph,
                                 struct TaskNode *task_node_mesh_render_data,
                                 struct TaskNode *task_node_user_data_init,
@@ -5585,6 +5745,14 @@ static void extract_task_create(struct TaskGraph *task_graph,
   if (do_hq_normals && (extract == &extract_tan)) {
     extract = &extract_tan_hq;
   }
+  if (mr->extract_type != MR_EXTRACT_BMESH) {
+    if (extract == &extract_lines) {
+      extract = &extract_lines_mesh;
+    }
+    else if (extract == &extract_lines_with_lines_loose) {
+      extract = &extract_lines_with_lines_loose_mesh;
+    }
+  }
 
   /* Divide extraction of the VBO/IBO into sensible chunks of works. */
   ExtractTaskData *taskdata = extract_task_data_create_mesh_extract(
@@ -5592,7 +5760,10 @@ static void extract_task_create(struct TaskGraph *task_graph,
 
   /* Simple heuristic. */
   const int chunk_size = 8192;
-  const bool use_thread = (mr->loop_len + mr->loop_loose_len) > chunk_size;
+  bool use_thread = (mr->loop_len + mr->loop_loose_len) > chunk_size;
+#ifdef WITH_OPENGL_DRAW_TESTS
+  use_thread = use_thread && extract_use_threading_gtests;
+#endif
   if (use_thread && extract->use_threading) {
 
     /* Divide task into sensible chunks. */
@@ -602,6 +602,57 @@ static void mesh_batch_cache_discard_uvedit(MeshBatchCache *cache)
   mesh_batch_cache_discard_surface_batches(cache);
 }
 
+/* Polygons with more than 4 sides are triangulated using the vertex positions. */
+static bool mesh_has_ngons(const Mesh *me)
+{
+  for (int i = 0; i < me->totpoly; i++) {
+    if (me->mpoly[i].totloop > 4) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Only vertex positions changed: discard the buffers derived from them, index buffers and
+ * attributes only depending on topology are kept and the batches are rebuilt around them.
+ * The triangulation of n-gons depends on the positions, so with n-gons the index buffers
+ * built from the triangles are discarded too. */
+static void mesh_batch_cache_discard_deform(const Mesh *me, MeshBatchCache *cache)
+{
+  if (mesh_has_ngons(me)) {
+    FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.tris);
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.lines_adjacency);
+    }
+    for (int i = 0; i < cache->mat_len; i++) {
+      GPU_INDEXBUF_DISCARD_SAFE(cache->final.tris_per_mat[i]);
+    }
+  }
+
+  FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edge_fac);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.tan);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.orco);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_area);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_angle);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.mesh_analysis);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_pos);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_nor);
+  }
+  for (int i = 0; i < sizeof(cache->batch) / sizeof(void *); i++) {
+    GPUBatch **batch = (GPUBatch **)&cache->batch;
+    GPU_BATCH_DISCARD_SAFE(batch[i]);
+  }
+  mesh_batch_cache_discard_surface_batches(cache);
+
+  cache->tot_area = 0.0f;
+  cache->tot_uv_area = 0.0f;
+
+  cache->batch_ready = 0;
+}
+
 static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
 {
   FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
@@ -667,6 +718,9 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
     case BKE_MESH_BATCH_DIRTY_ALL:
       cache->is_dirty = true;
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      mesh_batch_cache_discard_deform(me, cache);
+      break;
     case BKE_MESH_BATCH_DIRTY_SHADING:
       mesh_batch_cache_discard_shaded_tri(cache);
       mesh_batch_cache_discard_uvedit(cache);
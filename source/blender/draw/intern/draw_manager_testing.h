@@ -32,6 +32,7 @@ extern "C" {
 
 #ifdef WITH_OPENGL_DRAW_TESTS
 void DRW_draw_state_init_gtests(eGPUShaderConfig sh_cfg);
+void DRW_mesh_extract_use_threading_set_gtests(bool use_threading);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,209 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_math_matrix.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BKE_editmesh.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+
+#include "GPU_batch.h"
+#include "gpu_testing.hh"
+
+#include "bmesh.h"
+
+#include "intern/draw_cache_extract.h"
+#include "intern/draw_manager_testing.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::draw::tests {
+
+using blender::bke::tests::mesh_grid_create;
+
+/* Buffers extracted to draw the mesh surface and its wire-frame. */
+struct ExtractedMeshBuffers {
+  GPUVertBuf *pos_nor, *lnor, *edit_data;
+  GPUIndexBuf *tris, *lines, *points, *fdots;
+};
+
+/* Checks the mesh extraction split in chunks over several threads gives the same buffers as
+ * the extraction done on a single thread, in object and edit mode. Runs headless, the buffers
+ * are compared before being uploaded. */
+class DrawCacheExtractMeshTest : public blender::gpu::GPUTest {
+ protected:
+  void SetUp() override
+  {
+    GPUTest::SetUp();
+    BLI_threadapi_init();
+  }
+
+  void TearDown() override
+  {
+    DRW_mesh_extract_use_threading_set_gtests(true);
+    BLI_threadapi_exit();
+    GPUTest::TearDown();
+  }
+
+  static Mesh *mesh_create(const int size)
+  {
+    Mesh *me = mesh_grid_create(size);
+    for (int i = 0; i < me->totedge; i++) {
+      me->medge[i].flag = ME_EDGEDRAW | ME_EDGERENDER;
+    }
+    BKE_mesh_calc_normals(me);
+    return me;
+  }
+
+  static BMEditMesh *editmesh_create(Mesh *me)
+  {
+    const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(me);
+    struct BMeshCreateParams bmesh_create_params = {0};
+    BMesh *bm = BM_mesh_create(&allocsize, &bmesh_create_params);
+
+    struct BMeshFromMeshParams bmesh_from_mesh_params = {0};
+    bmesh_from_mesh_params.calc_face_normal = true;
+    BM_mesh_bm_from_me(bm, me, &bmesh_from_mesh_params);
+
+    BMEditMesh *em = BKE_editmesh_create(bm, true);
+    em->mesh_eval_final = me;
+    em->mesh_eval_cage = me;
+    return em;
+  }
+
+  static ExtractedMeshBuffers extract_mesh(Mesh *me,
+                                           const bool is_editmode,
+                                           const bool use_threading)
+  {
+    Scene scene = {};
+    ToolSettings ts = {};
+    MeshBatchCache cache = {};
+    DRW_MeshCDMask cd_used = {};
+    float obmat[4][4];
+    unit_m4(obmat);
+
+    MeshBufferCache &mbc = cache.final;
+    mbc.vbo.pos_nor = GPU_vertbuf_calloc();
+    mbc.vbo.lnor = GPU_vertbuf_calloc();
+    mbc.ibo.tris = GPU_indexbuf_calloc();
+    mbc.ibo.lines = GPU_indexbuf_calloc();
+    mbc.ibo.points = GPU_indexbuf_calloc();
+    mbc.ibo.fdots = GPU_indexbuf_calloc();
+    if (is_editmode) {
+      mbc.vbo.edit_data = GPU_vertbuf_calloc();
+    }
+
+    DRW_mesh_extract_use_threading_set_gtests(use_threading);
+
+    struct TaskGraph *task_graph = BLI_task_graph_create();
+    mesh_buffer_cache_create_requested(task_graph,
+                                       &cache,
+                                       mbc,
+                                       me,
+                                       is_editmode,
+                                       false,
+                                       false,
+                                       obmat,
+                                       true,
+                                       false,
+                                       false,
+                                       &cd_used,
+                                       &scene,
+                                       &ts,
+                                       true);
+    BLI_task_graph_work_and_wait(task_graph);
+    BLI_task_graph_free(task_graph);
+
+    EXPECT_TRUE(GPU_indexbuf_is_init(mbc.ibo.tris));
+    EXPECT_TRUE(GPU_indexbuf_is_init(mbc.ibo.lines));
+    EXPECT_TRUE(GPU_indexbuf_is_init(mbc.ibo.points));
+    EXPECT_TRUE(GPU_indexbuf_is_init(mbc.ibo.fdots));
+
+    return {mbc.vbo.pos_nor,
+            mbc.vbo.lnor,
+            mbc.vbo.edit_data,
+            mbc.ibo.tris,
+            mbc.ibo.lines,
+            mbc.ibo.points,
+            mbc.ibo.fdots};
+  }
+
+  static void buffers_free(ExtractedMeshBuffers &buffers)
+  {
+    GPU_VERTBUF_DISCARD_SAFE(buffers.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(buffers.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(buffers.edit_data);
+    GPU_INDEXBUF_DISCARD_SAFE(buffers.tris);
+    GPU_INDEXBUF_DISCARD_SAFE(buffers.lines);
+    GPU_INDEXBUF_DISCARD_SAFE(buffers.points);
+    GPU_INDEXBUF_DISCARD_SAFE(buffers.fdots);
+  }
+
+  static void expect_vertbuf_eq(const GPUVertBuf *a, const GPUVertBuf *b)
+  {
+    if (a == nullptr || b == nullptr) {
+      EXPECT_EQ(a, b);
+      return;
+    }
+    const uint len = GPU_vertbuf_get_vertex_len(a);
+    ASSERT_EQ(len, GPU_vertbuf_get_vertex_len(b));
+    const uint stride = GPU_vertbuf_get_format(a)->stride;
+    ASSERT_EQ(stride, GPU_vertbuf_get_format(b)->stride);
+    ASSERT_NE(GPU_vertbuf_get_data(a), nullptr);
+    EXPECT_EQ(memcmp(GPU_vertbuf_get_data(a), GPU_vertbuf_get_data(b), size_t(len) * stride), 0);
+  }
+
+  static void expect_indexbuf_eq(const GPUIndexBuf *a, const GPUIndexBuf *b)
+  {
+    const uint size = GPU_indexbuf_get_size(a);
+    ASSERT_EQ(size, GPU_indexbuf_get_size(b));
+    ASSERT_NE(GPU_indexbuf_get_data(a), nullptr);
+    EXPECT_EQ(memcmp(GPU_indexbuf_get_data(a), GPU_indexbuf_get_data(b), size), 0);
+  }
+
+  static void expect_extraction_eq(Mesh *me, const bool is_editmode)
+  {
+    ExtractedMeshBuffers single = extract_mesh(me, is_editmode, false);
+    ExtractedMeshBuffers threaded = extract_mesh(me, is_editmode, true);
+
+    expect_vertbuf_eq(single.pos_nor, threaded.pos_nor);
+    expect_vertbuf_eq(single.lnor, threaded.lnor);
+    expect_vertbuf_eq(single.edit_data, threaded.edit_data);
+    expect_indexbuf_eq(single.tris, threaded.tris);
+    expect_indexbuf_eq(single.lines, threaded.lines);
+    expect_indexbuf_eq(single.points, threaded.points);
+    expect_indexbuf_eq(single.fdots, threaded.fdots);
+
+    buffers_free(single);
+    buffers_free(threaded);
+  }
+};
+
+TEST_F(DrawCacheExtractMeshTest, threaded_extraction_matches_single_thread)
+{
+  /* Enough loops to be split in several chunks of 8192. */
+  Mesh *me = mesh_create(128);
+  expect_extraction_eq(me, false);
+
+  BMEditMesh *em = editmesh_create(me);
+  me->edit_mesh = em;
+  expect_extraction_eq(me, true);
+  me->edit_mesh = nullptr;
+
+  em->mesh_eval_final = em->mesh_eval_cage = nullptr;
+  BKE_editmesh_free(em);
+  MEM_freeN(em);
+  BKE_id_free(nullptr, me);
+}
+
+}  // namespace blender::draw::tests
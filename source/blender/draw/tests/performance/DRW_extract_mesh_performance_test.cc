@@ -0,0 +1,173 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_math_matrix.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BKE_editmesh.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+
+#include "GPU_batch.h"
+#include "GPU_context.h"
+#include "GPU_init_exit.h"
+
+#include "GHOST_C-api.h"
+
+#include "bmesh.h"
+
+#include "PIL_time.h"
+
+#include "intern/draw_cache_extract.h"
+#include "intern/draw_manager_testing.h"
+
+#include "mesh_test_utils.hh"
+
+using blender::bke::tests::mesh_grid_create;
+
+/* Benchmark of the mesh extraction done when drawing a large mesh, in object and edit mode,
+ * on a single thread and split over several threads. Runs headless, only the GPU buffers are
+ * created. */
+class DrawExtractMeshPerformanceTest : public ::testing::Test {
+ protected:
+  GHOST_SystemHandle ghost_system;
+  GHOST_ContextHandle ghost_context;
+  struct GPUContext *context;
+
+  void SetUp() override
+  {
+    GHOST_GLSettings glSettings = {0};
+    ghost_system = GHOST_CreateSystem();
+    ghost_context = GHOST_CreateOpenGLContext(ghost_system, glSettings);
+    context = GPU_context_create(NULL);
+    GPU_init();
+    BLI_threadapi_init();
+  }
+
+  void TearDown() override
+  {
+    DRW_mesh_extract_use_threading_set_gtests(true);
+    BLI_threadapi_exit();
+    GPU_exit();
+    GPU_backend_exit();
+    GPU_context_discard(context);
+    GHOST_DisposeOpenGLContext(ghost_system, ghost_context);
+    GHOST_DisposeSystem(ghost_system);
+  }
+
+  static BMEditMesh *editmesh_create(Mesh *me)
+  {
+    const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(me);
+    struct BMeshCreateParams bmesh_create_params = {0};
+    BMesh *bm = BM_mesh_create(&allocsize, &bmesh_create_params);
+
+    struct BMeshFromMeshParams bmesh_from_mesh_params = {0};
+    bmesh_from_mesh_params.calc_face_normal = true;
+    BM_mesh_bm_from_me(bm, me, &bmesh_from_mesh_params);
+
+    BMEditMesh *em = BKE_editmesh_create(bm, true);
+    em->mesh_eval_final = me;
+    em->mesh_eval_cage = me;
+    return em;
+  }
+
+  /* Extract the buffers needed to draw the mesh surface and its wire-frame, and return the
+   * time it took. */
+  static double extract_mesh(Mesh *me, const bool is_editmode, const bool use_threading)
+  {
+    Scene scene = {};
+    ToolSettings ts = {};
+    MeshBatchCache cache = {};
+    DRW_MeshCDMask cd_used = {};
+    float obmat[4][4];
+    unit_m4(obmat);
+
+    MeshBufferCache &mbc = cache.final;
+    mbc.vbo.pos_nor = GPU_vertbuf_calloc();
+    mbc.vbo.lnor = GPU_vertbuf_calloc();
+    mbc.ibo.tris = GPU_indexbuf_calloc();
+    mbc.ibo.lines = GPU_indexbuf_calloc();
+    mbc.ibo.points = GPU_indexbuf_calloc();
+    mbc.ibo.fdots = GPU_indexbuf_calloc();
+    if (is_editmode) {
+      mbc.vbo.edit_data = GPU_vertbuf_calloc();
+    }
+
+    DRW_mesh_extract_use_threading_set_gtests(use_threading);
+
+    const double time_start = PIL_check_seconds_timer();
+
+    struct TaskGraph *task_graph = BLI_task_graph_create();
+    mesh_buffer_cache_create_requested(task_graph,
+                                       &cache,
+                                       mbc,
+                                       me,
+                                       is_editmode,
+                                       false,
+                                       false,
+                                       obmat,
+                                       true,
+                                       false,
+                                       false,
+                                       &cd_used,
+                                       &scene,
+                                       &ts,
+                                       true);
+    BLI_task_graph_work_and_wait(task_graph);
+    BLI_task_graph_free(task_graph);
+
+    const double time_total = PIL_check_seconds_timer() - time_start;
+
+    GPU_VERTBUF_DISCARD_SAFE(mbc.vbo.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbc.vbo.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(mbc.vbo.edit_data);
+    GPU_INDEXBUF_DISCARD_SAFE(mbc.ibo.tris);
+    GPU_INDEXBUF_DISCARD_SAFE(mbc.ibo.lines);
+    GPU_INDEXBUF_DISCARD_SAFE(mbc.ibo.points);
+    GPU_INDEXBUF_DISCARD_SAFE(mbc.ibo.fdots);
+
+    return time_total;
+  }
+
+  static void print_extract_times(Mesh *me, const bool is_editmode)
+  {
+    const double time_single = extract_mesh(me, is_editmode, false);
+    const double time_threaded = extract_mesh(me, is_editmode, true);
+    printf("%s mode extraction: %d faces in %.4fs single threaded, %.4fs threaded\n",
+           is_editmode ? "Edit" : "Object",
+           me->totpoly,
+           time_single,
+           time_threaded);
+  }
+};
+
+TEST_F(DrawExtractMeshPerformanceTest, extract_large_mesh)
+{
+  /* A bit over 4 million faces. */
+  Mesh *me = mesh_grid_create(2048);
+  for (int i = 0; i < me->totedge; i++) {
+    me->medge[i].flag = ME_EDGEDRAW | ME_EDGERENDER;
+  }
+  BKE_mesh_calc_normals(me);
+
+  print_extract_times(me, false);
+
+  BMEditMesh *em = editmesh_create(me);
+  me->edit_mesh = em;
+  print_extract_times(me, true);
+  me->edit_mesh = nullptr;
+
+  em->mesh_eval_final = em->mesh_eval_cage = nullptr;
+  BKE_editmesh_free(em);
+  MEM_freeN(em);
+  BKE_id_free(nullptr, me);
+}
@@ -619,6 +619,12 @@ typedef struct SculptUndoNode {
   /* Sculpt Face Sets */
   int *face_sets;
 
+  /* Once the undo step is finished the per vertex arrays above are moved into a de-duplicating
+   * array store, they are only expanded again while the step is being restored. */
+  struct {
+    struct BArrayState *co, *orig_co, *col, *mask, *index;
+  } store;
+
   size_t undo_size;
 } SculptUndoNode;
 
@@ -1099,6 +1105,8 @@ SculptUndoNode *SCULPT_undo_get_first_node(void);
 void SCULPT_undo_push_begin(struct Object *ob, const char *name);
 void SCULPT_undo_push_end(void);
 void SCULPT_undo_push_end_ex(const bool use_nested_undo);
+void SCULPT_undo_free_list(ListBase *lb);
+size_t SCULPT_undo_arraystore_compact(ListBase *nodes, const ListBase *nodes_ref);
 
 void SCULPT_vertcos_to_key(Object *ob, KeyBlock *kb, const float (*vertCos)[3]);
 
@@ -70,6 +70,15 @@
 #include "bmesh.h"
 #include "sculpt_intern.h"
 
+#define USE_ARRAY_STORE
+
+#ifdef USE_ARRAY_STORE
+#  include "BLI_array_store.h"
+#  include "BLI_array_store_utils.h"
+/* Same as edit-mesh undo, small enough for a stroke touching part of a node to share chunks. */
+#  define ARRAY_CHUNK_SIZE 256
+#endif
+
 /* Implementation of undo system for objects in sculpt mode.
  *
  * Each undo step in sculpt mode consists of list of nodes, each node contains:
@@ -117,6 +126,252 @@ typedef struct UndoSculpt {
 
 static UndoSculpt *sculpt_undo_get_nodes(void);
 
+#ifdef USE_ARRAY_STORE
+
+/* -------------------------------------------------------------------- */
+/** \name Array Store
+ *
+ * The coordinates, masks and colors of a finished undo step are moved into a de-duplicating
+ * array store, using the node of the previous step for the same PBVH node as a reference.
+ * A stroke usually only changes part of the nodes it touches, so most chunks are shared with
+ * the previous steps. The arrays are only expanded while the step is restored.
+ * \{ */
+
+static struct {
+  struct BArrayStore_AtSize bs_stride;
+  /* Number of nodes with data in the store, it's cleared when this reaches zero. */
+  int users;
+} sculpt_arraystore = {{NULL}};
+
+static void sculpt_arraystore_array_compact(void **data_p,
+                                            BArrayState **state_p,
+                                            const int data_len,
+                                            const size_t stride,
+                                            const BArrayState *state_reference)
+{
+  if (*data_p == NULL) {
+    return;
+  }
+  BLI_assert(*state_p == NULL);
+
+  BArrayStore *bs = BLI_array_store_at_size_ensure(
+      &sculpt_arraystore.bs_stride, stride, ARRAY_CHUNK_SIZE);
+  *state_p = BLI_array_store_state_add(bs, *data_p, (size_t)data_len * stride, state_reference);
+
+  MEM_freeN(*data_p);
+  *data_p = NULL;
+}
+
+static void sculpt_arraystore_array_expand(void **data_p, BArrayState *state)
+{
+  if (state == NULL) {
+    return;
+  }
+  BLI_assert(*data_p == NULL);
+
+  size_t data_len;
+  *data_p = BLI_array_store_state_data_get_alloc(state, &data_len);
+}
+
+static void sculpt_arraystore_array_remove(BArrayState **state_p, const size_t stride)
+{
+  if (*state_p == NULL) {
+    return;
+  }
+  BArrayStore *bs = BLI_array_store_at_size_get(&sculpt_arraystore.bs_stride, stride);
+  BLI_array_store_state_remove(bs, *state_p);
+  *state_p = NULL;
+}
+
+static bool sculpt_arraystore_node_has_arrays(const SculptUndoNode *unode)
+{
+  return unode->co || unode->orig_co || unode->col || unode->mask || unode->index;
+}
+
+static bool sculpt_arraystore_node_has_states(const SculptUndoNode *unode)
+{
+  return unode->store.co || unode->store.orig_co || unode->store.col || unode->store.mask ||
+         unode->store.index;
+}
+
+/* Only the first `totvert` elements are used once the stroke is done,
+ * the remaining ones (non-unique vertices of regular meshes) are not stored. */
+static void sculpt_arraystore_node_compact(SculptUndoNode *unode, const SculptUndoNode *unode_ref)
+{
+  const int data_len = unode->totvert;
+
+  sculpt_arraystore_array_compact((void **)&unode->co,
+                                  &unode->store.co,
+                                  data_len,
+                                  sizeof(*unode->co),
+                                  unode_ref ? unode_ref->store.co : NULL);
+  sculpt_arraystore_array_compact((void **)&unode->orig_co,
+                                  &unode->store.orig_co,
+                                  data_len,
+                                  sizeof(*unode->orig_co),
+                                  unode_ref ? unode_ref->store.orig_co : NULL);
+  sculpt_arraystore_array_compact((void **)&unode->col,
+                                  &unode->store.col,
+                                  data_len,
+                                  sizeof(*unode->col),
+                                  unode_ref ? unode_ref->store.col : NULL);
+  sculpt_arraystore_array_compact((void **)&unode->mask,
+                                  &unode->store.mask,
+                                  data_len,
+                                  sizeof(*unode->mask),
+                                  unode_ref ? unode_ref->store.mask : NULL);
+  sculpt_arraystore_array_compact((void **)&unode->index,
+                                  &unode->store.index,
+                                  data_len,
+                                  sizeof(*unode->index),
+                                  unode_ref ? unode_ref->store.index : NULL);
+}
+
+static void sculpt_arraystore_node_expand(SculptUndoNode *unode)
+{
+  sculpt_arraystore_array_expand((void **)&unode->co, unode->store.co);
+  sculpt_arraystore_array_expand((void **)&unode->orig_co, unode->store.orig_co);
+  sculpt_arraystore_array_expand((void **)&unode->col, unode->store.col);
+  sculpt_arraystore_array_expand((void **)&unode->mask, unode->store.mask);
+  sculpt_arraystore_array_expand((void **)&unode->index, unode->store.index);
+}
+
+static void sculpt_arraystore_node_states_remove(SculptUndoNode *unode)
+{
+  sculpt_arraystore_array_remove(&unode->store.co, sizeof(*unode->co));
+  sculpt_arraystore_array_remove(&unode->store.orig_co, sizeof(*unode->orig_co));
+  sculpt_arraystore_array_remove(&unode->store.col, sizeof(*unode->col));
+  sculpt_arraystore_array_remove(&unode->store.mask, sizeof(*unode->mask));
+  sculpt_arraystore_array_remove(&unode->store.index, sizeof(*unode->index));
+}
+
+/* Store the expanded arrays of a node again after restoring it,
+ * restoring swaps the data so it now holds the state to redo to. */
+static void sculpt_arraystore_node_recompact(SculptUndoNode *unode)
+{
+  if (!sculpt_arraystore_node_has_states(unode)) {
+    return;
+  }
+
+  SculptUndoNode unode_prev;
+  unode_prev.store = unode->store;
+  memset(&unode->store, 0, sizeof(unode->store));
+
+  sculpt_arraystore_node_compact(unode, &unode_prev);
+  sculpt_arraystore_node_states_remove(&unode_prev);
+}
+
+static void sculpt_arraystore_node_free(SculptUndoNode *unode)
+{
+  if (!sculpt_arraystore_node_has_states(unode)) {
+    return;
+  }
+
+  sculpt_arraystore_node_states_remove(unode);
+
+  sculpt_arraystore.users -= 1;
+  BLI_assert(sculpt_arraystore.users >= 0);
+
+  if (sculpt_arraystore.users == 0) {
+    BLI_array_store_at_size_clear(&sculpt_arraystore.bs_stride);
+  }
+}
+
+/* Memory used by the data of a node that is not moved into the store. */
+static size_t sculpt_arraystore_node_unstored_size(const SculptUndoNode *unode)
+{
+  const void *arrays[] = {
+      unode->co,
+      unode->orig_co,
+      unode->col,
+      unode->mask,
+      unode->index,
+      unode->no,
+      unode->grids,
+      unode->vert_hidden,
+      unode->grid_hidden,
+      unode->face_sets,
+  };
+  size_t size = 0;
+  for (int i = 0; i < ARRAY_SIZE(arrays); i++) {
+    if (arrays[i] != NULL) {
+      size += MEM_allocN_len(arrays[i]);
+    }
+  }
+  if (unode->grid_hidden != NULL) {
+    for (int i = 0; i < unode->totgrid; i++) {
+      if (unode->grid_hidden[i] != NULL) {
+        size += MEM_allocN_len(unode->grid_hidden[i]);
+      }
+    }
+  }
+  return size;
+}
+
+/**
+ * Move the arrays of all nodes of a finished step into the store.
+ * The size of the step is the memory the store grew by plus the data kept outside of it
+ * (normals, hidden flags, face sets), so the undo memory limit applies to the de-duplicated
+ * data.
+ *
+ * \param nodes_ref: Nodes of the previous step typically, can be NULL.
+ * \return The size of the step.
+ */
+size_t SCULPT_undo_arraystore_compact(ListBase *nodes, const ListBase *nodes_ref)
+{
+  size_t size_expanded_prev, size_compacted_prev;
+  BLI_array_store_at_size_calc_memory_usage(
+      &sculpt_arraystore.bs_stride, &size_expanded_prev, &size_compacted_prev);
+
+  /* Nodes of the reference step by PBVH node, the pointer is only used as a key since the
+   * PBVH may have been rebuilt since, in that case the reference is just less effective. */
+  GHash *unode_ref_map = NULL;
+  if (nodes_ref != NULL) {
+    unode_ref_map = BLI_ghash_ptr_new_ex(__func__, BLI_listbase_count(nodes_ref));
+    LISTBASE_FOREACH (SculptUndoNode *, unode_ref, nodes_ref) {
+      if (unode_ref->node && sculpt_arraystore_node_has_states(unode_ref)) {
+        BLI_ghash_reinsert(unode_ref_map, unode_ref->node, unode_ref, NULL, NULL);
+      }
+    }
+  }
+
+  size_t size = 0;
+  bool is_compacted = false;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, nodes) {
+    if (sculpt_arraystore_node_has_arrays(unode)) {
+      const SculptUndoNode *unode_ref = NULL;
+      if (unode_ref_map != NULL) {
+        unode_ref = BLI_ghash_lookup(unode_ref_map, unode->node);
+        if (unode_ref &&
+            (unode_ref->type != unode->type || !STREQ(unode_ref->idname, unode->idname))) {
+          unode_ref = NULL;
+        }
+      }
+
+      sculpt_arraystore_node_compact(unode, unode_ref);
+      sculpt_arraystore.users += 1;
+      is_compacted = true;
+    }
+    size += sculpt_arraystore_node_unstored_size(unode);
+  }
+
+  if (unode_ref_map != NULL) {
+    BLI_ghash_free(unode_ref_map, NULL, NULL);
+  }
+
+  if (is_compacted) {
+    size_t size_expanded, size_compacted;
+    BLI_array_store_at_size_calc_memory_usage(
+        &sculpt_arraystore.bs_stride, &size_expanded, &size_compacted);
+    size += size_compacted - size_compacted_prev;
+  }
+  return size;
+}
+
+/** \} */
+
+#endif /* USE_ARRAY_STORE */
+
 static void update_cb(PBVHNode *node, void *rebuild)
 {
   BKE_pbvh_node_mark_update(node);
@@ -704,6 +959,10 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
       use_multires_undo = true;
     }
 
+#ifdef USE_ARRAY_STORE
+    sculpt_arraystore_node_expand(unode);
+#endif
+
     switch (unode->type) {
       case SCULPT_UNDO_COORDS:
         if (sculpt_undo_restore_coords(C, depsgraph, unode)) {
@@ -741,6 +1000,10 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
         BLI_assert(!"Dynamic topology should've already been handled");
         break;
     }
+
+#ifdef USE_ARRAY_STORE
+    sculpt_arraystore_node_recompact(unode);
+#endif
   }
 
   if (use_multires_undo) {
@@ -823,11 +1086,14 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
   MEM_SAFE_FREE(undo_modified_grids);
 }
 
-static void sculpt_undo_free_list(ListBase *lb)
+void SCULPT_undo_free_list(ListBase *lb)
 {
   SculptUndoNode *unode = lb->first;
   while (unode != NULL) {
     SculptUndoNode *unode_next = unode->next;
+#ifdef USE_ARRAY_STORE
+    sculpt_arraystore_node_free(unode);
+#endif
     if (unode->co) {
       MEM_freeN(unode->co);
     }
@@ -1163,11 +1429,10 @@ static SculptUndoNode *sculpt_undo_face_sets_push(Object *ob, SculptUndoType typ
   return unode;
 }
 
-static SculptUndoNode *sculpt_undo_bmesh_push(Object *ob, PBVHNode *node, SculptUndoType type)
+static SculptUndoNode *sculpt_undo_bmesh_push(Object *ob, SculptUndoType type)
 {
   UndoSculpt *usculpt = sculpt_undo_get_nodes();
   SculptSession *ss = ob->sculpt;
-  PBVHVertexIter vd;
 
   SculptUndoNode *unode = usculpt->nodes.first;
 
@@ -1201,6 +1466,16 @@ static SculptUndoNode *sculpt_undo_bmesh_push(Object *ob, PBVHNode *node, Sculpt
     BLI_addtail(&usculpt->nodes, unode);
   }
 
+  return unode;
+}
+
+/* Log the elements of a PBVH node before they are modified.
+ * The #BMLog supports this from multiple threads, so it runs without holding the undo lock. */
+static void sculpt_undo_bmesh_push_node(Object *ob, PBVHNode *node, SculptUndoType type)
+{
+  SculptSession *ss = ob->sculpt;
+  PBVHVertexIter vd;
+
   if (node) {
     switch (type) {
       case SCULPT_UNDO_COORDS:
@@ -1239,8 +1514,6 @@ static SculptUndoNode *sculpt_undo_bmesh_push(Object *ob, PBVHNode *node, Sculpt
         break;
     }
   }
-
-  return unode;
 }
 
 SculptUndoNode *SCULPT_undo_push_node(Object *ob, PBVHNode *node, SculptUndoType type)
@@ -1256,8 +1529,9 @@ SculptUndoNode *SCULPT_undo_push_node(Object *ob, PBVHNode *node, SculptUndoType
   if (ss->bm || ELEM(type, SCULPT_UNDO_DYNTOPO_BEGIN, SCULPT_UNDO_DYNTOPO_END)) {
     /* Dynamic topology stores only one undo node per stroke,
      * regardless of the number of PBVH nodes modified. */
-    unode = sculpt_undo_bmesh_push(ob, node, type);
+    unode = sculpt_undo_bmesh_push(ob, type);
     BLI_thread_unlock(LOCK_CUSTOM1);
+    sculpt_undo_bmesh_push_node(ob, node, type);
     return unode;
   }
   if (type == SCULPT_UNDO_GEOMETRY) {
@@ -1405,6 +1679,21 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
   /* Dummy, encoding is done along the way by adding tiles
    * to the current 'SculptUndoStep' added by encode_init. */
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+
+#ifdef USE_ARRAY_STORE
+  {
+    /* Steps after the active one have been freed already, so it's the step the new one follows. */
+    UndoStack *ustack = ED_undo_stack_get();
+    const UndoStep *us_ref = ustack->step_active;
+    const UndoSculpt *usculpt_ref = (us_ref && us_ref != us_p &&
+                                     us_ref->type == BKE_UNDOSYS_TYPE_SCULPT) ?
+                                        &((const SculptUndoStep *)us_ref)->data :
+                                        NULL;
+    us->data.undo_size = SCULPT_undo_arraystore_compact(
+        &us->data.nodes, usculpt_ref ? &usculpt_ref->nodes : NULL);
+  }
+#endif
+
   us->step.data_size = us->data.undo_size;
 
   SculptUndoNode *unode = us->data.nodes.last;
@@ -1527,7 +1816,7 @@ static void sculpt_undosys_step_decode(
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
-  sculpt_undo_free_list(&us->data.nodes);
+  SCULPT_undo_free_list(&us->data.nodes);
 }
 
 void ED_sculpt_undo_geometry_begin(struct Object *ob, const char *name)
@@ -0,0 +1,93 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_listbase.h"
+#include "BLI_rand.h"
+#include "BLI_string.h"
+
+#include "DNA_scene_types.h"
+
+extern "C" {
+#include "sculpt_intern.h"
+}
+
+namespace blender::ed::sculpt_paint::tests {
+
+static const int totvert = 10000;
+static const int totpoly = 1000;
+
+/* Undo node of a stroke on a PBVH node, the key is only used to find the node of the
+ * previous step. */
+static SculptUndoNode *undo_node_create(PBVHNode *node_key, const int seed)
+{
+  SculptUndoNode *unode = static_cast<SculptUndoNode *>(MEM_callocN(sizeof(*unode), __func__));
+  BLI_strncpy(unode->idname, "OBTest", sizeof(unode->idname));
+  unode->type = SCULPT_UNDO_COORDS;
+  unode->node = node_key;
+  unode->totvert = totvert;
+
+  unode->co = static_cast<float(*)[3]>(MEM_malloc_arrayN(totvert, sizeof(*unode->co), __func__));
+  BLI_array_frand(&unode->co[0][0], totvert * 3, seed);
+  unode->index = static_cast<int *>(MEM_malloc_arrayN(totvert, sizeof(int), __func__));
+  for (int i = 0; i < totvert; i++) {
+    unode->index[i] = i;
+  }
+
+  unode->no = static_cast<short(*)[3]>(MEM_calloc_arrayN(totvert, sizeof(*unode->no), __func__));
+  unode->vert_hidden = BLI_BITMAP_NEW(totvert, __func__);
+  unode->face_sets = static_cast<int *>(MEM_calloc_arrayN(totpoly, sizeof(int), __func__));
+  return unode;
+}
+
+static size_t undo_node_unstored_size(const SculptUndoNode *unode)
+{
+  return MEM_allocN_len(unode->no) + MEM_allocN_len(unode->vert_hidden) +
+         MEM_allocN_len(unode->face_sets);
+}
+
+TEST(sculpt_undo, arraystore_size)
+{
+  static char node_key_data;
+  PBVHNode *node_key = reinterpret_cast<PBVHNode *>(&node_key_data);
+
+  /* Random coordinates can't be de-duplicated, the whole arrays are stored. The normals,
+   * hidden flags and face sets are not stored but still count. */
+  ListBase nodes_a = {nullptr, nullptr};
+  SculptUndoNode *unode_a = undo_node_create(node_key, 1);
+  BLI_addtail(&nodes_a, unode_a);
+  const size_t unstored_size_a = undo_node_unstored_size(unode_a);
+  const size_t size_a = SCULPT_undo_arraystore_compact(&nodes_a, nullptr);
+  EXPECT_EQ(unode_a->co, nullptr);
+  EXPECT_EQ(unode_a->index, nullptr);
+  EXPECT_GE(size_a, unstored_size_a + sizeof(float[3]) * totvert);
+
+  /* The same coordinates in the next step are shared with the previous one. */
+  ListBase nodes_b = {nullptr, nullptr};
+  SculptUndoNode *unode_b = undo_node_create(node_key, 1);
+  BLI_addtail(&nodes_b, unode_b);
+  const size_t unstored_size_b = undo_node_unstored_size(unode_b);
+  const size_t size_b = SCULPT_undo_arraystore_compact(&nodes_b, &nodes_a);
+  EXPECT_GE(size_b, unstored_size_b);
+  EXPECT_LT(size_b - unstored_size_b, sizeof(float[3]) * totvert / 10);
+
+  /* Different coordinates are stored again, the vertex indices are still shared. */
+  ListBase nodes_c = {nullptr, nullptr};
+  SculptUndoNode *unode_c = undo_node_create(node_key, 2);
+  BLI_addtail(&nodes_c, unode_c);
+  const size_t unstored_size_c = undo_node_unstored_size(unode_c);
+  const size_t size_c = SCULPT_undo_arraystore_compact(&nodes_c, &nodes_b);
+  EXPECT_GE(size_c, unstored_size_c + sizeof(float[3]) * totvert);
+  EXPECT_LT(size_c, size_a);
+
+  SCULPT_undo_free_list(&nodes_c);
+  SCULPT_undo_free_list(&nodes_b);
+  SCULPT_undo_free_list(&nodes_a);
+}
+
+}  // namespace blender::ed::sculpt_paint::tests
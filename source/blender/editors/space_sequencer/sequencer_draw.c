@@ -2064,10 +2064,15 @@ typedef struct CacheDrawData {
   GPUVertBuf *preprocessed_vbo;
   GPUVertBuf *composite_vbo;
   GPUVertBuf *final_out_vbo;
+  GPUVertBuf *render_time_vbo;
   size_t raw_vert_count;
   size_t preprocessed_vert_count;
   size_t composite_vert_count;
   size_t final_out_vert_count;
+  size_t render_time_vert_count;
+  /* Bottom and height of the render time graph, height corresponds to one frame duration. */
+  float render_time_bot;
+  float render_time_ht;
 } CacheDrawData;
 
 /* Called as a callback. */
@@ -2084,13 +2089,32 @@ static bool draw_cache_view_init_fn(void *userdata, size_t item_count)
   GPU_vertbuf_data_alloc(drawdata->preprocessed_vbo, max_vert_count);
   GPU_vertbuf_data_alloc(drawdata->composite_vbo, max_vert_count);
   GPU_vertbuf_data_alloc(drawdata->final_out_vbo, max_vert_count);
+  GPU_vertbuf_data_alloc(drawdata->render_time_vbo, max_vert_count);
 
   return false;
 }
 
+static void draw_cache_view_add_quad(
+    GPUVertBuf *vbo, size_t *vert_count, float x1, float y1, float x2, float y2)
+{
+  float vert_pos[6][2];
+  copy_v2_fl2(vert_pos[0], x1, y1);
+  copy_v2_fl2(vert_pos[1], x1, y2);
+  copy_v2_fl2(vert_pos[2], x2, y2);
+  copy_v2_v2(vert_pos[3], vert_pos[2]);
+  copy_v2_v2(vert_pos[4], vert_pos[0]);
+  copy_v2_fl2(vert_pos[5], x2, y1);
+
+  for (int i = 0; i < 6; i++) {
+    GPU_vertbuf_vert_set(vbo, *vert_count + i, vert_pos[i]);
+  }
+
+  *vert_count += 6;
+}
+
 /* Called as a callback */
 static bool draw_cache_view_iter_fn(
-    void *userdata, struct Sequence *seq, int timeline_frame, int cache_type, float UNUSED(cost))
+    void *userdata, struct Sequence *seq, int timeline_frame, int cache_type, float cost)
 {
   CacheDrawData *drawdata = userdata;
   struct View2D *v2d = drawdata->v2d;
@@ -2098,6 +2122,18 @@ static bool draw_cache_view_iter_fn(
   GPUVertBuf *vbo;
   size_t *vert_count;
 
+  if ((cache_type & SEQ_CACHE_STORE_FINAL_OUT) &&
+      (drawdata->cache_flag & SEQ_CACHE_VIEW_RENDER_TIME)) {
+    /* Cost is render time relative to the frame duration, clamp so slow frames stay visible. */
+    const float bar_ht = min_ff(cost, 2.0f) * drawdata->render_time_ht;
+    draw_cache_view_add_quad(drawdata->render_time_vbo,
+                             &drawdata->render_time_vert_count,
+                             timeline_frame,
+                             drawdata->render_time_bot,
+                             timeline_frame + 1,
+                             drawdata->render_time_bot + bar_ht);
+  }
+
   if ((cache_type & SEQ_CACHE_STORE_FINAL_OUT) &&
       (drawdata->cache_flag & SEQ_CACHE_VIEW_FINAL_OUT)) {
     stripe_ht = UI_view2d_region_to_view_y(v2d, 4.0f * UI_DPI_FAC * U.pixelsize) - v2d->cur.ymin;
@@ -2136,19 +2172,8 @@ static bool draw_cache_view_iter_fn(
     return false;
   }
 
-  float vert_pos[6][2];
-  copy_v2_fl2(vert_pos[0], timeline_frame, stripe_bot);
-  copy_v2_fl2(vert_pos[1], timeline_frame, stripe_top);
-  copy_v2_fl2(vert_pos[2], timeline_frame + 1, stripe_top);
-  copy_v2_v2(vert_pos[3], vert_pos[2]);
-  copy_v2_v2(vert_pos[4], vert_pos[0]);
-  copy_v2_fl2(vert_pos[5], timeline_frame + 1, stripe_bot);
-
-  for (int i = 0; i < 6; i++) {
-    GPU_vertbuf_vert_set(vbo, *vert_count + i, vert_pos[i]);
-  }
-
-  *vert_count += 6;
+  draw_cache_view_add_quad(
+      vbo, vert_count, timeline_frame, stripe_bot, timeline_frame + 1, stripe_top);
   return false;
 }
 
@@ -2196,6 +2221,22 @@ static void draw_cache_view(const bContext *C)
     immRectf(pos, scene->r.sfra, stripe_bot, scene->r.efra, stripe_top);
   }
 
+  const float render_time_bot = UI_view2d_region_to_view_y(v2d, V2D_SCROLL_HANDLE_HEIGHT) +
+                                stripe_ht + stripe_offs;
+  const float render_time_ht = UI_view2d_region_to_view_y(v2d, 24.0f * UI_DPI_FAC) -
+                               v2d->cur.ymin;
+
+  if (scene->ed->cache_flag & SEQ_CACHE_VIEW_RENDER_TIME) {
+    /* Line marking the time budget of one frame. */
+    const float line_ht = UI_view2d_region_to_view_y(v2d, U.pixelsize) - v2d->cur.ymin;
+    immUniformColor4f(1.0f, 1.0f, 1.0f, 0.3f);
+    immRectf(pos,
+             scene->r.sfra,
+             render_time_bot + render_time_ht,
+             scene->r.efra,
+             render_time_bot + render_time_ht + line_ht);
+  }
+
   for (Sequence *seq = scene->ed->seqbasep->first; seq != NULL; seq = seq->next) {
     if (seq->type == SEQ_TYPE_SOUND_RAM) {
       continue;
@@ -2247,10 +2288,14 @@ static void draw_cache_view(const bContext *C)
   userdata.preprocessed_vert_count = 0;
   userdata.composite_vert_count = 0;
   userdata.final_out_vert_count = 0;
+  userdata.render_time_vert_count = 0;
+  userdata.render_time_bot = render_time_bot;
+  userdata.render_time_ht = render_time_ht;
   userdata.raw_vbo = GPU_vertbuf_create_with_format(&format);
   userdata.preprocessed_vbo = GPU_vertbuf_create_with_format(&format);
   userdata.composite_vbo = GPU_vertbuf_create_with_format(&format);
   userdata.final_out_vbo = GPU_vertbuf_create_with_format(&format);
+  userdata.render_time_vbo = GPU_vertbuf_create_with_format(&format);
 
   BKE_sequencer_cache_iterate(scene, &userdata, draw_cache_view_init_fn, draw_cache_view_iter_fn);
 
@@ -2261,6 +2306,8 @@ static void draw_cache_view(const bContext *C)
       userdata.composite_vbo, userdata.composite_vert_count, 1.0f, 0.6f, 0.0f, 0.4f);
   draw_cache_view_batch(
       userdata.final_out_vbo, userdata.final_out_vert_count, 1.0f, 0.4f, 0.2f, 0.4f);
+  draw_cache_view_batch(
+      userdata.render_time_vbo, userdata.render_time_vert_count, 0.2f, 0.8f, 0.3f, 0.5f);
 
   GPU_blend(GPU_BLEND_NONE);
 }
@@ -50,6 +50,15 @@ void GPU_indexbuf_init_ex(GPUIndexBufBuilder *, GPUPrimType, uint index_len, uin
 /* supports only GPU_PRIM_POINTS, GPU_PRIM_LINES and GPU_PRIM_TRIS. */
 void GPU_indexbuf_init(GPUIndexBufBuilder *, GPUPrimType, uint prim_len, uint vertex_len);
 
+/* Sub-builders share the data of their parent builder, so that several threads can fill
+ * distinct elements of the same index buffer using the `GPU_indexbuf_set_*` functions.
+ * Each sub-builder must be joined back into its parent before building. Joining is not
+ * thread-safe. */
+void GPU_indexbuf_subbuilder_init(const GPUIndexBufBuilder *parent_builder,
+                                  GPUIndexBufBuilder *sub_builder);
+void GPU_indexbuf_subbuilder_join(GPUIndexBufBuilder *parent_builder,
+                                  const GPUIndexBufBuilder *sub_builder);
+
 void GPU_indexbuf_add_generic_vert(GPUIndexBufBuilder *, uint v);
 void GPU_indexbuf_add_primitive_restart(GPUIndexBufBuilder *);
 
@@ -81,6 +90,11 @@ void GPU_indexbuf_discard(GPUIndexBuf *elem);
 
 bool GPU_indexbuf_is_init(GPUIndexBuf *elem);
 
+/* Indices waiting to be uploaded, in the compressed index type, NULL once sent to VRAM.
+ * The size in bytes of the drawable range is returned by #GPU_indexbuf_get_size. */
+const void *GPU_indexbuf_get_data(const GPUIndexBuf *elem);
+uint GPU_indexbuf_get_size(const GPUIndexBuf *elem);
+
 int GPU_indexbuf_primitive_len(GPUPrimType prim_type);
 
 /* Macros */
@@ -66,6 +66,20 @@ void GPU_indexbuf_init(GPUIndexBufBuilder *builder,
   GPU_indexbuf_init_ex(builder, prim_type, prim_len * (uint)verts_per_prim, vertex_len);
 }
 
+void GPU_indexbuf_subbuilder_init(const GPUIndexBufBuilder *parent_builder,
+                                  GPUIndexBufBuilder *sub_builder)
+{
+  *sub_builder = *parent_builder;
+  sub_builder->index_len = 0;
+}
+
+void GPU_indexbuf_subbuilder_join(GPUIndexBufBuilder *parent_builder,
+                                  const GPUIndexBufBuilder *sub_builder)
+{
+  BLI_assert(parent_builder->data == sub_builder->data);
+  parent_builder->index_len = MAX2(parent_builder->index_len, sub_builder->index_len);
+}
+
 void GPU_indexbuf_add_generic_vert(GPUIndexBufBuilder *builder, uint v)
 {
 #if TRUST_NO_ONE
@@ -361,6 +375,16 @@ bool GPU_indexbuf_is_init(GPUIndexBuf *elem)
   return unwrap(elem)->is_init();
 }
 
+const void *GPU_indexbuf_get_data(const GPUIndexBuf *elem)
+{
+  return unwrap(elem)->data_get();
+}
+
+uint GPU_indexbuf_get_size(const GPUIndexBuf *elem)
+{
+  return unwrap(elem)->size_get();
+}
+
 int GPU_indexbuf_primitive_len(GPUPrimType prim_type)
 {
   return indices_per_primitive(prim_type);
@@ -81,7 +81,7 @@ class IndexBuf {
     return index_len_;
   }
   /* Return size in byte of the drawable data buffer range. Actual buffer size might be bigger. */
-  size_t size_get(void)
+  size_t size_get(void) const
   {
     return index_len_ * to_bytesize(index_type_);
   };
@@ -90,6 +90,11 @@ class IndexBuf {
   {
     return is_init_;
   };
+  /* Indices not yet sent to VRAM, NULL for subranges or once uploaded. */
+  const void *data_get(void) const
+  {
+    return is_subrange_ ? nullptr : data_;
+  };
 
  private:
   inline void squeeze_indices_short(uint min_idx, uint max_idx);
@@ -105,6 +110,10 @@ static inline IndexBuf *unwrap(GPUIndexBuf *indexbuf)
 {
   return reinterpret_cast<IndexBuf *>(indexbuf);
 }
+static inline const IndexBuf *unwrap(const GPUIndexBuf *indexbuf)
+{
+  return reinterpret_cast<const IndexBuf *>(indexbuf);
+}
 
 static inline int indices_per_primitive(GPUPrimType prim_type)
 {
@@ -122,6 +122,20 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ * Same as #IMB_loadiffname, but of multilayer OpenEXR files only the passes selected with
+ * \a layname and \a passname are decoded: all passes of the layer when \a passname is NULL,
+ * none when \a layname is NULL. The layer and pass list is complete, passes which are not
+ * decoded have no pixels.
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_loadiffname_passes(const char *filepath,
+                                     int flags,
+                                     char colorspace[IM_MAX_SPACE],
+                                     const char *layname,
+                                     const char *passname);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -462,6 +476,34 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/* Reconstruction filters for #IMB_scaleImBuf_filter. */
+typedef enum eIMBScaleFilter {
+  /* Same result as #IMB_scaleImBuf. */
+  IMB_SCALE_FILTER_DEFAULT = 0,
+  IMB_SCALE_FILTER_BOX,
+  IMB_SCALE_FILTER_BILINEAR,
+  IMB_SCALE_FILTER_MITCHELL,
+  IMB_SCALE_FILTER_LANCZOS3,
+} eIMBScaleFilter;
+
+/**
+ * Separable, multi-threaded resampling of byte and float buffers with the given filter.
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf,
+                           unsigned int newx,
+                           unsigned int newy,
+                           eIMBScaleFilter filter);
+
+/**
+ * Filter chosen in the preferences, used for thumbnails, proxies and sequencer previews.
+ *
+ * \attention Defined in scaling.c
+ */
+void IMB_scale_filter_preference_set(eIMBScaleFilter filter);
+eIMBScaleFilter IMB_scale_filter_preference_get(void);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -136,6 +136,10 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* The demuxer had a seek index for the video stream when opened. Used to start decoding from
+   * the nearest key frame when seeking. */
+  int use_keyframe_index;
 #endif
 
   char index_dir[768];
@@ -53,8 +53,10 @@
 #  include <io.h>
 #endif
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "MEM_guardedalloc.h"
@@ -500,11 +502,36 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+/* Frame threading delays output by one frame per thread, which has to be decoded again after each
+ * seek. Keep the number of threads small, so random access stays responsive. */
+#  define FFMPEG_DECODE_THREADS_MAX 8
+
 BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 {
   return (anim->x & 31) != 0;
 }
 
+/* Containers with a seek index (MP4, MOV, MKV, ...) have it filled on open, so seeking to key
+ * frames doesn't need to read the file. Other formats fall back to the preseek heuristic or to
+ * time code indices built with proxies. */
+static bool ffmpeg_has_keyframe_index(struct anim *anim)
+{
+  AVStream *v_st = anim->pFormatCtx->streams[anim->videoStream];
+  return avformat_index_get_entries_count(v_st) > 0 &&
+         av_index_search_timestamp(v_st, INT64_MAX, AVSEEK_FLAG_BACKWARD) >= 0;
+}
+
+/* Time stamp of the last key frame in the seek index with a time stamp not greater than `ts`,
+ * AV_NOPTS_VALUE if there is none. Index time stamps are decoding time stamps. */
+static int64_t ffmpeg_keyframe_dts_find(struct anim *anim, int64_t ts)
+{
+  AVStream *v_st = anim->pFormatCtx->streams[anim->videoStream];
+  const int index = av_index_search_timestamp(v_st, ts, AVSEEK_FLAG_BACKWARD);
+  const AVIndexEntry *entry = avformat_index_get_entry(v_st, index);
+
+  return (entry != NULL) ? entry->timestamp : AV_NOPTS_VALUE;
+}
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -573,6 +600,14 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  pCodecCtx->thread_count = min_ii(BLI_system_thread_count(), FFMPEG_DECODE_THREADS_MAX);
+  if (pCodec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_FRAME;
+  }
+  else if (pCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -641,6 +676,8 @@ static int startffmpeg(struct anim *anim)
   anim->next_pts = -1;
   anim->next_packet.stream_index = -1;
 
+  anim->use_keyframe_index = ffmpeg_has_keyframe_index(anim);
+
   anim->pFrame = av_frame_alloc();
   anim->pFrameComplete = false;
   anim->pFrameDeinterlaced = av_frame_alloc();
@@ -1048,6 +1085,83 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
+static void ffmpeg_decoder_reset(struct anim *anim)
+{
+  avcodec_flush_buffers(anim->pCodecCtx);
+
+  anim->next_pts = -1;
+
+  if (anim->next_packet.stream_index == anim->videoStream) {
+    av_free_packet(&anim->next_packet);
+    anim->next_packet.stream_index = -1;
+  }
+}
+
+/**
+ * Decode frame with `pts_to_search` starting from the nearest key frame.
+ *
+ * The seek index holds decoding time stamps, which can't be compared with presentation time
+ * stamps directly. A frame is never decoded after it is presented though, so its key frame is the
+ * last one with a decoding time stamp not greater than the decoding time stamp of the frame,
+ * which in turn is not greater than `pts_to_search`. When that key frame turns out to be after
+ * the frame, decoding starts from the previous one.
+ */
+static void ffmpeg_seek_to_keyframe(struct anim *anim, int64_t pts_to_search)
+{
+  AVStream *v_st = anim->pFormatCtx->streams[anim->videoStream];
+  int64_t keyframe_dts = ffmpeg_keyframe_dts_find(anim, pts_to_search);
+
+  if (keyframe_dts == AV_NOPTS_VALUE) {
+    /* Frame is before the first key frame in the index, start from that one. */
+    const int index = av_index_search_timestamp(v_st, pts_to_search, 0);
+    keyframe_dts = avformat_index_get_entry(v_st, index)->timestamp;
+  }
+
+  /* Key frame of the frame was already read, continue decoding. Compares the decoding time stamp
+   * of the last read packet with the one of the key frame. */
+  if (anim->next_pts != -1 && anim->next_pts <= pts_to_search &&
+      anim->next_packet.stream_index == anim->videoStream &&
+      anim->next_packet.dts != AV_NOPTS_VALUE && keyframe_dts <= anim->next_packet.dts) {
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within current GOP (keyframe index)\n");
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    return;
+  }
+
+  while (true) {
+    int ret = av_seek_frame(
+        anim->pFormatCtx, anim->videoStream, keyframe_dts, AVSEEK_FLAG_BACKWARD);
+
+    av_log(anim->pFormatCtx,
+           AV_LOG_DEBUG,
+           "FETCH: seek to keyframe dts = %lld\n",
+           (long long)keyframe_dts);
+
+    ffmpeg_decoder_reset(anim);
+
+    if (ret < 0) {
+      av_log(anim->pFormatCtx,
+             AV_LOG_ERROR,
+             "FETCH: error while seeking to keyframe dts = %lld: errcode = %d\n",
+             (long long)keyframe_dts,
+             ret);
+      return;
+    }
+
+    if (!ffmpeg_decode_video_frame(anim)) {
+      return;
+    }
+
+    /* With reordered frames, key frame can be presented after the frame we look for. In that
+     * case, start from the previous key frame. */
+    const int64_t prev_keyframe_dts = ffmpeg_keyframe_dts_find(anim, keyframe_dts - 1);
+    if (anim->next_pts <= pts_to_search || prev_keyframe_dts == AV_NOPTS_VALUE) {
+      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+      return;
+    }
+    keyframe_dts = prev_keyframe_dts;
+  }
+}
+
 static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
 {
   int64_t pts_to_search = 0;
@@ -1109,8 +1223,12 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     return anim->last_frame;
   }
 
-  if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
-      position - (anim->curposition + 1) < anim->preseek) {
+  if (!tc_index && anim->use_keyframe_index && position != anim->curposition + 1 &&
+      !(position == 0 && anim->curposition == -1)) {
+    ffmpeg_seek_to_keyframe(anim, pts_to_search);
+  }
+  else if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
+           position - (anim->curposition + 1) < anim->preseek) {
     av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval (no index)\n");
 
     ffmpeg_decode_video_frame_scan(anim, pts_to_search);
@@ -1181,14 +1299,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
              ret);
     }
 
-    avcodec_flush_buffers(anim->pCodecCtx);
-
-    anim->next_pts = -1;
-
-    if (anim->next_packet.stream_index == anim->videoStream) {
-      av_free_packet(&anim->next_packet);
-      anim->next_packet.stream_index = -1;
-    }
+    ffmpeg_decoder_reset(anim);
 
     /* memset(anim->pFrame, ...) ?? */
 
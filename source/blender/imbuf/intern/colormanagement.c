@@ -42,6 +42,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
@@ -61,6 +63,10 @@
 
 #include <ocio_capi.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Global declarations
  * \{ */
@@ -100,9 +106,32 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* 3D LUT with the display transform baked in, see #display_lut_acquire. */
+typedef struct ColormanageDisplayLUT {
+  struct ColormanageDisplayLUT *next, *prev;
+
+  /* Settings the LUT is baked for. */
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure, gamma;
+
+  /* Number of processors using this LUT. */
+  int users;
+
+  /* DISPLAY_LUT_SIZE^3 RGBA nodes, blue varies fastest. NULL until the first bake finished,
+   * set with #atomic_cas_ptr since baking happens outside of #display_lut_lock. */
+  float *table;
+} ColormanageDisplayLUT;
+
+/* Baked LUTs, least recently used first. */
+static ListBase global_display_luts = {NULL, NULL};
+static pthread_mutex_t display_lut_lock = BLI_MUTEX_INITIALIZER;
+
 typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
   CurveMapping *curve_mapping;
+  ColormanageDisplayLUT *display_lut;
   bool is_data_result;
 } ColormanageProcessor;
 
@@ -469,6 +498,293 @@ static void colormanage_cache_handle_release(void *cache_handle)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Baked Display LUT
+ *
+ * Display transforms can be expensive to evaluate per pixel. When the view settings ask for it,
+ * the display transform is baked into a 3D LUT indexed by scene linear RGB through a logarithmic
+ * shaper, and evaluated with tetrahedral interpolation. LUTs are shared between processors with
+ * the same settings and are kept around for a few settings changes.
+ * \{ */
+
+#define DISPLAY_LUT_SIZE 65
+/* Maximum number of cached LUTs, unused LUTs are freed beyond this. */
+#define DISPLAY_LUT_CACHE_MAX 4
+
+/* The shaper maps `log2(x + 2^offset)` from [offset, max] to the LUT nodes, which covers
+ * scene linear values from 0 to 2^max. Values outside of this range are clamped. */
+#define DISPLAY_LUT_SHAPER_LOG2_OFFSET -12.0f
+#define DISPLAY_LUT_SHAPER_LOG2_MAX 8.0f
+#define DISPLAY_LUT_SHAPER_SCALE \
+  ((DISPLAY_LUT_SIZE - 1) / (DISPLAY_LUT_SHAPER_LOG2_MAX - DISPLAY_LUT_SHAPER_LOG2_OFFSET))
+
+BLI_INLINE float display_lut_shaper(float value)
+{
+  const float offset = exp2f(DISPLAY_LUT_SHAPER_LOG2_OFFSET);
+  const float t = (log2f(max_ff(value, 0.0f) + offset) - DISPLAY_LUT_SHAPER_LOG2_OFFSET) *
+                  DISPLAY_LUT_SHAPER_SCALE;
+
+  return min_ff(t, (float)(DISPLAY_LUT_SIZE - 1));
+}
+
+BLI_INLINE float display_lut_shaper_inverse(int node)
+{
+  const float offset = exp2f(DISPLAY_LUT_SHAPER_LOG2_OFFSET);
+
+  return exp2f(node / DISPLAY_LUT_SHAPER_SCALE + DISPLAY_LUT_SHAPER_LOG2_OFFSET) - offset;
+}
+
+typedef struct DisplayLUTBakeData {
+  OCIO_ConstProcessorRcPtr *processor;
+  float *table;
+} DisplayLUTBakeData;
+
+/* Every scanline is one row of blue values of the LUT. */
+static void display_lut_bake_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  DisplayLUTBakeData *data = (DisplayLUTBakeData *)data_v;
+  float *table = data->table + (size_t)4 * DISPLAY_LUT_SIZE * start_scanline;
+  float *node = table;
+
+  for (int line = start_scanline; line < start_scanline + num_scanlines; line++) {
+    const float r = display_lut_shaper_inverse(line / DISPLAY_LUT_SIZE);
+    const float g = display_lut_shaper_inverse(line % DISPLAY_LUT_SIZE);
+
+    for (int b = 0; b < DISPLAY_LUT_SIZE; b++, node += 4) {
+      node[0] = r;
+      node[1] = g;
+      node[2] = display_lut_shaper_inverse(b);
+      node[3] = 1.0f;
+    }
+  }
+
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(table,
+                                                              DISPLAY_LUT_SIZE,
+                                                              num_scanlines,
+                                                              4,
+                                                              sizeof(float),
+                                                              4 * sizeof(float),
+                                                              4 * sizeof(float) *
+                                                                  DISPLAY_LUT_SIZE);
+  OCIO_processorApply(data->processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+static void display_lut_free(ColormanageDisplayLUT *lut)
+{
+  if (lut->table) {
+    MEM_freeN(lut->table);
+  }
+  MEM_freeN(lut);
+}
+
+static float *display_lut_bake(OCIO_ConstProcessorRcPtr *processor)
+{
+  DisplayLUTBakeData data;
+
+  data.processor = processor;
+  data.table = MEM_mallocN_aligned(sizeof(float[4]) * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE *
+                                       DISPLAY_LUT_SIZE,
+                                   16,
+                                   "colormanage display lut table");
+  IMB_processor_apply_threaded_scanlines(
+      DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE, display_lut_bake_thread_do, &data);
+
+  return data.table;
+}
+
+static void display_lut_free_all(void)
+{
+  ColormanageDisplayLUT *lut;
+
+  while ((lut = BLI_pophead(&global_display_luts))) {
+    BLI_assert(lut->users == 0);
+    display_lut_free(lut);
+  }
+}
+
+/* Get the LUT for the given settings, baking it from the processor of the full transform when it
+ * is not in the cache yet. The lock only protects the cache list, so baking doesn't block
+ * processors for other settings. Threads asking for the same settings while it is being baked
+ * bake their own copy, the first one to finish is kept. */
+static ColormanageDisplayLUT *display_lut_acquire(const ColorManagedViewSettings *view_settings,
+                                                  const char *display,
+                                                  OCIO_ConstProcessorRcPtr *processor)
+{
+  ColormanageDisplayLUT *lut;
+
+  BLI_mutex_lock(&display_lut_lock);
+
+  for (lut = global_display_luts.first; lut; lut = lut->next) {
+    if (STREQ(lut->look, view_settings->look) && STREQ(lut->view, view_settings->view_transform) &&
+        STREQ(lut->display, display) && lut->exposure == view_settings->exposure &&
+        lut->gamma == view_settings->gamma) {
+      break;
+    }
+  }
+
+  if (lut) {
+    BLI_remlink(&global_display_luts, lut);
+  }
+  else {
+    lut = MEM_callocN(sizeof(ColormanageDisplayLUT), "colormanage display lut");
+    STRNCPY(lut->look, view_settings->look);
+    STRNCPY(lut->view, view_settings->view_transform);
+    STRNCPY(lut->display, display);
+    lut->exposure = view_settings->exposure;
+    lut->gamma = view_settings->gamma;
+
+    /* Make room for the new LUT. */
+    ColormanageDisplayLUT *lut_iter = global_display_luts.first;
+    int tot_luts = BLI_listbase_count(&global_display_luts);
+    while (lut_iter && tot_luts >= DISPLAY_LUT_CACHE_MAX) {
+      ColormanageDisplayLUT *lut_next = lut_iter->next;
+      if (lut_iter->users == 0) {
+        BLI_remlink(&global_display_luts, lut_iter);
+        display_lut_free(lut_iter);
+        tot_luts--;
+      }
+      lut_iter = lut_next;
+    }
+  }
+
+  /* Users keep the LUT from being freed while it is baked and used without the lock. */
+  lut->users++;
+  BLI_addtail(&global_display_luts, lut);
+
+  BLI_mutex_unlock(&display_lut_lock);
+
+  /* Atomic read, the table may be published by another thread at any time. */
+  if (atomic_cas_ptr((void **)&lut->table, NULL, NULL) == NULL) {
+    float *table = display_lut_bake(processor);
+    if (atomic_cas_ptr((void **)&lut->table, NULL, table) != NULL) {
+      MEM_freeN(table);
+    }
+  }
+
+  return lut;
+}
+
+static void display_lut_release(ColormanageDisplayLUT *lut)
+{
+  BLI_mutex_lock(&display_lut_lock);
+  BLI_assert(lut->users > 0);
+  lut->users--;
+  BLI_mutex_unlock(&display_lut_lock);
+}
+
+/* Apply the baked transform to a scene linear RGB value. */
+BLI_INLINE void display_lut_apply_v3(const ColormanageDisplayLUT *lut, float pixel[3])
+{
+  const size_t stride_r = (size_t)4 * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+  const size_t stride_g = (size_t)4 * DISPLAY_LUT_SIZE;
+  const size_t stride_b = 4;
+  int index[3];
+  float f[3];
+
+  for (int i = 0; i < 3; i++) {
+    const float t = display_lut_shaper(pixel[i]);
+    index[i] = min_ii((int)t, DISPLAY_LUT_SIZE - 2);
+    f[i] = t - index[i];
+  }
+
+  /* Tetrahedral interpolation: the unit cube is split in six tetrahedra along its diagonal,
+   * pick the one containing the sample by ordering the fractional coordinates. */
+  const float *c0 = lut->table + index[0] * stride_r + index[1] * stride_g + index[2] * stride_b;
+  const float *c3 = c0 + stride_r + stride_g + stride_b;
+  const float *c1, *c2;
+  float w0, w1, w2, w3;
+
+  if (f[0] > f[1]) {
+    if (f[1] > f[2]) {
+      c1 = c0 + stride_r;
+      c2 = c0 + stride_r + stride_g;
+      w0 = 1.0f - f[0], w1 = f[0] - f[1], w2 = f[1] - f[2], w3 = f[2];
+    }
+    else if (f[0] > f[2]) {
+      c1 = c0 + stride_r;
+      c2 = c0 + stride_r + stride_b;
+      w0 = 1.0f - f[0], w1 = f[0] - f[2], w2 = f[2] - f[1], w3 = f[1];
+    }
+    else {
+      c1 = c0 + stride_b;
+      c2 = c0 + stride_r + stride_b;
+      w0 = 1.0f - f[2], w1 = f[2] - f[0], w2 = f[0] - f[1], w3 = f[1];
+    }
+  }
+  else {
+    if (f[2] > f[1]) {
+      c1 = c0 + stride_b;
+      c2 = c0 + stride_g + stride_b;
+      w0 = 1.0f - f[2], w1 = f[2] - f[1], w2 = f[1] - f[0], w3 = f[0];
+    }
+    else if (f[2] > f[0]) {
+      c1 = c0 + stride_g;
+      c2 = c0 + stride_g + stride_b;
+      w0 = 1.0f - f[1], w1 = f[1] - f[2], w2 = f[2] - f[0], w3 = f[0];
+    }
+    else {
+      c1 = c0 + stride_g;
+      c2 = c0 + stride_r + stride_g;
+      w0 = 1.0f - f[1], w1 = f[1] - f[0], w2 = f[0] - f[2], w3 = f[2];
+    }
+  }
+
+#ifdef __SSE2__
+  __m128 result = _mm_mul_ps(_mm_set1_ps(w0), _mm_load_ps(c0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w1), _mm_load_ps(c1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w2), _mm_load_ps(c2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w3), _mm_load_ps(c3)));
+
+  float result_v4[4];
+  _mm_storeu_ps(result_v4, result);
+  copy_v3_v3(pixel, result_v4);
+#else
+  for (int i = 0; i < 3; i++) {
+    pixel[i] = w0 * c0[i] + w1 * c1[i] + w2 * c2[i] + w3 * c3[i];
+  }
+#endif
+}
+
+/* Same as #OCIO_processorApplyRGBA_predivide. */
+BLI_INLINE void display_lut_apply_v4_predivide(const ColormanageDisplayLUT *lut, float pixel[4])
+{
+  if (pixel[3] == 1.0f || pixel[3] == 0.0f) {
+    display_lut_apply_v3(lut, pixel);
+  }
+  else {
+    const float alpha = pixel[3];
+
+    mul_v3_fl(pixel, 1.0f / alpha);
+    display_lut_apply_v3(lut, pixel);
+    mul_v3_fl(pixel, alpha);
+  }
+}
+
+static void display_lut_apply(const ColormanageDisplayLUT *lut,
+                              float *buffer,
+                              int width,
+                              int height,
+                              int channels,
+                              bool predivide)
+{
+  const size_t tot_pixels = (size_t)width * height;
+  float *pixel = buffer;
+
+  BLI_assert(channels >= 3);
+
+  for (size_t i = 0; i < tot_pixels; i++, pixel += channels) {
+    if (predivide && channels == 4) {
+      display_lut_apply_v4_predivide(lut, pixel);
+    }
+    else {
+      display_lut_apply_v3(lut, pixel);
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Initialization / De-initialization
  * \{ */
@@ -758,6 +1074,8 @@ void colormanagement_exit(void)
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  display_lut_free_all();
+
   colormanage_free_config();
 }
 
@@ -2635,9 +2953,12 @@ ImBuf *IMB_colormanagement_imbuf_for_write(ImBuf *ibuf,
       }
     }
 
-    /* perform color space conversions */
+    /* perform color space conversions, written files always use the exact transform */
+    ColorManagedViewSettings write_view_settings = *view_settings;
+    write_view_settings.flag &= ~COLORMANAGE_VIEW_USE_BAKED_LUT;
+
     colormanagement_imbuf_make_display_space(
-        colormanaged_ibuf, view_settings, display_settings, make_byte);
+        colormanaged_ibuf, &write_view_settings, display_settings, make_byte);
 
     if (colormanaged_ibuf->rect_float) {
       /* float buffer isn't linear anymore,
@@ -3841,6 +4162,11 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
                                                             global_role_scene_linear,
                                                             false);
 
+  if ((applied_view_settings->flag & COLORMANAGE_VIEW_USE_BAKED_LUT) && cm_processor->processor) {
+    cm_processor->display_lut = display_lut_acquire(
+        applied_view_settings, display_settings->display_device, cm_processor->processor);
+  }
+
   if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
     cm_processor->curve_mapping = BKE_curvemapping_copy(applied_view_settings->curve_mapping);
     BKE_curvemapping_premultiply(cm_processor->curve_mapping, false);
@@ -3871,7 +4197,10 @@ void IMB_colormanagement_processor_apply_v4(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    display_lut_apply_v3(cm_processor->display_lut, pixel);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGBA(cm_processor->processor, pixel);
   }
 }
@@ -3883,7 +4212,10 @@ void IMB_colormanagement_processor_apply_v4_predivide(ColormanageProcessor *cm_p
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    display_lut_apply_v4_predivide(cm_processor->display_lut, pixel);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGBA_predivide(cm_processor->processor, pixel);
   }
 }
@@ -3894,7 +4226,10 @@ void IMB_colormanagement_processor_apply_v3(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    display_lut_apply_v3(cm_processor->display_lut, pixel);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGB(cm_processor->processor, pixel);
   }
 }
@@ -3940,7 +4275,10 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->processor && channels >= 3) {
+  if (cm_processor->display_lut && channels >= 3) {
+    display_lut_apply(cm_processor->display_lut, buffer, width, height, channels, predivide);
+  }
+  else if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3989,6 +4327,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
@@ -0,0 +1,144 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math_base.h"
+#include "BLI_path_util.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender::imbuf::tests {
+
+/* Maximum difference between the baked LUT and the full transform, in display space. */
+#define DISPLAY_LUT_TOLERANCE (2.0f / 255.0f)
+
+class ColormanagementTest : public testing::Test {
+ protected:
+  ColorManagedDisplaySettings display_settings;
+  ColorManagedViewSettings view_settings;
+
+  static void SetUpTestCase()
+  {
+    /* Use the configuration of the build, the fallback one only has a "Standard" view. */
+    const std::string &release_dir = blender::tests::flags_test_release_dir();
+    if (release_dir.empty() || BLI_getenv("OCIO") != nullptr) {
+      return;
+    }
+
+    char configfile[FILE_MAX];
+    BLI_path_join(configfile,
+                  sizeof(configfile),
+                  release_dir.c_str(),
+                  "datafiles",
+                  "colormanagement",
+                  "config.ocio",
+                  nullptr);
+    if (BLI_exists(configfile)) {
+      BLI_setenv("OCIO", configfile);
+    }
+  }
+
+  void SetUp() override
+  {
+    IMB_init();
+
+    STRNCPY(display_settings.display_device, IMB_colormanagement_display_get_default_name());
+    IMB_colormanagement_init_default_view_settings(&view_settings, &display_settings);
+  }
+
+  void TearDown() override
+  {
+    IMB_exit();
+  }
+
+  /* Scene linear pixels spanning the range of the LUT shaper, plus zero and negative values. */
+  static float *random_pixels(int width, int height)
+  {
+    RandomNumberGenerator rng;
+    const size_t tot_pixels = (size_t)width * height;
+    float *buffer = (float *)MEM_mallocN(sizeof(float[4]) * tot_pixels, __func__);
+
+    for (size_t i = 0; i < tot_pixels; i++) {
+      for (int c = 0; c < 3; c++) {
+        buffer[4 * i + c] = powf(2.0f, rng.get_float() * 18.0f - 14.0f);
+      }
+      buffer[4 * i + 3] = 1.0f;
+    }
+    buffer[0] = 0.0f;
+    buffer[1] = -0.5f;
+
+    return buffer;
+  }
+
+  /* Apply the display transform to a copy of `buffer`, exact or with the baked LUT. */
+  float *apply_display_transform(const float *buffer, int width, int height, bool use_baked_lut)
+  {
+    float *result = (float *)MEM_dupallocN(buffer);
+
+    SET_FLAG_FROM_TEST(view_settings.flag, use_baked_lut, COLORMANAGE_VIEW_USE_BAKED_LUT);
+    ColormanageProcessor *cm_processor = IMB_colormanagement_display_processor_new(
+        &view_settings, &display_settings);
+    IMB_colormanagement_processor_apply(cm_processor, result, width, height, 4, false);
+    IMB_colormanagement_processor_free(cm_processor);
+
+    return result;
+  }
+
+  void test_display_lut_accuracy()
+  {
+    float *buffer = random_pixels(256, 256);
+    float *exact = apply_display_transform(buffer, 256, 256, false);
+    float *baked = apply_display_transform(buffer, 256, 256, true);
+
+    for (int i = 0; i < 4 * 256 * 256; i++) {
+      EXPECT_NEAR(
+          clamp_f(baked[i], 0.0f, 1.0f), clamp_f(exact[i], 0.0f, 1.0f), DISPLAY_LUT_TOLERANCE)
+          << view_settings.view_transform << ", exposure " << view_settings.exposure;
+    }
+
+    MEM_freeN(buffer);
+    MEM_freeN(exact);
+    MEM_freeN(baked);
+  }
+};
+
+TEST_F(ColormanagementTest, display_lut_accuracy)
+{
+  for (const char *view : {"Standard", "Filmic"}) {
+    if (IMB_colormanagement_view_get_named_index(view) == 0) {
+      GTEST_SKIP() << "view \"" << view << "\" not in the OCIO configuration";
+    }
+    STRNCPY(view_settings.view_transform, view);
+
+    for (const float exposure : {0.0f, 2.5f}) {
+      view_settings.exposure = exposure;
+      test_display_lut_accuracy();
+    }
+  }
+}
+
+}  // namespace blender::imbuf::tests
@@ -464,6 +464,24 @@ static int round_up(int x, int mod)
   return x + ((mod - (x % mod)) % mod);
 }
 
+/* Scaler of the filter chosen in the preferences. */
+static int proxy_sws_flags_get(void)
+{
+  switch (IMB_scale_filter_preference_get()) {
+    case IMB_SCALE_FILTER_BOX:
+      return SWS_AREA;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return SWS_BILINEAR;
+    case IMB_SCALE_FILTER_MITCHELL:
+      return SWS_BICUBIC;
+    case IMB_SCALE_FILTER_LANCZOS3:
+      return SWS_LANCZOS;
+    case IMB_SCALE_FILTER_DEFAULT:
+      break;
+  }
+  return SWS_FAST_BILINEAR;
+}
+
 static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
     struct anim *anim, AVStream *st, int proxy_size, int width, int height, int quality)
 {
@@ -556,7 +574,7 @@ static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
                                  width,
                                  height,
                                  rv->c->pix_fmt,
-                                 SWS_FAST_BILINEAR | SWS_PRINT_INFO,
+                                 proxy_sws_flags_get() | SWS_PRINT_INFO,
                                  NULL,
                                  NULL,
                                  NULL);
@@ -1114,8 +1132,14 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
         int y = anim->y * proxy_fac[i];
 
         struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
+        const eIMBScaleFilter filter = IMB_scale_filter_preference_get();
 
-        IMB_scalefastImBuf(s_ibuf, x, y);
+        if (filter == IMB_SCALE_FILTER_DEFAULT) {
+          IMB_scalefastImBuf(s_ibuf, x, y);
+        }
+        else {
+          IMB_scaleImBuf_filter(s_ibuf, x, y, filter);
+        }
 
         IMB_convert_rgba_to_abgr(s_ibuf);
 
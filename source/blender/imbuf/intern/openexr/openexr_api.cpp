@@ -78,6 +78,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 }
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
+#include "BLI_rect.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -98,6 +99,8 @@ using namespace Imath;
 extern "C" {
 /* prototype */
 static struct ExrPass *imb_exr_get_pass(ListBase *lb, char *passname);
+static bool imb_exr_build_layers(struct ExrHandle *data);
+static void imb_exr_alloc_passes(struct ExrHandle *data);
 static bool exr_has_multiview(MultiPartInputFile &file);
 static bool exr_has_multipart_file(MultiPartInputFile &file);
 static bool exr_has_alpha(MultiPartInputFile &file);
@@ -645,6 +648,12 @@ struct ExrHandle {
   ListBase layers;   /* hierarchical, pointing in end to ExrChannel */
 
   int num_half_channels; /* used during filr save, allows faster temporary buffers allocation */
+
+  /* Partial reading: only passes marked with `read_selected` and the pixels in `read_region`
+   * are loaded, see #IMB_exr_read_select_pass and #IMB_exr_read_set_region. */
+  bool use_read_selection;
+  bool use_read_region;
+  rcti read_region;
 };
 
 /* flattened out channel */
@@ -672,6 +681,8 @@ struct ExrPass {
   char internal_name[EXR_PASS_MAXNAME]; /* name with no view */
   char view[EXR_VIEW_MAXNAME];
   int view_id;
+
+  bool read_selected;
 };
 
 struct ExrLayer {
@@ -971,7 +982,7 @@ int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *heig
     /* avoid crash/abort when we don't have permission to write here */
     try {
       data->ifile_stream = new IFileStream(filename);
-      data->ifile = new MultiPartInputFile(*(data->ifile_stream));
+      data->ifile = new MultiPartInputFile(*(data->ifile_stream), globalThreadCount());
     }
     catch (const std::exception &) {
       delete data->ifile;
@@ -1008,6 +1019,57 @@ int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *heig
   return 0;
 }
 
+/* Same as #IMB_exr_begin_read, but also sorts channels into layers and passes which are
+ * allocated by #IMB_exr_read_channels. Before reading, the passes and region to load can be
+ * restricted, the result is passed on with #IMB_exr_multilayer_convert. */
+int IMB_exr_begin_read_multilayer(void *handle, const char *filename, int *width, int *height)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+
+  if (IMB_exr_begin_read(handle, filename, width, height) == 0) {
+    return 0;
+  }
+
+  return imb_exr_build_layers(data);
+}
+
+/* Only read the given pass of the layer, or all passes of the layer when passname is NULL.
+ * Can be called multiple times, passes which are not selected are not loaded. */
+void IMB_exr_read_select_pass(void *handle, const char *layname, const char *passname)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  ExrLayer *lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+
+  data->use_read_selection = true;
+
+  if (lay == nullptr) {
+    return;
+  }
+
+  LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+    if (passname == nullptr || STREQ(pass->internal_name, passname)) {
+      pass->read_selected = true;
+    }
+  }
+}
+
+/* Only read pixels inside the region, in image coordinates with the origin at the bottom left
+ * of the data window. Pass buffers get the size of the region, which is returned. */
+void IMB_exr_read_set_region(void *handle, const rcti *region, int *width, int *height)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  rcti image_rect;
+
+  BLI_rcti_init(&image_rect, 0, data->width, 0, data->height);
+  if (!BLI_rcti_isect(region, &image_rect, &data->read_region)) {
+    BLI_rcti_init(&data->read_region, 0, 0, 0, 0);
+  }
+  data->use_read_region = true;
+
+  *width = BLI_rcti_size_x(&data->read_region);
+  *height = BLI_rcti_size_y(&data->read_region);
+}
+
 /* still clumsy name handling, layers/channels can be ordered as list in list later */
 /* passname here is the raw channel name without the layer */
 void IMB_exr_set_channel(
@@ -1204,6 +1266,88 @@ void IMB_exrtile_write_channels(
   }
 }
 
+/* Lines decoded at once when reading a region, the buffer holds all channels being read. */
+#define EXR_READ_CHUNK_SIZE (64 * 1024 * 1024)
+#define EXR_READ_CHUNK_LINES_MIN 32
+#define EXR_READ_CHUNK_LINES_MAX 256
+
+/* Read the region of one part in chunks of lines. Every chunk is decoded once for all channels
+ * into a shared buffer, and the region is copied from there into the channel buffers. */
+static void imb_exr_read_part_region(ExrHandle *data,
+                                     InputPart &in,
+                                     const Box2i &dw,
+                                     const bool flip,
+                                     const std::vector<ExrChannel *> &channels)
+{
+  const rcti *region = &data->read_region;
+  const int region_width = BLI_rcti_size_x(region);
+  const int num_channels = channels.size();
+  const int dw_width = dw.max.x - dw.min.x + 1;
+  const size_t line_size = (size_t)num_channels * dw_width;
+
+  if (num_channels == 0 || region_width <= 0 || BLI_rcti_size_y(region) <= 0) {
+    return;
+  }
+
+  /* Lines in file coordinates, Blender stores images bottom to top unless flipped. */
+  int line_min, line_max;
+  if (flip) {
+    line_min = dw.min.y + region->ymin;
+    line_max = dw.min.y + region->ymax - 1;
+  }
+  else {
+    line_min = dw.min.y + data->height - region->ymax;
+    line_max = dw.min.y + data->height - 1 - region->ymin;
+  }
+
+  /* Multiple of 32 lines, so chunks start at line block boundaries of all compression types
+   * except DWAB, and large enough for the OpenEXR thread pool to decode blocks in parallel. */
+  int chunk_lines = (int)(EXR_READ_CHUNK_SIZE / (line_size * sizeof(float))) & ~31;
+  CLAMP(chunk_lines, EXR_READ_CHUNK_LINES_MIN, EXR_READ_CHUNK_LINES_MAX);
+
+  float *buffer = (float *)MEM_mallocN(sizeof(float) * line_size * chunk_lines, __func__);
+
+  for (int chunk_start = line_min - (line_min - dw.min.y) % chunk_lines; chunk_start <= line_max;
+       chunk_start += chunk_lines) {
+    const int chunk_min = std::max(chunk_start, line_min);
+    const int chunk_max = std::min(chunk_start + chunk_lines - 1, line_max);
+
+    /* Inverse correct first pixel for data-window coordinates, starting at chunk_min. */
+    float *first = buffer - ((ptrdiff_t)dw.min.x + (ptrdiff_t)chunk_min * dw_width) * num_channels;
+    FrameBuffer frameBuffer;
+
+    for (int c = 0; c < num_channels; c++) {
+      frameBuffer.insert(channels[c]->m->internal_name,
+                         Slice(Imf::FLOAT,
+                               (char *)(first + c),
+                               num_channels * sizeof(float),
+                               line_size * sizeof(float)));
+    }
+
+    in.setFrameBuffer(frameBuffer);
+    exr_printf("readPixels:readPixels: min.y: %d, max.y: %d\n", chunk_min, chunk_max);
+    in.readPixels(chunk_min, chunk_max);
+
+    for (int line = chunk_min; line <= chunk_max; line++) {
+      const int y = (flip ? line - dw.min.y : data->height - 1 - (line - dw.min.y)) -
+                    region->ymin;
+      const float *src = buffer +
+                         ((size_t)(line - chunk_min) * dw_width + region->xmin) * num_channels;
+
+      for (int c = 0; c < num_channels; c++) {
+        const ExrChannel *echan = channels[c];
+        float *dst = echan->rect + (size_t)y * echan->ystride;
+
+        for (int x = 0; x < region_width; x++) {
+          dst[(size_t)x * echan->xstride] = src[(size_t)x * num_channels + c];
+        }
+      }
+    }
+  }
+
+  MEM_freeN(buffer);
+}
+
 void IMB_exr_read_channels(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
@@ -1216,6 +1360,9 @@ void IMB_exr_read_channels(void *handle)
   /* 'previous multilayer attribute, flipped. */
   short flip = (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
 
+  /* Passes of multilayer handles are allocated here, after selecting what to read. */
+  imb_exr_alloc_passes(data);
+
   exr_printf(
       "\nIMB_exr_read_channels\n%s %-6s %-22s "
       "\"%s\"\n---------------------------------------------------------------------\n",
@@ -1232,6 +1379,7 @@ void IMB_exr_read_channels(void *handle)
 
     /* Insert all matching channel into framebuffer. */
     FrameBuffer frameBuffer;
+    std::vector<ExrChannel *> read_channels;
     ExrChannel *echan;
 
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
@@ -1250,6 +1398,8 @@ void IMB_exr_read_channels(void *handle)
         size_t xstride = echan->xstride * sizeof(float);
         size_t ystride = echan->ystride * sizeof(float);
 
+        read_channels.push_back(echan);
+
         if (!flip) {
           /* Inverse correct first pixel for data-window coordinates. */
           rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
@@ -1265,16 +1415,25 @@ void IMB_exr_read_channels(void *handle)
         frameBuffer.insert(echan->m->internal_name,
                            Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
       }
-      else {
+      else if (!data->use_read_selection) {
         printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
       }
     }
 
+    if (read_channels.empty()) {
+      continue;
+    }
+
     /* Read pixels. */
     try {
-      in.setFrameBuffer(frameBuffer);
-      exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
-      in.readPixels(dw.min.y, dw.max.y);
+      if (data->use_read_region) {
+        imb_exr_read_part_region(data, in, dw, flip, read_channels);
+      }
+      else {
+        in.setFrameBuffer(frameBuffer);
+        exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
+        in.readPixels(dw.min.y, dw.max.y);
+      }
     }
     catch (const std::exception &exc) {
       std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
@@ -1319,6 +1478,7 @@ void IMB_exr_multilayer_convert(void *handle,
     void *laybase = addlayer(base, lay->name);
     if (laybase) {
       for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+        /* Passes which were not selected for reading are passed on without pixels. */
         addpass(base,
                 laybase,
                 pass->internal_name,
@@ -1523,43 +1683,54 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
-/* creates channels, makes a hierarchy and assigns memory to channels */
-static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
-                                         MultiPartInputFile &file,
-                                         int width,
-                                         int height)
+/* Offsets of the channels in the interleaved buffer of the pass. With some heuristics RGB(A),
+ * XYZ(W) and UVA channels are sorted, unknown channels keep their order. */
+static void imb_exr_pass_channel_offsets(const ExrPass *pass, int r_offsets[EXR_PASS_MAXCHAN])
 {
-  ExrLayer *lay;
-  ExrPass *pass;
-  ExrChannel *echan;
-  ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
   int a;
-  char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
-  data->ifile_stream = &file_stream;
-  data->ifile = &file;
+  if (ELEM(pass->totchan, 3, 4)) {
+    char lookup[256];
 
-  data->width = width;
-  data->height = height;
+    memset(lookup, 0, sizeof(lookup));
 
-  std::vector<MultiViewChannelName> channels;
-  GetChannelsInMultiPartFile(*data->ifile, channels);
-
-  imb_exr_get_views(*data->ifile, *data->multiView);
-
-  for (const MultiViewChannelName &channel : channels) {
-    IMB_exr_add_channel(
-        data, nullptr, channel.name.c_str(), channel.view.c_str(), 0, 0, nullptr, false);
-
-    echan = (ExrChannel *)data->channels.last;
-    echan->m->name = channel.name;
-    echan->m->view = channel.view;
-    echan->m->part_number = channel.part_number;
-    echan->m->internal_name = channel.internal_name;
+    /* we can have RGB(A), XYZ(W), UVA */
+    if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
+        pass->chan[2]->chan_id == 'B') {
+      lookup[(unsigned int)'R'] = 0;
+      lookup[(unsigned int)'G'] = 1;
+      lookup[(unsigned int)'B'] = 2;
+      lookup[(unsigned int)'A'] = 3;
+    }
+    else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
+             pass->chan[2]->chan_id == 'Y') {
+      lookup[(unsigned int)'X'] = 0;
+      lookup[(unsigned int)'Y'] = 1;
+      lookup[(unsigned int)'Z'] = 2;
+      lookup[(unsigned int)'W'] = 3;
+    }
+    else {
+      lookup[(unsigned int)'U'] = 0;
+      lookup[(unsigned int)'V'] = 1;
+      lookup[(unsigned int)'A'] = 2;
+    }
+    for (a = 0; a < pass->totchan; a++) {
+      r_offsets[a] = lookup[(unsigned int)pass->chan[a]->chan_id];
+    }
+  }
+  else { /* single channel or unknown */
+    for (a = 0; a < pass->totchan; a++) {
+      r_offsets[a] = a;
+    }
   }
+}
+
+/* builds the hierarchical layer list from the channels */
+static bool imb_exr_build_layers(ExrHandle *data)
+{
+  ExrChannel *echan;
+  char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
-  /* now try to sort out how to assign memory to the channels */
-  /* first build hierarchical layer list */
   for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
     if (imb_exr_split_channel_name(echan, layname, passname)) {
 
@@ -1590,70 +1761,97 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
   }
   if (echan) {
     printf("error, too many channels in one pass: %s\n", echan->m->name.c_str());
-    IMB_exr_close(data);
-    return nullptr;
+    return false;
+  }
+
+  /* Channel order of the pass buffers, also known for passes which are not read. */
+  LISTBASE_FOREACH (ExrLayer *, lay, &data->layers) {
+    LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+      int offsets[EXR_PASS_MAXCHAN];
+
+      imb_exr_pass_channel_offsets(pass, offsets);
+      for (int a = 0; a < pass->totchan; a++) {
+        pass->chan_id[offsets[a]] = pass->chan[a]->chan_id;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* assigns memory to the channels of passes to be read */
+static void imb_exr_alloc_passes(ExrHandle *data)
+{
+  ExrLayer *lay;
+  ExrPass *pass;
+  ExrChannel *echan;
+  int a;
+  int width = data->width;
+  int height = data->height;
+
+  if (data->use_read_region) {
+    width = BLI_rcti_size_x(&data->read_region);
+    height = BLI_rcti_size_y(&data->read_region);
   }
 
-  /* with some heuristics, try to merge the channels in buffers */
   for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+      if (pass->rect || (data->use_read_selection && !pass->read_selected)) {
+        continue;
+      }
       if (pass->totchan) {
-        pass->rect = (float *)MEM_callocN(width * height * pass->totchan * sizeof(float),
-                                          "pass rect");
-        if (pass->totchan == 1) {
-          echan = pass->chan[0];
-          echan->rect = pass->rect;
-          echan->xstride = 1;
-          echan->ystride = width;
-          pass->chan_id[0] = echan->chan_id;
-        }
-        else {
-          char lookup[256];
-
-          memset(lookup, 0, sizeof(lookup));
-
-          /* we can have RGB(A), XYZ(W), UVA */
-          if (ELEM(pass->totchan, 3, 4)) {
-            if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
-                pass->chan[2]->chan_id == 'B') {
-              lookup[(unsigned int)'R'] = 0;
-              lookup[(unsigned int)'G'] = 1;
-              lookup[(unsigned int)'B'] = 2;
-              lookup[(unsigned int)'A'] = 3;
-            }
-            else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
-                     pass->chan[2]->chan_id == 'Y') {
-              lookup[(unsigned int)'X'] = 0;
-              lookup[(unsigned int)'Y'] = 1;
-              lookup[(unsigned int)'Z'] = 2;
-              lookup[(unsigned int)'W'] = 3;
-            }
-            else {
-              lookup[(unsigned int)'U'] = 0;
-              lookup[(unsigned int)'V'] = 1;
-              lookup[(unsigned int)'A'] = 2;
-            }
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-            }
-          }
-          else { /* unknown */
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + a;
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[a] = echan->chan_id;
-            }
-          }
+        int offsets[EXR_PASS_MAXCHAN];
+
+        pass->rect = (float *)MEM_callocN(
+            (size_t)width * height * pass->totchan * sizeof(float), "pass rect");
+        imb_exr_pass_channel_offsets(pass, offsets);
+
+        for (a = 0; a < pass->totchan; a++) {
+          echan = pass->chan[a];
+          echan->rect = pass->rect + offsets[a];
+          echan->xstride = pass->totchan;
+          echan->ystride = width * pass->totchan;
         }
       }
     }
   }
+}
+
+/* creates channels and makes a hierarchy, memory is assigned to channels when reading */
+static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
+                                         MultiPartInputFile &file,
+                                         int width,
+                                         int height)
+{
+  ExrChannel *echan;
+  ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
+
+  data->ifile_stream = &file_stream;
+  data->ifile = &file;
+
+  data->width = width;
+  data->height = height;
+
+  std::vector<MultiViewChannelName> channels;
+  GetChannelsInMultiPartFile(*data->ifile, channels);
+
+  imb_exr_get_views(*data->ifile, *data->multiView);
+
+  for (const MultiViewChannelName &channel : channels) {
+    IMB_exr_add_channel(
+        data, nullptr, channel.name.c_str(), channel.view.c_str(), 0, 0, nullptr, false);
+
+    echan = (ExrChannel *)data->channels.last;
+    echan->m->name = channel.name;
+    echan->m->view = channel.view;
+    echan->m->part_number = channel.part_number;
+    echan->m->internal_name = channel.internal_name;
+  }
+
+  if (!imb_exr_build_layers(data)) {
+    IMB_exr_close(data);
+    return nullptr;
+  }
 
   return data;
 }
@@ -1893,6 +2091,36 @@ bool IMB_exr_has_multilayer(void *handle)
   return imb_exr_is_multi(*data->ifile);
 }
 
+static void imb_exr_ibuf_init_from_header(ImBuf *ibuf, MultiPartInputFile &file)
+{
+  ibuf->flags |= exr_is_half_float(file) ? IB_halffloat : 0;
+
+  if (hasXDensity(file.header(0))) {
+    /* Convert inches to meters. */
+    ibuf->ppm[0] = (double)xDensity(file.header(0)) / 0.0254;
+    ibuf->ppm[1] = ibuf->ppm[0] * (double)file.header(0).pixelAspectRatio();
+  }
+
+  ibuf->ftype = IMB_FTYPE_OPENEXR;
+}
+
+static void imb_exr_read_metadata(ImBuf *ibuf, MultiPartInputFile &file)
+{
+  const Header &header = file.header(0);
+  Header::ConstIterator iter;
+
+  IMB_metadata_ensure(&ibuf->metadata);
+  for (iter = header.begin(); iter != header.end(); iter++) {
+    const StringAttribute *attr = header.findTypedAttribute<StringAttribute>(iter.name());
+
+    /* not all attributes are string attributes so we might get some NULLs here */
+    if (attr) {
+      IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
+      ibuf->flags |= IB_metadata;
+    }
+  }
+}
+
 struct ImBuf *imb_load_openexr(const unsigned char *mem,
                                size_t size,
                                int flags,
@@ -1912,7 +2140,7 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
     bool is_multi;
 
     membuf = new IMemStream((unsigned char *)mem, size);
-    file = new MultiPartInputFile(*membuf);
+    file = new MultiPartInputFile(*membuf, globalThreadCount());
 
     Box2i dw = file->header(0).dataWindow();
     const int width = dw.max.x - dw.min.x + 1;
@@ -1935,33 +2163,12 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
       const int is_alpha = exr_has_alpha(*file);
 
       ibuf = IMB_allocImBuf(width, height, is_alpha ? 32 : 24, 0);
-      ibuf->flags |= exr_is_half_float(*file) ? IB_halffloat : 0;
-
-      if (hasXDensity(file->header(0))) {
-        /* Convert inches to meters. */
-        ibuf->ppm[0] = (double)xDensity(file->header(0)) / 0.0254;
-        ibuf->ppm[1] = ibuf->ppm[0] * (double)file->header(0).pixelAspectRatio();
-      }
-
-      ibuf->ftype = IMB_FTYPE_OPENEXR;
+      imb_exr_ibuf_init_from_header(ibuf, *file);
 
       if (!(flags & IB_test)) {
 
         if (flags & IB_metadata) {
-          const Header &header = file->header(0);
-          Header::ConstIterator iter;
-
-          IMB_metadata_ensure(&ibuf->metadata);
-          for (iter = header.begin(); iter != header.end(); iter++) {
-            const StringAttribute *attr = file->header(0).findTypedAttribute<StringAttribute>(
-                iter.name());
-
-            /* not all attributes are string attributes so we might get some NULLs here */
-            if (attr) {
-              IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
-              ibuf->flags |= IB_metadata;
-            }
-          }
+          imb_exr_read_metadata(ibuf, *file);
         }
 
         /* Only enters with IB_multilayer flag set. */
@@ -2106,4 +2313,43 @@ void imb_exitopenexr(void)
   setGlobalThreadCount(0);
 }
 
+/* Load a multilayer file, decoding only the selected passes. Unlike #imb_load_openexr this reads
+ * from the file instead of memory, so the handle can still read other passes later on. Returns
+ * NULL when the file is not a multilayer or multiview OpenEXR file. */
+struct ImBuf *imb_load_openexr_passes(const char *filepath,
+                                      int flags,
+                                      char colorspace[IM_MAX_SPACE],
+                                      const char *layname,
+                                      const char *passname)
+{
+  ExrHandle *handle = (ExrHandle *)IMB_exr_get_handle();
+  int width, height;
+
+  if (IMB_exr_begin_read(handle, filepath, &width, &height) == 0 ||
+      !imb_exr_is_multi(*handle->ifile) || !imb_exr_build_layers(handle)) {
+    IMB_exr_close(handle);
+    return nullptr;
+  }
+
+  colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+  ImBuf *ibuf = IMB_allocImBuf(width, height, exr_has_alpha(*handle->ifile) ? 32 : 24, 0);
+  imb_exr_ibuf_init_from_header(ibuf, *handle->ifile);
+
+  if (flags & IB_metadata) {
+    imb_exr_read_metadata(ibuf, *handle->ifile);
+  }
+
+  /* Without a layer nothing is selected, only the layer and pass list is built. */
+  handle->use_read_selection = true;
+  if (layname) {
+    IMB_exr_read_select_pass(handle, layname, passname);
+  }
+  IMB_exr_read_channels(handle);
+
+  ibuf->userdata = handle; /* potential danger, the caller has to check for this! */
+
+  return ibuf;
+}
+
 } /* export "C" */
@@ -37,6 +37,11 @@ bool imb_is_a_openexr(const unsigned char *mem, const size_t size);
 bool imb_save_openexr(struct ImBuf *ibuf, const char *name, int flags);
 
 struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags, char *colorspace);
+struct ImBuf *imb_load_openexr_passes(const char *filepath,
+                                      int flags,
+                                      char *colorspace,
+                                      const char *layname,
+                                      const char *passname);
 
 #ifdef __cplusplus
 }
@@ -38,6 +38,7 @@ extern "C" {
 #endif
 
 struct StampData;
+struct rcti;
 
 void *IMB_exr_get_handle(void);
 void *IMB_exr_get_handle_name(const char *name);
@@ -51,6 +52,9 @@ void IMB_exr_add_channel(void *handle,
                          bool use_half_float);
 
 int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *height);
+int IMB_exr_begin_read_multilayer(void *handle, const char *filename, int *width, int *height);
+void IMB_exr_read_select_pass(void *handle, const char *layname, const char *passname);
+void IMB_exr_read_set_region(void *handle, const struct rcti *region, int *width, int *height);
 int IMB_exr_begin_write(void *handle,
                         const char *filename,
                         int width,
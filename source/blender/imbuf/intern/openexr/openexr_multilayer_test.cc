@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <map>
+#include <string>
+
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_fileops.h"
+#include "BLI_utildefines.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "intern/openexr/openexr_multi.h"
+
+namespace blender::imbuf::tests {
+
+#define TEST_WIDTH 16
+#define TEST_HEIGHT 8
+
+/* Pass pixels by "layer.pass" name, NULL for passes which were not decoded. */
+typedef std::map<std::string, float *> PassRects;
+
+static void *test_addview(void *base, const char * /*str*/)
+{
+  return base;
+}
+
+static void *test_addlayer(void * /*base*/, const char *str)
+{
+  return (void *)str;
+}
+
+static void test_addpass(void *base,
+                         void *lay,
+                         const char *str,
+                         float *rect,
+                         int /*totchan*/,
+                         const char * /*chan_id*/,
+                         const char * /*view*/)
+{
+  PassRects &rects = *(PassRects *)base;
+  rects[std::string((const char *)lay) + "." + str] = rect;
+}
+
+class OpenEXRMultilayerTest : public testing::Test {
+ protected:
+  std::string filepath;
+  float combined[4 * TEST_WIDTH * TEST_HEIGHT];
+  float depth[TEST_WIDTH * TEST_HEIGHT];
+
+  void SetUp() override
+  {
+    IMB_init();
+
+    for (int i = 0; i < 4 * TEST_WIDTH * TEST_HEIGHT; i++) {
+      combined[i] = (float)i / (4 * TEST_WIDTH * TEST_HEIGHT);
+    }
+    for (int i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++) {
+      depth[i] = (float)i;
+    }
+
+    /* Two layers, the first with a combined and depth pass, the second with a combined pass. */
+    filepath = testing::TempDir() + "imbuf_multilayer_test.exr";
+    void *handle = IMB_exr_get_handle();
+    const char *rgba[4] = {"Combined.R", "Combined.G", "Combined.B", "Combined.A"};
+    for (const char *layname : {"Layer1", "Layer2"}) {
+      for (int a = 0; a < 4; a++) {
+        IMB_exr_add_channel(handle, layname, rgba[a], "", 4, 4 * TEST_WIDTH, combined + a, false);
+      }
+    }
+    IMB_exr_add_channel(handle, "Layer1", "Depth.Z", "", 1, TEST_WIDTH, depth, false);
+
+    ASSERT_TRUE(IMB_exr_begin_write(
+        handle, filepath.c_str(), TEST_WIDTH, TEST_HEIGHT, R_IMF_EXR_CODEC_NONE, nullptr));
+    IMB_exr_write_channels(handle);
+    IMB_exr_close(handle);
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath.c_str(), false, false);
+    IMB_exit();
+  }
+
+  /* Load the file with the given selection, returns the pixels of all passes in the file. */
+  PassRects load_passes(const char *layname, const char *passname)
+  {
+    PassRects rects;
+    char colorspace[IM_MAX_SPACE] = "";
+
+    ImBuf *ibuf = IMB_loadiffname_passes(
+        filepath.c_str(), IB_rect | IB_multilayer, colorspace, layname, passname);
+    EXPECT_NE(ibuf, nullptr);
+    if (ibuf == nullptr) {
+      return rects;
+    }
+    EXPECT_NE(ibuf->userdata, nullptr);
+
+    if (ibuf->userdata) {
+      IMB_exr_multilayer_convert(
+          ibuf->userdata, &rects, test_addview, test_addlayer, test_addpass);
+      IMB_exr_close(ibuf->userdata);
+      ibuf->userdata = nullptr;
+    }
+    IMB_freeImBuf(ibuf);
+
+    return rects;
+  }
+
+  static void free_passes(PassRects &rects)
+  {
+    for (auto &item : rects) {
+      MEM_SAFE_FREE(item.second);
+    }
+  }
+};
+
+TEST_F(OpenEXRMultilayerTest, read_selected_pass)
+{
+  PassRects rects = load_passes("Layer1", "Combined");
+
+  ASSERT_EQ(rects.size(), 3u);
+  EXPECT_EQ(rects["Layer1.Depth"], nullptr);
+  EXPECT_EQ(rects["Layer2.Combined"], nullptr);
+
+  /* Scanlines are flipped on reading and writing, so pixels match the written ones. */
+  const float *rect = rects["Layer1.Combined"];
+  ASSERT_NE(rect, nullptr);
+  for (int i = 0; i < 4 * TEST_WIDTH * TEST_HEIGHT; i++) {
+    EXPECT_EQ(rect[i], combined[i]);
+  }
+
+  free_passes(rects);
+}
+
+TEST_F(OpenEXRMultilayerTest, read_selected_layer)
+{
+  PassRects rects = load_passes("Layer1", nullptr);
+
+  ASSERT_EQ(rects.size(), 3u);
+  EXPECT_NE(rects["Layer1.Combined"], nullptr);
+  EXPECT_EQ(rects["Layer2.Combined"], nullptr);
+
+  const float *rect = rects["Layer1.Depth"];
+  ASSERT_NE(rect, nullptr);
+  for (int i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++) {
+    EXPECT_EQ(rect[i], depth[i]);
+  }
+
+  free_passes(rects);
+}
+
+TEST_F(OpenEXRMultilayerTest, read_pass_list_only)
+{
+  PassRects rects = load_passes(nullptr, nullptr);
+
+  EXPECT_EQ(rects.size(), 3u);
+  for (auto &item : rects) {
+    EXPECT_EQ(item.second, nullptr) << item.first;
+  }
+}
+
+}  // namespace blender::imbuf::tests
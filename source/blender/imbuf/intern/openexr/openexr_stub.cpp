@@ -50,6 +50,24 @@ int IMB_exr_begin_read(void * /*handle*/,
 {
   return 0;
 }
+int IMB_exr_begin_read_multilayer(void * /*handle*/,
+                                  const char * /*filename*/,
+                                  int * /*width*/,
+                                  int * /*height*/)
+{
+  return 0;
+}
+void IMB_exr_read_select_pass(void * /*handle*/,
+                              const char * /*layname*/,
+                              const char * /*passname*/)
+{
+}
+void IMB_exr_read_set_region(void * /*handle*/,
+                             const struct rcti * /*region*/,
+                             int * /*width*/,
+                             int * /*height*/)
+{
+}
 int IMB_exr_begin_write(void * /*handle*/,
                         const char * /*filename*/,
                         int /*width*/,
@@ -44,6 +44,10 @@
 #include "IMB_colormanagement.h"
 #include "IMB_colormanagement_intern.h"
 
+#ifdef WITH_OPENEXR
+#  include "openexr/openexr_api.h"
+#endif
+
 static void imb_handle_alpha(ImBuf *ibuf,
                              int flags,
                              char colorspace[IM_MAX_SPACE],
@@ -252,6 +256,39 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
   return ibuf;
 }
 
+ImBuf *IMB_loadiffname_passes(const char *filepath,
+                              int flags,
+                              char colorspace[IM_MAX_SPACE],
+                              const char *layname,
+                              const char *passname)
+{
+#ifdef WITH_OPENEXR
+  if ((flags & IB_multilayer) && !(flags & (IB_test | IB_thumbnail)) &&
+      IMB_ispic_type(filepath) == IMB_FTYPE_OPENEXR) {
+    char effective_colorspace[IM_MAX_SPACE] = "";
+    ImBuf *ibuf;
+
+    BLI_assert(!BLI_path_is_rel(filepath));
+
+    if (colorspace) {
+      BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+    }
+
+    ibuf = imb_load_openexr_passes(filepath, flags, effective_colorspace, layname, passname);
+    if (ibuf) {
+      imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+      BLI_strncpy(ibuf->name, filepath, sizeof(ibuf->name));
+      BLI_strncpy(ibuf->cachename, filepath, sizeof(ibuf->cachename));
+      return ibuf;
+    }
+  }
+#else
+  UNUSED_VARS(layname, passname);
+#endif
+
+  return IMB_loadiffname(filepath, flags, colorspace);
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
   ImBuf *ibuf;
@@ -24,6 +24,7 @@
 
 #include <math.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
 #include "BLI_utildefines.h"
@@ -37,6 +38,10 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -1876,3 +1881,502 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
     ibuf->rect_float = init_data.float_buffer;
   }
 }
+
+/* ******** filtered scaling ******** */
+
+/* Separable resampling: every output pixel is a weighted sum of input pixels in its filter
+ * support, first along rows then along columns. Weights only depend on the position within the
+ * row or column, so they are computed once per axis. Byte buffers use fixed point weights. */
+
+#define SCALE_PRECISION_BITS 14
+
+typedef struct ScaleFilter {
+  float (*func)(float x);
+  float support;
+} ScaleFilter;
+
+static float scale_filter_box(float x)
+{
+  return (x > -0.5f && x <= 0.5f) ? 1.0f : 0.0f;
+}
+
+static float scale_filter_bilinear(float x)
+{
+  x = fabsf(x);
+  return (x < 1.0f) ? 1.0f - x : 0.0f;
+}
+
+/* Mitchell-Netravali with B = C = 1/3. */
+static float scale_filter_mitchell(float x)
+{
+  const float b = 1.0f / 3.0f;
+  const float c = 1.0f / 3.0f;
+
+  x = fabsf(x);
+  if (x < 1.0f) {
+    return ((12.0f - 9.0f * b - 6.0f * c) * x * x * x + (-18.0f + 12.0f * b + 6.0f * c) * x * x +
+            (6.0f - 2.0f * b)) /
+           6.0f;
+  }
+  if (x < 2.0f) {
+    return ((-b - 6.0f * c) * x * x * x + (6.0f * b + 30.0f * c) * x * x +
+            (-12.0f * b - 48.0f * c) * x + (8.0f * b + 24.0f * c)) /
+           6.0f;
+  }
+  return 0.0f;
+}
+
+static float scale_filter_sinc(float x)
+{
+  if (x == 0.0f) {
+    return 1.0f;
+  }
+  x *= (float)M_PI;
+  return sinf(x) / x;
+}
+
+static float scale_filter_lanczos3(float x)
+{
+  if (x > -3.0f && x < 3.0f) {
+    return scale_filter_sinc(x) * scale_filter_sinc(x / 3.0f);
+  }
+  return 0.0f;
+}
+
+static ScaleFilter scale_filter_get(eIMBScaleFilter filter)
+{
+  ScaleFilter result = {scale_filter_box, 0.5f};
+
+  switch (filter) {
+    case IMB_SCALE_FILTER_BILINEAR:
+      result.func = scale_filter_bilinear;
+      result.support = 1.0f;
+      break;
+    case IMB_SCALE_FILTER_MITCHELL:
+      result.func = scale_filter_mitchell;
+      result.support = 2.0f;
+      break;
+    case IMB_SCALE_FILTER_LANCZOS3:
+      result.func = scale_filter_lanczos3;
+      result.support = 3.0f;
+      break;
+    case IMB_SCALE_FILTER_DEFAULT:
+    case IMB_SCALE_FILTER_BOX:
+      break;
+  }
+
+  return result;
+}
+
+/* Filter weights of one axis. */
+typedef struct ScaleWeights {
+  /* First input pixel and number of input pixels for every output pixel. */
+  int *start;
+  int *count;
+  /* Weights of input pixels, `stride` per output pixel. */
+  float *weights;
+  short *weights_fixed;
+  int stride;
+} ScaleWeights;
+
+static void scale_weights_init(ScaleWeights *sw, const ScaleFilter *filter, int size, int newsize)
+{
+  const float scale = (float)size / newsize;
+  const float filterscale = max_ff(scale, 1.0f);
+  const float support = filter->support * filterscale;
+
+  sw->stride = (int)ceilf(support) * 2 + 1;
+  sw->start = MEM_mallocN(sizeof(int) * newsize, __func__);
+  sw->count = MEM_mallocN(sizeof(int) * newsize, __func__);
+  sw->weights = MEM_calloc_arrayN((size_t)newsize * sw->stride, sizeof(float), __func__);
+  sw->weights_fixed = MEM_calloc_arrayN((size_t)newsize * sw->stride, sizeof(short), __func__);
+
+  for (int i = 0; i < newsize; i++) {
+    const float center = (i + 0.5f) * scale;
+    const int start = max_ii((int)(center - support + 0.5f), 0);
+    const int end = min_ii((int)(center + support + 0.5f), size);
+    float *weights = sw->weights + (size_t)i * sw->stride;
+    short *weights_fixed = sw->weights_fixed + (size_t)i * sw->stride;
+    float total = 0.0f;
+
+    sw->start[i] = start;
+    sw->count[i] = min_ii(end - start, sw->stride);
+
+    for (int k = 0; k < sw->count[i]; k++) {
+      weights[k] = filter->func((start + k - center + 0.5f) / filterscale);
+      total += weights[k];
+    }
+    for (int k = 0; k < sw->count[i]; k++) {
+      if (total != 0.0f) {
+        weights[k] /= total;
+      }
+      weights_fixed[k] = (short)roundf(weights[k] * (1 << SCALE_PRECISION_BITS));
+    }
+  }
+}
+
+static void scale_weights_free(ScaleWeights *sw)
+{
+  MEM_freeN(sw->start);
+  MEM_freeN(sw->count);
+  MEM_freeN(sw->weights);
+  MEM_freeN(sw->weights_fixed);
+}
+
+BLI_INLINE unsigned char scale_fixed_to_uchar(int value)
+{
+  value >>= SCALE_PRECISION_BITS;
+  return (unsigned char)((value < 0) ? 0 : (value > 255) ? 255 : value);
+}
+
+#ifdef __SSE2__
+/* Two 16 bit weights in every 32 bit lane, to be used with `_mm_madd_epi16`. */
+BLI_INLINE __m128i scale_weights_pair(short w0, short w1)
+{
+  return _mm_set1_epi32((int)(unsigned short)w0 | ((int)(unsigned short)w1 << 16));
+}
+
+BLI_INLINE unsigned int scale_fixed_to_uchar_v4(__m128i acc)
+{
+  acc = _mm_srai_epi32(acc, SCALE_PRECISION_BITS);
+  acc = _mm_packs_epi32(acc, acc);
+  return (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+}
+#endif
+
+/* Filter RGBA byte row `src` into `newx` pixels of `dst`. */
+static void scale_row_byte(const unsigned char *src,
+                           unsigned char *dst,
+                           const ScaleWeights *sw,
+                           int newx)
+{
+  for (int x = 0; x < newx; x++) {
+    const unsigned char *in = src + 4 * sw->start[x];
+    const short *weights = sw->weights_fixed + (size_t)x * sw->stride;
+    const int count = sw->count[x];
+    int k = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_set1_epi32(1 << (SCALE_PRECISION_BITS - 1));
+
+    for (; k + 1 < count; k += 2) {
+      /* Two pixels, interleaved per channel: r0 r1 g0 g1 b0 b1 a0 a1. */
+      __m128i pix = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(in + 4 * k)), zero);
+      pix = _mm_unpacklo_epi16(pix, _mm_srli_si128(pix, 8));
+      const __m128i w = scale_weights_pair(weights[k], weights[k + 1]);
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(pix, w));
+    }
+    if (k < count) {
+      __m128i pix = _mm_cvtsi32_si128(*(const int *)(in + 4 * k));
+      pix = _mm_unpacklo_epi16(_mm_unpacklo_epi8(pix, zero), zero);
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(pix, scale_weights_pair(weights[k], 0)));
+    }
+    *(unsigned int *)(dst + 4 * x) = scale_fixed_to_uchar_v4(acc);
+#else
+    int acc[4];
+    for (int c = 0; c < 4; c++) {
+      acc[c] = 1 << (SCALE_PRECISION_BITS - 1);
+    }
+    for (; k < count; k++) {
+      for (int c = 0; c < 4; c++) {
+        acc[c] += in[4 * k + c] * weights[k];
+      }
+    }
+    for (int c = 0; c < 4; c++) {
+      dst[4 * x + c] = scale_fixed_to_uchar(acc[c]);
+    }
+#endif
+  }
+}
+
+/* Filter byte rows `rows` (`count` rows, `row_stride` bytes apart) into `dst` of `len` bytes. */
+static void scale_column_byte(const unsigned char *rows,
+                              size_t row_stride,
+                              const short *weights,
+                              int count,
+                              unsigned char *dst,
+                              int len)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i acc[4];
+    for (int j = 0; j < 4; j++) {
+      acc[j] = _mm_set1_epi32(1 << (SCALE_PRECISION_BITS - 1));
+    }
+
+    int k = 0;
+    for (; k < count; k += 2) {
+      const __m128i w = scale_weights_pair(weights[k], (k + 1 < count) ? weights[k + 1] : 0);
+      const __m128i a = _mm_loadu_si128((const __m128i *)(rows + k * row_stride + i));
+      const __m128i b = (k + 1 < count) ?
+                            _mm_loadu_si128((const __m128i *)(rows + (k + 1) * row_stride + i)) :
+                            zero;
+      /* Interleave both rows per channel. */
+      const __m128i lo = _mm_unpacklo_epi8(a, b);
+      const __m128i hi = _mm_unpackhi_epi8(a, b);
+      acc[0] = _mm_add_epi32(acc[0], _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+      acc[1] = _mm_add_epi32(acc[1], _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+      acc[2] = _mm_add_epi32(acc[2], _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+      acc[3] = _mm_add_epi32(acc[3], _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+    }
+
+    for (int j = 0; j < 4; j++) {
+      acc[j] = _mm_srai_epi32(acc[j], SCALE_PRECISION_BITS);
+    }
+    const __m128i lo16 = _mm_packs_epi32(acc[0], acc[1]);
+    const __m128i hi16 = _mm_packs_epi32(acc[2], acc[3]);
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo16, hi16));
+  }
+#endif
+  for (; i < len; i++) {
+    int acc = 1 << (SCALE_PRECISION_BITS - 1);
+    for (int k = 0; k < count; k++) {
+      acc += rows[k * row_stride + i] * weights[k];
+    }
+    dst[i] = scale_fixed_to_uchar(acc);
+  }
+}
+
+/* Filter float row `src` with `channels` channels into `dst`. */
+static void scale_row_float(
+    const float *src, float *dst, const ScaleWeights *sw, int newx, int channels)
+{
+  for (int x = 0; x < newx; x++) {
+    const float *in = src + (size_t)channels * sw->start[x];
+    const float *weights = sw->weights + (size_t)x * sw->stride;
+    const int count = sw->count[x];
+#ifdef __SSE2__
+    if (channels == 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (int k = 0; k < count; k++) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(in + 4 * k)));
+      }
+      _mm_storeu_ps(dst + 4 * x, acc);
+      continue;
+    }
+#endif
+    for (int c = 0; c < channels; c++) {
+      float acc = 0.0f;
+      for (int k = 0; k < count; k++) {
+        acc += in[channels * k + c] * weights[k];
+      }
+      dst[channels * x + c] = acc;
+    }
+  }
+}
+
+static void scale_column_float(const float *rows,
+                               size_t row_stride,
+                               const float *weights,
+                               int count,
+                               float *dst,
+                               int len)
+{
+  int i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= len; i += 4) {
+    __m128 acc = _mm_setzero_ps();
+    for (int k = 0; k < count; k++) {
+      const __m128 pix = _mm_loadu_ps(rows + k * row_stride + i);
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), pix));
+    }
+    _mm_storeu_ps(dst + i, acc);
+  }
+#endif
+  for (; i < len; i++) {
+    float acc = 0.0f;
+    for (int k = 0; k < count; k++) {
+      acc += rows[k * row_stride + i] * weights[k];
+    }
+    dst[i] = acc;
+  }
+}
+
+typedef struct ScaleFilterData {
+  const ScaleWeights *weights;
+  int x, y;
+  int newx;
+  int channels;
+  const unsigned char *byte_in;
+  unsigned char *byte_out;
+  const float *float_in;
+  float *float_out;
+} ScaleFilterData;
+
+static void scale_filter_x_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  ScaleFilterData *data = (ScaleFilterData *)data_v;
+
+  for (int y = start_scanline; y < start_scanline + num_scanlines; y++) {
+    if (data->byte_in) {
+      scale_row_byte(data->byte_in + (size_t)4 * data->x * y,
+                     data->byte_out + (size_t)4 * data->newx * y,
+                     data->weights,
+                     data->newx);
+    }
+    if (data->float_in) {
+      scale_row_float(data->float_in + (size_t)data->channels * data->x * y,
+                      data->float_out + (size_t)data->channels * data->newx * y,
+                      data->weights,
+                      data->newx,
+                      data->channels);
+    }
+  }
+}
+
+static void scale_filter_y_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  ScaleFilterData *data = (ScaleFilterData *)data_v;
+  const ScaleWeights *sw = data->weights;
+
+  for (int y = start_scanline; y < start_scanline + num_scanlines; y++) {
+    if (data->byte_in) {
+      const size_t row_stride = (size_t)4 * data->x;
+      scale_column_byte(data->byte_in + row_stride * sw->start[y],
+                        row_stride,
+                        sw->weights_fixed + (size_t)y * sw->stride,
+                        sw->count[y],
+                        data->byte_out + row_stride * y,
+                        4 * data->x);
+    }
+    if (data->float_in) {
+      const size_t row_stride = (size_t)data->channels * data->x;
+      scale_column_float(data->float_in + row_stride * sw->start[y],
+                         row_stride,
+                         sw->weights + (size_t)y * sw->stride,
+                         sw->count[y],
+                         data->float_out + row_stride * y,
+                         data->channels * data->x);
+    }
+  }
+}
+
+static void scale_filter_x(ImBuf *ibuf, int newx, const ScaleFilter *filter)
+{
+  ScaleWeights sw;
+  ScaleFilterData data = {NULL};
+
+  scale_weights_init(&sw, filter, ibuf->x, newx);
+
+  data.weights = &sw;
+  data.x = ibuf->x;
+  data.y = ibuf->y;
+  data.newx = newx;
+  data.channels = ibuf->channels;
+  if (ibuf->rect) {
+    data.byte_in = (unsigned char *)ibuf->rect;
+    data.byte_out = MEM_mallocN((size_t)4 * newx * ibuf->y, "scale filter byte buffer");
+  }
+  if (ibuf->rect_float) {
+    data.float_in = ibuf->rect_float;
+    data.float_out = MEM_mallocN(sizeof(float) * ibuf->channels * newx * ibuf->y,
+                                 "scale filter float buffer");
+  }
+
+  IMB_processor_apply_threaded_scanlines(ibuf->y, scale_filter_x_thread_do, &data);
+  scale_weights_free(&sw);
+
+  if (data.byte_out) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)data.byte_out;
+  }
+  if (data.float_out) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = data.float_out;
+  }
+  ibuf->x = newx;
+}
+
+static void scale_filter_y(ImBuf *ibuf, int newy, const ScaleFilter *filter)
+{
+  ScaleWeights sw;
+  ScaleFilterData data = {NULL};
+
+  scale_weights_init(&sw, filter, ibuf->y, newy);
+
+  data.weights = &sw;
+  data.x = ibuf->x;
+  data.y = ibuf->y;
+  data.channels = ibuf->channels;
+  if (ibuf->rect) {
+    data.byte_in = (unsigned char *)ibuf->rect;
+    data.byte_out = MEM_mallocN((size_t)4 * ibuf->x * newy, "scale filter byte buffer");
+  }
+  if (ibuf->rect_float) {
+    data.float_in = ibuf->rect_float;
+    data.float_out = MEM_mallocN(sizeof(float) * ibuf->channels * ibuf->x * newy,
+                                 "scale filter float buffer");
+  }
+
+  IMB_processor_apply_threaded_scanlines(newy, scale_filter_y_thread_do, &data);
+  scale_weights_free(&sw);
+
+  if (data.byte_out) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)data.byte_out;
+  }
+  if (data.float_out) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = data.float_out;
+  }
+  ibuf->y = newy;
+}
+
+/**
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf,
+                           unsigned int newx,
+                           unsigned int newy,
+                           eIMBScaleFilter filter)
+{
+  if (filter == IMB_SCALE_FILTER_DEFAULT) {
+    return IMB_scaleImBuf(ibuf, newx, newy);
+  }
+
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+  if (newx == 0 || newy == 0) {
+    return false;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  const ScaleFilter scale_filter = scale_filter_get(filter);
+  if (newx != ibuf->x) {
+    scale_filter_x(ibuf, newx, &scale_filter);
+  }
+  if (newy != ibuf->y) {
+    scale_filter_y(ibuf, newy, &scale_filter);
+  }
+
+  return true;
+}
+
+#undef SCALE_PRECISION_BITS
+
+static eIMBScaleFilter scale_filter_preference = IMB_SCALE_FILTER_DEFAULT;
+
+void IMB_scale_filter_preference_set(eIMBScaleFilter filter)
+{
+  scale_filter_preference = filter;
+}
+
+eIMBScaleFilter IMB_scale_filter_preference_get(void)
+{
+  return scale_filter_preference;
+}
@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_rand.h"
+
+namespace blender::imbuf::tests {
+
+static void test_scale_constant(eIMBScaleFilter filter, int newx, int newy)
+{
+  ImBuf *ibuf = IMB_allocImBuf(67, 45, 32, IB_rect | IB_rectfloat);
+  for (int i = 0; i < 4 * 67 * 45; i++) {
+    ((uchar *)ibuf->rect)[i] = 200;
+    ibuf->rect_float[i] = 0.7f;
+  }
+
+  EXPECT_TRUE(IMB_scaleImBuf_filter(ibuf, newx, newy, filter));
+  EXPECT_EQ(ibuf->x, newx);
+  EXPECT_EQ(ibuf->y, newy);
+
+  for (int i = 0; i < 4 * newx * newy; i++) {
+    EXPECT_EQ(((uchar *)ibuf->rect)[i], 200);
+    EXPECT_NEAR(ibuf->rect_float[i], 0.7f, 1e-5f);
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, constant)
+{
+  const eIMBScaleFilter filters[] = {IMB_SCALE_FILTER_BOX,
+                                     IMB_SCALE_FILTER_BILINEAR,
+                                     IMB_SCALE_FILTER_MITCHELL,
+                                     IMB_SCALE_FILTER_LANCZOS3};
+  for (const eIMBScaleFilter filter : filters) {
+    test_scale_constant(filter, 23, 17);
+    test_scale_constant(filter, 150, 91);
+    test_scale_constant(filter, 67, 20);
+  }
+}
+
+TEST(imbuf_scaling, box_half)
+{
+  ImBuf *ibuf = IMB_allocImBuf(64, 32, 32, IB_rectfloat);
+  BLI_array_frand(ibuf->rect_float, 4 * 64 * 32, 0);
+  ImBuf *orig = IMB_dupImBuf(ibuf);
+
+  IMB_scaleImBuf_filter(ibuf, 32, 16, IMB_SCALE_FILTER_BOX);
+
+  for (int y = 0; y < 16; y++) {
+    for (int x = 0; x < 32; x++) {
+      for (int c = 0; c < 4; c++) {
+        const float *in = orig->rect_float + 4 * (2 * y * 64 + 2 * x) + c;
+        const float expected = (in[0] + in[4] + in[4 * 64] + in[4 * 64 + 4]) * 0.25f;
+        EXPECT_NEAR(ibuf->rect_float[4 * (y * 32 + x) + c], expected, 1e-5f);
+      }
+    }
+  }
+
+  IMB_freeImBuf(orig);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, filter_preference)
+{
+  EXPECT_EQ(IMB_scale_filter_preference_get(), IMB_SCALE_FILTER_DEFAULT);
+
+  IMB_scale_filter_preference_set(IMB_SCALE_FILTER_LANCZOS3);
+  EXPECT_EQ(IMB_scale_filter_preference_get(), IMB_SCALE_FILTER_LANCZOS3);
+
+  IMB_scale_filter_preference_set(IMB_SCALE_FILTER_DEFAULT);
+}
+
+}  // namespace blender::imbuf::tests
@@ -0,0 +1,73 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+typedef void (*ScaleFunc)(ImBuf *ibuf, int newx, int newy, eIMBScaleFilter filter);
+
+static void scale_default(ImBuf *ibuf, int newx, int newy, eIMBScaleFilter /*filter*/)
+{
+  IMB_scaleImBuf(ibuf, newx, newy);
+}
+
+static void scale_threaded(ImBuf *ibuf, int newx, int newy, eIMBScaleFilter /*filter*/)
+{
+  IMB_scaleImBuf_threaded(ibuf, newx, newy);
+}
+
+static void scale_filter(ImBuf *ibuf, int newx, int newy, eIMBScaleFilter filter)
+{
+  IMB_scaleImBuf_filter(ibuf, newx, newy, filter);
+}
+
+static void scale_performance(ScaleFunc scale,
+                              eIMBScaleFilter filter,
+                              const char *name,
+                              bool use_float)
+{
+  const int x = 7680, y = 4320;
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, use_float ? IB_rectfloat : IB_rect);
+
+  const int num_channels = 4 * x * y;
+  if (use_float) {
+    BLI_array_frand(ibuf->rect_float, num_channels, 0);
+  }
+  else {
+    RNG *rng = BLI_rng_new(0);
+    BLI_rng_get_char_n(rng, (char *)ibuf->rect, num_channels);
+    BLI_rng_free(rng);
+  }
+
+  const double time_start = PIL_check_seconds_timer();
+  scale(ibuf, 1920, 1080, filter);
+  const double time_total = PIL_check_seconds_timer() - time_start;
+
+  printf("%s (%s): %dx%d to 1920x1080 in %.4fs\n",
+         name,
+         use_float ? "float" : "byte",
+         x,
+         y,
+         time_total);
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, downscale)
+{
+  for (const bool use_float : {false, true}) {
+    scale_performance(scale_default, IMB_SCALE_FILTER_DEFAULT, "IMB_scaleImBuf", use_float);
+    scale_performance(
+        scale_threaded, IMB_SCALE_FILTER_DEFAULT, "IMB_scaleImBuf_threaded", use_float);
+    scale_performance(scale_filter, IMB_SCALE_FILTER_BOX, "box", use_float);
+    scale_performance(scale_filter, IMB_SCALE_FILTER_BILINEAR, "bilinear", use_float);
+    scale_performance(scale_filter, IMB_SCALE_FILTER_MITCHELL, "mitchell", use_float);
+    scale_performance(scale_filter, IMB_SCALE_FILTER_LANCZOS3, "lanczos3", use_float);
+  }
+}
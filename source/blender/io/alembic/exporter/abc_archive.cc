@@ -19,6 +19,8 @@
 
 #include "abc_archive.h"
 
+#include "BLI_task.h"
+
 #include "BKE_blender_version.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
@@ -172,7 +174,7 @@ ABCArchive::ABCArchive(const Main *bmain,
                        const Scene *scene,
                        AlembicExportParams params,
                        std::string filename)
-    : archive(nullptr)
+    : archive(nullptr), task_pool_(nullptr)
 {
   double scene_fps = FPS;
   MetaData abc_metadata = create_abc_metadata(bmain, scene_fps);
@@ -207,10 +209,19 @@ ABCArchive::ABCArchive(const Main *bmain,
 
   abc_archive_bbox_ = Alembic::AbcGeom::CreateOArchiveBounds(*archive,
                                                              time_sampling_index_transforms_);
+
+  /* Deferred writes are run one after the other, Alembic archives are not thread-safe. */
+  task_pool_ = BLI_task_pool_create_background_serial(this, TASK_PRIORITY_HIGH);
 }
 
 ABCArchive::~ABCArchive()
 {
+  /* Errors of the deferred writes are reported by wait_for_deferred_writes(), when the archive
+   * is destroyed because of an error they are not of interest anymore. */
+  if (task_pool_) {
+    BLI_task_pool_work_and_wait(task_pool_);
+    BLI_task_pool_free(task_pool_);
+  }
   delete archive;
 }
 
@@ -258,4 +269,46 @@ void ABCArchive::update_bounding_box(const Imath::Box3d &bounds)
   abc_archive_bbox_.set(bounds);
 }
 
+void ABCArchive::defer_write(std::function<void()> write_fn)
+{
+  deferred_writes_.push_back(std::move(write_fn));
+}
+
+void ABCArchive::deferred_writes_task(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  ABCArchive *abc_archive = static_cast<ABCArchive *>(taskdata);
+
+  try {
+    for (const std::function<void()> &write_fn : abc_archive->running_writes_) {
+      write_fn();
+    }
+  }
+  catch (...) {
+    abc_archive->deferred_write_exception_ = std::current_exception();
+  }
+  abc_archive->running_writes_.clear();
+}
+
+void ABCArchive::start_deferred_writes()
+{
+  if (deferred_writes_.empty()) {
+    return;
+  }
+
+  BLI_assert(running_writes_.empty());
+  running_writes_.swap(deferred_writes_);
+  BLI_task_pool_push(task_pool_, deferred_writes_task, this, false, nullptr);
+}
+
+void ABCArchive::wait_for_deferred_writes()
+{
+  BLI_task_pool_work_and_wait(task_pool_);
+
+  if (deferred_write_exception_) {
+    std::exception_ptr exception = deferred_write_exception_;
+    deferred_write_exception_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
 }  // namespace blender::io::alembic
@@ -29,12 +29,16 @@
 #include <Alembic/Abc/OArchive.h>
 #include <Alembic/Abc/OTypedScalarProperty.h>
 
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <set>
 #include <string>
+#include <vector>
 
 struct Main;
 struct Scene;
+struct TaskPool;
 
 namespace blender::io::alembic {
 
@@ -68,6 +72,16 @@ class ABCArchive {
 
   void update_bounding_box(const Imath::Box3d &bounds);
 
+  /* Add Alembic calls that only use data owned by the function, so that they can run in a
+   * background thread while the depsgraph evaluates the next frame. Deferred writes run in the
+   * order they were added, so the archive layout does not depend on threads scheduling. */
+  void defer_write(std::function<void()> write_fn);
+  /* Start running the deferred writes in the background. */
+  void start_deferred_writes();
+  /* Wait for the deferred writes to be done. Must be called before anything else accesses the
+   * archive, rethrows the exception thrown by a deferred write if any. */
+  void wait_for_deferred_writes();
+
  private:
   std::ofstream abc_ostream_;
   uint32_t time_sampling_index_transforms_;
@@ -78,6 +92,14 @@ class ABCArchive {
   Frames export_frames_;
 
   Alembic::Abc::OBox3dProperty abc_archive_bbox_;
+
+  /* Writes added since the last start, and writes running in the background. */
+  std::vector<std::function<void()>> deferred_writes_;
+  std::vector<std::function<void()>> running_writes_;
+  std::exception_ptr deferred_write_exception_;
+  TaskPool *task_pool_;
+
+  static void deferred_writes_task(TaskPool *__restrict pool, void *taskdata);
 };
 
 }  // namespace blender::io::alembic
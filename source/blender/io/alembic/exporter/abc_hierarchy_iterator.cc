@@ -51,8 +51,14 @@ ABCHierarchyIterator::ABCHierarchyIterator(Depsgraph *depsgraph,
 
 void ABCHierarchyIterator::iterate_and_write()
 {
+  /* The samples of the previous frame were written while the depsgraph was evaluating this one,
+   * wait for them before writing to the archive again. */
+  abc_archive_->wait_for_deferred_writes();
+
   AbstractHierarchyIterator::iterate_and_write();
   update_archive_bounding_box();
+
+  abc_archive_->start_deferred_writes();
 }
 
 void ABCHierarchyIterator::update_archive_bounding_box()
@@ -90,6 +96,15 @@ bool ABCHierarchyIterator::mark_as_weak_export(const Object *object) const
 
 void ABCHierarchyIterator::release_writer(AbstractHierarchyWriter *writer)
 {
+  /* Deferred writes may still use the writer. When they failed, the writer is still freed
+   * before their exception is passed on. */
+  try {
+    abc_archive_->wait_for_deferred_writes();
+  }
+  catch (...) {
+    delete writer;
+    throw;
+  }
   delete writer;
 }
 
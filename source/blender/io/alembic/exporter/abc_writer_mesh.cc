@@ -44,6 +44,8 @@
 #include "DNA_object_fluidsim_types.h"
 #include "DNA_particle_types.h"
 
+#include <memory>
+
 #include "CLG_log.h"
 static CLG_LogRef LOG = {"io.alembic"};
 
@@ -83,6 +85,66 @@ static void get_loop_normals(struct Mesh *mesh,
                              std::vector<Imath::V3f> &normals,
                              bool has_flat_shaded_poly);
 
+/* Mesh data of a sample, owned by the sample so that it can be written after the mesh is freed
+ * and the depsgraph moved on to the next frame. */
+struct PolyMeshSampleData {
+  std::vector<Imath::V3f> points;
+  std::vector<int32_t> poly_verts, loop_counts;
+  std::vector<Imath::V3f> normals;
+  std::vector<Imath::V3f> velocities;
+  bool use_normals = false;
+  bool use_velocities = false;
+  Imath::Box3d bounds;
+};
+
+struct SubDSampleData {
+  std::vector<Imath::V3f> points;
+  std::vector<int32_t> poly_verts, loop_counts;
+  std::vector<int32_t> crease_indices, crease_lengths;
+  std::vector<float> crease_sharpness;
+  Imath::Box3d bounds;
+};
+
+static OPolyMeshSchema::Sample poly_mesh_sample(const PolyMeshSampleData &data)
+{
+  OPolyMeshSchema::Sample mesh_sample(V3fArraySample(data.points),
+                                      Int32ArraySample(data.poly_verts),
+                                      Int32ArraySample(data.loop_counts));
+
+  if (data.use_normals) {
+    ON3fGeomParam::Sample normals_sample;
+    if (!data.normals.empty()) {
+      normals_sample.setScope(kFacevaryingScope);
+      normals_sample.setVals(V3fArraySample(data.normals));
+    }
+
+    mesh_sample.setNormals(normals_sample);
+  }
+
+  if (data.use_velocities) {
+    mesh_sample.setVelocities(V3fArraySample(data.velocities));
+  }
+
+  mesh_sample.setSelfBounds(data.bounds);
+  return mesh_sample;
+}
+
+static OSubDSchema::Sample subd_sample(const SubDSampleData &data)
+{
+  OSubDSchema::Sample subdiv_sample(V3fArraySample(data.points),
+                                    Int32ArraySample(data.poly_verts),
+                                    Int32ArraySample(data.loop_counts));
+
+  if (!data.crease_indices.empty()) {
+    subdiv_sample.setCreaseIndices(Int32ArraySample(data.crease_indices));
+    subdiv_sample.setCreaseLengths(Int32ArraySample(data.crease_lengths));
+    subdiv_sample.setCreaseSharpnesses(FloatArraySample(data.crease_sharpness));
+  }
+
+  subdiv_sample.setSelfBounds(data.bounds);
+  return subdiv_sample;
+}
+
 ABCGenericMeshWriter::ABCGenericMeshWriter(const ABCWriterConstructorArgs &args)
     : ABCAbstractWriter(args), is_subd_(false)
 {
@@ -237,24 +299,41 @@ void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
 
 void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
 {
-  std::vector<Imath::V3f> points, normals;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<Imath::V3f> velocities;
+  std::shared_ptr<PolyMeshSampleData> data = std::make_shared<PolyMeshSampleData>();
   bool has_flat_shaded_poly = false;
 
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_shaded_poly);
+  get_vertices(mesh, data->points);
+  get_topology(mesh, data->poly_verts, data->loop_counts, has_flat_shaded_poly);
+
+  if (args_.export_params->normals) {
+    get_loop_normals(mesh, data->normals, has_flat_shaded_poly);
+    data->use_normals = true;
+  }
+
+  if (liquid_sim_modifier_ != nullptr) {
+    get_velocities(mesh, data->velocities);
+    data->use_velocities = true;
+  }
+
+  update_bounding_box(context.object);
+  data->bounds = bounding_box_;
 
-  if (!frame_has_been_written_ && args_.export_params->face_sets) {
+  if (frame_has_been_written_) {
+    /* Later frames only write the mesh sample, let the archive encode it in the background. */
+    args_.abc_archive->defer_write(
+        [this, data]() { abc_poly_mesh_schema_.set(poly_mesh_sample(*data)); });
+    return;
+  }
+
+  if (args_.export_params->face_sets) {
     write_face_sets(context.object, mesh, abc_poly_mesh_schema_);
   }
 
-  OPolyMeshSchema::Sample mesh_sample = OPolyMeshSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+  OPolyMeshSchema::Sample mesh_sample = poly_mesh_sample(*data);
 
   UVSample uvs_and_indices;
 
-  if (!frame_has_been_written_ && args_.export_params->uvs) {
+  if (args_.export_params->uvs) {
     const char *name = get_uv_sample(uvs_and_indices, m_custom_data_config, &mesh->ldata);
 
     if (!uvs_and_indices.indices.empty() && !uvs_and_indices.uvs.empty()) {
@@ -271,26 +350,6 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
         abc_poly_mesh_schema_.getArbGeomParams(), m_custom_data_config, &mesh->ldata, CD_MLOOPUV);
   }
 
-  if (args_.export_params->normals) {
-    get_loop_normals(mesh, normals, has_flat_shaded_poly);
-
-    ON3fGeomParam::Sample normals_sample;
-    if (!normals.empty()) {
-      normals_sample.setScope(kFacevaryingScope);
-      normals_sample.setVals(V3fArraySample(normals));
-    }
-
-    mesh_sample.setNormals(normals_sample);
-  }
-
-  if (liquid_sim_modifier_ != nullptr) {
-    get_velocities(mesh, velocities);
-    mesh_sample.setVelocities(V3fArraySample(velocities));
-  }
-
-  update_bounding_box(context.object);
-  mesh_sample.setSelfBounds(bounding_box_);
-
   abc_poly_mesh_schema_.set(mesh_sample);
 
   write_arb_geo_params(mesh);
@@ -298,25 +357,31 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
 
 void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *mesh)
 {
-  std::vector<float> crease_sharpness;
-  std::vector<Imath::V3f> points;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<int32_t> crease_indices, crease_lengths;
+  std::shared_ptr<SubDSampleData> data = std::make_shared<SubDSampleData>();
   bool has_flat_poly = false;
 
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_poly);
-  get_creases(mesh, crease_indices, crease_lengths, crease_sharpness);
+  get_vertices(mesh, data->points);
+  get_topology(mesh, data->poly_verts, data->loop_counts, has_flat_poly);
+  get_creases(mesh, data->crease_indices, data->crease_lengths, data->crease_sharpness);
 
-  if (!frame_has_been_written_ && args_.export_params->face_sets) {
+  update_bounding_box(context.object);
+  data->bounds = bounding_box_;
+
+  if (frame_has_been_written_) {
+    /* Later frames only write the subdivision sample, let the archive encode it in the
+     * background. */
+    args_.abc_archive->defer_write([this, data]() { abc_subdiv_schema_.set(subd_sample(*data)); });
+    return;
+  }
+
+  if (args_.export_params->face_sets) {
     write_face_sets(context.object, mesh, abc_subdiv_schema_);
   }
 
-  OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+  OSubDSchema::Sample subdiv_sample = subd_sample(*data);
 
   UVSample sample;
-  if (!frame_has_been_written_ && args_.export_params->uvs) {
+  if (args_.export_params->uvs) {
     const char *name = get_uv_sample(sample, m_custom_data_config, &mesh->ldata);
 
     if (!sample.indices.empty() && !sample.uvs.empty()) {
@@ -333,14 +398,6 @@ void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *me
         abc_subdiv_schema_.getArbGeomParams(), m_custom_data_config, &mesh->ldata, CD_MLOOPUV);
   }
 
-  if (!crease_indices.empty()) {
-    subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices));
-    subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths));
-    subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness));
-  }
-
-  update_bounding_box(context.object);
-  subdiv_sample.setSelfBounds(bounding_box_);
   abc_subdiv_schema_.set(subdiv_sample);
 
   write_arb_geo_params(mesh);
@@ -35,7 +35,9 @@
 #include "BLI_compiler_compat.h"
 #include "BLI_listbase.h"
 #include "BLI_math_geom.h"
+#include "BLI_task.h"
 
+#include "BKE_lib_id.h"
 #include "BKE_main.h"
 #include "BKE_material.h"
 #include "BKE_mesh.h"
@@ -250,6 +252,70 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
   }
 }
 
+/* Copy the topology that read_mpolys() converted for a previous sample of the same mesh. */
+static void read_mpolys_from_topology(CDStreamConfig &config,
+                                      const Mesh *topology_mesh,
+                                      const std::string &uv_name)
+{
+  Mesh *mesh = config.mesh;
+  const MPoly *topology_mpolys = topology_mesh->mpoly;
+
+  for (int i = 0; i < config.totpoly; i++) {
+    MPoly &poly = config.mpoly[i];
+    poly.loopstart = topology_mpolys[i].loopstart;
+    poly.totloop = topology_mpolys[i].totloop;
+    poly.flag |= ME_SMOOTH;
+  }
+  memcpy(config.mloop, topology_mesh->mloop, sizeof(MLoop) * config.totloop);
+
+  if (!uv_name.empty()) {
+    const void *uv_data = CustomData_get_layer_named(
+        &topology_mesh->ldata, CD_MLOOPUV, uv_name.c_str());
+    void *cd_ptr = config.add_customdata_cb(mesh, uv_name.c_str(), CD_MLOOPUV);
+    memcpy(cd_ptr, uv_data, sizeof(MLoopUV) * config.totloop);
+  }
+
+  /* Replace the edges, like BKE_mesh_calc_edges() does. */
+  CustomData_free(&mesh->edata, mesh->totedge);
+  CustomData_reset(&mesh->edata);
+  mesh->medge = static_cast<MEdge *>(CustomData_add_layer(
+      &mesh->edata, CD_MEDGE, CD_DUPLICATE, topology_mesh->medge, topology_mesh->totedge));
+  mesh->totedge = topology_mesh->totedge;
+}
+
+/* Read animated UVs for the topology copied by read_mpolys_from_topology(), the same way
+ * read_mpolys() does. */
+static void read_uvs_from_topology(CDStreamConfig &config, const AbcMeshData &mesh_data)
+{
+  MLoopUV *mloopuvs = config.mloopuv;
+  const V2fArraySamplePtr &uvs = mesh_data.uvs;
+  const UInt32ArraySamplePtr &uvs_indices = mesh_data.uvs_indices;
+
+  if (!(mloopuvs && uvs && uvs_indices) || uvs_indices->size() != config.totloop) {
+    return;
+  }
+
+  const size_t uvs_size = uvs->size();
+
+  for (int i = 0; i < config.totpoly; i++) {
+    const MPoly &poly = config.mpoly[i];
+
+    /* NOTE: Alembic data is stored in the reverse order. */
+    for (int f = 0; f < poly.totloop; f++) {
+      const unsigned int uv_index = (*uvs_indices)[poly.loopstart + f];
+
+      /* Some Alembic files are broken (or at least export UVs in a way we don't expect). */
+      if (uv_index >= uvs_size) {
+        continue;
+      }
+
+      MLoopUV &loopuv = mloopuvs[poly.loopstart + poly.totloop - 1 - f];
+      loopuv.uv[0] = (*uvs)[uv_index][0];
+      loopuv.uv[1] = (*uvs)[uv_index][1];
+    }
+  }
+}
+
 static void process_no_normals(CDStreamConfig &config)
 {
   /* Absence of normals in the Alembic mesh is interpreted as 'smooth'. */
@@ -473,7 +539,11 @@ CDStreamConfig get_config(Mesh *mesh, const bool use_vertex_interpolation)
 /* ************************************************************************** */
 
 AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
-    : AbcObjectReader(object, settings)
+    : AbcObjectReader(object, settings),
+      m_topology_mesh(nullptr),
+      m_topology_read_flag(0),
+      m_read_ahead_pool(nullptr),
+      m_read_ahead_index(0)
 {
   m_settings->read_flag |= MOD_MESHSEQ_READ_ALL;
 
@@ -483,6 +553,15 @@ AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
   get_min_max_time(m_iobject, m_schema, m_min_time, m_max_time);
 }
 
+AbcMeshReader::~AbcMeshReader()
+{
+  if (m_read_ahead_pool) {
+    BLI_task_pool_work_and_wait(m_read_ahead_pool);
+    BLI_task_pool_free(m_read_ahead_pool);
+  }
+  free_topology_cache();
+}
+
 bool AbcMeshReader::valid() const
 {
   return m_schema.valid();
@@ -595,6 +674,8 @@ bool AbcMeshReader::accepts_object_type(
 
 bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector &sample_sel)
 {
+  wait_for_read_ahead();
+
   IPolyMeshSchema::Sample sample;
   try {
     sample = m_schema.getValue(sample_sel);
@@ -623,6 +704,15 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
                                int read_flag,
                                const char **err_str)
 {
+  if (m_topology_mesh) {
+    Mesh *mesh = read_mesh_from_topology(existing_mesh, sample_sel, read_flag, err_str);
+    if (mesh) {
+      return mesh;
+    }
+  }
+
+  wait_for_read_ahead();
+
   IPolyMeshSchema::Sample sample;
   try {
     sample = m_schema.getValue(sample_sel);
@@ -694,6 +784,15 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
 
   read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample_sel, config);
 
+  if ((settings.read_flag & MOD_MESHSEQ_READ_POLY) != 0 &&
+      m_schema.getTopologyVariance() != Alembic::AbcGeom::kHeterogenousTopology &&
+      mesh_to_export->totpoly == poly_count && mesh_to_export->totloop == loop_count) {
+    update_topology_cache(mesh_to_export, settings.read_flag, config);
+  }
+  else {
+    free_topology_cache();
+  }
+
   if (new_mesh) {
     /* Here we assume that the number of materials doesn't change, i.e. that
      * the material slots that were created when the object was loaded from
@@ -710,6 +809,202 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   return existing_mesh;
 }
 
+/* Read a sample of a mesh with a constant topology, copying the topology converted for a previous
+ * sample. Returns null when the whole sample has to be read instead. */
+Mesh *AbcMeshReader::read_mesh_from_topology(Mesh *existing_mesh,
+                                             const ISampleSelector &sample_sel,
+                                             int read_flag,
+                                             const char **err_str)
+{
+  const Mesh *topology_mesh = m_topology_mesh;
+  const bool topology_changed = existing_mesh->totvert != topology_mesh->totvert ||
+                                existing_mesh->totpoly != topology_mesh->totpoly ||
+                                existing_mesh->totloop != topology_mesh->totloop;
+
+  /* Same settings as read_mesh(), the cached topology only holds what they read. */
+  ImportSettings settings;
+  settings.read_flag |= read_flag;
+  if (topology_changed) {
+    settings.read_flag |= MOD_MESHSEQ_READ_ALL;
+  }
+  if (settings.read_flag != m_topology_read_flag) {
+    return nullptr;
+  }
+
+  AbcMeshData abc_mesh_data;
+  const Alembic::AbcGeom::index_t index = sample_sel.getIndex(m_schema.getTimeSampling(),
+                                                               m_schema.getNumSamples());
+  try {
+    abc_mesh_data.positions = read_positions(index);
+  }
+  catch (Alembic::Util::Exception &ex) {
+    if (err_str != nullptr) {
+      *err_str = "Error reading mesh sample; more detail on the console";
+    }
+    printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
+           m_iobject.getFullName().c_str(),
+           m_schema.getName().c_str(),
+           sample_sel.getRequestedTime(),
+           ex.what());
+    return existing_mesh;
+  }
+
+  if (abc_mesh_data.positions->size() != topology_mesh->totvert) {
+    free_topology_cache();
+    return nullptr;
+  }
+
+  Mesh *new_mesh = nullptr;
+  if (topology_changed) {
+    new_mesh = BKE_mesh_new_nomain_from_template(existing_mesh,
+                                                 topology_mesh->totvert,
+                                                 0,
+                                                 0,
+                                                 topology_mesh->totloop,
+                                                 topology_mesh->totpoly);
+  }
+
+  Mesh *mesh_to_export = new_mesh ? new_mesh : existing_mesh;
+  const bool use_vertex_interpolation = read_flag & MOD_MESHSEQ_INTERPOLATE_VERTICES;
+  CDStreamConfig config = get_config(mesh_to_export, use_vertex_interpolation);
+  config.time = sample_sel.getRequestedTime();
+  config.modifier_error_message = err_str;
+
+  get_weight_and_index(config, m_schema.getTimeSampling(), m_schema.getNumSamples());
+
+  if (config.weight != 0.0f) {
+    abc_mesh_data.ceil_positions = read_positions(config.ceil_index);
+  }
+
+  if ((settings.read_flag & MOD_MESHSEQ_READ_VERT) != 0) {
+    read_mverts(config, abc_mesh_data);
+  }
+
+  if ((settings.read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
+    read_mpolys_from_topology(config, topology_mesh, m_topology_uv_name);
+
+    /* Only constant UVs are part of the cached topology. */
+    if ((settings.read_flag & MOD_MESHSEQ_READ_UV) != 0 && m_topology_uv_name.empty()) {
+      read_uvs_params(config, abc_mesh_data, m_schema.getUVsParam(), sample_sel);
+      read_uvs_from_topology(config, abc_mesh_data);
+    }
+
+    process_normals(config, m_schema.getNormalsParam(), sample_sel);
+  }
+
+  if ((settings.read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
+    read_custom_data(m_iobject.getFullName(), m_schema.getArbGeomParams(), config, sample_sel);
+  }
+
+  /* Playback will most likely need the next sample. */
+  read_ahead_positions(std::max(index, config.ceil_index) + 1);
+
+  if (new_mesh) {
+    size_t num_polys = new_mesh->totpoly;
+    if (num_polys > 0) {
+      std::map<std::string, int> mat_map;
+      assign_facesets_to_mpoly(sample_sel, new_mesh->mpoly, num_polys, mat_map);
+    }
+
+    return new_mesh;
+  }
+
+  return existing_mesh;
+}
+
+void AbcMeshReader::update_topology_cache(const Mesh *mesh,
+                                          const int read_flag,
+                                          const CDStreamConfig &config)
+{
+  free_topology_cache();
+
+  m_topology_mesh = BKE_mesh_new_nomain(
+      mesh->totvert, mesh->totedge, 0, mesh->totloop, mesh->totpoly);
+  memcpy(m_topology_mesh->medge, mesh->medge, sizeof(MEdge) * mesh->totedge);
+  memcpy(m_topology_mesh->mloop, mesh->mloop, sizeof(MLoop) * mesh->totloop);
+  memcpy(m_topology_mesh->mpoly, mesh->mpoly, sizeof(MPoly) * mesh->totpoly);
+  m_topology_read_flag = read_flag;
+
+  /* The primary UV map can be animated even when the topology is constant, only keep it when
+   * it is constant as well. */
+  if (config.mloopuv && m_schema.getUVsParam().isConstant()) {
+    const CustomData *ldata = &mesh->ldata;
+    for (int i = 0; i < ldata->totlayer; i++) {
+      const CustomDataLayer &layer = ldata->layers[i];
+      if (layer.type == CD_MLOOPUV && layer.data == config.mloopuv) {
+        m_topology_uv_name = layer.name;
+        CustomData_add_layer_named(&m_topology_mesh->ldata,
+                                   CD_MLOOPUV,
+                                   CD_DUPLICATE,
+                                   layer.data,
+                                   mesh->totloop,
+                                   layer.name);
+        break;
+      }
+    }
+  }
+}
+
+void AbcMeshReader::free_topology_cache()
+{
+  if (m_topology_mesh) {
+    BKE_id_free(nullptr, m_topology_mesh);
+    m_topology_mesh = nullptr;
+  }
+  m_topology_uv_name.clear();
+}
+
+P3fArraySamplePtr AbcMeshReader::read_positions(const Alembic::AbcGeom::index_t index)
+{
+  wait_for_read_ahead();
+
+  if (m_read_ahead_positions && m_read_ahead_index == index) {
+    return m_read_ahead_positions;
+  }
+
+  P3fArraySamplePtr positions;
+  m_schema.getPositionsProperty().get(positions, ISampleSelector(index));
+  return positions;
+}
+
+void AbcMeshReader::read_ahead_task(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  AbcMeshReader *reader = static_cast<AbcMeshReader *>(taskdata);
+
+  try {
+    reader->m_schema.getPositionsProperty().get(reader->m_read_ahead_positions,
+                                                ISampleSelector(reader->m_read_ahead_index));
+  }
+  catch (Alembic::Util::Exception & /*ex*/) {
+    /* The sample is read again when it is needed, which reports the error. */
+    reader->m_read_ahead_positions.reset();
+  }
+}
+
+void AbcMeshReader::read_ahead_positions(const Alembic::AbcGeom::index_t index)
+{
+  if (index >= static_cast<Alembic::AbcGeom::index_t>(m_schema.getNumSamples()) ||
+      (m_read_ahead_positions && m_read_ahead_index == index)) {
+    return;
+  }
+
+  if (m_read_ahead_pool == nullptr) {
+    m_read_ahead_pool = BLI_task_pool_create_background(this, TASK_PRIORITY_LOW);
+  }
+
+  m_read_ahead_index = index;
+  m_read_ahead_positions.reset();
+  BLI_task_pool_push(m_read_ahead_pool, read_ahead_task, this, false, nullptr);
+}
+
+/* The read-ahead task uses the schema, wait for it before reading anything else. */
+void AbcMeshReader::wait_for_read_ahead()
+{
+  if (m_read_ahead_pool) {
+    BLI_task_pool_work_and_wait(m_read_ahead_pool);
+  }
+}
+
 void AbcMeshReader::assign_facesets_to_mpoly(const ISampleSelector &sample_sel,
                                              MPoly *mpoly,
                                              int totpoly,
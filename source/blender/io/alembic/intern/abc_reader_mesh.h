@@ -23,6 +23,7 @@
 #include "abc_reader_object.h"
 
 struct Mesh;
+struct TaskPool;
 
 namespace blender::io::alembic {
 
@@ -31,8 +32,20 @@ class AbcMeshReader : public AbcObjectReader {
 
   CDStreamConfig m_mesh_data;
 
+  /* Topology converted from a previous sample of a mesh whose topology does not change over
+   * time, later samples copy it and only read their positions. */
+  Mesh *m_topology_mesh;
+  int m_topology_read_flag;
+  std::string m_topology_uv_name;
+
+  /* Positions of the next sample, read in the background during playback. */
+  TaskPool *m_read_ahead_pool;
+  Alembic::AbcGeom::index_t m_read_ahead_index;
+  Alembic::AbcGeom::P3fArraySamplePtr m_read_ahead_positions;
+
  public:
   AbcMeshReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
+  ~AbcMeshReader() override;
 
   bool valid() const override;
   bool accepts_object_type(const Alembic::AbcCoreAbstract::ObjectHeader &alembic_header,
@@ -56,6 +69,18 @@ class AbcMeshReader : public AbcObjectReader {
                                 MPoly *mpoly,
                                 int totpoly,
                                 std::map<std::string, int> &r_mat_map);
+
+  struct Mesh *read_mesh_from_topology(struct Mesh *existing_mesh,
+                                       const Alembic::Abc::ISampleSelector &sample_sel,
+                                       int read_flag,
+                                       const char **err_str);
+  void update_topology_cache(const Mesh *mesh, int read_flag, const CDStreamConfig &config);
+  void free_topology_cache();
+
+  Alembic::AbcGeom::P3fArraySamplePtr read_positions(Alembic::AbcGeom::index_t index);
+  void read_ahead_positions(Alembic::AbcGeom::index_t index);
+  void wait_for_read_ahead();
+  static void read_ahead_task(TaskPool *__restrict pool, void *taskdata);
 };
 
 class AbcSubDReader : public AbcObjectReader {
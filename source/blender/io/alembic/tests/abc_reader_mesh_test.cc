@@ -0,0 +1,153 @@
+#include "testing/testing.h"
+
+/* Keep first since utildefines defines AT which conflicts with STL */
+#include "intern/abc_reader_mesh.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#include <Alembic/AbcCoreOgawa/All.h>
+#include <Alembic/AbcGeom/All.h>
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BLI_fileops.h"
+#include "BLI_span.hh"
+#include "BLI_utildefines.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+
+using namespace Alembic::AbcGeom;
+
+namespace blender::io::alembic {
+
+class AlembicReaderMeshTest : public testing::Test {
+ protected:
+  static constexpr const char *filename = "abc_reader_mesh_test.abc";
+  static constexpr int frames_num = 4;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void TearDown() override
+  {
+    if (BLI_exists(filename)) {
+      BLI_delete(filename, false, false);
+    }
+  }
+
+  static float uv_offset(const int frame, const bool animated_uvs)
+  {
+    return animated_uvs ? frame * 0.25f : 0.0f;
+  }
+
+  static V3f quad_position(const int frame, const int vert)
+  {
+    static const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    return V3f(corners[vert][0], corners[vert][1] + frame * 0.1f, frame * 0.5f);
+  }
+
+  /* A quad moving along Y and Z on every frame with a constant topology, with UVs moving along X
+   * on every frame when animated. */
+  void write_quad(const bool animated_uvs)
+  {
+    OArchive archive(Alembic::AbcCoreOgawa::WriteArchive(), filename);
+    const uint32_t time_sampling = archive.addTimeSampling(TimeSampling(1.0, 0.0));
+    OXform xform(archive.getTop(), "quad", time_sampling);
+    OPolyMesh poly_mesh(xform, "quadShape", time_sampling);
+    OPolyMeshSchema &schema = poly_mesh.getSchema();
+
+    const int32_t face_indices[4] = {0, 1, 2, 3};
+    const int32_t face_counts[1] = {4};
+    const uint32_t uv_indices[4] = {0, 1, 2, 3};
+
+    for (int frame = 0; frame < frames_num; frame++) {
+      V3f positions[4];
+      for (int i = 0; i < 4; i++) {
+        positions[i] = quad_position(frame, i);
+      }
+      const float offset = uv_offset(frame, animated_uvs);
+      const V2f uvs[4] = {
+          V2f(offset, 0), V2f(offset + 1, 0), V2f(offset + 1, 1), V2f(offset, 1)};
+      const OV2fGeomParam::Sample uv_sample(
+          V2fArraySample(uvs, 4), UInt32ArraySample(uv_indices, 4), kFacevaryingScope);
+
+      const OPolyMeshSchema::Sample sample(P3fArraySample(positions, 4),
+                                           Int32ArraySample(face_indices, 4),
+                                           Int32ArraySample(face_counts, 1),
+                                           uv_sample);
+      schema.set(sample);
+    }
+  }
+
+  /* Read the frames with the same reader, like the mesh sequence cache modifier does. */
+  void expect_frames_read(const bool animated_uvs, const Span<int> frames)
+  {
+    IArchive archive(Alembic::AbcCoreOgawa::ReadArchive(), filename);
+    const IObject object = archive.getTop().getChild("quad").getChild("quadShape");
+    ImportSettings settings;
+    AbcMeshReader reader(object, settings);
+    ASSERT_TRUE(reader.valid());
+
+    Mesh *mesh = BKE_mesh_new_nomain(4, 0, 0, 4, 1);
+
+    for (const int frame : frames) {
+      const char *err_str = nullptr;
+      Mesh *result = reader.read_mesh(
+          mesh, ISampleSelector(double(frame)), MOD_MESHSEQ_READ_ALL, &err_str);
+      EXPECT_EQ(err_str, nullptr);
+      if (result != mesh) {
+        BKE_id_free(nullptr, mesh);
+        mesh = result;
+      }
+
+      ASSERT_EQ(mesh->totvert, 4);
+      for (int i = 0; i < 4; i++) {
+        /* Converted from Alembic's Y-up to Z-up. */
+        const V3f co = quad_position(frame, i);
+        EXPECT_FLOAT_EQ(mesh->mvert[i].co[0], co.x);
+        EXPECT_FLOAT_EQ(mesh->mvert[i].co[1], -co.z);
+        EXPECT_FLOAT_EQ(mesh->mvert[i].co[2], co.y);
+      }
+
+      const MLoopUV *mloopuv = static_cast<const MLoopUV *>(
+          CustomData_get_layer(&mesh->ldata, CD_MLOOPUV));
+      ASSERT_NE(mloopuv, nullptr);
+
+      float uv_min = FLT_MAX;
+      for (int i = 0; i < mesh->totloop; i++) {
+        uv_min = std::min(uv_min, mloopuv[i].uv[0]);
+      }
+      EXPECT_FLOAT_EQ(uv_min, uv_offset(frame, animated_uvs));
+    }
+
+    BKE_id_free(nullptr, mesh);
+  }
+
+  /* Read the frames in order, then out of order, as when scrubbing the timeline. */
+  void expect_uvs_read(const bool animated_uvs)
+  {
+    expect_frames_read(animated_uvs, {0, 1, 2, 3});
+    expect_frames_read(animated_uvs, {2, 0, 3, 1, 1});
+  }
+};
+
+TEST_F(AlembicReaderMeshTest, ConstantTopologyConstantUVs)
+{
+  write_quad(false);
+  expect_uvs_read(false);
+}
+
+/* Frames after the first reuse the topology of the first, but not its UVs. */
+TEST_F(AlembicReaderMeshTest, ConstantTopologyAnimatedUVs)
+{
+  write_quad(true);
+  expect_uvs_read(true);
+}
+
+}  // namespace blender::io::alembic
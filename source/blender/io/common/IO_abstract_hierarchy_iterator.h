@@ -47,6 +47,7 @@ struct Base;
 struct Depsgraph;
 struct DupliObject;
 struct ID;
+struct ListBase;
 struct Object;
 struct ParticleSystem;
 struct ViewLayer;
@@ -238,7 +239,8 @@ class AbstractHierarchyIterator {
    * (sub)frame. */
   virtual void iterate_and_write();
 
-  /* Release all writers. Call after all frames have been exported. */
+  /* Release all writers. Call after all frames have been exported. When releasing a writer
+   * throws, the others are still released before the exception is rethrown. */
   void release_writers();
 
   /* Determine which subset of writers is used for exporting.
@@ -328,6 +330,11 @@ class AbstractHierarchyIterator {
 
   virtual bool should_visit_dupli_object(const DupliObject *dupli_object) const;
 
+  /* Return whether the dupli-objects generated by this duplicator should be visited. Concrete
+   * subclasses can return false to export them in a different way, for example all of them as
+   * a single point instancer. In that case they are not part of the export hierarchy. */
+  virtual bool should_visit_duplilist(Object *duplicator, const ListBase *duplilist);
+
   virtual ExportGraph::key_type determine_graph_index_object(const HierarchyContext *context);
   virtual ExportGraph::key_type determine_graph_index_dupli(
       const HierarchyContext *context,
@@ -348,7 +355,8 @@ class AbstractHierarchyIterator {
   virtual AbstractHierarchyWriter *create_hair_writer(const HierarchyContext *context) = 0;
   virtual AbstractHierarchyWriter *create_particle_writer(const HierarchyContext *context) = 0;
 
-  /* Called by release_writers() to free what the create_XXX_writer() functions allocated. */
+  /* Called by release_writers() to free what the create_XXX_writer() functions allocated. The
+   * writer must be freed even when this throws. */
   virtual void release_writer(AbstractHierarchyWriter *writer) = 0;
 
   AbstractHierarchyWriter *get_writer(const std::string &export_path) const;
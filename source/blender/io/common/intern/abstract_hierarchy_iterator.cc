@@ -21,6 +21,7 @@
 
 #include <climits>
 #include <cstdio>
+#include <exception>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -209,10 +210,23 @@ void AbstractHierarchyIterator::iterate_and_write()
 
 void AbstractHierarchyIterator::release_writers()
 {
+  /* Release all writers even when releasing one throws, the first exception is rethrown after. */
+  std::exception_ptr exception;
   for (WriterMap::value_type it : writers_) {
-    release_writer(it.second);
+    try {
+      release_writer(it.second);
+    }
+    catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
   }
   writers_.clear();
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
 }
 
 void AbstractHierarchyIterator::set_export_subset(ExportSubset export_subset)
@@ -302,7 +316,7 @@ void AbstractHierarchyIterator::export_graph_construct()
 
     /* Export the duplicated objects instanced by this object. */
     ListBase *lb = object_duplilist(depsgraph_, scene, object);
-    if (lb) {
+    if (lb && should_visit_duplilist(object, lb)) {
       DupliParentFinder dupli_parent_finder;
 
       LISTBASE_FOREACH (DupliObject *, dupli_object, lb) {
@@ -755,4 +769,10 @@ bool AbstractHierarchyIterator::should_visit_dupli_object(const DupliObject *dup
   return !dupli_object->no_draw;
 }
 
+bool AbstractHierarchyIterator::should_visit_duplilist(Object * /*duplicator*/,
+                                                       const ListBase * /*duplilist*/)
+{
+  return true;
+}
+
 }  // namespace blender::io
@@ -25,15 +25,22 @@
 #include "usd_writer_light.h"
 #include "usd_writer_mesh.h"
 #include "usd_writer_metaball.h"
+#include "usd_writer_point_instancer.h"
 #include "usd_writer_transform.h"
 
+#include <climits>
+#include <exception>
 #include <string>
 
 #include <pxr/base/tf/stringUtils.h>
+#include <pxr/usd/sdf/changeBlock.h>
 
 #include "BKE_duplilist.h"
 
 #include "BLI_assert.h"
+#include "BLI_listbase.h"
+#include "BLI_math_matrix.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DEG_depsgraph_query.h"
@@ -51,6 +58,19 @@ USDHierarchyIterator::USDHierarchyIterator(Depsgraph *depsgraph,
 {
 }
 
+void USDHierarchyIterator::iterate_and_write()
+{
+  try {
+    AbstractHierarchyIterator::iterate_and_write();
+    write_point_instancers();
+  }
+  catch (...) {
+    release_deferred_writes();
+    throw;
+  }
+  write_deferred();
+}
+
 bool USDHierarchyIterator::mark_as_weak_export(const Object *object) const
 {
   if (params_.selected_objects_only && (object->base_flag & BASE_SELECTED) == 0) {
@@ -59,6 +79,182 @@ bool USDHierarchyIterator::mark_as_weak_export(const Object *object) const
   return false;
 }
 
+bool USDHierarchyIterator::should_visit_duplilist(Object *duplicator, const ListBase *duplilist)
+{
+  if (!params_.use_instancing) {
+    return true;
+  }
+
+  /* Switching between regular prims and a point instancer over time would leave the prims of
+   * the other frames behind, so a duplicator is written the way it was on its first frame. */
+  if (regular_duplicators_.count(duplicator) != 0) {
+    return true;
+  }
+  const bool is_point_instancer = point_instancers_.count(duplicator) != 0;
+
+  /* Only meshes that do not generate instances themselves can be prototypes. */
+  USDPointInstances instances;
+  instances.duplicator = duplicator;
+  bool ids_fit = true;
+  LISTBASE_FOREACH (const DupliObject *, dupli_object, duplilist) {
+    if (!should_visit_dupli_object(dupli_object) || dupli_object->ob->type == OB_EMPTY) {
+      continue;
+    }
+    if (dupli_object->ob->type != OB_MESH || (dupli_object->ob->transflag & OB_DUPLI)) {
+      if (!is_point_instancer) {
+        regular_duplicators_.insert(duplicator);
+        return true;
+      }
+      /* Skip what cannot be instanced. */
+      continue;
+    }
+
+    instances.objects.push_back(dupli_object->ob);
+    instances.matrices.push_back(float4x4(dupli_object->mat));
+    instances.ids.push_back(dupli_object->persistent_id[0]);
+    if (dupli_object->persistent_id[1] != INT_MAX) {
+      ids_fit = false;
+    }
+  }
+
+  /* A single instance is written as a regular prim. */
+  if (instances.objects.size() < 2 && !is_point_instancer) {
+    regular_duplicators_.insert(duplicator);
+    return true;
+  }
+  if (!ids_fit) {
+    instances.ids.clear();
+  }
+
+  point_instancers_.insert(duplicator);
+  point_instances_.push_back(std::move(instances));
+  return false;
+}
+
+void USDHierarchyIterator::write_point_instancers()
+{
+  for (USDPointInstances &instances : point_instances_) {
+    Object *duplicator = instances.duplicator;
+    const std::map<const Object *, std::string>::const_iterator duplicator_path =
+        object_export_paths_.find(duplicator);
+    if (duplicator_path == object_export_paths_.end()) {
+      continue;
+    }
+
+    HierarchyContext context{};
+    context.object = duplicator;
+    context.export_name = "instances";
+    context.higher_up_export_path = duplicator_path->second;
+    context.export_path = path_concatenate(context.higher_up_export_path, context.export_name);
+    copy_m4_m4(context.matrix_world, duplicator->obmat);
+
+    USDPointInstancerWriter *writer = static_cast<USDPointInstancerWriter *>(
+        get_writer(context.export_path));
+    if (writer == nullptr) {
+      writer = new USDPointInstancerWriter(create_usd_export_context(&context));
+      writers_[context.export_path] = writer;
+    }
+    else if (!export_subset_.shapes) {
+      continue;
+    }
+
+    writer->set_instances(std::move(instances));
+    writer->write(context);
+  }
+  point_instances_.clear();
+}
+
+void USDHierarchyIterator::defer_write(std::function<void()> gather,
+                                       std::function<void()> author,
+                                       std::function<void()> finish,
+                                       std::function<void()> release)
+{
+  deferred_writes_.push_back(
+      {std::move(gather), std::move(author), std::move(finish), std::move(release)});
+}
+
+struct DeferredWriteGatherData {
+  std::vector<std::function<void()>> gather_funcs;
+  /* Exceptions cannot leave the tasks, they are rethrown on the main thread. */
+  std::vector<std::exception_ptr> exceptions;
+};
+
+static void deferred_write_gather_task(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DeferredWriteGatherData *data = static_cast<DeferredWriteGatherData *>(userdata);
+  try {
+    data->gather_funcs[i]();
+  }
+  catch (...) {
+    data->exceptions[i] = std::current_exception();
+  }
+}
+
+void USDHierarchyIterator::write_deferred()
+{
+  DeferredWriteGatherData gather_data;
+  for (DeferredWrite &deferred_write : deferred_writes_) {
+    if (deferred_write.gather) {
+      gather_data.gather_funcs.push_back(std::move(deferred_write.gather));
+    }
+  }
+  gather_data.exceptions.resize(gather_data.gather_funcs.size());
+
+  std::exception_ptr exception;
+  try {
+    /* Gathering the data of a single writer can take long, so do not group them. */
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(
+        0, gather_data.gather_funcs.size(), &gather_data, deferred_write_gather_task, &settings);
+
+    for (const std::exception_ptr &gather_exception : gather_data.exceptions) {
+      if (gather_exception) {
+        std::rethrow_exception(gather_exception);
+      }
+    }
+
+    {
+      /* Batch the change notifications of all values, instead of sending one per value. */
+      pxr::SdfChangeBlock change_block;
+      for (DeferredWrite &deferred_write : deferred_writes_) {
+        if (deferred_write.author) {
+          deferred_write.author();
+        }
+      }
+    }
+
+    for (DeferredWrite &deferred_write : deferred_writes_) {
+      if (deferred_write.finish) {
+        deferred_write.finish();
+      }
+    }
+  }
+  catch (...) {
+    exception = std::current_exception();
+  }
+
+  /* Free what the writers used, also when one of them failed. */
+  release_deferred_writes();
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+void USDHierarchyIterator::release_deferred_writes()
+{
+  for (DeferredWrite &deferred_write : deferred_writes_) {
+    if (deferred_write.release) {
+      deferred_write.release();
+    }
+  }
+  deferred_writes_.clear();
+}
+
 void USDHierarchyIterator::release_writer(AbstractHierarchyWriter *writer)
 {
   delete static_cast<USDAbstractWriter *>(writer);
@@ -88,6 +284,9 @@ USDExporterContext USDHierarchyIterator::create_usd_export_context(const Hierarc
 AbstractHierarchyWriter *USDHierarchyIterator::create_transform_writer(
     const HierarchyContext *context)
 {
+  if (context->duplicator == nullptr) {
+    object_export_paths_[context->object] = context->export_path;
+  }
   return new USDTransformWriter(create_usd_export_context(context));
 }
 
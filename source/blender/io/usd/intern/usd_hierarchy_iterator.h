@@ -21,8 +21,13 @@
 #include "IO_abstract_hierarchy_iterator.h"
 #include "usd.h"
 #include "usd_exporter_context.h"
+#include "usd_writer_point_instancer.h"
 
+#include <functional>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <pxr/usd/usd/common.h>
 #include <pxr/usd/usd/timeCode.h>
@@ -43,18 +48,49 @@ class USDHierarchyIterator : public AbstractHierarchyIterator {
   pxr::UsdTimeCode export_time_;
   const USDExportParams &params_;
 
+  struct DeferredWrite {
+    std::function<void()> gather;
+    std::function<void()> author;
+    std::function<void()> finish;
+    std::function<void()> release;
+  };
+  std::vector<DeferredWrite> deferred_writes_;
+
+  /* Dupli-objects that are written as point instancers instead of as part of the hierarchy, and
+   * the duplicators that have been written like that before. */
+  std::vector<USDPointInstances> point_instances_;
+  std::set<const Object *> point_instancers_;
+  /* Duplicators whose dupli-objects have been written as regular prims. */
+  std::set<const Object *> regular_duplicators_;
+  /* Export paths of the real objects, point instancers are written below their duplicator. */
+  std::map<const Object *, std::string> object_export_paths_;
+
  public:
   USDHierarchyIterator(Depsgraph *depsgraph,
                        pxr::UsdStageRefPtr stage,
                        const USDExportParams &params);
 
+  virtual void iterate_and_write() override;
+
   void set_export_frame(float frame_nr);
   const pxr::UsdTimeCode &get_export_time_code() const;
 
   virtual std::string make_valid_name(const std::string &name) const override;
 
+  /* Write data once the whole hierarchy has been iterated over, so that the data of all writers
+   * can be gathered in parallel. `gather` runs on any thread and must only read Blender data.
+   * `author` then writes the gathered values to the stage, batched with the other writers in a
+   * single change block, so it should only set values of attributes that already exist. `finish`
+   * runs after the change block for anything that needs the stage to be up to date. `release`
+   * always runs last, also when one of the writers threw, to free what the others used. */
+  void defer_write(std::function<void()> gather,
+                   std::function<void()> author,
+                   std::function<void()> finish,
+                   std::function<void()> release);
+
  protected:
   virtual bool mark_as_weak_export(const Object *object) const override;
+  virtual bool should_visit_duplilist(Object *duplicator, const ListBase *duplilist) override;
 
   virtual AbstractHierarchyWriter *create_transform_writer(
       const HierarchyContext *context) override;
@@ -67,6 +103,10 @@ class USDHierarchyIterator : public AbstractHierarchyIterator {
 
  private:
   USDExporterContext create_usd_export_context(const HierarchyContext *context);
+
+  void write_point_instancers();
+  void write_deferred();
+  void release_deferred_writes();
 };
 
 }  // namespace blender::io::usd
@@ -43,6 +43,7 @@
 #include "DNA_particle_types.h"
 
 #include <iostream>
+#include <memory>
 
 namespace blender::io::usd {
 
@@ -69,10 +70,9 @@ void USDGenericMeshWriter::do_write(HierarchyContext &context)
   }
 
   try {
-    write_mesh(context, mesh);
-
-    if (needsfree) {
-      free_export_mesh(mesh);
+    if (write_mesh(context, mesh, needsfree)) {
+      /* The mesh is freed once its data has been written. */
+      return;
     }
   }
   catch (...) {
@@ -81,6 +81,10 @@ void USDGenericMeshWriter::do_write(HierarchyContext &context)
     }
     throw;
   }
+
+  if (needsfree) {
+    free_export_mesh(mesh);
+  }
 }
 
 void USDGenericMeshWriter::free_export_mesh(Mesh *mesh)
@@ -109,128 +113,37 @@ struct USDMeshData {
    * single sharpness or a value per-edge, USD will encode either a single sharpness per crease on
    * a mesh, or sharpness's for all edges making up the creases on a mesh. */
   pxr::VtFloatArray crease_sharpnesses;
-};
-
-void USDGenericMeshWriter::write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh)
-{
-  pxr::UsdTimeCode timecode = get_export_time_code();
-
-  const CustomData *ldata = &mesh->ldata;
-  for (int layer_idx = 0; layer_idx < ldata->totlayer; layer_idx++) {
-    const CustomDataLayer *layer = &ldata->layers[layer_idx];
-    if (layer->type != CD_MLOOPUV) {
-      continue;
-    }
 
-    /* UV coordinates are stored in a Primvar on the Mesh, and can be referenced from materials.
-     * The primvar name is the same as the UV Map name. This is to allow the standard name "st"
-     * for texture coordinates by naming the UV Map as such, without having to guess which UV Map
-     * is the "standard" one. */
-    pxr::TfToken primvar_name(pxr::TfMakeValidIdentifier(layer->name));
-    pxr::UsdGeomPrimvar uv_coords_primvar = usd_mesh.CreatePrimvar(
-        primvar_name, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->faceVarying);
+  /* Coordinates of each UV map, in the order of the layers in the loop custom-data. */
+  std::vector<pxr::VtArray<pxr::GfVec2f>> uv_maps;
+  pxr::VtVec3fArray loop_normals;
+  pxr::VtVec3fArray velocities;
+};
 
-    MLoopUV *mloopuv = static_cast<MLoopUV *>(layer->data);
-    pxr::VtArray<pxr::GfVec2f> uv_coords;
-    for (int loop_idx = 0; loop_idx < mesh->totloop; loop_idx++) {
-      uv_coords.push_back(pxr::GfVec2f(mloopuv[loop_idx].uv));
-    }
+struct USDMeshAttribute {
+  pxr::UsdAttribute attr;
+  /* Provide the first value as default as well. This makes USD write the value as constant if it
+   * doesn't change over time. */
+  bool set_default;
+};
 
-    if (!uv_coords_primvar.HasValue()) {
-      uv_coords_primvar.Set(uv_coords, pxr::UsdTimeCode::Default());
-    }
-    const pxr::UsdAttribute &uv_coords_attr = uv_coords_primvar.GetAttr();
-    usd_value_writer_.SetAttribute(uv_coords_attr, pxr::VtValue(uv_coords), timecode);
-  }
-}
+/* Attributes are created before the mesh data is gathered, as only their values are set in the
+ * change block that batches the data of all meshes. */
+struct USDMeshAttributes {
+  USDMeshAttribute points;
+  USDMeshAttribute face_vertex_counts;
+  USDMeshAttribute face_indices;
+  USDMeshAttribute crease_lengths;
+  USDMeshAttribute crease_indices;
+  USDMeshAttribute crease_sharpnesses;
+  std::vector<USDMeshAttribute> uv_maps;
+  USDMeshAttribute normals;
+  pxr::UsdAttribute velocities;
+};
 
-void USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
+static USDMeshAttribute mesh_attribute(const pxr::UsdAttribute &attr)
 {
-  pxr::UsdTimeCode timecode = get_export_time_code();
-  pxr::UsdTimeCode defaultTime = pxr::UsdTimeCode::Default();
-  pxr::UsdStageRefPtr stage = usd_export_context_.stage;
-  const pxr::SdfPath &usd_path = usd_export_context_.usd_path;
-
-  pxr::UsdGeomMesh usd_mesh = pxr::UsdGeomMesh::Define(stage, usd_path);
-  write_visibility(context, timecode, usd_mesh);
-
-  USDMeshData usd_mesh_data;
-  get_geometry_data(mesh, usd_mesh_data);
-
-  if (usd_export_context_.export_params.use_instancing && context.is_instance()) {
-    if (!mark_as_instance(context, usd_mesh.GetPrim())) {
-      return;
-    }
-
-    /* The material path will be of the form </_materials/{material name}>, which is outside the
-     * sub-tree pointed to by ref_path. As a result, the referenced data is not allowed to point
-     * out of its own sub-tree. It does work when we override the material with exactly the same
-     * path, though.*/
-    if (usd_export_context_.export_params.export_materials) {
-      assign_materials(context, usd_mesh, usd_mesh_data.face_groups);
-    }
-
-    return;
-  }
-
-  pxr::UsdAttribute attr_points = usd_mesh.CreatePointsAttr(pxr::VtValue(), true);
-  pxr::UsdAttribute attr_face_vertex_counts = usd_mesh.CreateFaceVertexCountsAttr(pxr::VtValue(),
-                                                                                  true);
-  pxr::UsdAttribute attr_face_vertex_indices = usd_mesh.CreateFaceVertexIndicesAttr(pxr::VtValue(),
-                                                                                    true);
-
-  if (!attr_points.HasValue()) {
-    /* Provide the initial value as default. This makes USD write the value as constant if they
-     * don't change over time. */
-    attr_points.Set(usd_mesh_data.points, defaultTime);
-    attr_face_vertex_counts.Set(usd_mesh_data.face_vertex_counts, defaultTime);
-    attr_face_vertex_indices.Set(usd_mesh_data.face_indices, defaultTime);
-  }
-
-  usd_value_writer_.SetAttribute(attr_points, pxr::VtValue(usd_mesh_data.points), timecode);
-  usd_value_writer_.SetAttribute(
-      attr_face_vertex_counts, pxr::VtValue(usd_mesh_data.face_vertex_counts), timecode);
-  usd_value_writer_.SetAttribute(
-      attr_face_vertex_indices, pxr::VtValue(usd_mesh_data.face_indices), timecode);
-
-  if (!usd_mesh_data.crease_lengths.empty()) {
-    pxr::UsdAttribute attr_crease_lengths = usd_mesh.CreateCreaseLengthsAttr(pxr::VtValue(), true);
-    pxr::UsdAttribute attr_crease_indices = usd_mesh.CreateCreaseIndicesAttr(pxr::VtValue(), true);
-    pxr::UsdAttribute attr_crease_sharpness = usd_mesh.CreateCreaseSharpnessesAttr(pxr::VtValue(),
-                                                                                   true);
-
-    if (!attr_crease_lengths.HasValue()) {
-      attr_crease_lengths.Set(usd_mesh_data.crease_lengths, defaultTime);
-      attr_crease_indices.Set(usd_mesh_data.crease_vertex_indices, defaultTime);
-      attr_crease_sharpness.Set(usd_mesh_data.crease_sharpnesses, defaultTime);
-    }
-
-    usd_value_writer_.SetAttribute(
-        attr_crease_lengths, pxr::VtValue(usd_mesh_data.crease_lengths), timecode);
-    usd_value_writer_.SetAttribute(
-        attr_crease_indices, pxr::VtValue(usd_mesh_data.crease_vertex_indices), timecode);
-    usd_value_writer_.SetAttribute(
-        attr_crease_sharpness, pxr::VtValue(usd_mesh_data.crease_sharpnesses), timecode);
-  }
-
-  if (usd_export_context_.export_params.export_uvmaps) {
-    write_uv_maps(mesh, usd_mesh);
-  }
-  if (usd_export_context_.export_params.export_normals) {
-    write_normals(mesh, usd_mesh);
-  }
-  write_surface_velocity(context.object, mesh, usd_mesh);
-
-  /* TODO(Sybren): figure out what happens when the face groups change. */
-  if (frame_has_been_written_) {
-    return;
-  }
-
-  usd_mesh.CreateSubdivisionSchemeAttr().Set(pxr::UsdGeomTokens->none);
-
-  if (usd_export_context_.export_params.export_materials) {
-    assign_materials(context, usd_mesh, usd_mesh_data.face_groups);
-  }
+  return USDMeshAttribute{attr, !attr.HasValue()};
 }
 
 static void get_vertices(const Mesh *mesh, USDMeshData &usd_mesh_data)
@@ -292,18 +205,269 @@ static void get_creases(const Mesh *mesh, USDMeshData &usd_mesh_data)
   }
 }
 
-void USDGenericMeshWriter::get_geometry_data(const Mesh *mesh, USDMeshData &usd_mesh_data)
+static bool mesh_has_creases(const Mesh *mesh)
+{
+  const MEdge *edge = mesh->medge;
+  for (int edge_idx = 0, totedge = mesh->totedge; edge_idx < totedge; ++edge_idx, ++edge) {
+    if (edge->crease != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void get_uv_maps(const Mesh *mesh, USDMeshData &usd_mesh_data)
+{
+  const CustomData *ldata = &mesh->ldata;
+  for (int layer_idx = 0; layer_idx < ldata->totlayer; layer_idx++) {
+    const CustomDataLayer *layer = &ldata->layers[layer_idx];
+    if (layer->type != CD_MLOOPUV) {
+      continue;
+    }
+
+    const MLoopUV *mloopuv = static_cast<const MLoopUV *>(layer->data);
+    pxr::VtArray<pxr::GfVec2f> uv_coords;
+    uv_coords.reserve(mesh->totloop);
+    for (int loop_idx = 0; loop_idx < mesh->totloop; loop_idx++) {
+      uv_coords.push_back(pxr::GfVec2f(mloopuv[loop_idx].uv));
+    }
+    usd_mesh_data.uv_maps.push_back(uv_coords);
+  }
+}
+
+static void get_loop_normals(const Mesh *mesh, USDMeshData &usd_mesh_data)
+{
+  const float(*lnors)[3] = static_cast<float(*)[3]>(CustomData_get_layer(&mesh->ldata, CD_NORMAL));
+
+  pxr::VtVec3fArray &loop_normals = usd_mesh_data.loop_normals;
+  loop_normals.reserve(mesh->totloop);
+
+  if (lnors != nullptr) {
+    /* Export custom loop normals. */
+    for (int loop_idx = 0, totloop = mesh->totloop; loop_idx < totloop; ++loop_idx) {
+      loop_normals.push_back(pxr::GfVec3f(lnors[loop_idx]));
+    }
+  }
+  else {
+    /* Compute the loop normals based on the 'smooth' flag. */
+    float normal[3];
+    MPoly *mpoly = mesh->mpoly;
+    const MVert *mvert = mesh->mvert;
+    for (int poly_idx = 0, totpoly = mesh->totpoly; poly_idx < totpoly; ++poly_idx, ++mpoly) {
+      MLoop *mloop = mesh->mloop + mpoly->loopstart;
+
+      if ((mpoly->flag & ME_SMOOTH) == 0) {
+        /* Flat shaded, use common normal for all verts. */
+        BKE_mesh_calc_poly_normal(mpoly, mloop, mvert, normal);
+        pxr::GfVec3f pxr_normal(normal);
+        for (int loop_idx = 0; loop_idx < mpoly->totloop; ++loop_idx) {
+          loop_normals.push_back(pxr_normal);
+        }
+      }
+      else {
+        /* Smooth shaded, use individual vert normals. */
+        for (int loop_idx = 0; loop_idx < mpoly->totloop; ++loop_idx, ++mloop) {
+          normal_short_to_float_v3(normal, mvert[mloop->v].no);
+          loop_normals.push_back(pxr::GfVec3f(normal));
+        }
+      }
+    }
+  }
+}
+
+static void get_velocities(const Mesh *mesh,
+                           const FluidVertexVelocity *mesh_velocities,
+                           USDMeshData &usd_mesh_data)
+{
+  /* Export per-vertex velocity vectors. */
+  pxr::VtVec3fArray &usd_velocities = usd_mesh_data.velocities;
+  usd_velocities.reserve(mesh->totvert);
+
+  for (int vertex_idx = 0, totvert = mesh->totvert; vertex_idx < totvert;
+       ++vertex_idx, ++mesh_velocities) {
+    usd_velocities.push_back(pxr::GfVec3f(mesh_velocities->vel));
+  }
+}
+
+/* Runs in parallel with the other writers, so this must not touch the USD stage. */
+void USDGenericMeshWriter::get_geometry_data(const Mesh *mesh,
+                                             const FluidVertexVelocity *mesh_velocities,
+                                             USDMeshData &usd_mesh_data)
 {
   get_vertices(mesh, usd_mesh_data);
   get_loops_polys(mesh, usd_mesh_data);
   get_creases(mesh, usd_mesh_data);
+
+  if (usd_export_context_.export_params.export_uvmaps) {
+    get_uv_maps(mesh, usd_mesh_data);
+  }
+  if (usd_export_context_.export_params.export_normals) {
+    get_loop_normals(mesh, usd_mesh_data);
+  }
+  if (mesh_velocities != nullptr) {
+    get_velocities(mesh, mesh_velocities, usd_mesh_data);
+  }
+}
+
+void USDGenericMeshWriter::create_attributes(const Mesh *mesh,
+                                             const FluidVertexVelocity *mesh_velocities,
+                                             pxr::UsdGeomMesh usd_mesh,
+                                             USDMeshAttributes &attributes)
+{
+  attributes.points = mesh_attribute(usd_mesh.CreatePointsAttr(pxr::VtValue(), true));
+  attributes.face_vertex_counts = mesh_attribute(
+      usd_mesh.CreateFaceVertexCountsAttr(pxr::VtValue(), true));
+  attributes.face_indices = mesh_attribute(
+      usd_mesh.CreateFaceVertexIndicesAttr(pxr::VtValue(), true));
+
+  if (mesh_has_creases(mesh)) {
+    attributes.crease_lengths = mesh_attribute(
+        usd_mesh.CreateCreaseLengthsAttr(pxr::VtValue(), true));
+    attributes.crease_indices = mesh_attribute(
+        usd_mesh.CreateCreaseIndicesAttr(pxr::VtValue(), true));
+    attributes.crease_sharpnesses = mesh_attribute(
+        usd_mesh.CreateCreaseSharpnessesAttr(pxr::VtValue(), true));
+  }
+
+  if (usd_export_context_.export_params.export_uvmaps) {
+    const CustomData *ldata = &mesh->ldata;
+    for (int layer_idx = 0; layer_idx < ldata->totlayer; layer_idx++) {
+      const CustomDataLayer *layer = &ldata->layers[layer_idx];
+      if (layer->type != CD_MLOOPUV) {
+        continue;
+      }
+
+      /* UV coordinates are stored in a Primvar on the Mesh, and can be referenced from materials.
+       * The primvar name is the same as the UV Map name. This is to allow the standard name "st"
+       * for texture coordinates by naming the UV Map as such, without having to guess which UV
+       * Map is the "standard" one. */
+      pxr::TfToken primvar_name(pxr::TfMakeValidIdentifier(layer->name));
+      pxr::UsdGeomPrimvar uv_coords_primvar = usd_mesh.CreatePrimvar(
+          primvar_name, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->faceVarying);
+      attributes.uv_maps.push_back(mesh_attribute(uv_coords_primvar.GetAttr()));
+    }
+  }
+
+  if (usd_export_context_.export_params.export_normals) {
+    attributes.normals = mesh_attribute(usd_mesh.CreateNormalsAttr(pxr::VtValue(), true));
+    usd_mesh.SetNormalsInterpolation(pxr::UsdGeomTokens->faceVarying);
+  }
+
+  if (mesh_velocities != nullptr) {
+    attributes.velocities = usd_mesh.CreateVelocitiesAttr();
+  }
+}
+
+void USDGenericMeshWriter::set_attribute(const USDMeshAttribute &attribute,
+                                         const pxr::VtValue &value,
+                                         const pxr::UsdTimeCode timecode)
+{
+  if (attribute.set_default) {
+    attribute.attr.Set(value, pxr::UsdTimeCode::Default());
+  }
+  usd_value_writer_.SetAttribute(attribute.attr, value, timecode);
+}
+
+void USDGenericMeshWriter::write_attributes(const USDMeshAttributes &attributes,
+                                            const USDMeshData &usd_mesh_data,
+                                            const pxr::UsdTimeCode timecode)
+{
+  set_attribute(attributes.points, pxr::VtValue(usd_mesh_data.points), timecode);
+  set_attribute(
+      attributes.face_vertex_counts, pxr::VtValue(usd_mesh_data.face_vertex_counts), timecode);
+  set_attribute(attributes.face_indices, pxr::VtValue(usd_mesh_data.face_indices), timecode);
+
+  if (attributes.crease_lengths.attr) {
+    set_attribute(
+        attributes.crease_lengths, pxr::VtValue(usd_mesh_data.crease_lengths), timecode);
+    set_attribute(
+        attributes.crease_indices, pxr::VtValue(usd_mesh_data.crease_vertex_indices), timecode);
+    set_attribute(
+        attributes.crease_sharpnesses, pxr::VtValue(usd_mesh_data.crease_sharpnesses), timecode);
+  }
+
+  for (size_t uv_map_idx = 0; uv_map_idx < attributes.uv_maps.size(); uv_map_idx++) {
+    set_attribute(attributes.uv_maps[uv_map_idx],
+                  pxr::VtValue(usd_mesh_data.uv_maps[uv_map_idx]),
+                  timecode);
+  }
+
+  if (attributes.normals.attr) {
+    set_attribute(attributes.normals, pxr::VtValue(usd_mesh_data.loop_normals), timecode);
+  }
+
+  if (attributes.velocities) {
+    attributes.velocities.Set(usd_mesh_data.velocities, timecode);
+  }
+}
+
+bool USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh, const bool needsfree)
+{
+  pxr::UsdTimeCode timecode = get_export_time_code();
+  pxr::UsdStageRefPtr stage = usd_export_context_.stage;
+  const pxr::SdfPath &usd_path = usd_export_context_.usd_path;
+  const USDExportParams &export_params = usd_export_context_.export_params;
+
+  pxr::UsdGeomMesh usd_mesh = pxr::UsdGeomMesh::Define(stage, usd_path);
+  write_visibility(context, timecode, usd_mesh);
+
+  if (export_params.use_instancing && context.is_instance()) {
+    if (!mark_as_instance(context, usd_mesh.GetPrim())) {
+      return false;
+    }
+
+    /* The material path will be of the form </_materials/{material name}>, which is outside the
+     * sub-tree pointed to by ref_path. As a result, the referenced data is not allowed to point
+     * out of its own sub-tree. It does work when we override the material with exactly the same
+     * path, though.*/
+    if (export_params.export_materials) {
+      USDMeshData usd_mesh_data;
+      get_loops_polys(mesh, usd_mesh_data);
+      assign_materials(context.object, usd_mesh, usd_mesh_data.face_groups);
+    }
+
+    return false;
+  }
+
+  Object *object = context.object;
+  const FluidVertexVelocity *mesh_velocities = get_fluid_velocities(object);
+  std::shared_ptr<USDMeshAttributes> attributes = std::make_shared<USDMeshAttributes>();
+  create_attributes(mesh, mesh_velocities, usd_mesh, *attributes);
+
+  /* TODO(Sybren): figure out what happens when the face groups change. */
+  const bool is_first_frame = !frame_has_been_written_;
+  std::shared_ptr<USDMeshData> usd_mesh_data = std::make_shared<USDMeshData>();
+
+  usd_export_context_.hierarchy_iterator->defer_write(
+      [this, mesh, mesh_velocities, usd_mesh_data]() {
+        get_geometry_data(mesh, mesh_velocities, *usd_mesh_data);
+      },
+      [this, attributes, usd_mesh_data, timecode]() {
+        write_attributes(*attributes, *usd_mesh_data, timecode);
+      },
+      [this, object, is_first_frame, usd_mesh, usd_mesh_data]() {
+        if (is_first_frame) {
+          usd_mesh.CreateSubdivisionSchemeAttr().Set(pxr::UsdGeomTokens->none);
+
+          if (usd_export_context_.export_params.export_materials) {
+            assign_materials(object, usd_mesh, usd_mesh_data->face_groups);
+          }
+        }
+      },
+      [this, mesh, needsfree]() {
+        if (needsfree) {
+          free_export_mesh(mesh);
+        }
+      });
+
+  return true;
 }
 
-void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
+void USDGenericMeshWriter::assign_materials(Object *object,
                                             pxr::UsdGeomMesh usd_mesh,
                                             const MaterialFaceGroups &usd_face_groups)
 {
-  if (context.object->totcol == 0) {
+  if (object->totcol == 0) {
     return;
   }
 
@@ -312,8 +476,8 @@ void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
    * https://github.com/PixarAnimationStudios/USD/issues/542 for more info. */
   bool mesh_material_bound = false;
   pxr::UsdShadeMaterialBindingAPI material_binding_api(usd_mesh.GetPrim());
-  for (int mat_num = 0; mat_num < context.object->totcol; mat_num++) {
-    Material *material = BKE_object_material_get(context.object, mat_num + 1);
+  for (int mat_num = 0; mat_num < object->totcol; mat_num++) {
+    Material *material = BKE_object_material_get(object, mat_num + 1);
     if (material == nullptr) {
       continue;
     }
@@ -347,7 +511,7 @@ void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
     short material_number = face_group.first;
     const pxr::VtIntArray &face_indices = face_group.second;
 
-    Material *material = BKE_object_material_get(context.object, material_number + 1);
+    Material *material = BKE_object_material_get(object, material_number + 1);
     if (material == nullptr) {
       continue;
     }
@@ -361,64 +525,14 @@ void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
   }
 }
 
-void USDGenericMeshWriter::write_normals(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh)
-{
-  pxr::UsdTimeCode timecode = get_export_time_code();
-  const float(*lnors)[3] = static_cast<float(*)[3]>(CustomData_get_layer(&mesh->ldata, CD_NORMAL));
-
-  pxr::VtVec3fArray loop_normals;
-  loop_normals.reserve(mesh->totloop);
-
-  if (lnors != nullptr) {
-    /* Export custom loop normals. */
-    for (int loop_idx = 0, totloop = mesh->totloop; loop_idx < totloop; ++loop_idx) {
-      loop_normals.push_back(pxr::GfVec3f(lnors[loop_idx]));
-    }
-  }
-  else {
-    /* Compute the loop normals based on the 'smooth' flag. */
-    float normal[3];
-    MPoly *mpoly = mesh->mpoly;
-    const MVert *mvert = mesh->mvert;
-    for (int poly_idx = 0, totpoly = mesh->totpoly; poly_idx < totpoly; ++poly_idx, ++mpoly) {
-      MLoop *mloop = mesh->mloop + mpoly->loopstart;
-
-      if ((mpoly->flag & ME_SMOOTH) == 0) {
-        /* Flat shaded, use common normal for all verts. */
-        BKE_mesh_calc_poly_normal(mpoly, mloop, mvert, normal);
-        pxr::GfVec3f pxr_normal(normal);
-        for (int loop_idx = 0; loop_idx < mpoly->totloop; ++loop_idx) {
-          loop_normals.push_back(pxr_normal);
-        }
-      }
-      else {
-        /* Smooth shaded, use individual vert normals. */
-        for (int loop_idx = 0; loop_idx < mpoly->totloop; ++loop_idx, ++mloop) {
-          normal_short_to_float_v3(normal, mvert[mloop->v].no);
-          loop_normals.push_back(pxr::GfVec3f(normal));
-        }
-      }
-    }
-  }
-
-  pxr::UsdAttribute attr_normals = usd_mesh.CreateNormalsAttr(pxr::VtValue(), true);
-  if (!attr_normals.HasValue()) {
-    attr_normals.Set(loop_normals, pxr::UsdTimeCode::Default());
-  }
-  usd_value_writer_.SetAttribute(attr_normals, pxr::VtValue(loop_normals), timecode);
-  usd_mesh.SetNormalsInterpolation(pxr::UsdGeomTokens->faceVarying);
-}
-
-void USDGenericMeshWriter::write_surface_velocity(Object *object,
-                                                  const Mesh *mesh,
-                                                  pxr::UsdGeomMesh usd_mesh)
+const FluidVertexVelocity *USDGenericMeshWriter::get_fluid_velocities(Object *object) const
 {
   /* Only velocities from the fluid simulation are exported. This is the most important case,
    * though, as the baked mesh changes topology all the time, and thus computing the velocities
    * at import time in a post-processing step is hard. */
   ModifierData *md = BKE_modifiers_findby_type(object, eModifierType_Fluidsim);
   if (md == nullptr) {
-    return;
+    return nullptr;
   }
 
   /* Check that the fluid sim modifier is enabled and has useful data. */
@@ -426,29 +540,13 @@ void USDGenericMeshWriter::write_surface_velocity(Object *object,
   const ModifierMode required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
   const Scene *scene = DEG_get_evaluated_scene(usd_export_context_.depsgraph);
   if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
-    return;
+    return nullptr;
   }
   FluidsimModifierData *fsmd = reinterpret_cast<FluidsimModifierData *>(md);
   if (!fsmd->fss || fsmd->fss->type != OB_FLUIDSIM_DOMAIN) {
-    return;
-  }
-  FluidsimSettings *fss = fsmd->fss;
-  if (!fss->meshVelocities) {
-    return;
+    return nullptr;
   }
-
-  /* Export per-vertex velocity vectors. */
-  pxr::VtVec3fArray usd_velocities;
-  usd_velocities.reserve(mesh->totvert);
-
-  FluidVertexVelocity *mesh_velocities = fss->meshVelocities;
-  for (int vertex_idx = 0, totvert = mesh->totvert; vertex_idx < totvert;
-       ++vertex_idx, ++mesh_velocities) {
-    usd_velocities.push_back(pxr::GfVec3f(mesh_velocities->vel));
-  }
-
-  pxr::UsdTimeCode timecode = get_export_time_code();
-  usd_mesh.CreateVelocitiesAttr().Set(usd_velocities, timecode);
+  return fsmd->fss->meshVelocities;
 }
 
 USDMeshWriter::USDMeshWriter(const USDExporterContext &ctx) : USDGenericMeshWriter(ctx)
@@ -22,8 +22,12 @@
 
 #include <pxr/usd/usdGeom/mesh.h>
 
+struct FluidVertexVelocity;
+
 namespace blender::io::usd {
 
+struct USDMeshAttribute;
+struct USDMeshAttributes;
 struct USDMeshData;
 
 /* Writer for USD geometry. Does not assume the object is a mesh object. */
@@ -42,14 +46,26 @@ class USDGenericMeshWriter : public USDAbstractWriter {
   /* Mapping from material slot number to array of face indices with that material. */
   typedef std::map<short, pxr::VtIntArray> MaterialFaceGroups;
 
-  void write_mesh(HierarchyContext &context, Mesh *mesh);
-  void get_geometry_data(const Mesh *mesh, struct USDMeshData &usd_mesh_data);
-  void assign_materials(const HierarchyContext &context,
+  /* Write the mesh, return true when writing the mesh data has been deferred, in which case the
+   * mesh is freed afterwards if `needsfree` is set. */
+  bool write_mesh(HierarchyContext &context, Mesh *mesh, bool needsfree);
+  void get_geometry_data(const Mesh *mesh,
+                         const FluidVertexVelocity *mesh_velocities,
+                         struct USDMeshData &usd_mesh_data);
+  void create_attributes(const Mesh *mesh,
+                         const FluidVertexVelocity *mesh_velocities,
+                         pxr::UsdGeomMesh usd_mesh,
+                         USDMeshAttributes &attributes);
+  void set_attribute(const USDMeshAttribute &attribute,
+                     const pxr::VtValue &value,
+                     pxr::UsdTimeCode timecode);
+  void write_attributes(const USDMeshAttributes &attributes,
+                        const USDMeshData &usd_mesh_data,
+                        pxr::UsdTimeCode timecode);
+  void assign_materials(Object *object,
                         pxr::UsdGeomMesh usd_mesh,
                         const MaterialFaceGroups &usd_face_groups);
-  void write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh);
-  void write_normals(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh);
-  void write_surface_velocity(Object *object, const Mesh *mesh, pxr::UsdGeomMesh usd_mesh);
+  const FluidVertexVelocity *get_fluid_velocities(Object *object) const;
 };
 
 class USDMeshWriter : public USDGenericMeshWriter {
@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "usd_writer_point_instancer.h"
+#include "usd_hierarchy_iterator.h"
+#include "usd_writer_mesh.h"
+
+#include <pxr/usd/usdGeom/scope.h>
+
+#include <memory>
+
+#include "BLI_math_matrix.h"
+#include "BLI_task.h"
+
+#include "DNA_object_types.h"
+
+/* TfToken objects are not cheap to construct, so we do it once. */
+namespace usdtokens {
+static const pxr::TfToken prototypes("Prototypes", pxr::TfToken::Immortal);
+}  // namespace usdtokens
+
+namespace blender::io::usd {
+
+/* Per-instance data of one frame, gathered in parallel with the data of the other writers. */
+struct USDPointInstancerData {
+  USDPointInstances instances;
+  float4x4 duplicator_inv;
+
+  pxr::VtIntArray proto_indices;
+  pxr::VtVec3fArray positions;
+  pxr::VtQuathArray orientations;
+  pxr::VtVec3fArray scales;
+  pxr::VtInt64Array ids;
+
+  /* Array data, accessed without the copy-on-write checks of #pxr::VtArray from the threads. */
+  pxr::GfVec3f *positions_data;
+  pxr::GfQuath *orientations_data;
+  pxr::GfVec3f *scales_data;
+};
+
+USDPointInstancerWriter::USDPointInstancerWriter(const USDExporterContext &ctx)
+    : USDAbstractWriter(ctx)
+{
+}
+
+USDPointInstancerWriter::~USDPointInstancerWriter()
+{
+  for (USDAbstractWriter *prototype_writer : prototype_writers_) {
+    delete prototype_writer;
+  }
+}
+
+void USDPointInstancerWriter::set_instances(USDPointInstances &&instances)
+{
+  instances_ = std::move(instances);
+}
+
+bool USDPointInstancerWriter::check_is_animated(const HierarchyContext & /*context*/) const
+{
+  /* The instances are generated by the duplicator and may change on every frame. */
+  return true;
+}
+
+int USDPointInstancerWriter::ensure_prototype(Object *object)
+{
+  std::map<const Object *, int>::const_iterator it = prototype_indices_.find(object);
+  if (it != prototype_indices_.end()) {
+    return it->second;
+  }
+
+  /* Prototypes below the point instancer are only drawn as instances. */
+  pxr::SdfPath prototypes_path = usd_export_context_.usd_path.AppendChild(usdtokens::prototypes);
+  if (prototype_paths_.empty()) {
+    pxr::UsdGeomScope::Define(usd_export_context_.stage, prototypes_path);
+  }
+
+  pxr::TfToken prototype_name(usd_export_context_.hierarchy_iterator->get_id_name(&object->id));
+  pxr::SdfPath prototype_path = prototypes_path.AppendChild(prototype_name);
+  USDExporterContext prototype_export_context{usd_export_context_.depsgraph,
+                                              usd_export_context_.stage,
+                                              prototype_path,
+                                              usd_export_context_.hierarchy_iterator,
+                                              usd_export_context_.export_params};
+
+  const int index = prototype_writers_.size();
+  prototype_indices_[object] = index;
+  prototype_objects_.push_back(object);
+  prototype_writers_.push_back(new USDMeshWriter(prototype_export_context));
+  prototype_paths_.push_back(prototype_path);
+  return index;
+}
+
+void USDPointInstancerWriter::write_prototype(const HierarchyContext &context, const int index)
+{
+  Object *object = prototype_objects_[index];
+
+  HierarchyContext prototype_context{};
+  prototype_context.object = object;
+  /* Determine the visibility like for the other dupli-objects. */
+  prototype_context.duplicator = context.object;
+  copy_m4_m4(prototype_context.matrix_world, object->obmat);
+  prototype_context.export_name = prototype_paths_[index].GetName();
+  prototype_context.export_path = prototype_paths_[index].GetString();
+  prototype_context.higher_up_export_path = prototype_paths_[index].GetParentPath().GetString();
+
+  USDAbstractWriter *prototype_writer = prototype_writers_[index];
+  if (!prototype_writer->is_supported(&prototype_context)) {
+    return;
+  }
+  prototype_writer->write(prototype_context);
+}
+
+static void point_instancer_transform_task(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  USDPointInstancerData *data = static_cast<USDPointInstancerData *>(userdata);
+  const float4x4 matrix = data->duplicator_inv * data->instances.matrices[i];
+  float loc[3], quat[4], size[3];
+
+  mat4_decompose(loc, quat, size, matrix.values);
+
+  data->positions_data[i] = pxr::GfVec3f(loc);
+  data->orientations_data[i] = pxr::GfQuath(pxr::GfQuatf(quat[0], quat[1], quat[2], quat[3]));
+  data->scales_data[i] = pxr::GfVec3f(size);
+}
+
+static void point_instancer_gather(USDPointInstancerData &data)
+{
+  const int instances_num = data.instances.matrices.size();
+
+  data.positions.resize(instances_num);
+  data.orientations.resize(instances_num);
+  data.scales.resize(instances_num);
+  data.positions_data = data.positions.data();
+  data.orientations_data = data.orientations.data();
+  data.scales_data = data.scales.data();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, instances_num, &data, point_instancer_transform_task, &settings);
+
+  data.ids.assign(data.instances.ids.begin(), data.instances.ids.end());
+}
+
+void USDPointInstancerWriter::do_write(HierarchyContext &context)
+{
+  pxr::UsdTimeCode timecode = get_export_time_code();
+  pxr::UsdGeomPointInstancer usd_instancer = pxr::UsdGeomPointInstancer::Define(
+      usd_export_context_.stage, usd_export_context_.usd_path);
+  write_visibility(context, timecode, usd_instancer);
+
+  std::shared_ptr<USDPointInstancerData> data = std::make_shared<USDPointInstancerData>();
+  data->instances = std::move(instances_);
+  data->duplicator_inv = float4x4(context.object->obmat).inverted();
+
+  /* Prototypes are written once per frame, regardless of how often they are instanced. */
+  const size_t prototypes_num = prototype_paths_.size();
+  const std::vector<Object *> &objects = data->instances.objects;
+  data->proto_indices.resize(objects.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    data->proto_indices[i] = ensure_prototype(objects[i]);
+  }
+  std::vector<bool> prototype_is_used(prototype_paths_.size(), false);
+  for (const int index : data->proto_indices) {
+    prototype_is_used[index] = true;
+  }
+  for (size_t index = 0; index < prototype_is_used.size(); index++) {
+    if (prototype_is_used[index]) {
+      write_prototype(context, index);
+    }
+  }
+  if (prototype_paths_.size() != prototypes_num) {
+    usd_instancer.CreatePrototypesRel().SetTargets(prototype_paths_);
+  }
+
+  pxr::UsdAttribute attr_proto_indices = usd_instancer.CreateProtoIndicesAttr(pxr::VtValue(),
+                                                                              true);
+  pxr::UsdAttribute attr_positions = usd_instancer.CreatePositionsAttr(pxr::VtValue(), true);
+  pxr::UsdAttribute attr_orientations = usd_instancer.CreateOrientationsAttr(pxr::VtValue(), true);
+  pxr::UsdAttribute attr_scales = usd_instancer.CreateScalesAttr(pxr::VtValue(), true);
+  pxr::UsdAttribute attr_ids;
+  if (!data->instances.ids.empty()) {
+    attr_ids = usd_instancer.CreateIdsAttr(pxr::VtValue(), true);
+  }
+
+  usd_export_context_.hierarchy_iterator->defer_write(
+      [data]() { point_instancer_gather(*data); },
+      [this, data, attr_proto_indices, attr_positions, attr_orientations, attr_scales, attr_ids,
+       timecode]() {
+        usd_value_writer_.SetAttribute(
+            attr_proto_indices, pxr::VtValue(data->proto_indices), timecode);
+        usd_value_writer_.SetAttribute(attr_positions, pxr::VtValue(data->positions), timecode);
+        usd_value_writer_.SetAttribute(
+            attr_orientations, pxr::VtValue(data->orientations), timecode);
+        usd_value_writer_.SetAttribute(attr_scales, pxr::VtValue(data->scales), timecode);
+        if (attr_ids) {
+          usd_value_writer_.SetAttribute(attr_ids, pxr::VtValue(data->ids), timecode);
+        }
+      },
+      nullptr,
+      nullptr);
+}
+
+}  // namespace blender::io::usd
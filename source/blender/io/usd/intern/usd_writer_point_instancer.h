@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd_writer_abstract.h"
+
+#include <pxr/usd/usdGeom/pointInstancer.h>
+
+#include <map>
+#include <vector>
+
+#include "BLI_float4x4.hh"
+
+namespace blender::io::usd {
+
+/* Dupli-objects of a single duplicator, exported as one point instancer. */
+struct USDPointInstances {
+  Object *duplicator;
+  std::vector<Object *> objects;
+  /* World matrices of the instances. */
+  std::vector<float4x4> matrices;
+  /* Persistent IDs of the instances, empty when they do not fit in a single integer. */
+  std::vector<int> ids;
+};
+
+/* Writes the instances of a duplicator as a PointInstancer, with the instanced objects as its
+ * prototypes. This is much lighter than a prim per instance, when the same few objects are
+ * instanced many times. */
+class USDPointInstancerWriter : public USDAbstractWriter {
+ private:
+  USDPointInstances instances_;
+
+  /* Index of the objects in the prototypes relationship. Prototypes are only ever added, so that
+   * the indices remain valid over time. */
+  std::map<const Object *, int> prototype_indices_;
+  std::vector<Object *> prototype_objects_;
+  std::vector<USDAbstractWriter *> prototype_writers_;
+  pxr::SdfPathVector prototype_paths_;
+
+ public:
+  USDPointInstancerWriter(const USDExporterContext &ctx);
+  ~USDPointInstancerWriter();
+
+  /* Set the instances written by the next call to write(). */
+  void set_instances(USDPointInstances &&instances);
+
+ protected:
+  virtual void do_write(HierarchyContext &context) override;
+  virtual bool check_is_animated(const HierarchyContext &context) const override;
+
+ private:
+  int ensure_prototype(Object *object);
+  void write_prototype(const HierarchyContext &context, int index);
+};
+
+}  // namespace blender::io::usd
@@ -124,7 +124,14 @@ typedef struct Mesh_Runtime {
    */
   char wrapper_type_finalize;
 
-  char _pad[4];
+  /**
+   * Set when the batch cache was taken over from the previous evaluated mesh of the object,
+   * which only differed in vertex positions (see #mesh_build_data).
+   * The following dirty tag then only discards the position dependent buffers.
+   */
+  char batch_cache_deform_only;
+
+  char _pad[3];
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra;
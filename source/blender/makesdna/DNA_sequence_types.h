@@ -695,6 +695,9 @@ enum {
 
   SEQ_CACHE_PREFETCH_ENABLE = (1 << 10),
   SEQ_CACHE_DISK_CACHE_ENABLE = (1 << 11),
+
+  /* Show render time of cached final frames in timeline UI. */
+  SEQ_CACHE_VIEW_RENDER_TIME = (1 << 12),
 };
 
 #ifdef __cplusplus
@@ -34,6 +34,8 @@
 
 #include "BLT_translation.h"
 
+#include "IMB_imbuf.h"
+
 #include "BKE_addon.h"
 #include "BKE_appdir.h"
 #include "BKE_sound.h"
@@ -564,6 +566,14 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_image_scale_filter_update(Main *UNUSED(bmain),
+                                                  Scene *UNUSED(scene),
+                                                  PointerRNA *UNUSED(ptr))
+{
+  IMB_scale_filter_preference_set(U.image_scale_filter);
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_Userdef_disk_cache_dir_update(Main *UNUSED(bmain),
                                               Scene *UNUSED(scene),
                                               PointerRNA *UNUSED(ptr))
@@ -5316,6 +5326,12 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Lightweight compression with very fast decoding, for storage that can't keep up with "
+       "uncompressed images"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -5329,6 +5345,23 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       {0, NULL, 0, NULL, NULL},
   };
 
+  static const EnumPropertyItem image_scale_filter_items[] = {
+      {IMB_SCALE_FILTER_DEFAULT, "DEFAULT", 0, "Default", "Fast scaling, lowest quality"},
+      {IMB_SCALE_FILTER_BOX, "BOX", 0, "Box", "Average of the covered pixels"},
+      {IMB_SCALE_FILTER_BILINEAR, "BILINEAR", 0, "Bilinear", "Linear interpolation"},
+      {IMB_SCALE_FILTER_MITCHELL,
+       "MITCHELL",
+       0,
+       "Mitchell",
+       "Cubic filter, balanced between sharpness and ringing"},
+      {IMB_SCALE_FILTER_LANCZOS3,
+       "LANCZOS3",
+       0,
+       "Lanczos",
+       "Sharpest result, slowest and may cause ringing near edges"},
+      {0, NULL, 0, NULL, NULL},
+  };
+
   srna = RNA_def_struct(brna, "PreferencesSystem", NULL);
   RNA_def_struct_sdna(srna, "UserDef");
   RNA_def_struct_nested(brna, srna, "Preferences");
@@ -5396,6 +5429,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       "Disk Cache Compression Level",
       "Smaller compression will result in larger files, but less decoding overhead");
 
+  prop = RNA_def_property(srna, "image_scale_filter", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_items(prop, image_scale_filter_items);
+  RNA_def_property_enum_sdna(prop, NULL, "image_scale_filter");
+  RNA_def_property_ui_text(
+      prop,
+      "Image Scale Filter",
+      "Filter used to scale thumbnails, proxies and images in the sequencer preview");
+  RNA_def_property_update(prop, 0, "rna_Userdef_image_scale_filter_update");
+
   prop = RNA_def_property(srna, "scrollback", PROP_INT, PROP_UNSIGNED);
   RNA_def_property_int_sdna(prop, NULL, "scrollback");
   RNA_def_property_range(prop, 32, 32768);
@@ -6192,6 +6234,14 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "use_object_add_tool", 1);
   RNA_def_property_ui_text(
       prop, "Add Object Tool", "Show add object tool in the toolbar in Object Mode and Edit Mode");
+
+  prop = RNA_def_property(srna, "use_sculpt_pbvh_sah", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_sculpt_pbvh_sah", 1);
+  RNA_def_property_ui_text(prop,
+                           "Sculpt Mode SAH Acceleration Structure",
+                           "Split the sculpt acceleration structure using the surface area "
+                           "heuristic, which is slower to build but faster for brushes and "
+                           "ray-casts on uneven meshes");
 }
 
 static void rna_def_userdef_addon_collection(BlenderRNA *brna, PropertyRNA *cprop)
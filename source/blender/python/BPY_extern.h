@@ -98,6 +98,8 @@ void BPY_context_dict_clear_members_array(void **dict_p,
                                           uint context_members_len);
 
 void BPY_id_release(struct ID *id);
+/* Invalidate the buffers of the ID's data, needed even without `WITH_PYTHON_SAFETY`. */
+void BPY_id_release_buffers(struct ID *id);
 
 bool BPY_string_is_keyword(const char *str);
 
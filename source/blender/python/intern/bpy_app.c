@@ -49,6 +49,7 @@
 
 #include "BKE_appdir.h"
 #include "BKE_blender_version.h"
+#include "BKE_fcurve_driver.h"
 #include "BKE_global.h"
 
 #include "DNA_ID.h"
@@ -349,6 +350,17 @@ static PyObject *bpy_app_driver_dict_get(PyObject *UNUSED(self), void *UNUSED(cl
   return Py_INCREF_RET(bpy_pydriver_Dict);
 }
 
+PyDoc_STRVAR(bpy_app_driver_stats_doc,
+             "Number of driver expressions compiled since startup, as a tuple of the ones "
+             "evaluated with the simple expression evaluator and the ones falling back to Python, "
+             "which can't run multi-threaded (read-only)");
+static PyObject *bpy_app_driver_stats_get(PyObject *UNUSED(self), void *UNUSED(closure))
+{
+  uint64_t simple_num, python_num;
+  BKE_driver_expression_stats_get(&simple_num, &python_num);
+  return Py_BuildValue("(KK)", (unsigned long long)simple_num, (unsigned long long)python_num);
+}
+
 PyDoc_STRVAR(bpy_app_preview_render_size_doc,
              "Reference size for icon/preview renders (read-only)");
 static PyObject *bpy_app_preview_render_size_get(PyObject *UNUSED(self), void *closure)
@@ -456,6 +468,7 @@ static PyGetSetDef bpy_app_getsets[] = {
      NULL},
     {"tempdir", bpy_app_tempdir_get, NULL, bpy_app_tempdir_doc, NULL},
     {"driver_namespace", bpy_app_driver_dict_get, NULL, bpy_app_driver_dict_doc, NULL},
+    {"driver_stats", bpy_app_driver_stats_get, NULL, bpy_app_driver_stats_doc, NULL},
 
     {"render_icon_size",
      bpy_app_preview_render_size_get,
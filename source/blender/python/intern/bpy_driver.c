@@ -92,6 +92,8 @@ int bpy_pydriver_create_dict(void)
   mod = PyImport_ImportModule("math");
   if (mod) {
     PyDict_Merge(d, PyModule_GetDict(mod), 0); /* 0 - don't overwrite existing values */
+    /* Also allow the `math.` prefix, as the simple expression evaluator does. */
+    PyDict_SetItemString(d, "math", mod);
     Py_DECREF(mod);
   }
 #ifdef USE_BYTECODE_WHITELIST
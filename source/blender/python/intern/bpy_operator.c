@@ -199,6 +199,11 @@ static PyObject *pyop_call(PyObject *UNUSED(self), PyObject *args)
     return NULL;
   }
 
+  /* Operators may reallocate or free any data. */
+  if (pyrna_prop_collection_buffer_exports_check(NULL, opname) == -1) {
+    return NULL;
+  }
+
   if (!pyrna_write_check()) {
     PyErr_Format(PyExc_RuntimeError,
                  "Calling operator \"bpy.ops.%s\" error, "
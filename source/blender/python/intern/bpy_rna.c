@@ -33,9 +33,11 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_dynstr.h"
+#include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_math_rotation.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BPY_extern.h"
@@ -48,10 +50,6 @@
 #include "bpy_rna_anim.h"
 #include "bpy_rna_callback.h"
 
-#ifdef USE_PYRNA_INVALIDATE_WEAKREF
-#  include "BLI_ghash.h"
-#endif
-
 #include "RNA_access.h"
 #include "RNA_define.h" /* RNA_def_property_free_identifier */
 #include "RNA_enum_types.h"
@@ -5419,6 +5417,45 @@ static PyObject *pyrna_prop_collection_foreach_set(BPy_PropertyRNA *self, PyObje
   return foreach_getset(self, args, 1);
 }
 
+static PyObject *pyrna_prop_collection_buffer_CreatePyObject(BPy_PropertyRNA *collection,
+                                                             const char *attr);
+
+PyDoc_STRVAR(
+    pyrna_prop_collection_as_buffer_doc,
+    ".. method:: as_buffer(attr)\n"
+    "\n"
+    "   Direct access to an attribute of all items in the collection, without copying.\n"
+    "   The returned object supports the buffer protocol, so it can be passed to ``memoryview``\n"
+    "   or ``numpy.asarray`` to read and write the data in place. Like with :meth:`foreach_set`,\n"
+    "   writing the data doesn't send update notifications.\n"
+    "\n"
+    "   :arg attr: Name of an attribute of the items.\n"
+    "   :type attr: string\n"
+    "   :return: Buffer with the attribute values of all items, with a row per item when the\n"
+    "      attribute is an array.\n"
+    "\n"
+    "   .. warning::\n"
+    "\n"
+    "      Views of the buffer point directly to Blender's data. While they exist, RNA functions\n"
+    "      of the data's ID, removing the ID and running operators raise a ``BufferError``,\n"
+    "      so release the views (e.g. delete the NumPy arrays) before adding items.\n"
+    "      Changes made outside of Python, or through :mod:`bmesh`, are not prevented,\n"
+    "      the buffer then refuses to create new views but existing ones must not be used.\n");
+static PyObject *pyrna_prop_collection_as_buffer(BPy_PropertyRNA *self, PyObject *value)
+{
+  PYRNA_PROP_CHECK_OBJ(self);
+
+  const char *attr = PyUnicode_AsUTF8(value);
+  if (attr == NULL) {
+    PyErr_Format(PyExc_TypeError,
+                 "as_buffer(attr): expected a string, not %.200s",
+                 Py_TYPE(value)->tp_name);
+    return NULL;
+  }
+
+  return pyrna_prop_collection_buffer_CreatePyObject(self, attr);
+}
+
 static PyObject *pyprop_array_foreach_getset(BPy_PropertyArrayRNA *self,
                                              PyObject *args,
                                              const bool do_set)
@@ -5756,6 +5793,10 @@ static struct PyMethodDef pyrna_prop_collection_methods[] = {
      (PyCFunction)pyrna_prop_collection_foreach_set,
      METH_VARARGS,
      pyrna_prop_collection_foreach_set_doc},
+    {"as_buffer",
+     (PyCFunction)pyrna_prop_collection_as_buffer,
+     METH_O,
+     pyrna_prop_collection_as_buffer_doc},
 
     {"keys", (PyCFunction)pyrna_prop_collection_keys, METH_NOARGS, pyrna_prop_collection_keys_doc},
     {"items",
@@ -6044,6 +6085,56 @@ static PyObject *small_dict_get_item_string(PyObject *dict, const char *key_look
   return NULL;
 }
 
+/**
+ * Functions may reallocate or free the data of their own ID or of the IDs passed to them,
+ * refuse calling them while views of that data are exported.
+ */
+static int pyrna_func_buffer_exports_check(PointerRNA *self_ptr,
+                                           FunctionRNA *self_func,
+                                           PyObject *args,
+                                           PyObject *kw)
+{
+  if (!pyrna_prop_collection_buffer_has_exports(NULL)) {
+    return 0;
+  }
+
+  char error_prefix[512];
+  BLI_snprintf(error_prefix,
+               sizeof(error_prefix),
+               "%.200s.%.200s()",
+               RNA_struct_identifier(self_ptr->type),
+               RNA_function_identifier(self_func));
+
+  if (self_ptr->owner_id &&
+      pyrna_prop_collection_buffer_exports_check(self_ptr->owner_id, error_prefix) == -1) {
+    return -1;
+  }
+
+  const Py_ssize_t args_len = PyTuple_GET_SIZE(args);
+  for (Py_ssize_t i = 0; i < args_len; i++) {
+    PyObject *item = PyTuple_GET_ITEM(args, i);
+    if (BPy_StructRNA_Check(item) && ((BPy_StructRNA *)item)->ptr.owner_id &&
+        pyrna_prop_collection_buffer_exports_check(((BPy_StructRNA *)item)->ptr.owner_id,
+                                                   error_prefix) == -1) {
+      return -1;
+    }
+  }
+
+  if (kw) {
+    PyObject *key, *item;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(kw, &pos, &key, &item)) {
+      if (BPy_StructRNA_Check(item) && ((BPy_StructRNA *)item)->ptr.owner_id &&
+          pyrna_prop_collection_buffer_exports_check(((BPy_StructRNA *)item)->ptr.owner_id,
+                                                     error_prefix) == -1) {
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
 static PyObject *pyrna_func_call(BPy_FunctionRNA *self, PyObject *args, PyObject *kw)
 {
   /* Note, both BPy_StructRNA and BPy_PropertyRNA can be used here. */
@@ -6086,6 +6177,10 @@ static PyObject *pyrna_func_call(BPy_FunctionRNA *self, PyObject *args, PyObject
     return NULL;
   }
 
+  if (pyrna_func_buffer_exports_check(self_ptr, self_func, args, kw) == -1) {
+    return NULL;
+  }
+
   /* For testing. */
 #if 0
   {
@@ -7188,6 +7283,390 @@ static void pyrna_prop_collection_iter_dealloc(BPy_PropertyCollectionIterRNA *se
 /* --- collection iterator: end --- */
 #endif /* !USE_PYRNA_ITER */
 
+/* --- collection buffer: start --- */
+/* Expose the raw array of an attribute of all collection items through the buffer protocol,
+ * see #RNA_property_collection_raw_array. */
+
+static int pyrna_prop_collection_buffer_getbuffer(BPy_PropertyCollectionBufferRNA *self,
+                                                  Py_buffer *view,
+                                                  int flags);
+static void pyrna_prop_collection_buffer_releasebuffer(BPy_PropertyCollectionBufferRNA *self,
+                                                       Py_buffer *view);
+static void pyrna_prop_collection_buffer_dealloc(BPy_PropertyCollectionBufferRNA *self);
+
+static PyBufferProcs pyrna_prop_collection_buffer_as_buffer = {
+    (getbufferproc)pyrna_prop_collection_buffer_getbuffer,         /* bf_getbuffer */
+    (releasebufferproc)pyrna_prop_collection_buffer_releasebuffer, /* bf_releasebuffer */
+};
+
+/* All buffers, to invalidate them when the data's ID is freed. IDs can be freed from other
+ * threads than the one holding the GIL, the lock is held while adding and removing buffers. */
+static GSet *pyrna_prop_collection_buffers = NULL;
+static ThreadMutex pyrna_prop_collection_buffers_lock = BLI_MUTEX_INITIALIZER;
+/* Views of all buffers currently exported. */
+static int pyrna_prop_collection_buffer_exports_len = 0;
+
+static PyTypeObject pyrna_prop_collection_buffer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "bpy_prop_collection_buffer", /* tp_name */
+    sizeof(BPy_PropertyCollectionBufferRNA),                     /* tp_basicsize */
+    0,                                                           /* tp_itemsize */
+    /* methods */
+    (destructor)pyrna_prop_collection_buffer_dealloc, /* tp_dealloc */
+#if PY_VERSION_HEX >= 0x03080000
+    0, /* tp_vectorcall_offset */
+#else
+    (printfunc)NULL, /* printfunc tp_print */
+#endif
+    NULL, /* getattrfunc tp_getattr; */
+    NULL, /* setattrfunc tp_setattr; */
+    NULL,
+    /* tp_compare */ /* DEPRECATED in Python 3.0! */
+    NULL,
+    /* subclassed */ /* tp_repr */
+
+    /* Method suites for standard classes */
+
+    NULL, /* PyNumberMethods *tp_as_number; */
+    NULL, /* PySequenceMethods *tp_as_sequence; */
+    NULL, /* PyMappingMethods *tp_as_mapping; */
+
+    /* More standard operations (here for binary compatibility) */
+
+    NULL, /* hashfunc tp_hash; */
+    NULL, /* ternaryfunc tp_call; */
+    NULL, /* reprfunc tp_str; */
+    NULL, /* getattrofunc tp_getattro; */
+    NULL, /* setattrofunc tp_setattro; */
+
+    /* Functions to access object as input/output buffer */
+    &pyrna_prop_collection_buffer_as_buffer, /* PyBufferProcs *tp_as_buffer; */
+
+    /*** Flags to define presence of optional/expanded features ***/
+    Py_TPFLAGS_DEFAULT, /* long tp_flags; */
+
+    NULL, /*  char *tp_doc;  Documentation string */
+    /*** Assigned meaning in release 2.0 ***/
+    /* call function for all accessible objects */
+    NULL, /* traverseproc tp_traverse; */
+
+    /* delete references to contained objects */
+    NULL, /* inquiry tp_clear; */
+
+    /***  Assigned meaning in release 2.1 ***/
+    /*** rich comparisons (subclassed) ***/
+    NULL, /* richcmpfunc tp_richcompare; */
+
+    /***  weak reference enabler ***/
+    0, /* long tp_weaklistoffset; */
+    /*** Added in release 2.2 ***/
+    /*   Iterators */
+    NULL, /* getiterfunc tp_iter; */
+    NULL, /* iternextfunc tp_iternext; */
+
+    /*** Attribute descriptor and subclassing stuff ***/
+    NULL, /* struct PyMethodDef *tp_methods; */
+    NULL, /* struct PyMemberDef *tp_members; */
+    NULL, /* struct PyGetSetDef *tp_getset; */
+    NULL, /* struct _typeobject *tp_base; */
+    NULL, /* PyObject *tp_dict; */
+    NULL, /* descrgetfunc tp_descr_get; */
+    NULL, /* descrsetfunc tp_descr_set; */
+    0,    /* long tp_dictoffset; */
+    NULL, /* initproc tp_init; */
+    NULL, /* allocfunc tp_alloc; */
+    NULL, /* newfunc tp_new; */
+    /*  Low-level free-memory routine */
+    NULL, /* freefunc tp_free;  */
+    /* For PyObject_IS_GC */
+    NULL, /* inquiry tp_is_gc;  */
+    NULL, /* PyObject *tp_bases; */
+    /* method resolution order */
+    NULL, /* PyObject *tp_mro;  */
+    NULL, /* PyObject *tp_cache; */
+    NULL, /* PyObject *tp_subclasses; */
+    NULL, /* PyObject *tp_weaklist; */
+    NULL,
+};
+
+/* Struct format character of the raw type, as used by the buffer protocol. */
+static const char *pyrna_raw_type_buffer_format(const RawPropertyType raw_type,
+                                                const bool attr_signed)
+{
+  switch (raw_type) {
+    case PROP_RAW_CHAR:
+      return attr_signed ? "b" : "B";
+    case PROP_RAW_SHORT:
+      return attr_signed ? "h" : "H";
+    case PROP_RAW_INT:
+      return attr_signed ? "i" : "I";
+    case PROP_RAW_BOOLEAN:
+      return "?";
+    case PROP_RAW_FLOAT:
+      return "f";
+    case PROP_RAW_DOUBLE:
+      return "d";
+    case PROP_RAW_UNSET:
+      return NULL;
+  }
+
+  return NULL;
+}
+
+static PyObject *pyrna_prop_collection_buffer_CreatePyObject(BPy_PropertyRNA *collection,
+                                                             const char *attr)
+{
+  PropertyRNA *itemprop = NULL;
+  int attr_tot = 0;
+  bool is_empty = true;
+
+  /* Look up the attribute in the first item, items may be of a more specific type than the
+   * collection declares. */
+  bool is_editable = false;
+  RNA_PROP_BEGIN (&collection->ptr, itemptr, collection->prop) {
+    is_empty = false;
+    itemprop = RNA_struct_find_property(&itemptr, attr);
+    if (itemprop) {
+      attr_tot = RNA_property_array_length(&itemptr, itemprop);
+      is_editable = RNA_property_editable(&itemptr, itemprop);
+    }
+    break;
+  }
+  RNA_PROP_END;
+
+  if (is_empty) {
+    StructRNA *srna = RNA_property_pointer_type(&collection->ptr, collection->prop);
+    itemprop = srna ? RNA_struct_type_find_property(srna, attr) : NULL;
+    /* There is nothing to write. */
+    is_editable = false;
+  }
+
+  if (itemprop == NULL) {
+    PyErr_Format(PyExc_AttributeError,
+                 "as_buffer: '%.200s.%200s[...]' elements have no attribute '%.200s'",
+                 RNA_struct_identifier(collection->ptr.type),
+                 RNA_property_identifier(collection->prop),
+                 attr);
+    return NULL;
+  }
+
+  const RawPropertyType raw_type = RNA_property_raw_type(itemprop);
+  const char *format = pyrna_raw_type_buffer_format(
+      raw_type, RNA_property_subtype(itemprop) != PROP_UNSIGNED);
+  RawArray array;
+
+  if (format == NULL || !RNA_property_collection_raw_array(
+                            &collection->ptr, collection->prop, itemprop, &array)) {
+    PyErr_Format(PyExc_TypeError,
+                 "as_buffer: attribute '%.200s' doesn't support direct access, "
+                 "use foreach_get/foreach_set instead",
+                 attr);
+    return NULL;
+  }
+
+  BPy_PropertyCollectionBufferRNA *self = PyObject_New(BPy_PropertyCollectionBufferRNA,
+                                                       &pyrna_prop_collection_buffer_Type);
+  Py_INCREF(collection);
+  self->collection = collection;
+  self->itemprop = itemprop;
+  self->owner_id = collection->ptr.owner_id;
+  self->is_valid = true;
+  self->is_editable = is_editable;
+  self->exports = 0;
+  self->array = array;
+  self->format = format;
+  self->itemsize = RNA_raw_type_sizeof(raw_type);
+  self->is_contiguous = (array.len <= 1) || (array.stride == self->itemsize * MAX2(attr_tot, 1));
+
+  /* A row per item for array attributes. */
+  self->shape[0] = array.len;
+  self->strides[0] = array.stride;
+  if (attr_tot > 0) {
+    self->ndim = 2;
+    self->shape[1] = attr_tot;
+    self->strides[1] = self->itemsize;
+  }
+  else {
+    self->ndim = 1;
+  }
+
+  BLI_mutex_lock(&pyrna_prop_collection_buffers_lock);
+  if (pyrna_prop_collection_buffers == NULL) {
+    pyrna_prop_collection_buffers = BLI_gset_ptr_new(__func__);
+  }
+  BLI_gset_insert(pyrna_prop_collection_buffers, self);
+  BLI_mutex_unlock(&pyrna_prop_collection_buffers_lock);
+
+  return (PyObject *)self;
+}
+
+static int pyrna_prop_collection_buffer_getbuffer(BPy_PropertyCollectionBufferRNA *self,
+                                                  Py_buffer *view,
+                                                  int flags)
+{
+  BPy_PropertyRNA *collection = self->collection;
+  RawArray array;
+
+  view->obj = NULL;
+
+  /* Don't access the collection once its ID has been freed. */
+  if (!self->is_valid) {
+    PyErr_SetString(PyExc_ReferenceError,
+                    "bpy_prop_collection_buffer: the data was removed, use as_buffer() again");
+    return -1;
+  }
+
+  PYRNA_PROP_CHECK_INT(collection);
+
+  /* The data may have been reallocated or freed since the buffer was created. */
+  if (!RNA_property_collection_raw_array(
+          &collection->ptr, collection->prop, self->itemprop, &array) ||
+      array.array != self->array.array || array.len != self->array.len ||
+      array.stride != self->array.stride) {
+    PyErr_Format(PyExc_ReferenceError,
+                 "bpy_prop_collection_buffer: data of '%.200s' changed since the buffer was "
+                 "created, use as_buffer() again",
+                 RNA_property_identifier(collection->prop));
+    return -1;
+  }
+
+  const bool readonly = !self->is_editable || !pyrna_write_check();
+  if ((flags & PyBUF_WRITABLE) && readonly) {
+    PyErr_SetString(PyExc_BufferError,
+                    "bpy_prop_collection_buffer: data can't be written in this context");
+    return -1;
+  }
+  if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES && !self->is_contiguous) {
+    PyErr_SetString(PyExc_BufferError,
+                    "bpy_prop_collection_buffer: data is not contiguous, strides are required");
+    return -1;
+  }
+  /* Rows of array attributes are contiguous in C order only. */
+  const bool is_f_contiguous = self->is_contiguous &&
+                               (self->ndim == 1 || self->shape[0] <= 1 || self->shape[1] <= 1);
+  if (((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS && !self->is_contiguous) ||
+      ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && !is_f_contiguous) ||
+      ((flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS && !self->is_contiguous)) {
+    PyErr_SetString(PyExc_BufferError,
+                    "bpy_prop_collection_buffer: data is not contiguous in the requested order");
+    return -1;
+  }
+
+  view->buf = array.array;
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->len = (Py_ssize_t)self->itemsize * self->shape[0] *
+              ((self->ndim == 2) ? self->shape[1] : 1);
+  view->itemsize = self->itemsize;
+  view->readonly = readonly;
+  view->format = (flags & PyBUF_FORMAT) ? (char *)self->format : NULL;
+  view->ndim = self->ndim;
+  view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  self->exports++;
+  pyrna_prop_collection_buffer_exports_len++;
+
+  return 0;
+}
+
+static void pyrna_prop_collection_buffer_releasebuffer(BPy_PropertyCollectionBufferRNA *self,
+                                                       Py_buffer *UNUSED(view))
+{
+  BLI_assert(self->exports > 0);
+  self->exports--;
+  pyrna_prop_collection_buffer_exports_len--;
+}
+
+static void pyrna_prop_collection_buffer_dealloc(BPy_PropertyCollectionBufferRNA *self)
+{
+  /* Views reference the buffer, none can be left. */
+  BLI_assert(self->exports == 0);
+
+  BLI_mutex_lock(&pyrna_prop_collection_buffers_lock);
+  BLI_gset_remove(pyrna_prop_collection_buffers, self, NULL);
+  if (BLI_gset_len(pyrna_prop_collection_buffers) == 0) {
+    BLI_gset_free(pyrna_prop_collection_buffers, NULL);
+    pyrna_prop_collection_buffers = NULL;
+  }
+  BLI_mutex_unlock(&pyrna_prop_collection_buffers_lock);
+
+  Py_DECREF(self->collection);
+
+  PyObject_DEL(self);
+}
+
+void BPY_id_release_buffers(struct ID *id)
+{
+  /* Most IDs are freed while no buffer exists. */
+  if (pyrna_prop_collection_buffers == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&pyrna_prop_collection_buffers_lock);
+  if (pyrna_prop_collection_buffers == NULL) {
+    BLI_mutex_unlock(&pyrna_prop_collection_buffers_lock);
+    return;
+  }
+  GSET_FOREACH_BEGIN (BPy_PropertyCollectionBufferRNA *, buffer, pyrna_prop_collection_buffers) {
+    if (buffer->owner_id == id) {
+      /* Views still exported point to freed memory, nothing can be done about them. */
+      if (buffer->exports != 0) {
+        CLOG_WARN(BPY_LOG_RNA,
+                  "'%s' freed while %d view(s) of its data are in use",
+                  id->name + 2,
+                  buffer->exports);
+      }
+      buffer->is_valid = false;
+      buffer->owner_id = NULL;
+    }
+  }
+  GSET_FOREACH_END();
+  BLI_mutex_unlock(&pyrna_prop_collection_buffers_lock);
+}
+
+bool pyrna_prop_collection_buffer_has_exports(const struct ID *id)
+{
+  if (pyrna_prop_collection_buffer_exports_len == 0) {
+    return false;
+  }
+  if (id == NULL) {
+    return true;
+  }
+
+  GSET_FOREACH_BEGIN (BPy_PropertyCollectionBufferRNA *, buffer, pyrna_prop_collection_buffers) {
+    if (buffer->exports != 0 && buffer->owner_id == id) {
+      return true;
+    }
+  }
+  GSET_FOREACH_END();
+
+  return false;
+}
+
+int pyrna_prop_collection_buffer_exports_check(const struct ID *id, const char *error_prefix)
+{
+  if (!pyrna_prop_collection_buffer_has_exports(id)) {
+    return 0;
+  }
+
+  if (id) {
+    PyErr_Format(PyExc_BufferError,
+                 "%.200s: views of the data of '%.200s' exist, release them first",
+                 error_prefix,
+                 id->name + 2);
+  }
+  else {
+    PyErr_Format(PyExc_BufferError,
+                 "%.200s: views of Blender data exist, release them first",
+                 error_prefix);
+  }
+  return -1;
+}
+
+/* --- collection buffer: end --- */
+
 static void pyrna_subtype_set_rna(PyObject *newclass, StructRNA *srna)
 {
   PointerRNA ptr;
@@ -7647,6 +8126,10 @@ void BPY_rna_init(void)
     return;
   }
 #endif
+
+  if (PyType_Ready(&pyrna_prop_collection_buffer_Type) < 0) {
+    return;
+  }
 }
 
 /* 'bpy.data' from Python. */
@@ -168,6 +168,29 @@ typedef struct {
   CollectionPropertyIterator iter;
 } BPy_PropertyCollectionIterRNA;
 
+typedef struct {
+  PyObject_HEAD /* required python macro   */
+
+  /* The collection the data belongs to, referenced so it's valid as long as the buffer is. */
+  BPy_PropertyRNA *collection;
+  PropertyRNA *itemprop;
+  /* The ID the data belongs to, cleared when it's freed, see #BPY_id_release_buffers. */
+  struct ID *owner_id;
+  bool is_valid;
+  bool is_editable;
+  /* Number of views currently exported, the data must not be reallocated while they exist. */
+  int exports;
+
+  /* The data when the buffer was created, it can't be exported once that has been reallocated. */
+  RawArray array;
+  const char *format;
+  int itemsize;
+  bool is_contiguous;
+  int ndim;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+} BPy_PropertyCollectionBufferRNA;
+
 typedef struct {
   PyObject_HEAD /* required python macro   */
 #ifdef USE_WEAKREFS
@@ -258,6 +281,10 @@ void pyrna_invalidate(BPy_DummyPointerRNA *self);
 int pyrna_struct_validity_check(BPy_StructRNA *pysrna);
 int pyrna_prop_validity_check(BPy_PropertyRNA *self);
 
+/* Views exported by collection buffers, see `bpy_prop_collection.as_buffer`. */
+bool pyrna_prop_collection_buffer_has_exports(const struct ID *id);
+int pyrna_prop_collection_buffer_exports_check(const struct ID *id, const char *error_prefix);
+
 /* bpy.utils.(un)register_class */
 extern PyMethodDef meth_bpy_register_class;
 extern PyMethodDef meth_bpy_unregister_class;
@@ -329,6 +329,11 @@ static PyObject *bpy_batch_remove(PyObject *UNUSED(self), PyObject *args, PyObje
         goto error;
       }
 
+      if (pyrna_prop_collection_buffer_exports_check(id, "batch_remove") == -1) {
+        Py_DECREF(ids_fast);
+        goto error;
+      }
+
       id->tag |= LIB_TAG_DOIT;
     }
     Py_DECREF(ids_fast);
@@ -366,6 +371,14 @@ static PyObject *bpy_orphans_purge(PyObject *UNUSED(self),
 #endif
 
   ID *id;
+  FOREACH_MAIN_ID_BEGIN (bmain, id) {
+    if (id->us == 0 && pyrna_prop_collection_buffer_has_exports(id)) {
+      pyrna_prop_collection_buffer_exports_check(id, "orphans_purge");
+      return NULL;
+    }
+  }
+  FOREACH_MAIN_ID_END;
+
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
     if (id->us == 0) {
       id->tag |= LIB_TAG_DOIT;
@@ -507,6 +507,132 @@ int mathutils_any_to_rotmat(float rmat[3][3], PyObject *value, const char *error
   return -1;
 }
 
+/**
+ * Get a C-contiguous buffer of rows with \a array_min to \a array_max items of \a format
+ * (a single character of the `struct` module syntax, `'f'` or `'i'`).
+ * 2D buffers define the row size from their shape, flat buffers need a fixed row size.
+ *
+ * \param buffer_flags: Extra #PyObject_GetBuffer flags, such as `PyBUF_WRITABLE`.
+ * \param r_array_dim: The number of items per row (optional).
+ * \return The number of rows or -1 on error,
+ * otherwise the caller must release the buffer with #PyBuffer_Release.
+ */
+int mathutils_buffer_parse(PyObject *value,
+                           Py_buffer *r_buffer,
+                           const char format,
+                           const int array_min,
+                           const int array_max,
+                           const int buffer_flags,
+                           int *r_array_dim,
+                           const char *error_prefix)
+{
+  const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | buffer_flags;
+  const char *buffer_format;
+  Py_ssize_t len, rows;
+  int array_dim;
+
+  BLI_assert(ELEM(format, 'f', 'i'));
+
+  if (PyObject_GetBuffer(value, r_buffer, flags) == -1) {
+    PyC_Err_Format_Prefix(PyExc_TypeError, "%.200s", error_prefix);
+    return -1;
+  }
+
+  /* Skip the native byte order prefix, 'l' is used for 32 bit integers on some platforms. */
+  buffer_format = r_buffer->format ? r_buffer->format : "B";
+  if (ELEM(buffer_format[0], '@', '=')) {
+    buffer_format++;
+  }
+  if (!((buffer_format[0] == format || (format == 'i' && buffer_format[0] == 'l')) &&
+        buffer_format[1] == '\0' && r_buffer->itemsize == 4)) {
+    PyErr_Format(PyExc_TypeError,
+                 "%.200s: expected a buffer of '%c' items, found '%.200s'",
+                 error_prefix,
+                 format,
+                 r_buffer->format ? r_buffer->format : "B");
+    PyBuffer_Release(r_buffer);
+    return -1;
+  }
+
+  len = r_buffer->len / r_buffer->itemsize;
+  array_dim = -1;
+  if (r_buffer->ndim == 2) {
+    array_dim = (r_buffer->shape[1] <= INT_MAX) ? (int)r_buffer->shape[1] : -1;
+  }
+  else if (r_buffer->ndim == 1 && array_min == array_max) {
+    array_dim = array_max;
+  }
+
+  if (array_dim < array_min || array_dim > array_max || len % array_dim != 0) {
+    if (array_min == array_max) {
+      PyErr_Format(PyExc_ValueError,
+                   "%.200s: expected a 1D buffer with a multiple of %d items, "
+                   "or a 2D buffer with rows of %d items",
+                   error_prefix,
+                   array_max,
+                   array_max);
+    }
+    else {
+      PyErr_Format(PyExc_ValueError,
+                   "%.200s: expected a 2D buffer with rows of %d to %d items",
+                   error_prefix,
+                   array_min,
+                   array_max);
+    }
+    PyBuffer_Release(r_buffer);
+    return -1;
+  }
+
+  rows = len / array_dim;
+  if (rows > INT_MAX) {
+    PyErr_Format(PyExc_ValueError, "%.200s: buffer too large", error_prefix);
+    PyBuffer_Release(r_buffer);
+    return -1;
+  }
+
+  if (r_array_dim) {
+    *r_array_dim = array_dim;
+  }
+  return (int)rows;
+}
+
+/**
+ * Get an optional writable output buffer for \a rows_num rows of \a array_dim items,
+ * None leaves \a r_buffer empty (with a NULL `buf`).
+ *
+ * \return -1 on error, otherwise the caller must release the buffer with #PyBuffer_Release.
+ */
+int mathutils_buffer_parse_output(PyObject *value,
+                                  Py_buffer *r_buffer,
+                                  const char format,
+                                  const int array_dim,
+                                  const int rows_num,
+                                  const char *error_prefix)
+{
+  memset(r_buffer, 0, sizeof(*r_buffer));
+
+  if (value == NULL || value == Py_None) {
+    return 0;
+  }
+
+  const int rows_num_buffer = mathutils_buffer_parse(
+      value, r_buffer, format, array_dim, array_dim, PyBUF_WRITABLE, NULL, error_prefix);
+  if (rows_num_buffer == -1) {
+    memset(r_buffer, 0, sizeof(*r_buffer));
+    return -1;
+  }
+  if (rows_num_buffer != rows_num) {
+    PyErr_Format(PyExc_ValueError,
+                 "%.200s: expected a buffer with %d rows, found %d",
+                 error_prefix,
+                 rows_num,
+                 rows_num_buffer);
+    PyBuffer_Release(r_buffer);
+    return -1;
+  }
+  return 0;
+}
+
 /* ----------------------------------MATRIX FUNCTIONS-------------------- */
 
 /* Utility functions */
@@ -177,6 +177,20 @@ int mathutils_array_parse_alloc_vi(int **array,
 int mathutils_array_parse_alloc_viseq(
     int **array, int **start_table, int **len_table, PyObject *value, const char *error_prefix);
 int mathutils_any_to_rotmat(float rmat[3][3], PyObject *value, const char *error_prefix);
+int mathutils_buffer_parse(PyObject *value,
+                           Py_buffer *r_buffer,
+                           const char format,
+                           const int array_min,
+                           const int array_max,
+                           const int buffer_flags,
+                           int *r_array_dim,
+                           const char *error_prefix);
+int mathutils_buffer_parse_output(PyObject *value,
+                                  Py_buffer *r_buffer,
+                                  const char format,
+                                  const int array_dim,
+                                  const int rows_num,
+                                  const char *error_prefix);
 
 Py_hash_t mathutils_array_hash(const float *float_array, size_t array_len);
 
@@ -23,6 +23,7 @@
 #include "mathutils.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "../generic/py_capi_utils.h"
@@ -1769,6 +1770,75 @@ static PyObject *Matrix_rotate(MatrixObject *self, PyObject *value)
   Py_RETURN_NONE;
 }
 
+/*---------------------------matrix.transform_points() ---------------*/
+
+typedef struct MatrixTransformPointsData {
+  float mat[4][4];
+  float (*points)[3];
+} MatrixTransformPointsData;
+
+static void matrix_transform_points_task(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MatrixTransformPointsData *data = userdata;
+  mul_m4_v3(data->mat, data->points[i]);
+}
+
+PyDoc_STRVAR(Matrix_transform_points_doc,
+             ".. method:: transform_points(points)\n"
+             "\n"
+             "   Multiply an array of points by a 3x3 or 4x4 matrix in-place,\n"
+             "   without creating a :class:`Vector` for each point.\n"
+             "\n"
+             "   :arg points: Writable buffer of 32 bit floats, flat or with rows of 3 items,\n"
+             "      such as a numpy array of shape ``(n, 3)``.\n"
+             "   :type points: buffer\n");
+static PyObject *Matrix_transform_points(MatrixObject *self, PyObject *value)
+{
+  const char *error_prefix = "Matrix.transform_points()";
+  MatrixTransformPointsData data;
+  Py_buffer buffer;
+  int points_num;
+
+  if (BaseMath_ReadCallback(self) == -1) {
+    return NULL;
+  }
+
+  if (self->num_row == 3 && self->num_col == 3) {
+    float mat[3][3];
+    matrix_as_3x3(mat, self);
+    copy_m4_m3(data.mat, mat);
+  }
+  else if (self->num_row == 4 && self->num_col == 4) {
+    copy_m4_m4(data.mat, (float(*)[4])self->matrix);
+  }
+  else {
+    PyErr_SetString(PyExc_ValueError,
+                    "Matrix.transform_points(): "
+                    "must have 3x3 or 4x4 dimensions");
+    return NULL;
+  }
+
+  points_num = mathutils_buffer_parse(
+      value, &buffer, 'f', 3, 3, PyBUF_WRITABLE, NULL, error_prefix);
+  if (points_num == -1) {
+    return NULL;
+  }
+
+  data.points = buffer.buf;
+
+  Py_BEGIN_ALLOW_THREADS;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, points_num, &data, matrix_transform_points_task, &settings);
+  Py_END_ALLOW_THREADS;
+
+  PyBuffer_Release(&buffer);
+  Py_RETURN_NONE;
+}
+
 /*---------------------------matrix.decompose() ---------------------*/
 PyDoc_STRVAR(Matrix_decompose_doc,
              ".. method:: decompose()\n"
@@ -3080,6 +3150,10 @@ static struct PyMethodDef Matrix_methods[] = {
     /* TODO. {"resize_3x3", (PyCFunction) Matrix_resize3x3, METH_NOARGS, Matrix_resize3x3_doc}, */
     {"resize_4x4", (PyCFunction)Matrix_resize_4x4, METH_NOARGS, Matrix_resize_4x4_doc},
     {"rotate", (PyCFunction)Matrix_rotate, METH_O, Matrix_rotate_doc},
+    {"transform_points",
+     (PyCFunction)Matrix_transform_points,
+     METH_O,
+     Matrix_transform_points_doc},
 
     /* return converted representation */
     {"to_euler", (PyCFunction)Matrix_to_euler, METH_VARARGS, Matrix_to_euler_doc},
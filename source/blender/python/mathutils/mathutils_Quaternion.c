@@ -23,6 +23,7 @@
 #include "mathutils.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "../generic/py_capi_utils.h"
@@ -405,6 +406,58 @@ static PyObject *Quaternion_rotate(QuaternionObject *self, PyObject *value)
   Py_RETURN_NONE;
 }
 
+typedef struct QuaternionRotatePointsData {
+  float quat[4];
+  float (*points)[3];
+} QuaternionRotatePointsData;
+
+static void quaternion_rotate_points_task(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  QuaternionRotatePointsData *data = userdata;
+  mul_qt_v3(data->quat, data->points[i]);
+}
+
+PyDoc_STRVAR(Quaternion_rotate_points_doc,
+             ".. method:: rotate_points(points)\n"
+             "\n"
+             "   Rotate an array of points by this quaternion in-place, like ``quat @ point``\n"
+             "   without creating a :class:`Vector` for each point.\n"
+             "\n"
+             "   :arg points: Writable buffer of 32 bit floats, flat or with rows of 3 items,\n"
+             "      such as a numpy array of shape ``(n, 3)``.\n"
+             "   :type points: buffer\n");
+static PyObject *Quaternion_rotate_points(QuaternionObject *self, PyObject *value)
+{
+  QuaternionRotatePointsData data;
+  Py_buffer buffer;
+  int points_num;
+
+  if (BaseMath_ReadCallback(self) == -1) {
+    return NULL;
+  }
+
+  points_num = mathutils_buffer_parse(
+      value, &buffer, 'f', 3, 3, PyBUF_WRITABLE, NULL, "Quaternion.rotate_points()");
+  if (points_num == -1) {
+    return NULL;
+  }
+
+  copy_qt_qt(data.quat, self->quat);
+  data.points = buffer.buf;
+
+  Py_BEGIN_ALLOW_THREADS;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, points_num, &data, quaternion_rotate_points_task, &settings);
+  Py_END_ALLOW_THREADS;
+
+  PyBuffer_Release(&buffer);
+  Py_RETURN_NONE;
+}
+
 PyDoc_STRVAR(Quaternion_make_compatible_doc,
              ".. method:: make_compatible(other)\n"
              "\n"
@@ -1446,6 +1499,7 @@ static struct PyMethodDef Quaternion_methods[] = {
      Quaternion_rotation_difference_doc},
     {"slerp", (PyCFunction)Quaternion_slerp, METH_VARARGS, Quaternion_slerp_doc},
     {"rotate", (PyCFunction)Quaternion_rotate, METH_O, Quaternion_rotate_doc},
+    {"rotate_points", (PyCFunction)Quaternion_rotate_points, METH_O, Quaternion_rotate_points_doc},
     {"make_compatible",
      (PyCFunction)Quaternion_make_compatible,
      METH_O,
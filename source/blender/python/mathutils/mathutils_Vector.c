@@ -23,6 +23,7 @@
 #include "mathutils.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "../generic/py_capi_utils.h"
@@ -378,6 +379,60 @@ static PyObject *Vector_normalized(VectorObject *self)
   return vec__apply_to_copy(Vector_normalize, self);
 }
 
+typedef struct VectorNormalizeArrayData {
+  float *vectors;
+  int size;
+  /* The 4th item (w axis) of 4D vectors is left untouched, as with #Vector_normalize. */
+  int size_normalize;
+} VectorNormalizeArrayData;
+
+static void vector_normalize_array_task(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VectorNormalizeArrayData *data = userdata;
+  normalize_vn(data->vectors + (size_t)i * data->size, data->size_normalize);
+}
+
+PyDoc_STRVAR(C_Vector_normalize_array_doc,
+             ".. staticmethod:: normalize_array(vectors)\n"
+             "\n"
+             "   Normalize an array of vectors in-place,\n"
+             "   without creating a :class:`Vector` for each item.\n"
+             "\n"
+             "   :arg vectors: Writable 2D buffer of 32 bit floats with rows of 2 to 4 items,\n"
+             "      such as a numpy array of shape ``(n, 3)``.\n"
+             "   :type vectors: buffer\n"
+             "\n"
+             "   .. note:: As with :class:`Vector.normalize`, zero length vectors are left "
+             "unchanged\n"
+             "      and the w axis of 4D vectors is left untouched.\n");
+static PyObject *C_Vector_normalize_array(PyObject *UNUSED(cls), PyObject *value)
+{
+  VectorNormalizeArrayData data;
+  Py_buffer buffer;
+  int vectors_num;
+
+  vectors_num = mathutils_buffer_parse(
+      value, &buffer, 'f', 2, 4, PyBUF_WRITABLE, &data.size, "Vector.normalize_array()");
+  if (vectors_num == -1) {
+    return NULL;
+  }
+
+  data.vectors = buffer.buf;
+  data.size_normalize = (data.size == 4) ? 3 : data.size;
+
+  Py_BEGIN_ALLOW_THREADS;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, vectors_num, &data, vector_normalize_array_task, &settings);
+  Py_END_ALLOW_THREADS;
+
+  PyBuffer_Release(&buffer);
+  Py_RETURN_NONE;
+}
+
 PyDoc_STRVAR(Vector_resize_doc,
              ".. method:: resize(size=3)\n"
              "\n"
@@ -2973,6 +3028,10 @@ static struct PyMethodDef Vector_methods[] = {
     {"Range", (PyCFunction)C_Vector_Range, METH_VARARGS | METH_CLASS, C_Vector_Range_doc},
     {"Linspace", (PyCFunction)C_Vector_Linspace, METH_VARARGS | METH_CLASS, C_Vector_Linspace_doc},
     {"Repeat", (PyCFunction)C_Vector_Repeat, METH_VARARGS | METH_CLASS, C_Vector_Repeat_doc},
+    {"normalize_array",
+     (PyCFunction)C_Vector_normalize_array,
+     METH_O | METH_STATIC,
+     C_Vector_normalize_array_doc},
 
     /* in place only */
     {"zero", (PyCFunction)Vector_zero, METH_NOARGS, Vector_zero_doc},
@@ -30,6 +30,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_bvhutils.h"
@@ -376,6 +377,178 @@ static PyObject *py_bvhtree_ray_cast(PyBVHTree *self, PyObject *args)
   return py_bvhtree_raycast_to_py_none();
 }
 
+typedef struct PyBVHTree_RayCastArrayData {
+  PyBVHTree *self;
+  float max_dist;
+
+  const float (*origins)[3];
+  const float (*directions)[3];
+
+  /* Optional outputs. */
+  float (*locations)[3];
+  float (*normals)[3];
+  int *indices;
+  float *distances;
+} PyBVHTree_RayCastArrayData;
+
+static void py_bvhtree_ray_cast_array_task(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict tls)
+{
+  const PyBVHTree_RayCastArrayData *data = userdata;
+  int *hits_num = tls->userdata_chunk;
+  float co[3], direction[3];
+  BVHTreeRayHit hit;
+
+  copy_v3_v3(co, data->origins[i]);
+  normalize_v3_v3(direction, data->directions[i]);
+
+  hit.dist = data->max_dist;
+  hit.index = -1;
+
+  if (data->self->tree) {
+    BLI_bvhtree_ray_cast(
+        data->self->tree, co, direction, 0.0f, &hit, py_bvhtree_raycast_cb, data->self);
+  }
+
+  if (hit.index != -1) {
+    (*hits_num)++;
+  }
+  else {
+    copy_v3_fl(hit.co, NAN_FLT);
+    copy_v3_fl(hit.no, NAN_FLT);
+    hit.dist = NAN_FLT;
+  }
+
+  if (data->locations) {
+    copy_v3_v3(data->locations[i], hit.co);
+  }
+  if (data->normals) {
+    copy_v3_v3(data->normals[i], hit.no);
+  }
+  if (data->indices) {
+    data->indices[i] = hit.index;
+  }
+  if (data->distances) {
+    data->distances[i] = hit.dist;
+  }
+}
+
+static void py_bvhtree_ray_cast_array_reduce(const void *__restrict UNUSED(userdata),
+                                             void *__restrict chunk_join,
+                                             void *__restrict chunk)
+{
+  *(int *)chunk_join += *(const int *)chunk;
+}
+
+PyDoc_STRVAR(
+    py_bvhtree_ray_cast_array_doc,
+    ".. method:: ray_cast_array(origins, directions, distance=sys.float_info.max, *, "
+    "locations=None, normals=None, indices=None, distances=None)\n"
+    "\n"
+    "   Cast many rays onto the mesh, using multiple threads.\n"
+    "\n"
+    "   Rays are read from buffers and results written to buffers (such as numpy arrays),\n"
+    "   misses have an index of -1 and NaN values for the other results.\n"
+    "\n"
+    "   :arg origins: Start locations of the rays in object space.\n"
+    "   :type origins: buffer of 32 bit floats with rows of 3 items\n"
+    "   :arg directions: Directions of the rays in object space.\n"
+    "   :type directions: buffer of 32 bit floats with rows of 3 items\n"
+    PYBVH_FIND_GENERIC_DISTANCE_DOC
+    "   :arg locations: Optional output for the hit locations.\n"
+    "   :type locations: writable buffer of 32 bit floats with rows of 3 items\n"
+    "   :arg normals: Optional output for the hit normals.\n"
+    "   :type normals: writable buffer of 32 bit floats with rows of 3 items\n"
+    "   :arg indices: Optional output for the hit indices.\n"
+    "   :type indices: writable buffer of 32 bit integers\n"
+    "   :arg distances: Optional output for the hit distances.\n"
+    "   :type distances: writable buffer of 32 bit floats\n"
+    "   :return: The number of rays which hit the mesh.\n"
+    "   :rtype: int\n");
+static PyObject *py_bvhtree_ray_cast_array(PyBVHTree *self, PyObject *args, PyObject *kwargs)
+{
+  PyObject *py_origins, *py_directions;
+  PyObject *py_locations = NULL, *py_normals = NULL, *py_indices = NULL, *py_distances = NULL;
+  PyBVHTree_RayCastArrayData data = {.self = self, .max_dist = FLT_MAX};
+  /* Origins, directions and the outputs, empty buffers are ignored on release. */
+  Py_buffer buffers[6] = {{NULL}};
+  int rays_num, directions_num, hits_num = 0;
+  bool ok = false;
+
+  const char *keywords[] = {
+      "origins", "directions", "distance", "locations", "normals", "indices", "distances", NULL};
+
+  if (!PyArg_ParseTupleAndKeywords(args,
+                                   kwargs,
+                                   "OO|f$OOOO:ray_cast_array",
+                                   (char **)keywords,
+                                   &py_origins,
+                                   &py_directions,
+                                   &data.max_dist,
+                                   &py_locations,
+                                   &py_normals,
+                                   &py_indices,
+                                   &py_distances)) {
+    return NULL;
+  }
+
+  rays_num = mathutils_buffer_parse(
+      py_origins, &buffers[0], 'f', 3, 3, 0, NULL, "ray_cast_array(origins)");
+  if (rays_num == -1) {
+    goto finally;
+  }
+  directions_num = mathutils_buffer_parse(
+      py_directions, &buffers[1], 'f', 3, 3, 0, NULL, "ray_cast_array(directions)");
+  if (directions_num == -1) {
+    goto finally;
+  }
+  if (directions_num != rays_num) {
+    PyErr_Format(PyExc_ValueError,
+                 "ray_cast_array: expected as many directions as origins (%d), found %d",
+                 rays_num,
+                 directions_num);
+    goto finally;
+  }
+
+  if ((mathutils_buffer_parse_output(
+           py_locations, &buffers[2], 'f', 3, rays_num, "ray_cast_array(locations)") == -1) ||
+      (mathutils_buffer_parse_output(
+           py_normals, &buffers[3], 'f', 3, rays_num, "ray_cast_array(normals)") == -1) ||
+      (mathutils_buffer_parse_output(
+           py_indices, &buffers[4], 'i', 1, rays_num, "ray_cast_array(indices)") == -1) ||
+      (mathutils_buffer_parse_output(
+           py_distances, &buffers[5], 'f', 1, rays_num, "ray_cast_array(distances)") == -1)) {
+    goto finally;
+  }
+
+  data.origins = buffers[0].buf;
+  data.directions = buffers[1].buf;
+  data.locations = buffers[2].buf;
+  data.normals = buffers[3].buf;
+  data.indices = buffers[4].buf;
+  data.distances = buffers[5].buf;
+
+  /* The tree and its callback data are only read, the GIL is not needed. */
+  Py_BEGIN_ALLOW_THREADS;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  settings.userdata_chunk = &hits_num;
+  settings.userdata_chunk_size = sizeof(hits_num);
+  settings.func_reduce = py_bvhtree_ray_cast_array_reduce;
+  BLI_task_parallel_range(0, rays_num, &data, py_bvhtree_ray_cast_array_task, &settings);
+  Py_END_ALLOW_THREADS;
+
+  ok = true;
+
+finally:
+  for (uint i = 0; i < ARRAY_SIZE(buffers); i++) {
+    PyBuffer_Release(&buffers[i]);
+  }
+  return ok ? PyLong_FromLong(hits_num) : NULL;
+}
+
 PyDoc_STRVAR(py_bvhtree_find_nearest_doc,
              ".. method:: find_nearest(origin, distance=" PYBVH_MAX_DIST_STR
              ")\n"
@@ -1224,6 +1397,10 @@ static PyObject *C_BVHTree_FromObject(PyObject *UNUSED(cls), PyObject *args, PyO
 
 static PyMethodDef py_bvhtree_methods[] = {
     {"ray_cast", (PyCFunction)py_bvhtree_ray_cast, METH_VARARGS, py_bvhtree_ray_cast_doc},
+    {"ray_cast_array",
+     (PyCFunction)py_bvhtree_ray_cast_array,
+     METH_VARARGS | METH_KEYWORDS,
+     py_bvhtree_ray_cast_array_doc},
     {"find_nearest",
      (PyCFunction)py_bvhtree_find_nearest,
      METH_VARARGS,
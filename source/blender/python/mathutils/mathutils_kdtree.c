@@ -26,6 +26,8 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_kdtree.h"
+#include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "../generic/py_capi_utils.h"
@@ -256,6 +258,124 @@ static PyObject *py_kdtree_find(PyKDTree *self, PyObject *args, PyObject *kwargs
   return kdtree_nearest_to_py_and_check(&nearest);
 }
 
+typedef struct PyKDTree_FindArrayData {
+  const KDTree_3d *tree;
+  const float (*co)[3];
+
+  /* Optional outputs. */
+  float (*co_found)[3];
+  int *indices;
+  float *distances;
+} PyKDTree_FindArrayData;
+
+static void py_kdtree_find_array_task(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PyKDTree_FindArrayData *data = userdata;
+  KDTreeNearest_3d nearest;
+
+  nearest.index = -1;
+  BLI_kdtree_3d_find_nearest(data->tree, data->co[i], &nearest);
+
+  if (nearest.index == -1) {
+    copy_v3_fl(nearest.co, NAN_FLT);
+    nearest.dist = NAN_FLT;
+  }
+
+  if (data->co_found) {
+    copy_v3_v3(data->co_found[i], nearest.co);
+  }
+  if (data->indices) {
+    data->indices[i] = nearest.index;
+  }
+  if (data->distances) {
+    data->distances[i] = nearest.dist;
+  }
+}
+
+PyDoc_STRVAR(py_kdtree_find_array_doc,
+             ".. method:: find_array(co, *, co_found=None, indices=None, distances=None)\n"
+             "\n"
+             "   Find the nearest point to many coordinates, using multiple threads.\n"
+             "\n"
+             "   Coordinates are read from a buffer and results written to buffers\n"
+             "   (such as numpy arrays), an empty tree gives an index of -1 and NaN values.\n"
+             "\n"
+             "   :arg co: 3d coordinates.\n"
+             "   :type co: buffer of 32 bit floats with rows of 3 items\n"
+             "   :arg co_found: Optional output for the found coordinates.\n"
+             "   :type co_found: writable buffer of 32 bit floats with rows of 3 items\n"
+             "   :arg indices: Optional output for the found indices.\n"
+             "   :type indices: writable buffer of 32 bit integers\n"
+             "   :arg distances: Optional output for the distances.\n"
+             "   :type distances: writable buffer of 32 bit floats\n");
+static PyObject *py_kdtree_find_array(PyKDTree *self, PyObject *args, PyObject *kwargs)
+{
+  PyObject *py_co, *py_co_found = NULL, *py_indices = NULL, *py_distances = NULL;
+  PyKDTree_FindArrayData data = {.tree = self->obj};
+  /* Coordinates and the outputs, empty buffers are ignored on release. */
+  Py_buffer buffers[4] = {{NULL}};
+  int co_num;
+  bool ok = false;
+
+  const char *keywords[] = {"co", "co_found", "indices", "distances", NULL};
+
+  if (!PyArg_ParseTupleAndKeywords(args,
+                                   kwargs,
+                                   "O|$OOO:find_array",
+                                   (char **)keywords,
+                                   &py_co,
+                                   &py_co_found,
+                                   &py_indices,
+                                   &py_distances)) {
+    return NULL;
+  }
+
+  if (self->count != self->count_balance) {
+    PyErr_SetString(PyExc_RuntimeError, "KDTree must be balanced before calling find_array()");
+    return NULL;
+  }
+
+  co_num = mathutils_buffer_parse(py_co, &buffers[0], 'f', 3, 3, 0, NULL, "find_array(co)");
+  if (co_num == -1) {
+    goto finally;
+  }
+
+  if ((mathutils_buffer_parse_output(
+           py_co_found, &buffers[1], 'f', 3, co_num, "find_array(co_found)") == -1) ||
+      (mathutils_buffer_parse_output(
+           py_indices, &buffers[2], 'i', 1, co_num, "find_array(indices)") == -1) ||
+      (mathutils_buffer_parse_output(
+           py_distances, &buffers[3], 'f', 1, co_num, "find_array(distances)") == -1)) {
+    goto finally;
+  }
+
+  data.co = buffers[0].buf;
+  data.co_found = buffers[1].buf;
+  data.indices = buffers[2].buf;
+  data.distances = buffers[3].buf;
+
+  /* The balanced tree is only read, the GIL is not needed. */
+  Py_BEGIN_ALLOW_THREADS;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, co_num, &data, py_kdtree_find_array_task, &settings);
+  Py_END_ALLOW_THREADS;
+
+  ok = true;
+
+finally:
+  for (uint i = 0; i < ARRAY_SIZE(buffers); i++) {
+    PyBuffer_Release(&buffers[i]);
+  }
+  if (!ok) {
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
 PyDoc_STRVAR(py_kdtree_find_n_doc,
              ".. method:: find_n(co, n)\n"
              "\n"
@@ -370,6 +490,10 @@ static PyMethodDef PyKDTree_methods[] = {
     {"insert", (PyCFunction)py_kdtree_insert, METH_VARARGS | METH_KEYWORDS, py_kdtree_insert_doc},
     {"balance", (PyCFunction)py_kdtree_balance, METH_NOARGS, py_kdtree_balance_doc},
     {"find", (PyCFunction)py_kdtree_find, METH_VARARGS | METH_KEYWORDS, py_kdtree_find_doc},
+    {"find_array",
+     (PyCFunction)py_kdtree_find_array,
+     METH_VARARGS | METH_KEYWORDS,
+     py_kdtree_find_array_doc},
     {"find_n", (PyCFunction)py_kdtree_find_n, METH_VARARGS | METH_KEYWORDS, py_kdtree_find_n_doc},
     {"find_range",
      (PyCFunction)py_kdtree_find_range,
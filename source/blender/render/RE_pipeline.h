@@ -37,6 +37,7 @@ struct ReportList;
 struct Scene;
 struct StampData;
 struct ViewLayer;
+struct rcti;
 struct bMovieHandle;
 
 #ifdef __cplusplus
@@ -320,6 +321,12 @@ bool RE_WriteRenderResult(struct ReportList *reports,
                           int layer);
 struct RenderResult *RE_MultilayerConvert(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+struct RenderResult *RE_MultilayerReadPartial(const char *filepath,
+                                              const char *layname,
+                                              const char *passname,
+                                              const struct rcti *region,
+                                              const char *colorspace,
+                                              bool predivide);
 
 /* display and event callbacks */
 void RE_display_init_cb(struct Render *re,
@@ -292,6 +292,17 @@ RenderResult *RE_MultilayerConvert(
   return render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
 }
 
+RenderResult *RE_MultilayerReadPartial(const char *filepath,
+                                       const char *layname,
+                                       const char *passname,
+                                       const rcti *region,
+                                       const char *colorspace,
+                                       bool predivide)
+{
+  return render_result_new_from_exr_file(
+      filepath, layname, passname, region, colorspace, predivide);
+}
+
 RenderLayer *render_get_active_layer(Render *re, RenderResult *rr)
 {
   ViewLayer *view_layer = BLI_findlink(&re->view_layers, re->active_view_layer);
@@ -765,7 +765,8 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
+      /* Passes which were not read have no pixels. */
+      if (rpass->rect && rpass->channels >= 3) {
         IMB_colormanagement_transform(rpass->rect,
                                       rpass->rectx,
                                       rpass->recty,
@@ -780,6 +781,43 @@ RenderResult *render_result_new_from_exr(
   return rr;
 }
 
+/**
+ * Read a multilayer EXR file, loading only the passes named \a passname of layer \a layname
+ * (all passes of the layer when NULL, all layers when \a layname is NULL) and only the pixels
+ * inside \a region (the whole image when NULL). The result has the size of the region, other
+ * layers and passes of the file are included without pixels.
+ */
+RenderResult *render_result_new_from_exr_file(const char *filepath,
+                                              const char *layname,
+                                              const char *passname,
+                                              const rcti *region,
+                                              const char *colorspace,
+                                              bool predivide)
+{
+  void *exrhandle = IMB_exr_get_handle();
+  int rectx, recty;
+
+  if (IMB_exr_begin_read_multilayer(exrhandle, filepath, &rectx, &recty) == 0) {
+    printf("failed being read %s\n", filepath);
+    IMB_exr_close(exrhandle);
+    return NULL;
+  }
+
+  if (layname) {
+    IMB_exr_read_select_pass(exrhandle, layname, passname);
+  }
+  if (region) {
+    IMB_exr_read_set_region(exrhandle, region, &rectx, &recty);
+  }
+
+  IMB_exr_read_channels(exrhandle);
+
+  RenderResult *rr = render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
+  IMB_exr_close(exrhandle);
+
+  return rr;
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
   RenderView *rv = MEM_callocN(sizeof(RenderView), "new render view");
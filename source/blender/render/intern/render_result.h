@@ -58,6 +58,12 @@ struct RenderResult *render_result_new(struct Render *re,
 
 struct RenderResult *render_result_new_from_exr(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+struct RenderResult *render_result_new_from_exr_file(const char *filepath,
+                                                     const char *layname,
+                                                     const char *passname,
+                                                     const struct rcti *region,
+                                                     const char *colorspace,
+                                                     bool predivide);
 
 void render_result_view_new(struct RenderResult *rr, const char *viewname);
 void render_result_views_new(struct RenderResult *rr, const struct RenderData *rd);
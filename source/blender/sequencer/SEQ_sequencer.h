@@ -121,6 +121,8 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
   SEQ_TASK_PREFETCH_RENDER,
+  /* Prefetch workers rendering strip inputs of frames ahead of #SEQ_TASK_PREFETCH_RENDER. */
+  SEQ_TASK_PREFETCH_INPUT,
 } eSeqTaskId;
 
 typedef struct SeqRenderData {
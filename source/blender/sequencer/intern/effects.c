@@ -62,6 +62,10 @@
 
 #include "BLF_api.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "effects.h"
 #include "render.h"
 #include "strip_time.h"
@@ -119,6 +123,75 @@ static void slice_get_float_buffers(const SeqRenderData *context,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name SIMD Helpers
+ *
+ * Row kernels below work on one RGBA pixel per SSE register. Results must match the scalar
+ * code paths bit for bit, so the order of float operations mirrors the scalar expressions.
+ * \{ */
+
+#ifdef __SSE2__
+
+BLI_INLINE __m128 simd_load_uchar_v4(const unsigned char *cp)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i c = _mm_cvtsi32_si128(*((const int *)cp));
+  c = _mm_unpacklo_epi8(c, zero);
+  c = _mm_unpacklo_epi16(c, zero);
+  return _mm_cvtepi32_ps(c);
+}
+
+/* Same as #unit_float_to_uchar_clamp for all four channels. */
+BLI_INLINE void simd_store_uchar_clamp_v4(unsigned char *cp, __m128 v)
+{
+  v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+  __m128i c = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(255.0f), v), _mm_set1_ps(0.5f)));
+  c = _mm_packs_epi32(c, c);
+  c = _mm_packus_epi16(c, c);
+  *((int *)cp) = _mm_cvtsi128_si32(c);
+}
+
+BLI_INLINE __m128 simd_splat_alpha(__m128 v)
+{
+  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* Select the alpha channel of `a` and the color channels of `b`. */
+BLI_INLINE __m128 simd_select_alpha(__m128 a, __m128 b)
+{
+  const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+BLI_INLINE __m128 simd_select(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/* Same as #straight_uchar_to_premul_float. */
+BLI_INLINE __m128 simd_straight_uchar_to_premul_float(const unsigned char *cp)
+{
+  const __m128 color = simd_load_uchar_v4(cp);
+  const __m128 alpha = _mm_mul_ps(simd_splat_alpha(color), _mm_set1_ps(1.0f / 255.0f));
+  const __m128 fac = _mm_mul_ps(alpha, _mm_set1_ps(1.0f / 255.0f));
+  return simd_select_alpha(alpha, _mm_mul_ps(color, fac));
+}
+
+/* Same as #premul_float_to_straight_uchar. */
+BLI_INLINE void simd_premul_float_to_straight_uchar(unsigned char *cp, __m128 color)
+{
+  const float alpha = _mm_cvtss_f32(simd_splat_alpha(color));
+  if (alpha != 0.0f && alpha != 1.0f) {
+    const __m128 alpha_inv = _mm_div_ps(_mm_set1_ps(1.0f), simd_splat_alpha(color));
+    color = simd_select_alpha(color, _mm_mul_ps(color, alpha_inv));
+  }
+  simd_store_uchar_clamp_v4(cp, color);
+}
+
+#endif /* __SSE2__ */
+
+/** \} */
+
 /*********************** Glow effect *************************/
 
 enum {
@@ -200,157 +273,124 @@ static void init_alpha_over_or_under(Sequence *seq)
   seq->seq1 = seq2;
 }
 
-static void do_alphaover_effect_byte(float facf0,
-                                     float facf1,
-                                     int x,
-                                     int y,
-                                     unsigned char *rect1,
-                                     unsigned char *rect2,
-                                     unsigned char *out)
+static void do_alphaover_effect_byte_row(
+    float fac, int x, const unsigned char *cp1, const unsigned char *cp2, unsigned char *rt)
 {
-  float fac2, mfac, fac, fac4;
-  int xo;
-  unsigned char *cp1, *cp2, *rt;
-  float tempc[4], rt1[4], rt2[4];
+  /* rt = rt1 over rt2  (alpha from rt1) */
+  if (fac <= 0.0f) {
+    memcpy(rt, cp2, sizeof(unsigned char[4]) * x);
+    return;
+  }
 
-  xo = x;
-  cp1 = rect1;
-  cp2 = rect2;
-  rt = out;
+#ifdef __SSE2__
+  const __m128 fac_v = _mm_set1_ps(fac);
+#else
+  float tempc[4], rt1[4], rt2[4];
+#endif
 
-  fac2 = facf0;
-  fac4 = facf1;
+  while (x--) {
+    const float mfac = 1.0f - fac * (cp1[3] * (1.0f / 255.0f));
 
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 over rt2  (alpha from rt1) */
+    if (mfac <= 0.0f) {
+      *((unsigned int *)rt) = *((unsigned int *)cp1);
+    }
+    else {
+#ifdef __SSE2__
+      const __m128 rt1 = simd_straight_uchar_to_premul_float(cp1);
+      const __m128 rt2 = simd_straight_uchar_to_premul_float(cp2);
+      const __m128 tempc = _mm_add_ps(_mm_mul_ps(fac_v, rt1), _mm_mul_ps(_mm_set1_ps(mfac), rt2));
 
+      simd_premul_float_to_straight_uchar(rt, tempc);
+#else
       straight_uchar_to_premul_float(rt1, cp1);
       straight_uchar_to_premul_float(rt2, cp2);
 
-      fac = fac2;
-      mfac = 1.0f - fac2 * rt1[3];
-
-      if (fac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp2);
-      }
-      else if (mfac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp1);
-      }
-      else {
-        tempc[0] = fac * rt1[0] + mfac * rt2[0];
-        tempc[1] = fac * rt1[1] + mfac * rt2[1];
-        tempc[2] = fac * rt1[2] + mfac * rt2[2];
-        tempc[3] = fac * rt1[3] + mfac * rt2[3];
-
-        premul_float_to_straight_uchar(rt, tempc);
-      }
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
+      tempc[0] = fac * rt1[0] + mfac * rt2[0];
+      tempc[1] = fac * rt1[1] + mfac * rt2[1];
+      tempc[2] = fac * rt1[2] + mfac * rt2[2];
+      tempc[3] = fac * rt1[3] + mfac * rt2[3];
 
-    if (y == 0) {
-      break;
+      premul_float_to_straight_uchar(rt, tempc);
+#endif
     }
-    y--;
-
-    x = xo;
-    while (x--) {
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      fac = fac4;
-      mfac = 1.0f - (fac4 * rt1[3]);
+    cp1 += 4;
+    cp2 += 4;
+    rt += 4;
+  }
+}
 
-      if (fac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp2);
-      }
-      else if (mfac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp1);
-      }
-      else {
-        tempc[0] = fac * rt1[0] + mfac * rt2[0];
-        tempc[1] = fac * rt1[1] + mfac * rt2[1];
-        tempc[2] = fac * rt1[2] + mfac * rt2[2];
-        tempc[3] = fac * rt1[3] + mfac * rt2[3];
+static void do_alphaover_effect_byte(float facf0,
+                                     float facf1,
+                                     int x,
+                                     int y,
+                                     unsigned char *rect1,
+                                     unsigned char *rect2,
+                                     unsigned char *out)
+{
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const float fac = (i & 1) ? facf1 : facf0;
+    const size_t offset = (size_t)4 * x * i;
 
-        premul_float_to_straight_uchar(rt, tempc);
-      }
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
+    do_alphaover_effect_byte_row(fac, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
-static void do_alphaover_effect_float(
-    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void do_alphaover_effect_float_row(
+    float fac, int x, const float *rt1, const float *rt2, float *rt)
 {
-  float fac2, mfac, fac, fac4;
-  int xo;
-  float *rt1, *rt2, *rt;
+  /* rt = rt1 over rt2  (alpha from rt1) */
+  if (fac <= 0.0f) {
+    memcpy(rt, rt2, sizeof(float[4]) * x);
+    return;
+  }
 
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+#ifdef __SSE2__
+  const __m128 fac_v = _mm_set1_ps(fac);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
 
-  fac2 = facf0;
-  fac4 = facf1;
+  while (x--) {
+    const __m128 c1 = _mm_loadu_ps(rt1);
+    const __m128 c2 = _mm_loadu_ps(rt2);
+    const __m128 mfac = _mm_sub_ps(one, _mm_mul_ps(fac_v, simd_splat_alpha(c1)));
+    const __m128 blend = _mm_add_ps(_mm_mul_ps(fac_v, c1), _mm_mul_ps(mfac, c2));
 
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 over rt2  (alpha from rt1) */
+    _mm_storeu_ps(rt, simd_select(_mm_cmple_ps(mfac, zero), c1, blend));
 
-      fac = fac2;
-      mfac = 1.0f - (fac2 * rt1[3]);
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#else
+  while (x--) {
+    const float mfac = 1.0f - (fac * rt1[3]);
 
-      if (fac <= 0.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else if (mfac <= 0) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else {
-        rt[0] = fac * rt1[0] + mfac * rt2[0];
-        rt[1] = fac * rt1[1] + mfac * rt2[1];
-        rt[2] = fac * rt1[2] + mfac * rt2[2];
-        rt[3] = fac * rt1[3] + mfac * rt2[3];
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
+    if (mfac <= 0.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
     }
-
-    if (y == 0) {
-      break;
+    else {
+      rt[0] = fac * rt1[0] + mfac * rt2[0];
+      rt[1] = fac * rt1[1] + mfac * rt2[1];
+      rt[2] = fac * rt1[2] + mfac * rt2[2];
+      rt[3] = fac * rt1[3] + mfac * rt2[3];
     }
-    y--;
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#endif
+}
 
-    x = xo;
-    while (x--) {
-      fac = fac4;
-      mfac = 1.0f - (fac4 * rt1[3]);
+static void do_alphaover_effect_float(
+    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+{
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const float fac = (i & 1) ? facf1 : facf0;
+    const size_t offset = (size_t)4 * x * i;
 
-      if (fac <= 0.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else if (mfac <= 0.0f) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else {
-        rt[0] = fac * rt1[0] + mfac * rt2[0];
-        rt[1] = fac * rt1[1] + mfac * rt2[1];
-        rt[2] = fac * rt1[2] + mfac * rt2[2];
-        rt[3] = fac * rt1[3] + mfac * rt2[3];
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    do_alphaover_effect_float_row(fac, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
@@ -481,83 +521,73 @@ static void do_alphaunder_effect_byte(float facf0,
   }
 }
 
-static void do_alphaunder_effect_float(
-    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void do_alphaunder_effect_float_row(
+    float fac, int x, const float *rt1, const float *rt2, float *rt)
 {
-  float fac2, fac, fac4;
-  int xo;
-  float *rt1, *rt2, *rt;
+  /* rt = rt1 under rt2  (alpha from rt2) */
 
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+#ifdef __SSE2__
+  const __m128 fac_v = _mm_set1_ps(fac);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  /* The 'skybuf' case, see the scalar code below. */
+  const __m128 use_rt1 = (fac >= 1.0f) ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : zero;
 
-  fac2 = facf0;
-  fac4 = facf1;
+  while (x--) {
+    const __m128 c1 = _mm_loadu_ps(rt1);
+    const __m128 c2 = _mm_loadu_ps(rt2);
+    const __m128 a2 = simd_splat_alpha(c2);
+    const __m128 f = _mm_mul_ps(fac_v, _mm_sub_ps(one, a2));
+    const __m128 blend = _mm_add_ps(_mm_mul_ps(f, c1), c2);
+    const __m128 sel_rt2 = _mm_or_ps(_mm_cmpge_ps(a2, one), _mm_cmpeq_ps(f, zero));
+    const __m128 sel_rt1 = _mm_and_ps(use_rt1, _mm_cmple_ps(a2, zero));
 
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 under rt2  (alpha from rt2) */
+    _mm_storeu_ps(rt, simd_select(sel_rt1, c1, simd_select(sel_rt2, c2, blend)));
 
-      /* this complex optimization is because the
-       * 'skybuf' can be crossed in
-       */
-      if (rt2[3] <= 0 && fac2 >= 1.0f) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else if (rt2[3] >= 1.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else {
-        fac = fac2 * (1.0f - rt2[3]);
-
-        if (fac == 0) {
-          memcpy(rt, rt2, sizeof(float[4]));
-        }
-        else {
-          rt[0] = fac * rt1[0] + rt2[0];
-          rt[1] = fac * rt1[1] + rt2[1];
-          rt[2] = fac * rt1[2] + rt2[2];
-          rt[3] = fac * rt1[3] + rt2[3];
-        }
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#else
+  while (x--) {
+    /* this complex optimization is because the
+     * 'skybuf' can be crossed in
+     */
+    if (rt2[3] <= 0 && fac >= 1.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
     }
-
-    if (y == 0) {
-      break;
+    else if (rt2[3] >= 1.0f) {
+      memcpy(rt, rt2, sizeof(float[4]));
     }
-    y--;
+    else {
+      const float f = fac * (1.0f - rt2[3]);
 
-    x = xo;
-    while (x--) {
-      if (rt2[3] <= 0 && fac4 >= 1.0f) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else if (rt2[3] >= 1.0f) {
+      if (f == 0) {
         memcpy(rt, rt2, sizeof(float[4]));
       }
       else {
-        fac = fac4 * (1.0f - rt2[3]);
-
-        if (fac == 0) {
-          memcpy(rt, rt2, sizeof(float[4]));
-        }
-        else {
-          rt[0] = fac * rt1[0] + rt2[0];
-          rt[1] = fac * rt1[1] + rt2[1];
-          rt[2] = fac * rt1[2] + rt2[2];
-          rt[3] = fac * rt1[3] + rt2[3];
-        }
+        rt[0] = f * rt1[0] + rt2[0];
+        rt[1] = f * rt1[1] + rt2[1];
+        rt[2] = f * rt1[2] + rt2[2];
+        rt[3] = f * rt1[3] + rt2[3];
       }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
     }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#endif
+}
+
+static void do_alphaunder_effect_float(
+    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+{
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const float fac = (i & 1) ? facf1 : facf0;
+    const size_t offset = (size_t)4 * x * i;
+
+    do_alphaunder_effect_float_row(fac, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
@@ -593,6 +623,53 @@ static void do_alphaunder_effect(const SeqRenderData *context,
 
 /*********************** Cross *************************/
 
+static void do_cross_effect_byte_row(int fac1,
+                                     int fac2,
+                                     int x,
+                                     const unsigned char *rt1,
+                                     const unsigned char *rt2,
+                                     unsigned char *rt)
+{
+#ifdef __SSE2__
+  /* Products and their sum fit in 16 bits when the factors add up to 256. */
+  if (fac1 >= 0 && fac2 >= 0) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fac1_v = _mm_set1_epi16((short)fac1);
+    const __m128i fac2_v = _mm_set1_epi16((short)fac2);
+
+    for (; x >= 4; x -= 4) {
+      const __m128i c1 = _mm_loadu_si128((const __m128i *)rt1);
+      const __m128i c2 = _mm_loadu_si128((const __m128i *)rt2);
+      const __m128i lo = _mm_srli_epi16(
+          _mm_add_epi16(_mm_mullo_epi16(fac1_v, _mm_unpacklo_epi8(c1, zero)),
+                        _mm_mullo_epi16(fac2_v, _mm_unpacklo_epi8(c2, zero))),
+          8);
+      const __m128i hi = _mm_srli_epi16(
+          _mm_add_epi16(_mm_mullo_epi16(fac1_v, _mm_unpackhi_epi8(c1, zero)),
+                        _mm_mullo_epi16(fac2_v, _mm_unpackhi_epi8(c2, zero))),
+          8);
+
+      _mm_storeu_si128((__m128i *)rt, _mm_packus_epi16(lo, hi));
+
+      rt1 += 16;
+      rt2 += 16;
+      rt += 16;
+    }
+  }
+#endif
+
+  while (x--) {
+    rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
+    rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
+    rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
+    rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
+
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+}
+
 static void do_cross_effect_byte(float facf0,
                                  float facf1,
                                  int x,
@@ -601,98 +678,63 @@ static void do_cross_effect_byte(float facf0,
                                  unsigned char *rect2,
                                  unsigned char *out)
 {
-  int fac1, fac2, fac3, fac4;
-  int xo;
-  unsigned char *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+  const int fac2 = (int)(256.0f * facf0);
+  const int fac1 = 256 - fac2;
+  const int fac4 = (int)(256.0f * facf1);
+  const int fac3 = 256 - fac4;
 
-  fac2 = (int)(256.0f * facf0);
-  fac1 = 256 - fac2;
-  fac4 = (int)(256.0f * facf1);
-  fac3 = 256 - fac4;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
-      rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
-      rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
-      rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (int i = 0; i < y; i++) {
+    const size_t offset = (size_t)4 * x * i;
 
-    if (y == 0) {
-      break;
+    /* Odd lines use the second field factor. */
+    if (i & 1) {
+      do_cross_effect_byte_row(fac3, fac4, x, rect1 + offset, rect2 + offset, out + offset);
     }
-    y--;
-
-    x = xo;
-    while (x--) {
-      rt[0] = (fac3 * rt1[0] + fac4 * rt2[0]) >> 8;
-      rt[1] = (fac3 * rt1[1] + fac4 * rt2[1]) >> 8;
-      rt[2] = (fac3 * rt1[2] + fac4 * rt2[2]) >> 8;
-      rt[3] = (fac3 * rt1[3] + fac4 * rt2[3]) >> 8;
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
+    else {
+      do_cross_effect_byte_row(fac1, fac2, x, rect1 + offset, rect2 + offset, out + offset);
     }
   }
 }
 
-static void do_cross_effect_float(
-    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void do_cross_effect_float_row(
+    float fac1, float fac2, int x, const float *rt1, const float *rt2, float *rt)
 {
-  float fac1, fac2, fac3, fac4;
-  int xo;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+#ifdef __SSE2__
+  const __m128 fac1_v = _mm_set1_ps(fac1);
+  const __m128 fac2_v = _mm_set1_ps(fac2);
 
-  fac2 = facf0;
-  fac1 = 1.0f - fac2;
-  fac4 = facf1;
-  fac3 = 1.0f - fac4;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
-      rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
-      rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
-      rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
+  while (x--) {
+    _mm_storeu_ps(rt,
+                  _mm_add_ps(_mm_mul_ps(fac1_v, _mm_loadu_ps(rt1)),
+                             _mm_mul_ps(fac2_v, _mm_loadu_ps(rt2))));
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#else
+  while (x--) {
+    rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
+    rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
+    rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
+    rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
 
-    if (y == 0) {
-      break;
-    }
-    y--;
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#endif
+}
 
-    x = xo;
-    while (x--) {
-      rt[0] = fac3 * rt1[0] + fac4 * rt2[0];
-      rt[1] = fac3 * rt1[1] + fac4 * rt2[1];
-      rt[2] = fac3 * rt1[2] + fac4 * rt2[2];
-      rt[3] = fac3 * rt1[3] + fac4 * rt2[3];
+static void do_cross_effect_float(
+    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+{
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const float fac = (i & 1) ? facf1 : facf0;
+    const size_t offset = (size_t)4 * x * i;
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    do_cross_effect_float_row(1.0f - fac, fac, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
@@ -1080,52 +1122,49 @@ static void do_add_effect_byte(float facf0,
   }
 }
 
-static void do_add_effect_float(
-    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void do_add_effect_float_row(
+    float fac, int x, const float *rt1, const float *rt2, float *rt)
 {
-  int xo;
-  float fac1, fac3;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+#ifdef __SSE2__
+  const __m128 mfac_v = _mm_set1_ps(1.0f - fac);
+  const __m128 one = _mm_set1_ps(1.0f);
 
-  fac1 = facf0;
-  fac3 = facf1;
+  while (x--) {
+    const __m128 c1 = _mm_loadu_ps(rt1);
+    const __m128 c2 = _mm_loadu_ps(rt2);
+    const __m128 m = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(simd_splat_alpha(c1), mfac_v)),
+                                simd_splat_alpha(c2));
 
-  while (y--) {
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * (1.0f - fac1))) * rt2[3];
-      rt[0] = rt1[0] + m * rt2[0];
-      rt[1] = rt1[1] + m * rt2[1];
-      rt[2] = rt1[2] + m * rt2[2];
-      rt[3] = rt1[3];
+    _mm_storeu_ps(rt, simd_select_alpha(c1, _mm_add_ps(c1, _mm_mul_ps(m, c2))));
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#else
+  while (x--) {
+    const float m = (1.0f - (rt1[3] * (1.0f - fac))) * rt2[3];
+    rt[0] = rt1[0] + m * rt2[0];
+    rt[1] = rt1[1] + m * rt2[1];
+    rt[2] = rt1[2] + m * rt2[2];
+    rt[3] = rt1[3];
 
-    if (y == 0) {
-      break;
-    }
-    y--;
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#endif
+}
 
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * (1.0f - fac3))) * rt2[3];
-      rt[0] = rt1[0] + m * rt2[0];
-      rt[1] = rt1[1] + m * rt2[1];
-      rt[2] = rt1[2] + m * rt2[2];
-      rt[3] = rt1[3];
+static void do_add_effect_float(
+    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+{
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const float fac = (i & 1) ? facf1 : facf0;
+    const size_t offset = (size_t)4 * x * i;
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    do_add_effect_float_row(fac, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
@@ -1214,53 +1253,52 @@ static void do_sub_effect_byte(float facf0,
   }
 }
 
-static void do_sub_effect_float(
-    float UNUSED(facf0), float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void do_sub_effect_float_row(
+    float fac_inv, int x, const float *rt1, const float *rt2, float *rt)
 {
-  int xo;
-  float /* fac1, */ fac3_inv;
-  float *rt1, *rt2, *rt;
+#ifdef __SSE2__
+  const __m128 fac_inv_v = _mm_set1_ps(fac_inv);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
 
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+  while (x--) {
+    const __m128 c1 = _mm_loadu_ps(rt1);
+    const __m128 c2 = _mm_loadu_ps(rt2);
+    const __m128 m = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(simd_splat_alpha(c1), fac_inv_v)),
+                                simd_splat_alpha(c2));
 
-  /* UNUSED */
-  // fac1 = facf0;
-  fac3_inv = 1.0f - facf1;
+    _mm_storeu_ps(rt,
+                  simd_select_alpha(c1, _mm_max_ps(_mm_sub_ps(c1, _mm_mul_ps(m, c2)), zero)));
 
-  while (y--) {
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * fac3_inv)) * rt2[3];
-      rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
-      rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
-      rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
-      rt[3] = rt1[3];
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#else
+  while (x--) {
+    const float m = (1.0f - (rt1[3] * fac_inv)) * rt2[3];
+    rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
+    rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
+    rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
+    rt[3] = rt1[3];
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#endif
+}
 
-    if (y == 0) {
-      break;
-    }
-    y--;
+static void do_sub_effect_float(
+    float UNUSED(facf0), float facf1, int x, int y, float *rect1, float *rect2, float *out)
+{
+  /* Both fields use the second factor. */
+  const float fac3_inv = 1.0f - facf1;
 
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * fac3_inv)) * rt2[3];
-      rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
-      rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
-      rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
-      rt[3] = rt1[3];
+  for (int i = 0; i < y; i++) {
+    const size_t offset = (size_t)4 * x * i;
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    do_sub_effect_float_row(fac3_inv, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
@@ -1405,6 +1443,58 @@ static void do_drop_effect_float(
 
 /*********************** Mul *************************/
 
+static void do_mul_effect_byte_row(
+    int fac, int x, const unsigned char *rt1, const unsigned char *rt2, unsigned char *rt)
+{
+  /* formula:
+   * fac * (a * b) + (1 - fac) * a  => fac * a * (b - 1) + a
+   */
+
+#ifdef __SSE2__
+  /* `fac * a * (b - 255)` needs 32 bits, SSE2 has no 32 bit multiply: split `a * (b - 255)` into
+   * its high and low byte and multiply both by `fac` with 16 bit multiply-add. */
+  if (fac >= 0 && fac <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fac_v = _mm_set1_epi32(fac);
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i mask_lo = _mm_set1_epi32(0xff);
+
+    for (; x >= 2; x -= 2) {
+      const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)rt1), zero);
+      const __m128i b = _mm_sub_epi16(
+          _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)rt2), zero), c255);
+      const __m128i ab_lo16 = _mm_mullo_epi16(a, b);
+      const __m128i ab_hi16 = _mm_mulhi_epi16(a, b);
+      __m128i ab[2] = {_mm_unpacklo_epi16(ab_lo16, ab_hi16), _mm_unpackhi_epi16(ab_lo16, ab_hi16)};
+
+      for (int i = 0; i < 2; i++) {
+        const __m128i t_hi = _mm_madd_epi16(_mm_srai_epi32(ab[i], 8), fac_v);
+        const __m128i t_lo = _mm_madd_epi16(_mm_and_si128(ab[i], mask_lo), fac_v);
+        ab[i] = _mm_srai_epi32(_mm_add_epi32(_mm_slli_epi32(t_hi, 8), t_lo), 16);
+      }
+
+      const __m128i result = _mm_add_epi16(a, _mm_packs_epi32(ab[0], ab[1]));
+      _mm_storel_epi64((__m128i *)rt, _mm_packus_epi16(result, result));
+
+      rt1 += 8;
+      rt2 += 8;
+      rt += 8;
+    }
+  }
+#endif
+
+  while (x--) {
+    rt[0] = rt1[0] + ((fac * rt1[0] * (rt2[0] - 255)) >> 16);
+    rt[1] = rt1[1] + ((fac * rt1[1] * (rt2[1] - 255)) >> 16);
+    rt[2] = rt1[2] + ((fac * rt1[2] * (rt2[2] - 255)) >> 16);
+    rt[3] = rt1[3] + ((fac * rt1[3] * (rt2[3] - 255)) >> 16);
+
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+}
+
 static void do_mul_effect_byte(float facf0,
                                float facf1,
                                int x,
@@ -1413,105 +1503,62 @@ static void do_mul_effect_byte(float facf0,
                                unsigned char *rect2,
                                unsigned char *out)
 {
-  int xo, fac1, fac3;
-  unsigned char *rt1, *rt2, *rt;
+  const int fac1 = (int)(256.0f * facf0);
+  const int fac3 = (int)(256.0f * facf1);
 
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const int fac = (i & 1) ? fac3 : fac1;
+    const size_t offset = (size_t)4 * x * i;
 
-  fac1 = (int)(256.0f * facf0);
-  fac3 = (int)(256.0f * facf1);
+    do_mul_effect_byte_row(fac, x, rect1 + offset, rect2 + offset, out + offset);
+  }
+}
 
+static void do_mul_effect_float_row(
+    float fac, int x, const float *rt1, const float *rt2, float *rt)
+{
   /* formula:
-   * fac * (a * b) + (1 - fac) * a  => fac * a * (b - 1) + axaux = c * px + py * s; //+centx
-   * yaux = -s * px + c * py; //+centy
+   * fac * (a * b) + (1 - fac) * a  =>  fac * a * (b - 1) + a
    */
 
-  while (y--) {
+#ifdef __SSE2__
+  const __m128 fac_v = _mm_set1_ps(fac);
+  const __m128 one = _mm_set1_ps(1.0f);
 
-    x = xo;
-    while (x--) {
+  while (x--) {
+    const __m128 c1 = _mm_loadu_ps(rt1);
+    const __m128 c2 = _mm_loadu_ps(rt2);
 
-      rt[0] = rt1[0] + ((fac1 * rt1[0] * (rt2[0] - 255)) >> 16);
-      rt[1] = rt1[1] + ((fac1 * rt1[1] * (rt2[1] - 255)) >> 16);
-      rt[2] = rt1[2] + ((fac1 * rt1[2] * (rt2[2] - 255)) >> 16);
-      rt[3] = rt1[3] + ((fac1 * rt1[3] * (rt2[3] - 255)) >> 16);
+    _mm_storeu_ps(rt, _mm_add_ps(c1, _mm_mul_ps(_mm_mul_ps(fac_v, c1), _mm_sub_ps(c2, one))));
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-
-      rt[0] = rt1[0] + ((fac3 * rt1[0] * (rt2[0] - 255)) >> 16);
-      rt[1] = rt1[1] + ((fac3 * rt1[1] * (rt2[1] - 255)) >> 16);
-      rt[2] = rt1[2] + ((fac3 * rt1[2] * (rt2[2] - 255)) >> 16);
-      rt[3] = rt1[3] + ((fac3 * rt1[3] * (rt2[3] - 255)) >> 16);
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
+  }
+#else
+  while (x--) {
+    rt[0] = rt1[0] + fac * rt1[0] * (rt2[0] - 1.0f);
+    rt[1] = rt1[1] + fac * rt1[1] * (rt2[1] - 1.0f);
+    rt[2] = rt1[2] + fac * rt1[2] * (rt2[2] - 1.0f);
+    rt[3] = rt1[3] + fac * rt1[3] * (rt2[3] - 1.0f);
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    rt1 += 4;
+    rt2 += 4;
+    rt += 4;
   }
+#endif
 }
 
 static void do_mul_effect_float(
     float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
 {
-  int xo;
-  float fac1, fac3;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac1 = facf0;
-  fac3 = facf1;
+  for (int i = 0; i < y; i++) {
+    /* Odd lines use the second field factor. */
+    const float fac = (i & 1) ? facf1 : facf0;
+    const size_t offset = (size_t)4 * x * i;
 
-  /* formula:
-   * fac * (a * b) + (1 - fac) * a  =>  fac * a * (b - 1) + a
-   */
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      rt[0] = rt1[0] + fac1 * rt1[0] * (rt2[0] - 1.0f);
-      rt[1] = rt1[1] + fac1 * rt1[1] * (rt2[1] - 1.0f);
-      rt[2] = rt1[2] + fac1 * rt1[2] * (rt2[2] - 1.0f);
-      rt[3] = rt1[3] + fac1 * rt1[3] * (rt2[3] - 1.0f);
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      rt[0] = rt1[0] + fac3 * rt1[0] * (rt2[0] - 1.0f);
-      rt[1] = rt1[1] + fac3 * rt1[1] * (rt2[1] - 1.0f);
-      rt[2] = rt1[2] + fac3 * rt1[2] * (rt2[2] - 1.0f);
-      rt[3] = rt1[3] + fac3 * rt1[3] * (rt2[3] - 1.0f);
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    do_mul_effect_float_row(fac, x, rect1 + offset, rect2 + offset, out + offset);
   }
 }
 
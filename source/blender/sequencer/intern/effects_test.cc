@@ -0,0 +1,253 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "DNA_sequence_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_math_base.h"
+#include "BLI_rand.h"
+
+#include "SEQ_sequencer.h"
+
+namespace blender::seq::tests {
+
+/* Width of the test buffers, odd so both the SIMD and the remaining scalar iterations run. */
+#define TEST_X 67
+#define TEST_Y 3
+
+struct EffectTestContext {
+  SeqRenderData render_data;
+  Sequence seq;
+  ImBuf *ibuf1;
+  ImBuf *ibuf2;
+  ImBuf *out;
+};
+
+static void test_effect_init(EffectTestContext *ctx, int type, bool use_float)
+{
+  const int flags = use_float ? IB_rectfloat : IB_rect;
+
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->render_data.rectx = TEST_X;
+  ctx->render_data.recty = TEST_Y;
+  ctx->seq.type = type;
+
+  ctx->ibuf1 = IMB_allocImBuf(TEST_X, TEST_Y, 32, flags);
+  ctx->ibuf2 = IMB_allocImBuf(TEST_X, TEST_Y, 32, flags);
+  ctx->out = IMB_allocImBuf(TEST_X, TEST_Y, 32, flags);
+
+  const int num_channels = 4 * TEST_X * TEST_Y;
+  if (use_float) {
+    BLI_array_frand(ctx->ibuf1->rect_float, num_channels, 1);
+    BLI_array_frand(ctx->ibuf2->rect_float, num_channels, 2);
+  }
+  else {
+    RNG *rng = BLI_rng_new(0);
+    BLI_rng_get_char_n(rng, (char *)ctx->ibuf1->rect, num_channels);
+    BLI_rng_get_char_n(rng, (char *)ctx->ibuf2->rect, num_channels);
+    BLI_rng_free(rng);
+  }
+}
+
+static void test_effect_free(EffectTestContext *ctx)
+{
+  IMB_freeImBuf(ctx->ibuf1);
+  IMB_freeImBuf(ctx->ibuf2);
+  IMB_freeImBuf(ctx->out);
+}
+
+static void test_effect_execute(EffectTestContext *ctx, float facf0, float facf1)
+{
+  struct SeqEffectHandle sh = BKE_sequence_get_effect(&ctx->seq);
+  sh.execute_slice(&ctx->render_data,
+                   &ctx->seq,
+                   0.0f,
+                   facf0,
+                   facf1,
+                   ctx->ibuf1,
+                   ctx->ibuf2,
+                   nullptr,
+                   0,
+                   TEST_Y,
+                   ctx->out);
+}
+
+/* Factor of the field the channel at index `i` is in, odd lines use the second one. */
+static float test_effect_fac(int i, float facf0, float facf1)
+{
+  return ((i / (4 * TEST_X)) & 1) ? facf1 : facf0;
+}
+
+TEST(sequencer_effects, cross_byte)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_CROSS, false);
+
+  test_effect_execute(&ctx, 0.25f, 0.75f);
+
+  const uchar *rt1 = (uchar *)ctx.ibuf1->rect;
+  const uchar *rt2 = (uchar *)ctx.ibuf2->rect;
+  const uchar *rt = (uchar *)ctx.out->rect;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const int fac2 = (int)(256.0f * test_effect_fac(i, 0.25f, 0.75f));
+    EXPECT_EQ(rt[i], ((256 - fac2) * rt1[i] + fac2 * rt2[i]) >> 8);
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, cross_float)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_CROSS, true);
+
+  test_effect_execute(&ctx, 0.25f, 0.75f);
+
+  const float *rt1 = ctx.ibuf1->rect_float;
+  const float *rt2 = ctx.ibuf2->rect_float;
+  const float *rt = ctx.out->rect_float;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const float fac = test_effect_fac(i, 0.25f, 0.75f);
+    EXPECT_FLOAT_EQ(rt[i], (1.0f - fac) * rt1[i] + fac * rt2[i]);
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, mul_byte)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_MUL, false);
+
+  test_effect_execute(&ctx, 0.5f, 1.0f);
+
+  const uchar *rt1 = (uchar *)ctx.ibuf1->rect;
+  const uchar *rt2 = (uchar *)ctx.ibuf2->rect;
+  const uchar *rt = (uchar *)ctx.out->rect;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const int fac = (int)(256.0f * test_effect_fac(i, 0.5f, 1.0f));
+    EXPECT_EQ(rt[i], rt1[i] + ((fac * rt1[i] * (rt2[i] - 255)) >> 16));
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, mul_float)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_MUL, true);
+
+  test_effect_execute(&ctx, 0.5f, 1.0f);
+
+  const float *rt1 = ctx.ibuf1->rect_float;
+  const float *rt2 = ctx.ibuf2->rect_float;
+  const float *rt = ctx.out->rect_float;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const float fac = test_effect_fac(i, 0.5f, 1.0f);
+    EXPECT_FLOAT_EQ(rt[i], rt1[i] + fac * rt1[i] * (rt2[i] - 1.0f));
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, alphaover_float)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_ALPHAOVER, true);
+
+  test_effect_execute(&ctx, 0.5f, 1.0f);
+
+  const float *rt1 = ctx.ibuf1->rect_float;
+  const float *rt2 = ctx.ibuf2->rect_float;
+  const float *rt = ctx.out->rect_float;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const float fac = test_effect_fac(i, 0.5f, 1.0f);
+    const float mfac = 1.0f - fac * rt1[(i & ~3) + 3];
+    EXPECT_FLOAT_EQ(rt[i], (mfac <= 0.0f) ? rt1[i] : fac * rt1[i] + mfac * rt2[i]);
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, alphaunder_float)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_ALPHAUNDER, true);
+
+  test_effect_execute(&ctx, 0.5f, 1.0f);
+
+  const float *rt1 = ctx.ibuf1->rect_float;
+  const float *rt2 = ctx.ibuf2->rect_float;
+  const float *rt = ctx.out->rect_float;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const float fac = test_effect_fac(i, 0.5f, 1.0f);
+    const float alpha2 = rt2[(i & ~3) + 3];
+    const float f = fac * (1.0f - alpha2);
+    if (alpha2 <= 0.0f && fac >= 1.0f) {
+      EXPECT_FLOAT_EQ(rt[i], rt1[i]);
+    }
+    else {
+      EXPECT_FLOAT_EQ(rt[i], (f == 0.0f) ? rt2[i] : f * rt1[i] + rt2[i]);
+    }
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, add_float)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_ADD, true);
+
+  test_effect_execute(&ctx, 0.5f, 1.0f);
+
+  const float *rt1 = ctx.ibuf1->rect_float;
+  const float *rt2 = ctx.ibuf2->rect_float;
+  const float *rt = ctx.out->rect_float;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    const float fac = test_effect_fac(i, 0.5f, 1.0f);
+    const float m = (1.0f - (rt1[(i & ~3) + 3] * (1.0f - fac))) * rt2[(i & ~3) + 3];
+    EXPECT_FLOAT_EQ(rt[i], ((i & 3) == 3) ? rt1[i] : rt1[i] + m * rt2[i]);
+  }
+
+  test_effect_free(&ctx);
+}
+
+TEST(sequencer_effects, sub_float)
+{
+  EffectTestContext ctx;
+  test_effect_init(&ctx, SEQ_TYPE_SUB, true);
+
+  test_effect_execute(&ctx, 0.5f, 0.75f);
+
+  const float *rt1 = ctx.ibuf1->rect_float;
+  const float *rt2 = ctx.ibuf2->rect_float;
+  const float *rt = ctx.out->rect_float;
+  for (int i = 0; i < 4 * TEST_X * TEST_Y; i++) {
+    /* Both fields use the second factor. */
+    const float m = (1.0f - (rt1[(i & ~3) + 3] * 0.25f)) * rt2[(i & ~3) + 3];
+    EXPECT_FLOAT_EQ(rt[i], ((i & 3) == 3) ? rt1[i] : max_ff(rt1[i] - m * rt2[i], 0.0f));
+  }
+
+  test_effect_free(&ctx);
+}
+
+}  // namespace blender::seq::tests
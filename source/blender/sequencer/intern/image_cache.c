@@ -40,6 +40,7 @@
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
 #include "BLI_threads.h"
@@ -48,12 +49,23 @@
 #include "BKE_main.h"
 #include "BKE_scene.h"
 
+#include "PIL_time.h"
+
 #include "SEQ_sequencer.h"
 
 #include "image_cache.h"
 #include "prefetch.h"
 #include "strip_time.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -86,7 +98,11 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data can be stored uncompressed, compressed with LZO(fast decoding) or with Zlib with
+ * user definable level. Codec is stored per image, so changing preferences doesn't invalidate
+ * existing files.
+ * Image data starts at offset aligned to DCACHE_PAGE_SIZE, so uncompressed images can be read
+ * directly into ImBuf buffer without intermediate copies.
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
@@ -99,11 +115,20 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
+#define DCACHE_PAGE_SIZE 4096
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* #DiskCacheHeaderEntry.codec */
+enum {
+  DCACHE_CODEC_ZLIB = 0,
+  DCACHE_CODEC_RAW = 1,
+  DCACHE_CODEC_LZO = 2,
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -121,6 +146,9 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+  /* Image data read so far and time spent on it, to report read throughput. */
+  uint64_t read_bytes_total;
+  double read_time_total;
 } SeqDiskCache;
 
 typedef struct DiskCacheFile {
@@ -185,6 +213,7 @@ static int seq_disk_cache_compression_level(void)
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -194,6 +223,23 @@ static int seq_disk_cache_compression_level(void)
   return U.sequencer_disk_cache_compression;
 }
 
+static int seq_disk_cache_codec(void)
+{
+  switch (U.sequencer_disk_cache_compression) {
+    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+      return DCACHE_CODEC_RAW;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+#ifdef WITH_LZO
+      return DCACHE_CODEC_LZO;
+#else
+      /* Closest alternative. */
+      return DCACHE_CODEC_ZLIB;
+#endif
+  }
+
+  return DCACHE_CODEC_ZLIB;
+}
+
 static size_t seq_disk_cache_size_limit(void)
 {
   return (size_t)U.sequencer_disk_cache_size_limit * (1024 * 1024 * 1024);
@@ -483,29 +529,116 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
+static void *seq_disk_cache_imbuf_data(ImBuf *ibuf)
+{
+  if (ibuf->rect) {
+    return ibuf->rect;
+  }
+  return ibuf->rect_float;
+}
+
+static size_t write_mem_to_file_at_pos(const void *buf, size_t len, FILE *file, uint64_t offset)
+{
+  if (BLI_fseek(file, (int64_t)offset, SEEK_SET) != 0) {
+    return 0;
+  }
+  if (fwrite(buf, 1, len, file) != len) {
+    return 0;
+  }
+  return len;
+}
+
+static size_t read_file_to_mem_at_pos(void *buf, size_t len, FILE *file, uint64_t offset)
+{
+  if (BLI_fseek(file, (int64_t)offset, SEEK_SET) != 0) {
+    return 0;
+  }
+  return fread(buf, 1, len, file);
+}
+
+#ifdef WITH_LZO
+static size_t lzo_compress_mem_to_file(void *buf, FILE *file, DiskCacheHeaderEntry *header_entry)
+{
+  lzo_uint out_len = LZO_OUT_LEN(header_entry->size_raw);
+  unsigned char *out = MEM_mallocN(out_len, "seq disk cache lzo buffer");
+  void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, "seq disk cache lzo work memory");
+  size_t bytes_written;
+
+  int r = lzo1x_1_compress(buf, (lzo_uint)header_entry->size_raw, out, &out_len, wrkmem);
+  if (r == LZO_E_OK && out_len < header_entry->size_raw) {
+    bytes_written = write_mem_to_file_at_pos(out, out_len, file, header_entry->offset);
+  }
+  else {
+    /* Data is not compressible, store it as is. */
+    header_entry->codec = DCACHE_CODEC_RAW;
+    bytes_written = write_mem_to_file_at_pos(
+        buf, header_entry->size_raw, file, header_entry->offset);
+  }
+
+  MEM_freeN(wrkmem);
+  MEM_freeN(out);
+  return bytes_written;
+}
+
+static size_t lzo_decompress_file_to_mem(void *buf, FILE *file, DiskCacheHeaderEntry *header_entry)
+{
+  unsigned char *in = MEM_mallocN(header_entry->size_compressed, "seq disk cache lzo buffer");
+  size_t bytes_read = 0;
+
+  if (read_file_to_mem_at_pos(in, header_entry->size_compressed, file, header_entry->offset) ==
+      header_entry->size_compressed) {
+    lzo_uint out_len = header_entry->size_raw;
+    int r = lzo1x_decompress_safe(
+        in, (lzo_uint)header_entry->size_compressed, buf, &out_len, NULL);
+    if (r == LZO_E_OK) {
+      bytes_read = out_len;
+    }
+  }
+
+  MEM_freeN(in);
+  return bytes_read;
+}
+#endif
+
 static size_t deflate_imbuf_to_file(ImBuf *ibuf,
                                     FILE *file,
                                     int level,
                                     DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+  void *buf = seq_disk_cache_imbuf_data(ibuf);
+
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_RAW:
+      return write_mem_to_file_at_pos(buf, header_entry->size_raw, file, header_entry->offset);
+#ifdef WITH_LZO
+    case DCACHE_CODEC_LZO:
+      return lzo_compress_mem_to_file(buf, file, header_entry);
+#endif
   }
 
   return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+      buf, header_entry->size_raw, file, header_entry->offset, level);
 }
 
 static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
-  }
-
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  void *buf = seq_disk_cache_imbuf_data(ibuf);
+
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_ZLIB:
+      return BLI_ungzip_file_to_mem_at_pos(
+          buf, header_entry->size_raw, file, header_entry->offset);
+    case DCACHE_CODEC_RAW:
+      /* Offset is page aligned, so this is a single read straight into the image buffer. */
+      return read_file_to_mem_at_pos(buf, header_entry->size_raw, file, header_entry->offset);
+#ifdef WITH_LZO
+    case DCACHE_CODEC_LZO:
+      return lzo_decompress_file_to_mem(buf, file, header_entry);
+#endif
+  }
+
+  /* Codec not supported by this build. */
+  return 0;
 }
 
 static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -553,6 +686,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
   if (i > 0) {
     offset = header->entry[i - 1].offset + header->entry[i - 1].size_compressed;
   }
+  offset = (offset + DCACHE_PAGE_SIZE - 1) & ~(uint64_t)(DCACHE_PAGE_SIZE - 1);
 
   if (ENDIAN_ORDER == B_ENDIAN) {
     header->entry[i].encoding = 255;
@@ -561,6 +695,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     header->entry[i].encoding = 0;
   }
 
+  header->entry[i].codec = seq_disk_cache_codec();
   header->entry[i].offset = offset;
   header->entry[i].frameno = key->frame_index;
 
@@ -671,7 +806,9 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
     return NULL;
   }
 
+  const double time_start = PIL_check_seconds_timer();
   size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  const double time_read = PIL_check_seconds_timer() - time_start;
 
   /* Sanity check. */
   if (bytes_read != expected_size) {
@@ -679,6 +816,17 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
     IMB_freeImBuf(ibuf);
     return NULL;
   }
+
+  disk_cache->read_bytes_total += bytes_read;
+  disk_cache->read_time_total += time_read;
+  if (G.debug & G_DEBUG) {
+    const double mb = 1024.0 * 1024.0;
+    printf("Sequencer disk cache: read %.1f MB in %.2f ms, %.0f MB/s (average %.0f MB/s)\n",
+           bytes_read / mb,
+           time_read * 1000.0,
+           bytes_read / mb / max_dd(time_read, 1e-6),
+           disk_cache->read_bytes_total / mb / max_dd(disk_cache->read_time_total, 1e-6));
+  }
   BLI_file_touch(path);
   seq_disk_cache_update_file(disk_cache, path);
   fclose(file);
@@ -690,6 +838,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_PAGE_SIZE
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -1338,6 +1487,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   }
 
   Scene *scene = context->scene;
+  const eSeqTaskId task_id = context->task_id;
 
   if (context->is_prefetch_render) {
     context = BKE_sequencer_prefetch_get_original_context(context);
@@ -1377,6 +1527,17 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
     cost = SEQ_CACHE_COST_MAX;
   }
 
+  /* Inputs rendered ahead by prefetch workers don't belong to the frame which is being rendered,
+   * so they can't be linked. Keep only those which are expensive to render again, and only while
+   * there is enough space left for final frames. */
+  const bool is_unlinked = (task_id == SEQ_TASK_PREFETCH_INPUT);
+  if (is_unlinked && (cost < SEQ_PREFETCH_INPUT_COST_MIN ||
+                      cache->memory_used + IMB_get_size_in_memory(i) >
+                          seq_cache_get_mem_total() / 2)) {
+    seq_cache_unlock(scene);
+    return;
+  }
+
   SeqCacheKey *key;
   key = BLI_mempool_alloc(cache->keys_pool);
   key->cache_owner = cache;
@@ -1389,10 +1550,13 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   key->link_prev = NULL;
   key->link_next = NULL;
   key->is_temp_cache = true;
-  key->task_id = context->task_id;
+  key->task_id = task_id;
 
   /* Item stored for later use */
-  if (flag & type) {
+  if (is_unlinked) {
+    key->is_temp_cache = false;
+  }
+  else if (flag & type) {
     key->is_temp_cache = false;
     key->link_prev = cache->last_key;
   }
@@ -1400,15 +1564,16 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   SeqCacheKey *temp_last_key = cache->last_key;
   seq_cache_put(cache, key, i);
 
-  /* Restore pointer to previous item as this one will be freed when stack is rendered. */
-  if (key->is_temp_cache) {
+  /* Restore pointer to previous item as this one will be freed when stack is rendered.
+   * Unlinked items are recycled on their own. */
+  if (key->is_temp_cache || is_unlinked) {
     cache->last_key = temp_last_key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
    * Item is already put in cache, so cache->last_key points to current key.
    */
-  if (flag & type && temp_last_key) {
+  if (flag & type && temp_last_key && !is_unlinked) {
     temp_last_key->link_next = cache->last_key;
   }
 
@@ -33,7 +33,10 @@
 #include "DNA_sequence_types.h"
 #include "DNA_windowmanager_types.h"
 
+#include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_string.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -53,12 +56,37 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
 #include "SEQ_sequencer.h"
 
 #include "image_cache.h"
 #include "prefetch.h"
 #include "render.h"
 
+/**
+ * Prefetching is done as a pipeline:
+ * - Input workers run ahead of the prefetch render thread, each with its own evaluated scene, and
+ *   render visible inputs of the stack which are expensive and safe to render from multiple
+ *   threads (image and movie strips). These are stored in cache as unlinked entries, see
+ *   #SEQ_TASK_PREFETCH_INPUT.
+ * - The prefetch render thread renders final frames in order, reusing inputs from cache.
+ *
+ * Frames are prefetched in the direction in which the playhead last moved while playing or
+ * scrubbing.
+ */
+
+/* Maximal number of input workers. */
+#define SEQ_PREFETCH_INPUT_WORKERS_MAX 4
+
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+  struct SeqRenderData context_cpy;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
@@ -73,6 +101,17 @@ typedef struct PrefetchJob {
 
   ListBase threads;
 
+  /* Input workers. Prefetch area and input costs are protected by `inputs_mutex`. */
+  PrefetchWorker *workers;
+  int num_workers;
+  ListBase input_threads;
+  ThreadMutex inputs_mutex;
+  ThreadCondition inputs_cond;
+  /* Measured cost of rendering strip inputs, by strip name. */
+  GHash *input_cost;
+  float next_input_frame;
+  bool inputs_stop;
+
   /* context */
   struct SeqRenderData context;
   struct SeqRenderData context_cpy;
@@ -82,6 +121,10 @@ typedef struct PrefetchJob {
   /* prefetch area */
   float cfra;
   int num_frames_prefetched;
+  /* 1 when prefetching forward, -1 when backward. */
+  int direction;
+  int direction_requested;
+  float last_timeline_frame;
 
   /* control */
   bool running;
@@ -186,8 +229,17 @@ static bool seq_prefetch_is_cache_full(Scene *scene)
 
 static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
-  return pfjob->cfra + pfjob->num_frames_prefetched;
+  return pfjob->cfra + pfjob->direction * pfjob->num_frames_prefetched;
+}
+
+static bool seq_prefetch_cfra_in_range(PrefetchJob *pfjob, float cfra)
+{
+  if (pfjob->direction > 0) {
+    return cfra <= pfjob->scene->r.efra;
+  }
+  return cfra >= pfjob->scene->r.sfra;
 }
+
 static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
 {
   return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
@@ -197,8 +249,14 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  *start = pfjob->cfra;
-  *end = seq_prefetch_cfra(pfjob);
+  /* Include inputs rendered ahead by workers. */
+  float last = seq_prefetch_cfra(pfjob);
+  if ((pfjob->next_input_frame - last) * pfjob->direction > 0) {
+    last = pfjob->next_input_frame;
+  }
+
+  *start = min_ff(pfjob->cfra, last);
+  *end = max_ff(pfjob->cfra, last);
 }
 
 static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
@@ -234,13 +292,49 @@ static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
   pfjob->scene_eval->ed->cache_flag = 0;
 }
 
+static void seq_prefetch_worker_free_depsgraph(PrefetchWorker *worker)
+{
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
+  }
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
+}
+
+static void seq_prefetch_worker_init_depsgraph(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+  Scene *scene = pfjob->scene;
+  ViewLayer *view_layer = BKE_view_layer_default_render(scene);
+
+  /* Input workers only render image and movie strips, which depend on nothing but the scene.
+   * Don't copy the objects and compositor of the render pipeline graph for every worker. */
+  ID *ids[] = {&scene->id};
+
+  worker->depsgraph = DEG_graph_new(worker->bmain_eval, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH INPUT");
+  DEG_graph_build_from_ids(worker->depsgraph, ids, ARRAY_SIZE(ids));
+  DEG_evaluate_on_framechange(worker->depsgraph, seq_prefetch_cfra(pfjob));
+
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+}
+
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
 {
   int cfra = pfjob->scene->r.cfra;
 
+  /* Playhead moved in opposite direction, start over from current frame. */
+  if (pfjob->direction_requested != pfjob->direction) {
+    pfjob->direction = pfjob->direction_requested;
+    pfjob->cfra = cfra;
+    pfjob->num_frames_prefetched = 1;
+    return;
+  }
+
   /* rebase */
-  if (cfra > pfjob->cfra) {
-    int delta = cfra - pfjob->cfra;
+  if ((cfra - pfjob->cfra) * pfjob->direction > 0) {
+    int delta = abs(cfra - (int)pfjob->cfra);
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched -= delta;
 
@@ -250,7 +344,7 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
   }
 
   /* reset */
-  if (cfra < pfjob->cfra) {
+  if ((cfra - pfjob->cfra) * pfjob->direction < 0) {
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched = 1;
   }
@@ -327,6 +421,26 @@ static void seq_prefetch_update_scene(Scene *scene)
   pfjob->scene = scene;
   seq_prefetch_free_depsgraph(pfjob);
   seq_prefetch_init_depsgraph(pfjob);
+
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_worker_free_depsgraph(&pfjob->workers[i]);
+    seq_prefetch_worker_init_depsgraph(&pfjob->workers[i]);
+  }
+}
+
+static void seq_prefetch_update_worker_context(PrefetchWorker *worker,
+                                               const SeqRenderData *context)
+{
+  SEQ_render_new_render_data(worker->bmain_eval,
+                             worker->depsgraph,
+                             worker->scene_eval,
+                             context->rectx,
+                             context->recty,
+                             context->preview_render_size,
+                             false,
+                             &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = SEQ_TASK_PREFETCH_INPUT;
 }
 
 static void seq_prefetch_resume(Scene *scene)
@@ -349,8 +463,17 @@ void BKE_sequencer_prefetch_free(Scene *scene)
 
   BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_end(&pfjob->threads);
+  BLI_threadpool_end(&pfjob->input_threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
+  BLI_mutex_end(&pfjob->inputs_mutex);
+  BLI_condition_end(&pfjob->inputs_cond);
+  BLI_ghash_free(pfjob->input_cost, MEM_freeN, MEM_freeN);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_worker_free_depsgraph(&pfjob->workers[i]);
+    BKE_main_free(pfjob->workers[i].bmain_eval);
+  }
+  MEM_SAFE_FREE(pfjob->workers);
   seq_prefetch_free_depsgraph(pfjob);
   BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
@@ -420,7 +543,19 @@ static bool seq_prefetch_do_skip_frame(Scene *scene)
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         !seq_prefetch_cfra_in_range(pfjob, seq_prefetch_cfra(pfjob) + pfjob->direction);
+}
+
+/* Update prefetch area and let input workers know about it. */
+static void seq_prefetch_update_area_locked(PrefetchJob *pfjob, bool advance)
+{
+  BLI_mutex_lock(&pfjob->inputs_mutex);
+  seq_prefetch_update_area(pfjob);
+  if (advance) {
+    pfjob->num_frames_prefetched++;
+  }
+  BLI_condition_notify_all(&pfjob->inputs_cond);
+  BLI_mutex_unlock(&pfjob->inputs_mutex);
 }
 
 static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
@@ -430,17 +565,170 @@ static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
          (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
     pfjob->waiting = true;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
-    seq_prefetch_update_area(pfjob);
+    seq_prefetch_update_area_locked(pfjob, false);
   }
   pfjob->waiting = false;
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 }
 
+/* Get next frame for input worker to render. Workers stay at most a few frames ahead of the
+ * prefetch render thread, so inputs don't fill cache faster than frames can be composited.
+ * Returns false when workers should stop. */
+static bool seq_prefetch_input_frame_claim(PrefetchJob *pfjob, float *r_frame)
+{
+  const int lookahead = 2 * pfjob->num_workers;
+  bool found = false;
+
+  BLI_mutex_lock(&pfjob->inputs_mutex);
+  while (!pfjob->inputs_stop && !pfjob->stop) {
+    const float render_frame = seq_prefetch_cfra(pfjob);
+    const float distance = (pfjob->next_input_frame - render_frame) * pfjob->direction;
+
+    /* Prefetch area was moved or reset. */
+    if (distance <= 0 || distance > lookahead + 1) {
+      pfjob->next_input_frame = render_frame + pfjob->direction;
+    }
+
+    if ((pfjob->next_input_frame - render_frame) * pfjob->direction <= lookahead &&
+        seq_prefetch_cfra_in_range(pfjob, pfjob->next_input_frame)) {
+      *r_frame = pfjob->next_input_frame;
+      pfjob->next_input_frame += pfjob->direction;
+      found = true;
+      break;
+    }
+
+    BLI_condition_wait(&pfjob->inputs_cond, &pfjob->inputs_mutex);
+  }
+  BLI_mutex_unlock(&pfjob->inputs_mutex);
+
+  return found;
+}
+
+/* Inputs measured to be cheap are left to the prefetch render thread. */
+static bool seq_prefetch_input_is_expensive(PrefetchJob *pfjob, Sequence *seq)
+{
+  BLI_mutex_lock(&pfjob->inputs_mutex);
+  float *cost = BLI_ghash_lookup(pfjob->input_cost, seq->name);
+  bool is_expensive = (cost == NULL || *cost >= SEQ_PREFETCH_INPUT_COST_MIN);
+  BLI_mutex_unlock(&pfjob->inputs_mutex);
+
+  return is_expensive;
+}
+
+static void seq_prefetch_input_cost_set(PrefetchJob *pfjob, Sequence *seq, float cost)
+{
+  BLI_mutex_lock(&pfjob->inputs_mutex);
+  void **key_p, **val_p;
+  if (!BLI_ghash_ensure_p_ex(pfjob->input_cost, seq->name, &key_p, &val_p)) {
+    *key_p = BLI_strdup(seq->name);
+    *val_p = MEM_mallocN(sizeof(float), "prefetch input cost");
+  }
+  *(float *)*val_p = cost;
+  BLI_mutex_unlock(&pfjob->inputs_mutex);
+}
+
+static void seq_prefetch_input_render_strips(PrefetchWorker *worker, float cfra)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+  SeqRenderData *ctx = &worker->context_cpy;
+  Sequence *seq_arr[MAXSEQ + 1];
+  int count = seq_get_shown_sequences(worker->scene_eval->ed->seqbasep, cfra, 0, seq_arr);
+  if (count == 0) {
+    return;
+  }
+
+  ImBuf *ibuf = BKE_sequencer_cache_get(
+      ctx, seq_arr[count - 1], cfra, SEQ_CACHE_STORE_FINAL_OUT, true);
+  if (ibuf != NULL) {
+    IMB_freeImBuf(ibuf);
+    return;
+  }
+
+  /* Strips hidden under other strips are not rendered by the prefetch render thread either. */
+  bool need_input[MAXSEQ + 1];
+  seq_render_strip_stack_need_input(seq_arr, count, need_input);
+
+  for (int i = 0; i < count && !pfjob->inputs_stop && !pfjob->stop; i++) {
+    Sequence *seq = seq_arr[i];
+    if (!need_input[i] || !seq_render_strip_is_threadsafe(seq) ||
+        !seq_prefetch_input_is_expensive(pfjob, seq)) {
+      continue;
+    }
+
+    ibuf = BKE_sequencer_cache_get(ctx, seq, cfra, SEQ_CACHE_STORE_PREPROCESSED, true);
+    if (ibuf != NULL) {
+      IMB_freeImBuf(ibuf);
+      continue;
+    }
+
+    /* Cache decides, whether rendered images are worth keeping. */
+    SeqRenderState state;
+    seq_render_state_init(&state);
+    const double begin = PIL_check_seconds_timer();
+    ibuf = seq_render_strip(ctx, &state, seq, cfra);
+    const double time_spent = PIL_check_seconds_timer() - begin;
+    IMB_freeImBuf(ibuf);
+
+    seq_prefetch_input_cost_set(pfjob, seq, (float)(time_spent * pfjob->scene->r.frs_sec));
+  }
+}
+
+static void seq_prefetch_input_render(PrefetchWorker *worker, float cfra)
+{
+  Scene *scene_eval = worker->scene_eval;
+
+  /* See #seq_prefetch_frames for why prefetch job is set only while rendering. */
+  scene_eval->ed->prefetch_job = NULL;
+  DEG_evaluate_on_framechange(worker->depsgraph, cfra);
+  AnimData *adt = BKE_animdata_from_id(&scene_eval->id);
+  AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(worker->depsgraph,
+                                                                              cfra);
+  BKE_animsys_evaluate_animdata(&scene_eval->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+
+  scene_eval->ed->prefetch_job = worker->pfjob;
+  seq_prefetch_input_render_strips(worker, cfra);
+  scene_eval->ed->prefetch_job = NULL;
+}
+
+static void *seq_prefetch_inputs(void *worker_v)
+{
+  PrefetchWorker *worker = (PrefetchWorker *)worker_v;
+  float cfra;
+
+  while (seq_prefetch_input_frame_claim(worker->pfjob, &cfra)) {
+    seq_prefetch_input_render(worker, cfra);
+  }
+
+  return NULL;
+}
+
+static void seq_prefetch_inputs_start(PrefetchJob *pfjob)
+{
+  pfjob->inputs_stop = false;
+  pfjob->next_input_frame = seq_prefetch_cfra(pfjob);
+
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_insert(&pfjob->input_threads, &pfjob->workers[i]);
+  }
+}
+
+static void seq_prefetch_inputs_stop(PrefetchJob *pfjob)
+{
+  BLI_mutex_lock(&pfjob->inputs_mutex);
+  pfjob->inputs_stop = true;
+  BLI_condition_notify_all(&pfjob->inputs_cond);
+  BLI_mutex_unlock(&pfjob->inputs_mutex);
+
+  BLI_threadpool_clear(&pfjob->input_threads);
+}
+
 static void *seq_prefetch_frames(void *job)
 {
   PrefetchJob *pfjob = (PrefetchJob *)job;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
+  seq_prefetch_inputs_start(pfjob);
+
+  while (seq_prefetch_cfra_in_range(pfjob, seq_prefetch_cfra(pfjob))) {
     pfjob->scene_eval->ed->prefetch_job = NULL;
 
     seq_prefetch_update_depsgraph(pfjob);
@@ -458,7 +746,7 @@ static void *seq_prefetch_frames(void *job)
     pfjob->scene_eval->ed->prefetch_job = pfjob;
 
     if (seq_prefetch_do_skip_frame(pfjob->scene)) {
-      pfjob->num_frames_prefetched++;
+      seq_prefetch_update_area_locked(pfjob, true);
       continue;
     }
 
@@ -472,7 +760,7 @@ static void *seq_prefetch_frames(void *job)
 
     /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
     if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
+        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) * pfjob->direction < 2) {
       break;
     }
 
@@ -480,10 +768,11 @@ static void *seq_prefetch_frames(void *job)
       break;
     }
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+    seq_prefetch_update_area_locked(pfjob, true);
   }
 
+  seq_prefetch_inputs_stop(pfjob);
+
   BKE_sequencer_cache_free_temp_cache(
       pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
   pfjob->running = false;
@@ -505,6 +794,22 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
+      /* Leave some threads for the prefetch render thread and main thread. */
+      pfjob->num_workers = min_ii(BLI_system_thread_count() / 2, SEQ_PREFETCH_INPUT_WORKERS_MAX);
+      if (pfjob->num_workers > 0) {
+        pfjob->workers = MEM_callocN(sizeof(PrefetchWorker) * pfjob->num_workers,
+                                     "PrefetchWorker");
+        BLI_threadpool_init(&pfjob->input_threads, seq_prefetch_inputs, pfjob->num_workers);
+      }
+      for (int i = 0; i < pfjob->num_workers; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+        pfjob->workers[i].bmain_eval = BKE_main_new();
+      }
+      BLI_mutex_init(&pfjob->inputs_mutex);
+      BLI_condition_init(&pfjob->inputs_cond);
+      pfjob->input_cost = BLI_ghash_str_new("prefetch input cost");
+      pfjob->direction = pfjob->direction_requested = 1;
+
       pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
       seq_prefetch_init_depsgraph(pfjob);
@@ -512,15 +817,22 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
   }
   pfjob->bmain = context->bmain;
 
+  pfjob->direction = pfjob->direction_requested;
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
+  /* Strips may have been edited since costs were measured. */
+  BLI_ghash_clear(pfjob->input_cost, MEM_freeN, MEM_freeN);
+
   pfjob->waiting = false;
   pfjob->stop = false;
   pfjob->running = true;
 
   seq_prefetch_update_scene(context->scene);
   seq_prefetch_update_context(context);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_update_worker_context(&pfjob->workers[i], context);
+  }
 
   BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_insert(&pfjob->threads, pfjob);
@@ -528,6 +840,21 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
   return pfjob;
 }
 
+/* Follow direction in which the playhead moves. */
+static void seq_prefetch_update_direction(Scene *scene, float timeline_frame, bool is_moving)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (!pfjob) {
+    return;
+  }
+
+  if (is_moving && timeline_frame != pfjob->last_timeline_frame) {
+    pfjob->direction_requested = (timeline_frame > pfjob->last_timeline_frame) ? 1 : -1;
+  }
+  pfjob->last_timeline_frame = timeline_frame;
+}
+
 /* Start or resume prefetching*/
 void BKE_sequencer_prefetch_start(const SeqRenderData *context, float timeline_frame, float cost)
 {
@@ -539,6 +866,7 @@ void BKE_sequencer_prefetch_start(const SeqRenderData *context, float timeline_f
     bool playing = seq_prefetch_is_playing(context->bmain);
     bool scrubbing = seq_prefetch_is_scrubbing(context->bmain);
     bool running = BKE_sequencer_prefetch_job_is_running(scene);
+    seq_prefetch_update_direction(scene, timeline_frame, playing || scrubbing);
     seq_prefetch_resume(scene);
     /* conditions to start:
      * prefetch enabled, prefetch not running, not scrubbing,
@@ -33,6 +33,9 @@ struct Scene;
 struct Sequence;
 struct SeqRenderData;
 
+/* Minimal cost of strip input rendered by prefetch workers to be kept in cache. */
+#define SEQ_PREFETCH_INPUT_COST_MIN 0.5f
+
 #ifdef __cplusplus
 }
 #endif
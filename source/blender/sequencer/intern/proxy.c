@@ -288,7 +288,14 @@ static void seq_proxy_build_frame(const SeqRenderData *context,
     ibuf = IMB_dupImBuf(ibuf_tmp);
     IMB_metadata_copy(ibuf, ibuf_tmp);
     IMB_freeImBuf(ibuf_tmp);
-    IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+
+    const eIMBScaleFilter filter = IMB_scale_filter_preference_get();
+    if (filter == IMB_SCALE_FILTER_DEFAULT) {
+      IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+    }
+    else {
+      IMB_scaleImBuf_filter(ibuf, rectx, recty, filter);
+    }
   }
   else {
     ibuf = ibuf_tmp;
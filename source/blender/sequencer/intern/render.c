@@ -24,8 +24,6 @@
  * \ingroup bke
  */
 
-#include <time.h>
-
 #include "MEM_guardedalloc.h"
 
 #include "DNA_anim_types.h"
@@ -37,6 +35,7 @@
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -59,6 +58,8 @@
 #include "IMB_imbuf_types.h"
 #include "IMB_metadata.h"
 
+#include "PIL_time.h"
+
 #include "RNA_access.h"
 
 #include "RE_engine.h"
@@ -397,20 +398,21 @@ int seq_get_shown_sequences(ListBase *seqbasep,
   return cnt;
 }
 
-/* Estimate time spent by the program rendering the strip */
-static clock_t seq_estimate_render_cost_begin(void)
+/* Estimate time spent by the program rendering the strip.
+ * Wall-clock time is used, because strips of a stack can be rendered by multiple threads at once,
+ * which would inflate the process CPU time. */
+static double seq_estimate_render_cost_begin(void)
 {
-  return clock();
+  return PIL_check_seconds_timer();
 }
 
-static float seq_estimate_render_cost_end(Scene *scene, clock_t begin)
+static float seq_estimate_render_cost_end(Scene *scene, double begin)
 {
-  clock_t end = clock();
-  float time_spent = (float)(end - begin);
-  float time_max = (1.0f / scene->r.frs_sec) * CLOCKS_PER_SEC;
+  const double time_spent = PIL_check_seconds_timer() - begin;
+  const double time_max = 1.0 / scene->r.frs_sec;
 
   if (time_max != 0) {
-    return time_spent / time_max;
+    return (float)(time_spent / time_max);
   }
 
   return 1;
@@ -460,6 +462,28 @@ static bool sequencer_use_crop(const Sequence *seq)
   return false;
 }
 
+/* Preview images which are only resized to fit the preview can be scaled directly with the
+ * filter chosen in the preferences, instead of the nearest interpolation of the transform. */
+static bool sequencer_use_scale_filter(const SeqRenderData *context,
+                                       const Sequence *seq,
+                                       const ImBuf *ibuf,
+                                       const float scale_to_fit_factor)
+{
+  if (context->for_render || sequencer_use_transform(seq)) {
+    return false;
+  }
+  if (IMB_scale_filter_preference_get() == IMB_SCALE_FILTER_DEFAULT) {
+    return false;
+  }
+  if (context->rectx == ibuf->x && context->recty == ibuf->y) {
+    return false;
+  }
+
+  /* Only when the image fills the whole preview, otherwise the borders need the transform. */
+  return (int)(ibuf->x * scale_to_fit_factor + 0.5f) == context->rectx &&
+         (int)(ibuf->y * scale_to_fit_factor + 0.5f) == context->recty;
+}
+
 static bool BKE_sequencer_input_have_to_preprocess(const SeqRenderData *context,
                                                    Sequence *seq,
                                                    float UNUSED(timeline_frame))
@@ -663,7 +687,16 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     IMB_rectfill_area_replace(preprocessed_ibuf, col, left, height - top, width - right, height);
   }
 
-  if (sequencer_use_transform(seq) || context->rectx != ibuf->x || context->recty != ibuf->y) {
+  if (sequencer_use_scale_filter(context, seq, ibuf, scale_to_fit_factor)) {
+    /* Plain resize of the whole image, use the filter chosen in the preferences. */
+    preprocessed_ibuf = IMB_makeSingleUser(ibuf);
+    ibuf = preprocessed_ibuf;
+
+    IMB_scaleImBuf_filter(
+        preprocessed_ibuf, context->rectx, context->recty, IMB_scale_filter_preference_get());
+  }
+  else if (sequencer_use_transform(seq) || context->rectx != ibuf->x ||
+           context->recty != ibuf->y) {
     const int x = context->rectx;
     const int y = context->recty;
     preprocessed_ibuf = IMB_allocImBuf(x, y, 32, ibuf->rect_float ? IB_rectfloat : IB_rect);
@@ -739,7 +772,7 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float timeline_frame,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image)
 {
@@ -1076,8 +1109,13 @@ static ImBuf *seq_render_image_strip(const SeqRenderData *context,
       localcontext.view_id = view_id;
 
       if (view_id != context->view_id) {
-        ibufs_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibufs_arr[view_id], timeline_frame, clock(), true, false);
+        ibufs_arr[view_id] = seq_render_preprocess_ibuf(&localcontext,
+                                                        seq,
+                                                        ibufs_arr[view_id],
+                                                        timeline_frame,
+                                                        seq_estimate_render_cost_begin(),
+                                                        true,
+                                                        false);
       }
     }
 
@@ -1226,8 +1264,13 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context,
       localcontext.view_id = view_id;
 
       if (view_id != context->view_id) {
-        ibuf_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibuf_arr[view_id], timeline_frame, clock(), true, false);
+        ibuf_arr[view_id] = seq_render_preprocess_ibuf(&localcontext,
+                                                       seq,
+                                                       ibuf_arr[view_id],
+                                                       timeline_frame,
+                                                       seq_estimate_render_cost_begin(),
+                                                       true,
+                                                       false);
       }
     }
 
@@ -1809,7 +1852,7 @@ ImBuf *seq_render_strip(const SeqRenderData *context,
   bool use_preprocess = false;
   bool is_proxy_image = false;
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
 
   ibuf = BKE_sequencer_cache_get(
       context, seq, timeline_frame, SEQ_CACHE_STORE_PREPROCESSED, false);
@@ -1905,6 +1948,180 @@ static ImBuf *seq_render_strip_stack_apply_effect(
   return out;
 }
 
+/* Strips which can be rendered from multiple threads at once. Their rendering only depends on
+ * the strip itself, other types use the render pipeline or render other strips recursively.
+ * Modifiers masked by another strip or a mask ID render those as well. */
+bool seq_render_strip_is_threadsafe(const Sequence *seq)
+{
+  if (!ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE)) {
+    return false;
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_sequence != NULL || smd->mask_id != NULL) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Get which strips of the stack `seq_arr` are composited, the strips below a strip which doesn't
+ * blend with its input are occluded. Cached composites and strips which fail to render are not
+ * taken into account.
+ */
+void seq_render_strip_stack_need_input(Sequence **seq_arr, int count, bool *r_need_input)
+{
+  bool occluded = false;
+
+  for (int i = count - 1; i >= 0; i--) {
+    Sequence *seq = seq_arr[i];
+    const int early_out = seq_get_early_out_for_blend_mode(seq);
+
+    if (occluded) {
+      r_need_input[i] = false;
+    }
+    else if (seq->blend_mode == SEQ_BLEND_REPLACE ||
+             ELEM(early_out, EARLY_NO_INPUT, EARLY_USE_INPUT_2)) {
+      r_need_input[i] = true;
+      occluded = true;
+    }
+    else {
+      r_need_input[i] = (early_out == EARLY_DO_EFFECT);
+    }
+  }
+}
+
+typedef struct RenderStackInputData {
+  const SeqRenderData *context;
+  SeqRenderState *state;
+  Sequence **seq_arr;
+  ImBuf **ibuf_arr;
+  /* Indices into `seq_arr` of strips to render. */
+  int *input_index;
+  float timeline_frame;
+} RenderStackInputData;
+
+static void render_stack_input_task(void *__restrict userdata,
+                                    const int iter,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RenderStackInputData *data = userdata;
+  const int index = data->input_index[iter];
+
+  data->ibuf_arr[index] = seq_render_strip(
+      data->context, data->state, data->seq_arr[index], data->timeline_frame);
+}
+
+/**
+ * Render independent inputs of the stack concurrently: decoding, preprocessing and modifiers of
+ * different strips don't depend on each other. Strips which are not safe to render from worker
+ * threads are left to be rendered on demand by #seq_render_strip_stack_input_get.
+ */
+static void seq_render_strip_stack_inputs(const SeqRenderData *context,
+                                          SeqRenderState *state,
+                                          Sequence **seq_arr,
+                                          const bool *need_input,
+                                          int count,
+                                          float timeline_frame,
+                                          ImBuf **r_ibuf_arr)
+{
+  int input_index[MAXSEQ + 1];
+  int input_len = 0;
+
+  for (int i = 0; i < count; i++) {
+    if (need_input[i] && seq_render_strip_is_threadsafe(seq_arr[i])) {
+      input_index[input_len++] = i;
+    }
+  }
+
+  if (input_len < 2) {
+    return;
+  }
+
+  RenderStackInputData data = {
+      .context = context,
+      .state = state,
+      .seq_arr = seq_arr,
+      .ibuf_arr = r_ibuf_arr,
+      .input_index = input_index,
+      .timeline_frame = timeline_frame,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, input_len, &data, render_stack_input_task, &settings);
+}
+
+static ImBuf *seq_render_strip_stack_input_get(const SeqRenderData *context,
+                                               SeqRenderState *state,
+                                               Sequence **seq_arr,
+                                               ImBuf **ibuf_arr,
+                                               int index,
+                                               float timeline_frame)
+{
+  if (ibuf_arr[index] != NULL) {
+    ImBuf *ibuf = ibuf_arr[index];
+    ibuf_arr[index] = NULL;
+    return ibuf;
+  }
+  return seq_render_strip(context, state, seq_arr[index], timeline_frame);
+}
+
+/**
+ * Find the bottom-most strip at or below `top` that contributes to the composite, looking up
+ * cached composites on the way. Strips are only rendered once all inputs are known, so they can
+ * be rendered concurrently, `r_need_input` is set for the strips from the bottom to `top` that
+ * have to be rendered.
+ */
+static int seq_render_strip_stack_bottom_find(const SeqRenderData *context,
+                                              Sequence **seq_arr,
+                                              int top,
+                                              float timeline_frame,
+                                              int *r_early_out_arr,
+                                              bool *r_need_input,
+                                              ImBuf **r_out)
+{
+  int i;
+
+  for (i = top; i >= 0; i--) {
+    Sequence *seq = seq_arr[i];
+
+    *r_out = BKE_sequencer_cache_get(
+        context, seq, timeline_frame, SEQ_CACHE_STORE_COMPOSITE, false);
+
+    if (*r_out) {
+      break;
+    }
+    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
+      r_need_input[i] = true;
+      break;
+    }
+
+    r_early_out_arr[i] = seq_get_early_out_for_blend_mode(seq);
+
+    if (ELEM(r_early_out_arr[i], EARLY_NO_INPUT, EARLY_USE_INPUT_2)) {
+      r_need_input[i] = true;
+      break;
+    }
+    if (i == 0) {
+      r_need_input[i] = (r_early_out_arr[i] == EARLY_DO_EFFECT);
+      break;
+    }
+  }
+
+  const int bottom = i;
+
+  for (i = bottom + 1; i <= top; i++) {
+    r_early_out_arr[i] = seq_get_early_out_for_blend_mode(seq_arr[i]);
+    r_need_input[i] = (r_early_out_arr[i] == EARLY_DO_EFFECT);
+  }
+
+  return bottom;
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      SeqRenderState *state,
                                      ListBase *seqbasep,
@@ -1912,10 +2129,13 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  ImBuf *ibuf_arr[MAXSEQ + 1] = {NULL};
+  int early_out_arr[MAXSEQ + 1];
+  bool need_input[MAXSEQ + 1] = {false};
   int count;
   int i;
   ImBuf *out = NULL;
-  clock_t begin;
+  double begin;
 
   count = seq_get_shown_sequences(seqbasep, timeline_frame, chanshown, (Sequence **)&seq_arr);
 
@@ -1923,63 +2143,61 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     return NULL;
   }
 
-  for (i = count - 1; i >= 0; i--) {
-    int early_out;
-    Sequence *seq = seq_arr[i];
+  int bottom = seq_render_strip_stack_bottom_find(
+      context, seq_arr, count - 1, timeline_frame, early_out_arr, need_input, &out);
+
+  seq_render_strip_stack_inputs(
+      context, state, seq_arr, need_input, count, timeline_frame, ibuf_arr);
 
-    out = BKE_sequencer_cache_get(context, seq, timeline_frame, SEQ_CACHE_STORE_COMPOSITE, false);
+  while (out == NULL) {
+    Sequence *seq = seq_arr[bottom];
 
-    if (out) {
+    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
+      out = seq_render_strip_stack_input_get(
+          context, state, seq_arr, ibuf_arr, bottom, timeline_frame);
       break;
     }
-    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-      out = seq_render_strip(context, state, seq, timeline_frame);
+    if (ELEM(early_out_arr[bottom], EARLY_NO_INPUT, EARLY_USE_INPUT_2)) {
+      out = seq_render_strip_stack_input_get(
+          context, state, seq_arr, ibuf_arr, bottom, timeline_frame);
+      if (out != NULL || bottom == 0) {
+        break;
+      }
+      /* Strip didn't render anything (missing media for example), composite the strips below
+       * instead. These are rendered on demand, they could not be known in advance. */
+      bottom = seq_render_strip_stack_bottom_find(
+          context, seq_arr, bottom - 1, timeline_frame, early_out_arr, need_input, &out);
+      continue;
+    }
+    if (early_out_arr[bottom] == EARLY_USE_INPUT_1) {
+      out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
       break;
     }
 
-    early_out = seq_get_early_out_for_blend_mode(seq);
-
-    switch (early_out) {
-      case EARLY_NO_INPUT:
-      case EARLY_USE_INPUT_2:
-        out = seq_render_strip(context, state, seq, timeline_frame);
-        break;
-      case EARLY_USE_INPUT_1:
-        if (i == 0) {
-          out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-        }
-        break;
-      case EARLY_DO_EFFECT:
-        if (i == 0) {
-          begin = seq_estimate_render_cost_begin();
+    begin = seq_estimate_render_cost_begin();
 
-          ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-          ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+    ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+    ImBuf *ibuf2 = seq_render_strip_stack_input_get(
+        context, state, seq_arr, ibuf_arr, bottom, timeline_frame);
 
-          out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
+    out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
-          float cost = seq_estimate_render_cost_end(context->scene, begin);
-          BKE_sequencer_cache_put(
-              context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
+    float cost = seq_estimate_render_cost_end(context->scene, begin);
+    BKE_sequencer_cache_put(
+        context, seq, timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
 
-          IMB_freeImBuf(ibuf1);
-          IMB_freeImBuf(ibuf2);
-        }
-        break;
-    }
-    if (out) {
-      break;
-    }
+    IMB_freeImBuf(ibuf1);
+    IMB_freeImBuf(ibuf2);
   }
 
-  i++;
-  for (; i < count; i++) {
+  for (i = bottom + 1; i < count; i++) {
     begin = seq_estimate_render_cost_begin();
     Sequence *seq = seq_arr[i];
 
-    if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
+    if (early_out_arr[i] == EARLY_DO_EFFECT) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+      ImBuf *ibuf2 = seq_render_strip_stack_input_get(
+          context, state, seq_arr, ibuf_arr, i, timeline_frame);
 
       out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
@@ -2034,7 +2252,7 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
 
   BKE_sequencer_cache_free_temp_cache(context->scene, context->task_id, timeline_frame);
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
   float cost = 0;
 
   if (count && !out) {
@@ -64,6 +64,8 @@ int seq_get_shown_sequences(struct ListBase *seqbasep,
                             int timeline_frame,
                             int chanshown,
                             struct Sequence **seq_arr_out);
+bool seq_render_strip_is_threadsafe(const struct Sequence *seq);
+void seq_render_strip_stack_need_input(struct Sequence **seq_arr, int count, bool *r_need_input);
 struct ImBuf *seq_render_strip(const struct SeqRenderData *context,
                                struct SeqRenderState *state,
                                struct Sequence *seq,
@@ -0,0 +1,104 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_sequence_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "SEQ_sequencer.h"
+
+/* Number of strips blended on top of each other, like a strip stack. */
+#define STACK_SIZE 10
+
+static void effect_stack_performance(int type, const char *name, bool use_float)
+{
+  const int x = 3840, y = 2160;
+  const int flags = use_float ? IB_rectfloat : IB_rect;
+
+  SeqRenderData render_data = {nullptr};
+  render_data.rectx = x;
+  render_data.recty = y;
+
+  Sequence seq = {nullptr};
+  seq.type = type;
+
+  ImBuf *layer = IMB_allocImBuf(x, y, 32, flags);
+  ImBuf *accum[2] = {IMB_allocImBuf(x, y, 32, flags), IMB_allocImBuf(x, y, 32, flags)};
+
+  const int num_channels = 4 * x * y;
+  if (use_float) {
+    BLI_array_frand(layer->rect_float, num_channels, 1);
+    BLI_array_frand(accum[0]->rect_float, num_channels, 2);
+  }
+  else {
+    RNG *rng = BLI_rng_new(0);
+    BLI_rng_get_char_n(rng, (char *)layer->rect, num_channels);
+    BLI_rng_get_char_n(rng, (char *)accum[0]->rect, num_channels);
+    BLI_rng_free(rng);
+  }
+
+  struct SeqEffectHandle sh = BKE_sequence_get_effect(&seq);
+
+  const double time_start = PIL_check_seconds_timer();
+  for (int i = 0; i < STACK_SIZE; i++) {
+    /* Blend the layer over one accumulation buffer, writing to the other one. */
+    sh.execute_slice(
+        &render_data, &seq, 0.0f, 0.5f, 0.5f, layer, accum[i & 1], nullptr, 0, y, accum[!(i & 1)]);
+  }
+  const double time_total = PIL_check_seconds_timer() - time_start;
+
+  printf("%s (%s): %d strips at %dx%d in %.4fs, %.4fs per strip\n",
+         name,
+         use_float ? "float" : "byte",
+         STACK_SIZE,
+         x,
+         y,
+         time_total,
+         time_total / STACK_SIZE);
+
+  IMB_freeImBuf(layer);
+  IMB_freeImBuf(accum[0]);
+  IMB_freeImBuf(accum[1]);
+}
+
+TEST(sequencer_effects, alphaover)
+{
+  effect_stack_performance(SEQ_TYPE_ALPHAOVER, "alpha over", false);
+  effect_stack_performance(SEQ_TYPE_ALPHAOVER, "alpha over", true);
+}
+
+TEST(sequencer_effects, alphaunder)
+{
+  effect_stack_performance(SEQ_TYPE_ALPHAUNDER, "alpha under", true);
+}
+
+TEST(sequencer_effects, cross)
+{
+  effect_stack_performance(SEQ_TYPE_CROSS, "cross", false);
+  effect_stack_performance(SEQ_TYPE_CROSS, "cross", true);
+}
+
+TEST(sequencer_effects, add)
+{
+  effect_stack_performance(SEQ_TYPE_ADD, "add", true);
+}
+
+TEST(sequencer_effects, sub)
+{
+  effect_stack_performance(SEQ_TYPE_SUB, "sub", true);
+}
+
+TEST(sequencer_effects, mul)
+{
+  effect_stack_performance(SEQ_TYPE_MUL, "mul", false);
+  effect_stack_performance(SEQ_TYPE_MUL, "mul", true);
+}
@@ -32,6 +32,7 @@
 
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -365,7 +366,12 @@ static int UNUSED_FUNCTION(cloth_calc_helper_forces)(Object *UNUSED(ob),
   return 1;
 }
 
-BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
+/* Compute the force of linear springs without modifying the solver data, so it can run in
+ * parallel for all springs. Angular and hair bending forces are computed and applied in
+ * #cloth_apply_spring_force instead. */
+BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd,
+                                        ClothSpring *s,
+                                        ImplicitSpringForce *r_force)
 {
   Cloth *cloth = clmd->clothObject;
   ClothSimSettings *parms = clmd->sim_parms;
@@ -374,23 +380,14 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
   bool resist_compress = (parms->flags & CLOTH_SIMSETTINGS_FLAG_RESIST_SPRING_COMPRESS) &&
                          !using_angular;
 
+  r_force->active = false;
   s->flags &= ~CLOTH_SPRING_FLAG_NEEDED;
 
-  /* Calculate force of bending springs. */
-  if ((s->type & CLOTH_SPRING_TYPE_BENDING) && using_angular) {
 #ifdef CLOTH_FORCE_SPRING_BEND
-    float k, scaling;
-
+  if ((s->type & CLOTH_SPRING_TYPE_BENDING) && using_angular) {
     s->flags |= CLOTH_SPRING_FLAG_NEEDED;
-
-    scaling = parms->bending + s->ang_stiffness * fabsf(parms->max_bend - parms->bending);
-    k = scaling * s->restlen *
-        0.1f; /* Multiplying by 0.1, just to scale the forces to more reasonable values. */
-
-    SIM_mass_spring_force_spring_angular(
-        data, s->ij, s->kl, s->pa, s->pb, s->la, s->lb, s->restang, k, parms->bending_damping);
-#endif
   }
+#endif
 
   /* Calculate force of structural + shear springs. */
   if (s->type &
@@ -408,17 +405,18 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
       /* TODO: verify, half verified (couldn't see error)
        * sewing springs usually have a large distance at first so clamp the force so we don't get
        * tunneling through collision objects. */
-      SIM_mass_spring_force_spring_linear(data,
-                                          s->ij,
-                                          s->kl,
-                                          s->restlen,
-                                          k_tension,
-                                          parms->tension_damp,
-                                          0.0f,
-                                          0.0f,
-                                          false,
-                                          false,
-                                          parms->max_sewing);
+      SIM_mass_spring_calc_spring_linear(data,
+                                         s->ij,
+                                         s->kl,
+                                         s->restlen,
+                                         k_tension,
+                                         parms->tension_damp,
+                                         0.0f,
+                                         0.0f,
+                                         false,
+                                         false,
+                                         parms->max_sewing,
+                                         r_force);
     }
     else if (s->type & CLOTH_SPRING_TYPE_STRUCTURAL) {
       float k_compression, scaling_compression;
@@ -426,17 +424,18 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
                             s->lin_stiffness * fabsf(parms->max_compression - parms->compression);
       k_compression = scaling_compression / (parms->avg_spring_len + FLT_EPSILON);
 
-      SIM_mass_spring_force_spring_linear(data,
-                                          s->ij,
-                                          s->kl,
-                                          s->restlen,
-                                          k_tension,
-                                          parms->tension_damp,
-                                          k_compression,
-                                          parms->compression_damp,
-                                          resist_compress,
-                                          using_angular,
-                                          0.0f);
+      SIM_mass_spring_calc_spring_linear(data,
+                                         s->ij,
+                                         s->kl,
+                                         s->restlen,
+                                         k_tension,
+                                         parms->tension_damp,
+                                         k_compression,
+                                         parms->compression_damp,
+                                         resist_compress,
+                                         using_angular,
+                                         0.0f,
+                                         r_force);
     }
     else {
       /* CLOTH_SPRING_TYPE_INTERNAL */
@@ -464,17 +463,18 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
         k_compression_damp = 0.0f;
       }
 
-      SIM_mass_spring_force_spring_linear(data,
-                                          s->ij,
-                                          s->kl,
-                                          s->restlen,
-                                          k_tension,
-                                          k_tension_damp,
-                                          k_compression,
-                                          k_compression_damp,
-                                          resist_compress,
-                                          using_angular,
-                                          0.0f);
+      SIM_mass_spring_calc_spring_linear(data,
+                                         s->ij,
+                                         s->kl,
+                                         s->restlen,
+                                         k_tension,
+                                         k_tension_damp,
+                                         k_compression,
+                                         k_compression_damp,
+                                         resist_compress,
+                                         using_angular,
+                                         0.0f,
+                                         r_force);
     }
 #endif
   }
@@ -487,17 +487,18 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
     scaling = parms->shear + s->lin_stiffness * fabsf(parms->max_shear - parms->shear);
     k = scaling / (parms->avg_spring_len + FLT_EPSILON);
 
-    SIM_mass_spring_force_spring_linear(data,
-                                        s->ij,
-                                        s->kl,
-                                        s->restlen,
-                                        k,
-                                        parms->shear_damp,
-                                        0.0f,
-                                        0.0f,
-                                        resist_compress,
-                                        false,
-                                        0.0f);
+    SIM_mass_spring_calc_spring_linear(data,
+                                       s->ij,
+                                       s->kl,
+                                       s->restlen,
+                                       k,
+                                       parms->shear_damp,
+                                       0.0f,
+                                       0.0f,
+                                       resist_compress,
+                                       false,
+                                       0.0f,
+                                       r_force);
 #endif
   }
   else if (s->type & CLOTH_SPRING_TYPE_BENDING) { /* calculate force of bending springs */
@@ -512,14 +513,47 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
     /* Fix for T45084 for cloth stiffness must have cb proportional to kb */
     cb = kb * parms->bending_damping;
 
-    SIM_mass_spring_force_spring_bending(data, s->ij, s->kl, s->restlen, kb, cb);
+    SIM_mass_spring_calc_spring_bending(data, s->ij, s->kl, s->restlen, kb, cb, r_force);
 #endif
   }
   else if (s->type & CLOTH_SPRING_TYPE_BENDING_HAIR) {
 #ifdef CLOTH_FORCE_SPRING_BEND
-    float kb, cb, scaling;
-
     s->flags |= CLOTH_SPRING_FLAG_NEEDED;
+#endif
+  }
+}
+
+/* Add the spring force to the solver, in the same order as the springs
+ * so the result does not depend on the threads scheduling. */
+BLI_INLINE void cloth_apply_spring_force(ClothModifierData *clmd,
+                                         ClothSpring *s,
+                                         const ImplicitSpringForce *force)
+{
+  Cloth *cloth = clmd->clothObject;
+  ClothSimSettings *parms = clmd->sim_parms;
+  Implicit_Data *data = cloth->implicit;
+  bool using_angular = parms->bending_model == CLOTH_BENDING_ANGULAR;
+
+  /* Calculate force of bending springs. */
+  if ((s->type & CLOTH_SPRING_TYPE_BENDING) && using_angular) {
+#ifdef CLOTH_FORCE_SPRING_BEND
+    float k, scaling;
+
+    scaling = parms->bending + s->ang_stiffness * fabsf(parms->max_bend - parms->bending);
+    k = scaling * s->restlen *
+        0.1f; /* Multiplying by 0.1, just to scale the forces to more reasonable values. */
+
+    SIM_mass_spring_force_spring_angular(
+        data, s->ij, s->kl, s->pa, s->pb, s->la, s->lb, s->restang, k, parms->bending_damping);
+#endif
+  }
+
+  if (force->active) {
+    SIM_mass_spring_apply_spring_force(data, force);
+  }
+  else if (s->type & CLOTH_SPRING_TYPE_BENDING_HAIR) {
+#ifdef CLOTH_FORCE_SPRING_BEND
+    float kb, cb, scaling;
 
     /* XXX WARNING: angular bending springs for hair apply stiffness factor as an overall factor,
      * unlike cloth springs! this is crap, but needed due to cloth/hair mixing ... max_bend factor
@@ -558,6 +592,64 @@ BLI_INLINE void cloth_calc_spring_force(ClothModifierData *clmd, ClothSpring *s)
   }
 }
 
+typedef struct SpringForceTaskData {
+  ClothModifierData *clmd;
+  ClothSpring **springs;
+  ImplicitSpringForce *forces;
+} SpringForceTaskData;
+
+static void cloth_calc_spring_force_task(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SpringForceTaskData *data = (SpringForceTaskData *)userdata;
+  ClothSpring *spring = data->springs[i];
+
+  /* only handle active springs */
+  if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+    cloth_calc_spring_force(data->clmd, spring, &data->forces[i]);
+  }
+}
+
+static void cloth_calc_spring_forces(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+  const int springs_num = BLI_linklist_count(cloth->springs);
+  if (springs_num == 0) {
+    return;
+  }
+
+  ClothSpring **springs = (ClothSpring **)MEM_malloc_arrayN(
+      springs_num, sizeof(*springs), __func__);
+  ImplicitSpringForce *forces = (ImplicitSpringForce *)MEM_malloc_arrayN(
+      springs_num, sizeof(*forces), __func__);
+
+  int i = 0;
+  for (LinkNode *link = cloth->springs; link; link = link->next, i++) {
+    springs[i] = (ClothSpring *)link->link;
+  }
+
+  /* Evaluate the springs in parallel, then add them to the solver in order. */
+  SpringForceTaskData data;
+  data.clmd = clmd;
+  data.springs = springs;
+  data.forces = forces;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, springs_num, &data, cloth_calc_spring_force_task, &settings);
+
+  for (i = 0; i < springs_num; i++) {
+    if (!(springs[i]->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
+      cloth_apply_spring_force(clmd, springs[i], &forces[i]);
+    }
+  }
+
+  MEM_freeN(springs);
+  MEM_freeN(forces);
+}
+
 static void hair_get_boundbox(ClothModifierData *clmd, float gmin[3], float gmax[3])
 {
   Cloth *cloth = clmd->clothObject;
@@ -788,13 +880,7 @@ static void cloth_calc_force(
   }
 
   /* calculate spring forces */
-  for (LinkNode *link = cloth->springs; link; link = link->next) {
-    ClothSpring *spring = (ClothSpring *)link->link;
-    /* only handle active springs */
-    if (!(spring->flags & CLOTH_SPRING_FLAG_DEACTIVATE)) {
-      cloth_calc_spring_force(clmd, spring);
-    }
-  }
+  cloth_calc_spring_forces(clmd);
 }
 
 /* returns vertexes' motion state */
@@ -1318,6 +1404,8 @@ int SIM_cloth_solve(
     cloth_calc_force(scene, clmd, frame, effectors, step);
 
     /* calculate new velocity and position */
+    SIM_mass_spring_solver_set_preconditioner(
+        id, (clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_SOLVER_PRECONDITIONER) != 0);
     SIM_mass_spring_solve_velocities(id, dt, &result);
     cloth_record_result(clmd, &result, dt);
 
@@ -59,6 +59,17 @@ typedef struct ImplicitSolverResult {
   float error;
 } ImplicitSolverResult;
 
+/* Force of a spring between two vertices and its derivatives, computed without modifying the
+ * solver data so springs can be evaluated in parallel, then applied in a fixed order. */
+typedef struct ImplicitSpringForce {
+  int i, j;
+  bool active;
+
+  float f[3];
+  float dfdx[3][3];
+  float dfdv[3][3];
+} ImplicitSpringForce;
+
 BLI_INLINE void implicit_print_matrix_elem(float v)
 {
   printf("%-8.3f", v);
@@ -100,6 +111,8 @@ void SIM_mass_spring_add_constraint_ndof2(struct Implicit_Data *data,
                                           const float c1[3],
                                           const float dV[3]);
 
+/* Use a block diagonal (Jacobi) preconditioner in the conjugate gradient solver. */
+void SIM_mass_spring_solver_set_preconditioner(struct Implicit_Data *data, bool use_precond);
 bool SIM_mass_spring_solve_velocities(struct Implicit_Data *data,
                                       float dt,
                                       struct ImplicitSolverResult *result);
@@ -144,17 +157,18 @@ void SIM_mass_spring_force_vertex_wind(struct Implicit_Data *data,
                                        float radius,
                                        const float (*winvec)[3]);
 /* Linear spring force between two points */
-bool SIM_mass_spring_force_spring_linear(struct Implicit_Data *data,
-                                         int i,
-                                         int j,
-                                         float restlen,
-                                         float stiffness_tension,
-                                         float damping_tension,
-                                         float stiffness_compression,
-                                         float damping_compression,
-                                         bool resist_compress,
-                                         bool new_compress,
-                                         float clamp_force);
+bool SIM_mass_spring_calc_spring_linear(struct Implicit_Data *data,
+                                        int i,
+                                        int j,
+                                        float restlen,
+                                        float stiffness_tension,
+                                        float damping_tension,
+                                        float stiffness_compression,
+                                        float damping_compression,
+                                        bool resist_compress,
+                                        bool new_compress,
+                                        float clamp_force,
+                                        struct ImplicitSpringForce *r_force);
 /* Angular spring force between two polygons */
 bool SIM_mass_spring_force_spring_angular(struct Implicit_Data *data,
                                           int i,
@@ -167,8 +181,17 @@ bool SIM_mass_spring_force_spring_angular(struct Implicit_Data *data,
                                           float stiffness,
                                           float damping);
 /* Bending force, forming a triangle at the base of two structural springs */
-bool SIM_mass_spring_force_spring_bending(
-    struct Implicit_Data *data, int i, int j, float restlen, float kb, float cb);
+bool SIM_mass_spring_calc_spring_bending(struct Implicit_Data *data,
+                                         int i,
+                                         int j,
+                                         float restlen,
+                                         float kb,
+                                         float cb,
+                                         struct ImplicitSpringForce *r_force);
+/* Add a spring force computed by one of the functions above to the system,
+ * must be called from a single thread. */
+void SIM_mass_spring_apply_spring_force(struct Implicit_Data *data,
+                                        const struct ImplicitSpringForce *force);
 /* Angular bending force based on local target vectors */
 bool SIM_mass_spring_force_spring_bending_hair(struct Implicit_Data *data,
                                                int i,
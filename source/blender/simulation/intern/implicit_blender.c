@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -46,9 +47,8 @@
 #    pragma GCC diagnostic ignored "-Wtype-limits"
 #  endif
 
-#  ifdef _OPENMP
-#    define CLOTH_OPENMP_LIMIT 512
-#  endif
+/* Long vector and big matrix operations are multi-threaded above this number of vertices. */
+#  define CLOTH_PARALLEL_LIMIT 1024
 
 //#define DEBUG_TIME
 
@@ -192,20 +192,90 @@ DO_INLINE void submul_lfvectorS(float (*to)[3],
     VECSUBMUL(to[i], fLongVector[i], scalar);
   }
 }
+/* Parallel long vector operations.
+ *
+ * Vectors are processed in chunks, the number of which only depends on the vector length. This
+ * way reductions sum the same partial results in the same order regardless of the threads
+ * scheduling, and the simulation gives the same result on every run. */
+
+#  define LFVECTOR_CHUNKS_MAX 256
+
+/* Off-diagonal blocks of a big matrix touching each vertex, in increasing block order.
+ * Lets the sparse matrix product be computed per vertex without concurrent writes. */
+typedef struct BigMatrixAdjacency {
+  unsigned int *offsets; /* vcount + 1 start indices into blocks */
+  unsigned int *blocks;  /* block indices, at most 2 per block */
+} BigMatrixAdjacency;
+
+typedef struct LfVectorTaskData {
+  unsigned int verts;
+  unsigned int chunk_size;
+  int num_chunks;
+
+  float (*to)[3];
+  float (*a)[3];
+  float (*b)[3];
+  fmatrix3x3 *matrix;
+  fmatrix3x3 *lA;
+  const BigMatrixAdjacency *adjacency;
+  float s;
+
+  /* Per chunk results of reductions. */
+  float partial[LFVECTOR_CHUNKS_MAX];
+} LfVectorTaskData;
+
+static void lfvector_task_data_init(LfVectorTaskData *data, unsigned int verts)
+{
+  data->verts = verts;
+  data->chunk_size = MAX2(CLOTH_PARALLEL_LIMIT, divide_ceil_u(verts, LFVECTOR_CHUNKS_MAX));
+  data->num_chunks = (int)divide_ceil_u(verts, data->chunk_size);
+}
+
+BLI_INLINE void lfvector_chunk_range(const LfVectorTaskData *data,
+                                     const int chunk,
+                                     unsigned int *r_start,
+                                     unsigned int *r_end)
+{
+  *r_start = (unsigned int)chunk * data->chunk_size;
+  *r_end = MIN2(*r_start + data->chunk_size, data->verts);
+}
+
+static void lfvector_parallel_chunks(LfVectorTaskData *data, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (data->num_chunks > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, data->num_chunks, data, func, &settings);
+}
+
+static void dot_lfvector_task(void *__restrict userdata,
+                              const int chunk,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorTaskData *data = userdata;
+  unsigned int start, end;
+  lfvector_chunk_range(data, chunk, &start, &end);
+
+  float temp = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    temp += dot_v3v3(data->a[i], data->b[i]);
+  }
+  data->partial[chunk] = temp;
+}
+
 /* dot product for big vector */
-DO_INLINE float dot_lfvector(float (*fLongVectorA)[3],
-                             float (*fLongVectorB)[3],
-                             unsigned int verts)
+static float dot_lfvector(float (*fLongVectorA)[3], float (*fLongVectorB)[3], unsigned int verts)
 {
-  long i = 0;
-  float temp = 0.0;
-  /* XXX brecht, disabled this for now (first schedule line was already disabled),
-   * due to non-commutative nature of floating point ops this makes the sim give
-   * different results each time you run it!
-   * schedule(guided, 2) */
-  //#pragma omp parallel for reduction(+: temp) if (verts > CLOTH_OPENMP_LIMIT)
-  for (i = 0; i < (long)verts; i++) {
-    temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
+  LfVectorTaskData data;
+  lfvector_task_data_init(&data, verts);
+  data.a = fLongVectorA;
+  data.b = fLongVectorB;
+  lfvector_parallel_chunks(&data, dot_lfvector_task);
+
+  float temp = 0.0f;
+  for (int chunk = 0; chunk < data.num_chunks; chunk++) {
+    temp += data.partial[chunk];
   }
   return temp;
 }
@@ -221,19 +291,34 @@ DO_INLINE void add_lfvector_lfvector(float (*to)[3],
     add_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
   }
 }
-/* A = B + C * float --> for big vector */
-DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
-                                      float (*fLongVectorA)[3],
-                                      float (*fLongVectorB)[3],
-                                      float bS,
-                                      unsigned int verts)
+static void add_lfvector_lfvectorS_task(void *__restrict userdata,
+                                        const int chunk,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  unsigned int i = 0;
+  LfVectorTaskData *data = userdata;
+  unsigned int start, end;
+  lfvector_chunk_range(data, chunk, &start, &end);
 
-  for (i = 0; i < verts; i++) {
-    VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
+  for (unsigned int i = start; i < end; i++) {
+    VECADDS(data->to[i], data->a[i], data->b[i], data->s);
   }
 }
+
+/* A = B + C * float --> for big vector */
+static void add_lfvector_lfvectorS(float (*to)[3],
+                                   float (*fLongVectorA)[3],
+                                   float (*fLongVectorB)[3],
+                                   float bS,
+                                   unsigned int verts)
+{
+  LfVectorTaskData data;
+  lfvector_task_data_init(&data, verts);
+  data.to = to;
+  data.a = fLongVectorA;
+  data.b = fLongVectorB;
+  data.s = bS;
+  lfvector_parallel_chunks(&data, add_lfvector_lfvectorS_task);
+}
 /* A = B * float + C * float --> for big vector */
 DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
                                        float (*fLongVectorA)[3],
@@ -613,35 +698,82 @@ DO_INLINE void initdiag_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
   }
 }
 
-/* SPARSE SYMMETRIC multiply big matrix with long vector*/
-/* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+/* Build the per vertex list of the first num_blocks off-diagonal blocks of the matrix. */
+static void adjacency_bfmatrix_build(BigMatrixAdjacency *adjacency,
+                                     const fmatrix3x3 *matrix,
+                                     unsigned int num_blocks)
+{
+  const unsigned int vcount = matrix[0].vcount;
+  unsigned int *offsets = adjacency->offsets;
+
+  memset(offsets, 0, sizeof(*offsets) * (vcount + 1));
+  for (unsigned int b = vcount; b < vcount + num_blocks; b++) {
+    offsets[matrix[b].r + 1]++;
+    if (matrix[b].c != matrix[b].r) {
+      offsets[matrix[b].c + 1]++;
+    }
+  }
+  for (unsigned int i = 0; i < vcount; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  /* Fill using the vertex start as cursor, which ends up at the start of the next vertex,
+   * then shift the offsets back. */
+  for (unsigned int b = vcount; b < vcount + num_blocks; b++) {
+    adjacency->blocks[offsets[matrix[b].r]++] = b;
+    if (matrix[b].c != matrix[b].r) {
+      adjacency->blocks[offsets[matrix[b].c]++] = b;
+    }
+  }
+  for (unsigned int i = vcount; i > 0; i--) {
+    offsets[i] = offsets[i - 1];
+  }
+  offsets[0] = 0;
+}
+
+static void mul_bfmatrix_lfvector_task(void *__restrict userdata,
+                                       const int chunk,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  unsigned int vcount = from[0].vcount;
-  lfVector *temp = create_lfvector(vcount);
+  LfVectorTaskData *data = userdata;
+  const fmatrix3x3 *from = data->matrix;
+  const BigMatrixAdjacency *adjacency = data->adjacency;
+  lfVector *fLongVector = data->a;
+  unsigned int start, end;
+  lfvector_chunk_range(data, chunk, &start, &end);
 
-  zero_lfvector(to, vcount);
+  for (unsigned int i = start; i < end; i++) {
+    float *to = data->to[i];
+    mul_v3_m3v3(to, from[i].m, fLongVector[i]);
 
-#  pragma omp parallel sections if (vcount > CLOTH_OPENMP_LIMIT)
-  {
-#  pragma omp section
-    {
-      for (unsigned int i = from[0].vcount; i < from[0].vcount + from[0].scount; i++) {
+    for (unsigned int k = adjacency->offsets[i]; k < adjacency->offsets[i + 1]; k++) {
+      const fmatrix3x3 *block = &from[adjacency->blocks[k]];
+      if (block->r == i) {
+        muladd_fmatrix_fvector(to, block->m, fLongVector[block->c]);
+      }
+      if (block->c == i) {
         /* This is the lower triangle of the sparse matrix,
          * therefore multiplication occurs with transposed submatrices. */
-        muladd_fmatrixT_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-      }
-    }
-#  pragma omp section
-    {
-      for (unsigned int i = 0; i < from[0].vcount + from[0].scount; i++) {
-        muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
+        muladd_fmatrixT_fvector(to, block->m, fLongVector[block->r]);
       }
     }
   }
-  add_lfvector_lfvector(to, to, temp, from[0].vcount);
+}
 
-  del_lfvector(temp);
+/* SPARSE SYMMETRIC multiply big matrix with long vector*/
+/* STATUS: verified */
+static void mul_bfmatrix_lfvector(float (*to)[3],
+                                  fmatrix3x3 *from,
+                                  const BigMatrixAdjacency *adjacency,
+                                  lfVector *fLongVector)
+{
+  LfVectorTaskData data;
+  lfvector_task_data_init(&data, from[0].vcount);
+  data.to = to;
+  data.a = fLongVector;
+  data.matrix = from;
+  data.adjacency = adjacency;
+  lfvector_parallel_chunks(&data, mul_bfmatrix_lfvector_task);
 }
 
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
@@ -683,6 +815,9 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+  bool use_precond;     /* use Pinv in the conjugate gradient solver */
+
+  BigMatrixAdjacency adjacency; /* off-diagonal blocks per vertex, shared by A and dFdX */
 } Implicit_Data;
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -707,6 +842,10 @@ Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
   id->B = create_lfvector(numverts);
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
+  id->adjacency.offsets = MEM_malloc_arrayN(
+      numverts + 1, sizeof(*id->adjacency.offsets), "cloth_implicit_adjacency_offsets");
+  id->adjacency.blocks = MEM_malloc_arrayN(
+      max_ii(numsprings * 2, 1), sizeof(*id->adjacency.blocks), "cloth_implicit_adjacency");
 
   initdiag_bfmatrix(id->bigI, I);
 
@@ -734,6 +873,9 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  MEM_freeN(id->adjacency.offsets);
+  MEM_freeN(id->adjacency.blocks);
+
   MEM_freeN(id);
 }
 
@@ -771,13 +913,84 @@ BLI_INLINE void root_to_world_m3(Implicit_Data *data,
 
 /* ================================ */
 
-DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
+static void filter_task(void *__restrict userdata,
+                        const int chunk,
+                        const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  unsigned int i = 0;
+  LfVectorTaskData *data = userdata;
+  const fmatrix3x3 *S = data->matrix;
+  unsigned int start, end;
+  lfvector_chunk_range(data, chunk, &start, &end);
+
+  for (unsigned int i = start; i < end; i++) {
+    mul_m3_v3(S[i].m, data->to[S[i].r]);
+  }
+}
+
+static void filter(lfVector *V, fmatrix3x3 *S)
+{
+  LfVectorTaskData data;
+  lfvector_task_data_init(&data, S[0].vcount);
+  data.to = V;
+  data.matrix = S;
+  lfvector_parallel_chunks(&data, filter_task);
+}
+
+static void precond_build_task(void *__restrict userdata,
+                               const int chunk,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorTaskData *data = userdata;
+  fmatrix3x3 *Pinv = data->matrix;
+  unsigned int start, end;
+  lfvector_chunk_range(data, chunk, &start, &end);
 
-  for (i = 0; i < S[0].vcount; i++) {
-    mul_m3_v3(S[i].m, V[S[i].r]);
+  for (unsigned int i = start; i < end; i++) {
+    /* Fall back to the identity for degenerate blocks, same as not preconditioning them. */
+    if (!invert_m3_m3(Pinv[i].m, data->lA[i].m)) {
+      unit_m3(Pinv[i].m);
+    }
+  }
+}
+
+/* Block diagonal (Jacobi) preconditioner: the inverse of the diagonal blocks of A. */
+static void precond_build(fmatrix3x3 *Pinv, fmatrix3x3 *lA)
+{
+  LfVectorTaskData data;
+  lfvector_task_data_init(&data, lA[0].vcount);
+  data.matrix = Pinv;
+  data.lA = lA;
+  lfvector_parallel_chunks(&data, precond_build_task);
+}
+
+static void precond_apply_task(void *__restrict userdata,
+                               const int chunk,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorTaskData *data = userdata;
+  const fmatrix3x3 *Pinv = data->matrix;
+  unsigned int start, end;
+  lfvector_chunk_range(data, chunk, &start, &end);
+
+  for (unsigned int i = start; i < end; i++) {
+    mul_v3_m3v3(data->to[i], Pinv[i].m, data->a[i]);
+  }
+}
+
+/* to = P^-1 * from, or a copy of from when not preconditioning. */
+static void precond_apply(float (*to)[3], fmatrix3x3 *Pinv, float (*from)[3], unsigned int verts)
+{
+  if (Pinv == NULL) {
+    cp_lfvector(to, from, verts);
+    return;
   }
+
+  LfVectorTaskData data;
+  lfvector_task_data_init(&data, verts);
+  data.to = to;
+  data.a = from;
+  data.matrix = Pinv;
+  lfvector_parallel_chunks(&data, precond_apply_task);
 }
 
 /* this version of the CG algorithm does not work very well with partial constraints
@@ -850,11 +1063,14 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 }
 #  endif
 
+/* Pinv is the inverse of the block diagonal preconditioner, or NULL to solve without it. */
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const BigMatrixAdjacency *adjacency,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
+                       fmatrix3x3 *Pinv,
                        ImplicitSolverResult *result)
 {
   /* Solves for unknown X in equation AX=B */
@@ -872,19 +1088,24 @@ static int cg_filtered(lfVector *ldV,
 
   cp_lfvector(ldV, z, numverts);
 
-  /* d0 = filter(B)^T * P * filter(B) */
+  if (Pinv) {
+    precond_build(Pinv, lA);
+  }
+
+  /* d0 = filter(B)^T * P^-1 * filter(B) */
   cp_lfvector(fB, lB, numverts);
   filter(fB, S);
-  bnorm2 = dot_lfvector(fB, fB, numverts);
+  precond_apply(s, Pinv, fB, numverts);
+  bnorm2 = dot_lfvector(fB, s, numverts);
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector(AdV, lA, adjacency, ldV);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
   /* c = filter(P^-1 * r) */
-  cp_lfvector(c, r, numverts);
+  precond_apply(c, Pinv, r, numverts);
   filter(c, S);
 
   /* delta = r^T * c */
@@ -902,7 +1123,7 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
+    mul_bfmatrix_lfvector(q, lA, adjacency, c);
     filter(q, S);
 
     alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -912,7 +1133,7 @@ static int cg_filtered(lfVector *ldV,
     add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
 
     /* s = P^-1 * r */
-    cp_lfvector(s, r, numverts);
+    precond_apply(s, Pinv, r, numverts);
     delta_old = delta_new;
     delta_new = dot_lfvector(r, s, numverts);
 
@@ -1151,6 +1372,11 @@ static int cg_filtered_pre(lfVector *dv,
 }
 #  endif
 
+void SIM_mass_spring_solver_set_preconditioner(Implicit_Data *data, bool use_precond)
+{
+  data->use_precond = use_precond;
+}
+
 bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSolverResult *result)
 {
   unsigned int numverts = data->dFdV[0].vcount;
@@ -1162,7 +1388,10 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* All matrices share the off-diagonal blocks allocated for this step. */
+  adjacency_bfmatrix_build(&data->adjacency, data->A, data->num_blocks);
+
+  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, &data->adjacency, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1171,7 +1400,14 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV,
+              data->A,
+              &data->adjacency,
+              data->B,
+              data->z,
+              data->S,
+              data->use_precond ? data->Pinv : NULL,
+              result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
@@ -1794,22 +2030,34 @@ BLI_INLINE void apply_spring(Implicit_Data *data,
   sub_m3_m3m3(data->dFdV[block_ij].m, data->dFdV[block_ij].m, dfdv);
 }
 
-bool SIM_mass_spring_force_spring_linear(Implicit_Data *data,
-                                         int i,
-                                         int j,
-                                         float restlen,
-                                         float stiffness_tension,
-                                         float damping_tension,
-                                         float stiffness_compression,
-                                         float damping_compression,
-                                         bool resist_compress,
-                                         bool new_compress,
-                                         float clamp_force)
+BLI_INLINE void spring_force_init(ImplicitSpringForce *r_force, int i, int j)
+{
+  r_force->i = i;
+  r_force->j = j;
+  r_force->active = false;
+}
+
+bool SIM_mass_spring_calc_spring_linear(Implicit_Data *data,
+                                        int i,
+                                        int j,
+                                        float restlen,
+                                        float stiffness_tension,
+                                        float damping_tension,
+                                        float stiffness_compression,
+                                        float damping_compression,
+                                        bool resist_compress,
+                                        bool new_compress,
+                                        float clamp_force,
+                                        ImplicitSpringForce *r_force)
 {
   float extent[3], length, dir[3], vel[3];
-  float f[3], dfdx[3][3], dfdv[3][3];
+  float *f = r_force->f;
+  float(*dfdx)[3] = r_force->dfdx;
+  float(*dfdv)[3] = r_force->dfdv;
   float damping = 0;
 
+  spring_force_init(r_force, i, j);
+
   /* calculate elongation */
   spring_length(data, i, j, extent, dir, &length, vel);
 
@@ -1849,22 +2097,30 @@ bool SIM_mass_spring_force_spring_linear(Implicit_Data *data,
   madd_v3_v3fl(f, dir, damping * dot_v3v3(vel, dir));
   dfdv_damp(dfdv, dir, damping);
 
-  apply_spring(data, i, j, f, dfdx, dfdv);
-
+  r_force->active = true;
   return true;
 }
 
 /* See "Stable but Responsive Cloth" (Choi, Ko 2005) */
-bool SIM_mass_spring_force_spring_bending(
-    Implicit_Data *data, int i, int j, float restlen, float kb, float cb)
+bool SIM_mass_spring_calc_spring_bending(Implicit_Data *data,
+                                         int i,
+                                         int j,
+                                         float restlen,
+                                         float kb,
+                                         float cb,
+                                         ImplicitSpringForce *r_force)
 {
   float extent[3], length, dir[3], vel[3];
 
+  spring_force_init(r_force, i, j);
+
   /* calculate elongation */
   spring_length(data, i, j, extent, dir, &length, vel);
 
   if (length < restlen) {
-    float f[3], dfdx[3][3], dfdv[3][3];
+    float *f = r_force->f;
+    float(*dfdx)[3] = r_force->dfdx;
+    float(*dfdv)[3] = r_force->dfdv;
 
     mul_v3_v3fl(f, dir, fbstar(length, restlen, kb, cb));
 
@@ -1874,14 +2130,20 @@ bool SIM_mass_spring_force_spring_bending(
     /* XXX damping not supported */
     zero_m3(dfdv);
 
-    apply_spring(data, i, j, f, dfdx, dfdv);
-
+    r_force->active = true;
     return true;
   }
 
   return false;
 }
 
+void SIM_mass_spring_apply_spring_force(Implicit_Data *data, const ImplicitSpringForce *force)
+{
+  if (force->active) {
+    apply_spring(data, force->i, force->j, force->f, force->dfdx, force->dfdv);
+  }
+}
+
 BLI_INLINE void poly_avg(lfVector *data, const int *inds, int len, float r_avg[3])
 {
   float fact = 1.0f / (float)len;
@@ -0,0 +1,61 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_threads.h"
+
+#include "implicit_test_utils.hh"
+
+namespace blender::sim::tests {
+
+class ImplicitSolverTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_threadapi_exit();
+  }
+};
+
+TEST_F(ImplicitSolverTest, hanging_sheet)
+{
+  /* 2 frames at 5 quality steps. */
+  const int steps = 10;
+  const HangingSheet sheet(16);
+
+  HangingSheet::SimulationStats stats_per_precond[2];
+  for (const bool use_precond : {false, true}) {
+    HangingSheet::SimulationStats &stats = stats_per_precond[use_precond];
+    float(*positions)[3] = sheet.simulate(steps, use_precond, &stats);
+    EXPECT_EQ(stats.failed_steps, 0);
+
+    /* Pinned vertices did not move, the rest of the sheet fell. */
+    EXPECT_EQ(positions[sheet.vert_index(0, sheet.size - 1)][2], 0.0f);
+    EXPECT_LT(positions[sheet.vert_index(sheet.size / 2, 0)][2], 0.0f);
+    for (int v = 0; v < sheet.verts_num; v++) {
+      EXPECT_TRUE(isfinite(positions[v][0]) && isfinite(positions[v][1]) &&
+                  isfinite(positions[v][2]));
+    }
+
+    /* The result does not depend on the threads scheduling. */
+    HangingSheet::SimulationStats stats_other;
+    float(*positions_other)[3] = sheet.simulate(steps, use_precond, &stats_other);
+    EXPECT_EQ(stats.iterations, stats_other.iterations);
+    EXPECT_EQ(memcmp(positions, positions_other, sizeof(float[3]) * sheet.verts_num), 0);
+
+    MEM_freeN(positions_other);
+    MEM_freeN(positions);
+  }
+
+  /* The masses differ by an order of magnitude between the hem and the rest of the sheet,
+   * which the block Jacobi preconditioner compensates for. */
+  EXPECT_LT(stats_per_precond[true].iterations, stats_per_precond[false].iterations);
+}
+
+}  // namespace blender::sim::tests
@@ -0,0 +1,174 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+
+#include "SIM_mass_spring.h"
+#include "implicit.h"
+
+namespace blender::sim::tests {
+
+/**
+ * Cloth sheet of `size` by `size` vertices pinned along one edge, with a heavier hem to make
+ * the system less uniform, like a garment hanging from its collar. Simulated headless using
+ * the mass-spring API directly.
+ */
+class HangingSheet {
+ public:
+  static constexpr float spacing = 0.01f;
+  static constexpr float dt = 0.2f;
+
+  struct SimulationStats {
+    int iterations;
+    int failed_steps;
+  };
+
+  const int size;
+  const int verts_num;
+  int springs_num = 0;
+
+ private:
+  struct Spring {
+    int i, j;
+    float restlen;
+    bool bending;
+  };
+
+  Spring *springs;
+
+  void spring_add(const int i, const int j, const float restlen, const bool bending)
+  {
+    springs[springs_num++] = {i, j, restlen, bending};
+  }
+
+ public:
+  /* Structural and shear springs between neighbors, bending springs skipping one vertex. */
+  HangingSheet(const int size) : size(size), verts_num(size * size)
+  {
+    springs = static_cast<Spring *>(MEM_malloc_arrayN(verts_num * 6, sizeof(Spring), __func__));
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        const int v = vert_index(x, y);
+        if (x + 1 < size) {
+          spring_add(v, vert_index(x + 1, y), spacing, false);
+        }
+        if (y + 1 < size) {
+          spring_add(v, vert_index(x, y + 1), spacing, false);
+        }
+        if (x + 1 < size && y + 1 < size) {
+          spring_add(v, vert_index(x + 1, y + 1), spacing * (float)M_SQRT2, false);
+          spring_add(vert_index(x + 1, y), vert_index(x, y + 1), spacing * (float)M_SQRT2, false);
+        }
+        if (x + 2 < size) {
+          spring_add(v, vert_index(x + 2, y), spacing * 2.0f, true);
+        }
+        if (y + 2 < size) {
+          spring_add(v, vert_index(x, y + 2), spacing * 2.0f, true);
+        }
+      }
+    }
+  }
+
+  ~HangingSheet()
+  {
+    MEM_freeN(springs);
+  }
+
+  int vert_index(const int x, const int y) const
+  {
+    return y * size + x;
+  }
+
+  /* The hem is made of the first 4 rows, the opposite edge is pinned. */
+  float vert_mass(const int v) const
+  {
+    return (v < size * 4) ? 3.0f : 0.3f;
+  }
+
+  /* Simulate the sheet falling from a horizontal position, and return the final positions. */
+  float (*simulate(const int steps, const bool use_precond, SimulationStats *r_stats) const)[3]
+  {
+    const float zero[3] = {0.0f, 0.0f, 0.0f};
+    const float gravity[3] = {0.0f, 0.0f, -9.81f * 0.001f};
+    float unit[3][3];
+    unit_m3(unit);
+
+    Implicit_Data *data = SIM_mass_spring_solver_create(verts_num, springs_num);
+    SIM_mass_spring_solver_set_preconditioner(data, use_precond);
+
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        const int v = vert_index(x, y);
+        const float co[3] = {x * spacing, y * spacing, 0.0f};
+        SIM_mass_spring_set_vertex_mass(data, v, vert_mass(v));
+        SIM_mass_spring_set_rest_transform(data, v, unit);
+        SIM_mass_spring_set_motion_state(data, v, co, zero);
+      }
+    }
+
+    const float k_linear = 15.0f / spacing;
+    const float k_bending = 0.5f / (20.0f * spacing);
+
+    r_stats->iterations = 0;
+    r_stats->failed_steps = 0;
+
+    for (int step = 0; step < steps; step++) {
+      SIM_mass_spring_clear_constraints(data);
+      for (int x = 0; x < size; x++) {
+        SIM_mass_spring_add_constraint_ndof0(data, vert_index(x, size - 1), zero);
+      }
+
+      SIM_mass_spring_clear_forces(data);
+      for (int v = 0; v < verts_num; v++) {
+        SIM_mass_spring_force_gravity(data, v, vert_mass(v), gravity);
+      }
+      SIM_mass_spring_force_drag(data, 0.01f);
+
+      for (int s = 0; s < springs_num; s++) {
+        const Spring &spring = springs[s];
+        ImplicitSpringForce force;
+        if (spring.bending) {
+          SIM_mass_spring_calc_spring_bending(
+              data, spring.i, spring.j, spring.restlen, k_bending, k_bending * 0.5f, &force);
+        }
+        else {
+          SIM_mass_spring_calc_spring_linear(data,
+                                             spring.i,
+                                             spring.j,
+                                             spring.restlen,
+                                             k_linear,
+                                             5.0f,
+                                             k_linear,
+                                             5.0f,
+                                             false,
+                                             true,
+                                             0.0f,
+                                             &force);
+        }
+        SIM_mass_spring_apply_spring_force(data, &force);
+      }
+
+      ImplicitSolverResult result;
+      if (!SIM_mass_spring_solve_velocities(data, dt, &result)) {
+        r_stats->failed_steps++;
+      }
+      r_stats->iterations += result.iterations;
+      SIM_mass_spring_solve_positions(data, dt);
+      SIM_mass_spring_apply_result(data);
+    }
+
+    float(*positions)[3] = static_cast<float(*)[3]>(
+        MEM_malloc_arrayN(verts_num, sizeof(float[3]), __func__));
+    for (int v = 0; v < verts_num; v++) {
+      SIM_mass_spring_get_position(data, v, positions[v]);
+    }
+
+    SIM_mass_spring_solver_free(data);
+    return positions;
+  }
+};
+
+}  // namespace blender::sim::tests
@@ -0,0 +1,45 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
+
+#include "implicit_test_utils.hh"
+
+namespace blender::sim::tests {
+
+static void hanging_sheet_performance(const int size, const int steps, const bool use_precond)
+{
+  const HangingSheet sheet(size);
+
+  HangingSheet::SimulationStats stats;
+  const double time_start = PIL_check_seconds_timer();
+  float(*positions)[3] = sheet.simulate(steps, use_precond, &stats);
+  const double time_total = PIL_check_seconds_timer() - time_start;
+
+  printf("%s: %d vertices, %d springs, %d steps in %.4fs, %d iterations, %d failed steps\n",
+         use_precond ? "Block Jacobi preconditioner" : "No preconditioner",
+         sheet.verts_num,
+         sheet.springs_num,
+         steps,
+         time_total,
+         stats.iterations,
+         stats.failed_steps);
+
+  MEM_freeN(positions);
+}
+
+TEST(implicit_solver, hanging_sheet)
+{
+  BLI_threadapi_init();
+  /* 10 frames at 5 quality steps. */
+  hanging_sheet_performance(128, 50, false);
+  hanging_sheet_performance(128, 50, true);
+  BLI_threadapi_exit();
+}
+
+}  // namespace blender::sim::tests
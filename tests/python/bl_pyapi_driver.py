@@ -0,0 +1,52 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_pyapi_driver.py -- --verbose
+import bpy
+import unittest
+
+
+class TestDriverExpression(unittest.TestCase):
+    def setUp(self):
+        self.obj = bpy.data.objects.new("test_driver", None)
+        bpy.context.scene.collection.objects.link(self.obj)
+        self.driver = self.obj.driver_add("location", 0).driver
+
+    def tearDown(self):
+        bpy.data.objects.remove(self.obj)
+
+    def evaluate(self, expression):
+        self.driver.expression = expression
+        stats = bpy.app.driver_stats
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        depsgraph.update()
+        stats_new = bpy.app.driver_stats
+        value = self.obj.evaluated_get(depsgraph).location.x
+        return value, (stats_new[0] - stats[0], stats_new[1] - stats[1])
+
+    def test_math_namespace(self):
+        self.assertIs(bpy.app.driver_namespace["math"].floor,
+                      bpy.app.driver_namespace["floor"])
+
+    def test_stats_simple(self):
+        value, stats = self.evaluate("math.floor(frame) + pi")
+        self.assertAlmostEqual(value, 1.0 + 3.14159265, places=5)
+        self.assertEqual(stats, (1, 0))
+
+    def test_stats_python(self):
+        value, stats = self.evaluate("len('ab') + frame")
+        self.assertEqual(value, 3.0)
+        self.assertEqual(stats, (0, 1))
+
+    def test_stats_compiled_once(self):
+        self.evaluate("len('ab') + frame")
+        stats = bpy.app.driver_stats
+        bpy.context.scene.frame_set(2)
+        self.assertEqual(self.obj.evaluated_get(bpy.context.evaluated_depsgraph_get()).location.x,
+                         4.0)
+        self.assertEqual(bpy.app.driver_stats, stats)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
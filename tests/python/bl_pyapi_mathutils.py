@@ -4,6 +4,8 @@
 import unittest
 from mathutils import Matrix, Vector, Quaternion
 from mathutils import kdtree, geometry
+from mathutils.bvhtree import BVHTree
+from array import array
 import math
 
 # keep globals immutable
@@ -31,6 +33,18 @@ vector_data = sum(
                    for sign in (1.0, -1.0))), ()) + ((0.0, 0.0, 0.0),)
 
 
+def vectors_as_buffer(vectors, size=3):
+    # 2D buffer of 32 bit floats, as used by the array methods.
+    values = array('f', [value for vector in vectors for value in vector])
+    return memoryview(values).cast('B').cast('f', (len(vectors), size))
+
+
+def assertAlmostEqualVectorScaled(test, first, second):
+    # Compare float32 results relative to the vector scale.
+    test.assertLessEqual((Vector(first) - Vector(second)).length,
+                         1e-5 * max(1.0, Vector(second).length))
+
+
 class MatrixTesting(unittest.TestCase):
     def test_matrix_column_access(self):
         # mat =
@@ -233,6 +247,30 @@ class MatrixTesting(unittest.TestCase):
 
         self.assertEqual(mat @ mat, prod_mat)
 
+    def test_matrix_transform_points(self):
+        for mat in (Matrix.Translation((1, 2, 3)) @ Matrix.Rotation(math.radians(30), 4, 'Z'),
+                    Matrix.Rotation(math.radians(30), 3, 'X') @ Matrix.Scale(2.0, 3)):
+            points = vectors_as_buffer(vector_data)
+            mat.transform_points(points)
+            for v, v_transformed in zip(vector_data, points.tolist()):
+                assertAlmostEqualVectorScaled(self, v_transformed, mat @ Vector(v))
+
+        # Flat buffers are supported as well.
+        points = array('f', (1.0, 2.0, 3.0) * 2)
+        Matrix.Translation((1, 1, 1)).transform_points(points)
+        self.assertEqual(points.tolist(), [2.0, 3.0, 4.0] * 2)
+
+    def test_matrix_transform_points_invalid(self):
+        mat = Matrix.Identity(4)
+        with self.assertRaises(TypeError):
+            mat.transform_points(array('d', (0.0,) * 3))
+        with self.assertRaises(TypeError):
+            mat.transform_points(bytes(12))
+        with self.assertRaises(ValueError):
+            mat.transform_points(array('f', (0.0,) * 4))
+        with self.assertRaises(ValueError):
+            Matrix.Identity(2).transform_points(array('f', (0.0,) * 3))
+
 
 class VectorTesting(unittest.TestCase):
 
@@ -259,6 +297,20 @@ class VectorTesting(unittest.TestCase):
         with self.assertRaises(TypeError):
             vec @= vec
 
+    def test_vector_normalize_array(self):
+        for size in (2, 3, 4):
+            vectors = [v[:size] if size <= 3 else v + (0.5,) for v in vector_data]
+            vectors_buffer = vectors_as_buffer(vectors, size)
+            Vector.normalize_array(vectors_buffer)
+            for v, v_normalized in zip(vectors, vectors_buffer.tolist()):
+                v = Vector(v)
+                v.normalize()
+                assertAlmostEqualVectorScaled(self, v_normalized, v)
+
+        # The row size can't be known from a flat buffer.
+        with self.assertRaises(ValueError):
+            Vector.normalize_array(array('f', (1.0, 2.0, 3.0)))
+
     """
     # tests for element-wise multiplication
 
@@ -316,6 +368,13 @@ class QuaternionTesting(unittest.TestCase):
         self.assertAlmostEqual(axis.y, math.sqrt(0.5), 6)
         self.assertAlmostEqual(axis.z, 0)
 
+    def test_rotate_points(self):
+        q = Quaternion((1, 2, 3), math.radians(60))
+        points = vectors_as_buffer(vector_data)
+        q.rotate_points(points)
+        for v, v_rotated in zip(vector_data, points.tolist()):
+            assertAlmostEqualVectorScaled(self, v_rotated, q @ Vector(v))
+
 
 class KDTreeTesting(unittest.TestCase):
     @staticmethod
@@ -487,6 +546,88 @@ class KDTreeTesting(unittest.TestCase):
         with self.assertRaises(ValueError):
             k.find((0,) * 3, filter=lambda i: None)
 
+    def test_kdtree_find_array(self):
+        k = self.kdtree_create_grid_3d(5)
+        co = [(x * 0.13, x * 0.07 - 0.2, 1.0 - x * 0.11) for x in range(50)]
+
+        co_found = vectors_as_buffer([(0.0, 0.0, 0.0)] * len(co))
+        indices = array('i', (0,) * len(co))
+        distances = array('f', (0.0,) * len(co))
+        k.find_array(vectors_as_buffer(co),
+                     co_found=co_found,
+                     indices=indices,
+                     distances=distances)
+
+        for i, (co_find, co_find_found) in enumerate(zip(co, co_found.tolist())):
+            co_expect, index_expect, dist_expect = k.find(co_find)
+            self.assertEqual(indices[i], index_expect)
+            self.assertAlmostEqual(distances[i], dist_expect, places=5)
+            self.assertAlmostEqualVector(co_find_found, co_expect)
+
+    def test_kdtree_find_array_empty(self):
+        k = kdtree.KDTree(0)
+        k.balance()
+        indices = array('i', (0,) * 2)
+        k.find_array(array('f', (0.0,) * 6), indices=indices)
+        self.assertEqual(indices.tolist(), [-1, -1])
+
+    def test_kdtree_find_array_invalid(self):
+        k = kdtree.KDTree(2)
+        k.insert((0.0, 0.0, 0.0), 0)
+        k.balance()
+        with self.assertRaises(ValueError):
+            k.find_array(array('f', (0.0,) * 6), indices=array('i', (0,) * 3))
+        k.insert((0.0, 0.0, 0.0), 1)
+        with self.assertRaises(RuntimeError):
+            k.find_array(array('f', (0.0,) * 3))
+
+
+class BVHTreeTesting(unittest.TestCase):
+    def test_ray_cast_array(self):
+        tree = BVHTree.FromPolygons(((-1, -1, 0), (1, -1, 0), (1, 1, 0), (-1, 1, 0)),
+                                    ((0, 1, 2, 3),))
+        origins = ((0.0, 0.0, 1.0), (0.0, 0.0, 1.0), (5.0, 5.0, 1.0), (0.5, 0.5, 2.0))
+        directions = ((0.0, 0.0, -1.0), (0.0, 0.0, 1.0), (0.0, 0.0, -1.0), (0.0, 0.0, -2.0))
+
+        locations = vectors_as_buffer([(0.0, 0.0, 0.0)] * len(origins))
+        normals = vectors_as_buffer([(0.0, 0.0, 0.0)] * len(origins))
+        indices = array('i', (0,) * len(origins))
+        distances = array('f', (0.0,) * len(origins))
+        hits_num = tree.ray_cast_array(vectors_as_buffer(origins),
+                                       vectors_as_buffer(directions),
+                                       locations=locations,
+                                       normals=normals,
+                                       indices=indices,
+                                       distances=distances)
+        self.assertEqual(hits_num, 2)
+
+        locations = locations.tolist()
+        normals = normals.tolist()
+        for i, (origin, direction) in enumerate(zip(origins, directions)):
+            location, normal, index, distance = tree.ray_cast(origin, direction)
+            if index is None:
+                self.assertEqual(indices[i], -1)
+                self.assertTrue(math.isnan(distances[i]))
+                self.assertTrue(math.isnan(locations[i][0]))
+            else:
+                self.assertEqual(indices[i], index)
+                self.assertAlmostEqual(distances[i], distance)
+                self.assertEqual(Vector(locations[i]), location)
+                self.assertEqual(Vector(normals[i]), normal)
+
+        # Outputs are optional, and the distance limits the hits.
+        self.assertEqual(tree.ray_cast_array(vectors_as_buffer(origins),
+                                             vectors_as_buffer(directions),
+                                             1.5), 1)
+
+    def test_ray_cast_array_invalid(self):
+        tree = BVHTree.FromPolygons(((0, 0, 0), (1, 0, 0), (0, 1, 0)), ((0, 1, 2),))
+        with self.assertRaises(ValueError):
+            tree.ray_cast_array(array('f', (0.0,) * 6), array('f', (0.0,) * 3))
+        with self.assertRaises(TypeError):
+            tree.ray_cast_array(array('f', (0.0,) * 3), array('f', (0.0,) * 3),
+                                indices=array('f', (0.0,)))
+
 
 class TesselatePolygon(unittest.TestCase):
     def test_empty(self):
@@ -0,0 +1,101 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_pyapi_prop_collection_buffer.py -- --verbose
+import bpy
+import unittest
+import numpy as np
+
+
+class TestPropCollectionBuffer(unittest.TestCase):
+    def setUp(self):
+        # A grid of 10 by 10 vertices with a single quad.
+        self.mesh = bpy.data.meshes.new("test_buffer")
+        self.mesh.from_pydata([(x, y, 0.0) for y in range(10) for x in range(10)],
+                              [], [(0, 1, 11, 10)])
+
+    def tearDown(self):
+        bpy.data.meshes.remove(self.mesh)
+
+    def test_read(self):
+        co = np.asarray(self.mesh.vertices.as_buffer("co"))
+        self.assertEqual(co.shape, (100, 3))
+        self.assertEqual(co.dtype, np.float32)
+
+        co_expect = np.empty(300, dtype=np.float32)
+        self.mesh.vertices.foreach_get("co", co_expect)
+        self.assertTrue(np.array_equal(co, co_expect.reshape(100, 3)))
+
+    def test_write(self):
+        co = np.asarray(self.mesh.vertices.as_buffer("co"))
+        co[:, 2] = 1.0
+        co[5] = (2.0, 3.0, 4.0)
+        self.assertEqual(self.mesh.vertices[0].co.z, 1.0)
+        self.assertEqual(tuple(self.mesh.vertices[5].co), (2.0, 3.0, 4.0))
+
+    def test_scalar(self):
+        vertex_index = np.asarray(self.mesh.loops.as_buffer("vertex_index"))
+        self.assertEqual(vertex_index.shape, (4,))
+        self.assertEqual(vertex_index.dtype, np.uint32)
+        vertex_index[:] = (10, 11, 1, 0)
+        self.assertEqual(self.mesh.loops[2].vertex_index, 1)
+
+    def test_read_only(self):
+        self.mesh.calc_loop_triangles()
+        loops = memoryview(self.mesh.loop_triangles.as_buffer("loops"))
+        self.assertTrue(loops.readonly)
+        self.assertEqual(loops.shape, (2, 3))
+
+    def test_attribute(self):
+        attribute = self.mesh.attributes.new("test", 'FLOAT', 'POINT')
+        values = np.asarray(attribute.data.as_buffer("value"))
+        self.assertTrue(values.flags["C_CONTIGUOUS"])
+        values[:] = np.arange(100, dtype=np.float32)
+        self.assertEqual(attribute.data[42].value, 42.0)
+
+    def test_empty(self):
+        mesh = bpy.data.meshes.new("test_buffer_empty")
+        self.assertEqual(len(memoryview(mesh.vertices.as_buffer("co"))), 0)
+        bpy.data.meshes.remove(mesh)
+
+    def test_invalid_attribute(self):
+        with self.assertRaises(AttributeError):
+            self.mesh.vertices.as_buffer("not_an_attribute")
+        with self.assertRaises(TypeError):
+            self.mesh.vertices.as_buffer("normal")
+
+    def test_reallocated(self):
+        buffer = self.mesh.vertices.as_buffer("co")
+        self.mesh.vertices.add(10)
+        with self.assertRaises(ReferenceError):
+            memoryview(buffer)
+
+        co = np.asarray(self.mesh.vertices.as_buffer("co"))
+        self.assertEqual(co.shape, (110, 3))
+
+    def test_exported_views(self):
+        co = np.asarray(self.mesh.vertices.as_buffer("co"))
+        # The data can't be reallocated or freed while the array points to it.
+        with self.assertRaises(BufferError):
+            self.mesh.vertices.add(10)
+        with self.assertRaises(BufferError):
+            bpy.data.meshes.remove(self.mesh)
+        with self.assertRaises(BufferError):
+            bpy.data.batch_remove([self.mesh])
+
+        del co
+        self.mesh.vertices.add(10)
+        self.assertEqual(len(self.mesh.vertices), 110)
+
+    def test_removed(self):
+        mesh = bpy.data.meshes.new("test_buffer_removed")
+        mesh.vertices.add(4)
+        buffer = mesh.vertices.as_buffer("co")
+        bpy.data.meshes.remove(mesh)
+        with self.assertRaises(ReferenceError):
+            memoryview(buffer)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
@@ -0,0 +1,57 @@
+# Apache License, Version 2.0
+
+# Compares reading and writing mesh data with `as_buffer` and with `foreach_get/foreach_set`.
+# Not run as a test, the timings depend on the machine:
+# ./blender.bin --background -noaudio --factory-startup \
+#     --python tests/python/bl_pyapi_prop_collection_buffer_benchmark.py
+import bpy
+import time
+import numpy as np
+
+VERTS_NUM = 1024 * 1024
+REPEAT = 10
+
+
+def time_best(func):
+    best = float("inf")
+    for _ in range(REPEAT):
+        time_start = time.perf_counter()
+        func()
+        best = min(best, time.perf_counter() - time_start)
+    return best
+
+
+def main():
+    mesh = bpy.data.meshes.new("benchmark_buffer")
+    mesh.vertices.add(VERTS_NUM)
+    co = np.random.default_rng(0).random((VERTS_NUM, 3), dtype=np.float32)
+    mesh.vertices.foreach_set("co", co.ravel())
+
+    co_read = np.empty(VERTS_NUM * 3, dtype=np.float32)
+
+    def read_foreach_get():
+        mesh.vertices.foreach_get("co", co_read)
+
+    def read_as_buffer():
+        co_read.reshape(VERTS_NUM, 3)[:] = mesh.vertices.as_buffer("co")
+
+    def write_foreach_set():
+        mesh.vertices.foreach_set("co", co_read)
+
+    def write_as_buffer():
+        np.asarray(mesh.vertices.as_buffer("co"))[:] = co_read.reshape(VERTS_NUM, 3)
+
+    print("%d vertices, best of %d:" % (VERTS_NUM, REPEAT))
+    for name, func in (
+            ("read foreach_get", read_foreach_get),
+            ("read as_buffer", read_as_buffer),
+            ("write foreach_set", write_foreach_set),
+            ("write as_buffer", write_as_buffer),
+    ):
+        print("  %-18s %.4fs" % (name, time_best(func)))
+
+    bpy.data.meshes.remove(mesh)
+
+
+if __name__ == "__main__":
+    main()
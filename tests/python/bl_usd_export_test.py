@@ -0,0 +1,107 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_usd_export_test.py -- --verbose
+import bpy
+import os
+import re
+import tempfile
+import unittest
+
+
+def usda_prims(text):
+    """Return the type of every prim defined in an ASCII USD file, by path."""
+    prims = {}
+    parents = []
+    for line in text.splitlines():
+        match = re.match(r'^( *)def (\w+) "(\w+)"', line)
+        if match is None:
+            continue
+        depth = len(match.group(1)) // 4
+        del parents[depth:]
+        parents.append(match.group(3))
+        prims["/" + "/".join(parents)] = match.group(2)
+    return prims
+
+
+def usda_array(text, name):
+    """Return the numbers of the first value of an array attribute, time sampled or not."""
+    match = re.search(name + r'(?: =|\.timeSamples = \{\s*[-\d.]+:) \[([^\]]*)\]', text)
+    if match is None:
+        return None
+    return [float(value) for value in re.findall(r'-?[\d.]+(?:e-?\d+)?', match.group(1))]
+
+
+class TestUSDExportPointInstancer(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        self.tempdir = tempfile.TemporaryDirectory()
+        self.filepath = os.path.join(self.tempdir.name, "point_instancer.usda")
+
+    def tearDown(self):
+        self.tempdir.cleanup()
+
+    @staticmethod
+    def collection_create(name, locations):
+        collection = bpy.data.collections.new(name)
+        for i, location in enumerate(locations):
+            mesh = bpy.data.meshes.new("%s_mesh_%d" % (name, i))
+            mesh.from_pydata([(0, 0, 0), (1, 0, 0), (0, 1, 0)], [], [(0, 1, 2)])
+            obj = bpy.data.objects.new("%s_%d" % (name, i), mesh)
+            obj.location = location
+            collection.objects.link(obj)
+        return collection
+
+    @staticmethod
+    def duplicator_create(name, collection, location):
+        obj = bpy.data.objects.new(name, None)
+        obj.instance_type = 'COLLECTION'
+        obj.instance_collection = collection
+        obj.location = location
+        bpy.context.scene.collection.objects.link(obj)
+        return obj
+
+    def export(self):
+        result = bpy.ops.wm.usd_export(filepath=self.filepath, use_instancing=True)
+        self.assertEqual(result, {'FINISHED'})
+        with open(self.filepath, encoding="utf-8") as usda:
+            return usda.read()
+
+    def test_collection_instance(self):
+        pair = self.collection_create("Pair", [(1, 0, 0), (0, 2, 0)])
+        self.duplicator_create("Duplicator", pair, (0, 0, 3))
+
+        text = self.export()
+        prims = usda_prims(text)
+
+        instancers = [path for path, prim_type in prims.items() if prim_type == "PointInstancer"]
+        self.assertEqual(len(instancers), 1)
+        self.assertTrue(instancers[0].startswith("/Duplicator/"))
+
+        prototypes = [path for path, prim_type in prims.items()
+                      if prim_type == "Mesh" and path.startswith(instancers[0] + "/Prototypes/")]
+        self.assertEqual(len(prototypes), 2)
+
+        # Positions are relative to the duplicator.
+        self.assertEqual(usda_array(text, "protoIndices"), [0, 1])
+        positions = usda_array(text, "positions")
+        self.assertEqual(len(positions), 6)
+        for value, expect in zip(positions, [1, 0, 0, 0, 2, 0]):
+            self.assertAlmostEqual(value, expect, places=5)
+
+    def test_single_instance(self):
+        single = self.collection_create("Single", [(1, 0, 0)])
+        self.duplicator_create("SingleDuplicator", single, (0, 0, 3))
+
+        text = self.export()
+        prims = usda_prims(text)
+
+        self.assertNotIn("PointInstancer", prims.values())
+        meshes = [path for path, prim_type in prims.items()
+                  if prim_type == "Mesh" and path.startswith("/SingleDuplicator/")]
+        self.assertEqual(len(meshes), 1)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()